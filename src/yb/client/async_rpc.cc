@@ -561,6 +561,14 @@ ReadRpc::ReadRpc(
   req_.set_consistency_level(yb_consistency_level);
   req_.set_proxy_uuid(batcher->proxy_uuid());
 
+  // Ops with different staleness bounds could be sent in the same RPC, the strictest one is used.
+  MonoDelta max_staleness;
+  auto update_max_staleness = [&max_staleness](const MonoDelta& op_max_staleness) {
+    if (op_max_staleness && (!max_staleness || op_max_staleness < max_staleness)) {
+      max_staleness = op_max_staleness;
+    }
+  };
+
   int ctr = 0;
   for (auto& op : ops_) {
     switch (op->yb_op->type()) {
@@ -570,6 +578,7 @@ ReadRpc::ReadRpc(
         // in ProcessResponseFromTserver.
         auto* redis_op = down_cast<YBRedisReadOp*>(op->yb_op.get());
         req_.add_redis_batch()->Swap(redis_op->mutable_request());
+        update_max_staleness(redis_op->max_staleness());
         break;
       }
       case YBOperation::Type::QL_READ: {
@@ -581,6 +590,7 @@ ReadRpc::ReadRpc(
         if (ql_op->read_time()) {
           ql_op->read_time().AddToPB(&req_);
         }
+        update_max_staleness(ql_op->max_staleness());
         break;
       }
       case YBOperation::Type::PGSQL_READ: {
@@ -605,6 +615,10 @@ ReadRpc::ReadRpc(
     VLOG(4) << ++ctr << ". Encoded row " << op->yb_op->ToString();
   }
 
+  if (max_staleness && yb_consistency_level != YBConsistencyLevel::STRONG) {
+    req_.set_max_staleness_ms(std::max<int64_t>(max_staleness.ToMilliseconds(), 1));
+  }
+
   if (VLOG_IS_ON(3)) {
     VLOG(3) << "Created batch for " << tablet->tablet_id() << ":\n" << req_.ShortDebugString();
   }
@@ -704,6 +718,9 @@ void ReadRpc::SwapRequestsAndResponses(bool skip_responses) {
               ql_response.rows_data_sidecar(), &rows_data));
           ql_op->mutable_rows_data()->assign(util::to_char_ptr(rows_data.data()), rows_data.size());
         }
+        if (resp_.has_hybrid_time()) {
+          ql_op->SetUsedReadTime(HybridTime(resp_.hybrid_time()));
+        }
         ql_idx++;
         break;
       }
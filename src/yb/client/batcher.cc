@@ -394,13 +394,17 @@ YB_DEFINE_ENUM(OpGroup, (kWrite)(kLeaderRead)(kConsistentPrefixRead));
 namespace {
 inline bool IsOkToReadFromFollower(const InFlightOpPtr& op) {
   return op->yb_op->type() == YBOperation::Type::REDIS_READ &&
-         FLAGS_redis_allow_reads_from_followers;
+         (FLAGS_redis_allow_reads_from_followers ||
+          std::static_pointer_cast<YBRedisReadOp>(op->yb_op)->max_staleness());
 }
 
 inline bool IsQLConsistentPrefixRead(const InFlightOpPtr& op) {
-  return op->yb_op->type() == YBOperation::Type::QL_READ &&
-         std::static_pointer_cast<YBqlReadOp>(op->yb_op)->yb_consistency_level() ==
-         YBConsistencyLevel::CONSISTENT_PREFIX;
+  if (op->yb_op->type() != YBOperation::Type::QL_READ) {
+    return false;
+  }
+  const auto& ql_op = std::static_pointer_cast<YBqlReadOp>(op->yb_op);
+  return ql_op->yb_consistency_level() == YBConsistencyLevel::CONSISTENT_PREFIX ||
+         ql_op->max_staleness();
 }
 } // namespace
 
@@ -16,11 +16,15 @@
 #include "yb/client/ql-dml-test-base.h"
 #include "yb/client/table_handle.h"
 
+#include "yb/consensus/consensus.h"
+
 #include "yb/tablet/tablet.h"
+#include "yb/tablet/tablet_metrics.h"
 #include "yb/tablet/tablet_peer.h"
 
 #include "yb/tserver/mini_tablet_server.h"
 #include "yb/tserver/tablet_server.h"
+#include "yb/tserver/ts_tablet_manager.h"
 
 #include "yb/util/backoff_waiter.h"
 #include "yb/util/curl_util.h"
@@ -191,10 +195,16 @@ class QLDmlTest : public QLDmlTestBase {
   }
 
   Result<RowValue> ReadRow(const YBSessionPtr& session, const RowKey& key,
-                           YBConsistencyLevel consistency_level = YBConsistencyLevel::STRONG) {
+                           YBConsistencyLevel consistency_level = YBConsistencyLevel::STRONG,
+                           const MonoDelta& max_staleness = MonoDelta(),
+                           HybridTime* used_read_time = nullptr) {
     auto op = SelectRow(session, kValueColumns, key);
     op->set_yb_consistency_level(consistency_level);
+    op->set_max_staleness(max_staleness);
     RETURN_NOT_OK(session->Flush());
+    if (used_read_time) {
+      *used_read_time = op->used_read_time();
+    }
     if (op->response().status() != QLResponsePB::YQL_STATUS_OK) {
       return STATUS_FORMAT(
           RemoteError, "Read filed: $0", QLResponsePB::QLStatus_Name(op->response().status()));
@@ -229,6 +239,18 @@ class QLDmlTest : public QLDmlTestBase {
     table_.AddColumns(kAllColumns, req);
   }
 
+  // Returns the number of QL reads served by each tablet peer in the cluster.
+  std::map<tablet::TabletPeer*, int64_t> CountTabletReads() {
+    std::map<tablet::TabletPeer*, int64_t> result;
+    for (int i = 0; i != cluster_->num_tablet_servers(); ++i) {
+      auto peers = cluster_->mini_tablet_server(i)->server()->tablet_manager()->GetTabletPeers();
+      for (const auto& peer : peers) {
+        result[peer.get()] = peer->tablet()->metrics()->ql_read_latency->TotalCount();
+      }
+    }
+    return result;
+  }
+
   TableHandle table_;
 };
 
@@ -1250,5 +1272,52 @@ TEST_F(QLDmlTest, ReadFollower) {
   ASSERT_TRUE(missing_rows.empty()) << "Missing rows: " << yb::ToString(missing_rows);
 }
 
+TEST_F(QLDmlTest, ReadFollowerBoundedStaleness) {
+  constexpr size_t kNumRows = 100;
+  constexpr int kMaxStalenessMs = 1000;
+  const auto kMaxStaleness = MonoDelta::FromMilliseconds(kMaxStalenessMs);
+
+  ASSERT_NO_FATALS(InsertRows(kNumRows));
+
+  // Rows written more than the staleness bound ago should be visible to every bounded staleness
+  // read, regardless of the replica that serves it.
+  std::this_thread::sleep_for(kMaxStaleness.ToSteadyDuration());
+  auto clock = cluster_->mini_tablet_server(0)->server()->Clock();
+  auto session = NewSession();
+  size_t follower_reads = 0;
+  for (size_t i = 0; i != kNumRows; ++i) {
+    auto reads_before = CountTabletReads();
+    auto min_read_time = clock->Now().AddMilliseconds(-kMaxStalenessMs);
+    HybridTime used_read_time;
+    auto row = ReadRow(session, KeyForIndex(i), YBConsistencyLevel::CONSISTENT_PREFIX,
+                       kMaxStaleness, &used_read_time);
+    ASSERT_OK(row);
+    ASSERT_EQ(*row, ValueForIndex(i));
+
+    // The read time is chosen by the serving replica within the bound.
+    ASSERT_TRUE(used_read_time.is_valid());
+    ASSERT_GE(used_read_time, min_read_time);
+    ASSERT_LE(used_read_time, clock->Now());
+
+    // Exactly one replica served the read.
+    tablet::TabletPeer* serving_peer = nullptr;
+    for (const auto& peer_and_reads : CountTabletReads()) {
+      if (peer_and_reads.second != reads_before[peer_and_reads.first]) {
+        ASSERT_EQ(serving_peer, nullptr) << "Read " << i << " served by several replicas";
+        serving_peer = peer_and_reads.first;
+      }
+    }
+    ASSERT_NE(serving_peer, nullptr) << "Read " << i << " not served";
+    if (serving_peer->consensus()->GetLeaderStatus() == consensus::LeaderStatus::NOT_LEADER) {
+      ++follower_reads;
+    }
+  }
+
+  // Tablet leaders are spread over the tablet servers, so followers should serve some of the reads,
+  // whether the client picks random replicas or the tablet server on its host.
+  LOG(INFO) << "Reads served by followers: " << follower_reads << " of " << kNumRows;
+  ASSERT_GT(follower_reads, 0);
+}
+
 }  // namespace client
 }  // namespace yb
@@ -18,6 +18,7 @@
 #include <boost/optional/optional.hpp>
 #include <boost/scope_exit.hpp>
 
+#include "yb/client/meta_cache.h"
 #include "yb/client/ql-dml-test-base.h"
 #include "yb/client/table_handle.h"
 #include "yb/client/transaction.h"
@@ -41,6 +42,7 @@
 #include "yb/tserver/tablet_server.h"
 #include "yb/tserver/ts_tablet_manager.h"
 
+#include "yb/util/metrics.h"
 #include "yb/util/random_util.h"
 
 using namespace std::literals;
@@ -65,7 +67,20 @@ DECLARE_uint64(aborted_intent_cleanup_ms);
 DECLARE_int32(intents_flush_max_delay_ms);
 DECLARE_int32(remote_bootstrap_max_chunk_size);
 DECLARE_int32(load_balancer_max_concurrent_adds);
+DECLARE_bool(transaction_single_shard_fast_path);
+DECLARE_bool(apply_intents_flush_before_crash);
+DECLARE_uint64(txn_max_apply_pending_deletes_bytes);
 DECLARE_int32(master_inject_latency_on_transactional_tablet_lookups_ms);
+DECLARE_uint64(txn_max_apply_batch_records);
+DECLARE_int32(apply_intents_crash_after_batches);
+DECLARE_int64(intent_index_memory_limit_bytes);
+DECLARE_int32(transaction_rpc_max_concurrent_batches);
+DECLARE_int32(transaction_status_inject_latency_ms);
+
+METRIC_DECLARE_counter(transaction_status_cache_hits);
+METRIC_DECLARE_counter(transaction_status_cache_misses);
+METRIC_DECLARE_counter(transaction_heartbeat_rpcs_saved);
+METRIC_DECLARE_counter(transaction_status_rpcs_saved);
 
 namespace yb {
 namespace client {
@@ -340,6 +355,16 @@ class QLTransactionTest : public KeyValueTableTest {
 
   void TestWriteConflicts(bool do_restarts);
 
+  MonoDelta MeasureWriteLatencyUnderContention(MonoDelta test_time);
+
+  // Returns number of tablets whose intent index is used for conflict resolution.
+  size_t CountReadyIntentIndexes();
+
+  Result<internal::RemoteTabletPtr> PickStatusTablet();
+
+  // Returns sum of specified counter over all tablet peers.
+  int64_t SumTabletCounters(CounterPrototype* prototype);
+
   std::shared_ptr<server::SkewedClock> skewed_clock_{
       std::make_shared<server::SkewedClock>(WallClock())};
   server::ClockPtr clock_{new server::HybridClock(skewed_clock_)};
@@ -354,6 +379,73 @@ TEST_F(QLTransactionTest, Simple) {
   CheckNoRunningTransactions();
 }
 
+// Test that transaction is correctly applied in several write batches, including replay of
+// partially applied transaction after restart.
+TEST_F(QLTransactionTest, ApplyInChunks) {
+  FLAGS_txn_max_apply_batch_records = 2;
+
+  WriteDataWithRepetition();
+  VerifyData();
+  CheckNoRunningTransactions();
+  ASSERT_EQ(0, CountIntents());
+
+  FLAGS_flush_rocksdb_on_shutdown = false;
+  WriteData(WriteOpType::UPDATE);
+  VerifyData(1, WriteOpType::UPDATE);
+  ASSERT_OK(cluster_->RestartSync());
+  VerifyData(1, WriteOpType::UPDATE);
+  CheckNoRunningTransactions();
+}
+
+// Test replay of transaction, whose apply was interrupted after some of its write batches were
+// written, i.e. of partially applied or partially removed transaction.
+TEST_F(QLTransactionTest, ApplyInChunksWithCrash) {
+  FLAGS_txn_max_apply_batch_records = 2;
+
+  size_t num_transactions = 0;
+  for (int crash_after_batches : {1, 2, 3, 5}) {
+    SetAtomicFlag(crash_after_batches, &FLAGS_apply_intents_crash_after_batches);
+    WriteData(WriteOpType::INSERT, num_transactions);
+    ++num_transactions;
+    // Wait until apply is interrupted, so its partial result is flushed during shutdown.
+    CheckNoRunningTransactions();
+    if (crash_after_batches == 1) {
+      // Intents are removed only after all regular records are written.
+      ASSERT_GT(CountIntents(), 0);
+    }
+
+    SetAtomicFlag(0, &FLAGS_apply_intents_crash_after_batches);
+    ASSERT_OK(cluster_->RestartSync());
+    VerifyData(num_transactions);
+    CheckNoRunningTransactions();
+    ASSERT_EQ(0, CountIntents());
+  }
+}
+
+// Same as ApplyInChunksWithCrash, but only intents DB is flushed right before the simulated crash,
+// and only some of the intent deletes are kept in memory while regular records are written.
+TEST_F(QLTransactionTest, ApplyInChunksWithIntentsFlush) {
+  FLAGS_flush_rocksdb_on_shutdown = false;
+  FLAGS_txn_max_apply_batch_records = 2;
+  FLAGS_txn_max_apply_pending_deletes_bytes = 1;
+  FLAGS_intents_flush_max_delay_ms = 100;
+  FLAGS_apply_intents_flush_before_crash = true;
+
+  size_t num_transactions = 0;
+  for (int crash_after_batches : {1, 2, 3, 4, 5, 6}) {
+    SetAtomicFlag(crash_after_batches, &FLAGS_apply_intents_crash_after_batches);
+    WriteData(WriteOpType::INSERT, num_transactions);
+    ++num_transactions;
+    CheckNoRunningTransactions();
+
+    SetAtomicFlag(0, &FLAGS_apply_intents_crash_after_batches);
+    ASSERT_OK(cluster_->RestartSync());
+    VerifyData(num_transactions);
+    CheckNoRunningTransactions();
+    ASSERT_EQ(0, CountIntents());
+  }
+}
+
 TEST_F(QLTransactionTest, LookupTabletFailure) {
   google::FlagSaver saver;
   FLAGS_master_inject_latency_on_transactional_tablet_lookups_ms =
@@ -904,6 +996,88 @@ TEST_F_EX(QLTransactionTest, WriteConflictsWithRestarts, WriteConflictsTest) {
   TestWriteConflicts(true /* do_restarts */);
 }
 
+// Runs transactional writes from several threads to the same small set of keys, so most writes
+// have to resolve conflicts with intents of other transactions. Returns average write latency.
+MonoDelta QLTransactionTest::MeasureWriteLatencyUnderContention(MonoDelta test_time) {
+  constexpr size_t kThreads = 8;
+  constexpr int kTotalKeys = 5;
+
+  std::atomic<bool> stop(false);
+  std::atomic<size_t> writes(0);
+  std::atomic<size_t> conflicts(0);
+  std::atomic<int64_t> total_write_us(0);
+  std::vector<std::thread> threads;
+
+  for (size_t i = 0; i != kThreads; ++i) {
+    threads.emplace_back([this, &stop, &writes, &conflicts, &total_write_us] {
+      int32_t value = 0;
+      while (!stop) {
+        auto txn = CreateTransaction();
+        auto session = CreateSession(txn);
+        auto start = MonoTime::Now();
+        auto result = WriteRow(session, RandomUniformInt(1, kTotalKeys), ++value);
+        total_write_us += (MonoTime::Now() - start).ToMicroseconds();
+        ++writes;
+        if (!result.ok() || !txn->CommitFuture().get().ok()) {
+          ++conflicts;
+        }
+      }
+    });
+  }
+
+  std::this_thread::sleep_for(test_time.ToSteadyDuration());
+  stop = true;
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_GT(writes.load(), 0);
+  auto result = MonoDelta::FromMicroseconds(total_write_us.load() / std::max<size_t>(writes, 1));
+  LOG(INFO) << "Writes: " << writes.load() << ", conflicts: " << conflicts.load()
+            << ", average write latency: " << result;
+  return result;
+}
+
+size_t QLTransactionTest::CountReadyIntentIndexes() {
+  size_t result = 0;
+  for (int i = 0; i != cluster_->num_tablet_servers(); ++i) {
+    auto peers = cluster_->mini_tablet_server(i)->server()->tablet_manager()->GetTabletPeers();
+    for (const auto& peer : peers) {
+      auto* intent_index = peer->tablet()->TEST_intent_index();
+      if (intent_index && intent_index->ready()) {
+        ++result;
+      }
+    }
+  }
+  return result;
+}
+
+// Compares write latency under contention when conflicts are resolved using intent index and
+// when they are resolved by reading intents DB.
+TEST_F(QLTransactionTest, WriteLatencyUnderContention) {
+  if (!AllowSlowTests()) {
+    LOG(WARNING) << "WriteLatencyUnderContention disabled since slow.";
+    return;
+  }
+  constexpr auto kTestTime = 10s;
+
+  ASSERT_OK(WaitFor(
+      [this] { return CountReadyIntentIndexes() != 0; }, 10s, "Intent index rebuilt"));
+  auto index_latency = MeasureWriteLatencyUnderContention(kTestTime);
+  ASSERT_NE(0, CountReadyIntentIndexes());
+
+  // Zero memory limit disables intent index on the first added intent.
+  FLAGS_intent_index_memory_limit_bytes = 0;
+  auto db_latency = MeasureWriteLatencyUnderContention(kTestTime);
+  ASSERT_EQ(0, CountReadyIntentIndexes());
+
+  LOG(INFO) << "Average write latency with intent index: " << index_latency
+            << ", with intents DB: " << db_latency;
+  // Allow some noise, but index should not make conflict resolution slower.
+  ASSERT_LE(index_latency.ToMicroseconds(), db_latency.ToMicroseconds() * 3 / 2);
+  CheckNoRunningTransactions();
+}
+
 TEST_F(QLTransactionTest, ResolveIntentsWriteReadUpdateRead) {
   DisableApplyingIntents();
 
@@ -916,6 +1090,159 @@ TEST_F(QLTransactionTest, ResolveIntentsWriteReadUpdateRead) {
   ASSERT_OK(cluster_->RestartSync());
 }
 
+TEST_F(QLTransactionTest, StatusCache) {
+  DisableApplyingIntents();
+
+  auto get_hits_and_misses = [this] {
+    std::pair<int64_t, int64_t> result(0, 0);
+    for (int i = 0; i != cluster_->num_tablet_servers(); ++i) {
+      auto peers = cluster_->mini_tablet_server(i)->server()->tablet_manager()->GetTabletPeers();
+      for (const auto& peer : peers) {
+        if (!peer->tablet()->transaction_participant()) {
+          continue;
+        }
+        const auto& entity = peer->tablet()->GetMetricEntity();
+        result.first += METRIC_transaction_status_cache_hits.Instantiate(entity)->value();
+        result.second += METRIC_transaction_status_cache_misses.Instantiate(entity)->value();
+      }
+    }
+    LOG(INFO) << "Transaction status cache hits: " << result.first
+              << ", misses: " << result.second;
+    return result;
+  };
+
+  WriteData();
+  VerifyData();
+  auto first_read = get_hits_and_misses();
+  ASSERT_GT(first_read.second, 0);
+
+  for (int i = 0; i != 4; ++i) {
+    VerifyData();
+  }
+  // Only the first read of each tablet should request status of the transaction, further reads
+  // should find it in the cache.
+  auto further_reads = get_hits_and_misses();
+  ASSERT_EQ(first_read.second, further_reads.second);
+  ASSERT_GT(further_reads.first, first_read.first);
+}
+
+Result<internal::RemoteTabletPtr> QLTransactionTest::PickStatusTablet() {
+  std::promise<Result<TabletId>> tablet_id_promise;
+  transaction_manager_->PickStatusTablet([&tablet_id_promise](const Result<TabletId>& tablet_id) {
+    tablet_id_promise.set_value(tablet_id);
+  });
+  auto tablet_id = VERIFY_RESULT(tablet_id_promise.get_future().get());
+
+  std::promise<Result<internal::RemoteTabletPtr>> tablet_promise;
+  client_->LookupTabletById(
+      tablet_id, MonoTime::Now() + 10s,
+      [&tablet_promise](const Result<internal::RemoteTabletPtr>& tablet) {
+        tablet_promise.set_value(tablet);
+      },
+      UseCache::kTrue);
+  return tablet_promise.get_future().get();
+}
+
+int64_t QLTransactionTest::SumTabletCounters(CounterPrototype* prototype) {
+  int64_t result = 0;
+  for (int i = 0; i != cluster_->num_tablet_servers(); ++i) {
+    auto peers = cluster_->mini_tablet_server(i)->server()->tablet_manager()->GetTabletPeers();
+    for (const auto& peer : peers) {
+      result += prototype->Instantiate(peer->tablet()->GetMetricEntity())->value();
+    }
+  }
+  return result;
+}
+
+// Checks that heartbeats queued while max number of heartbeat RPCs are in flight are sent in
+// a single RPC, and that each heartbeat gets its own result.
+TEST_F(QLTransactionTest, BatchedHeartbeats) {
+  constexpr size_t kTransactions = 10;
+
+  auto status_tablet = ASSERT_RESULT(PickStatusTablet());
+  auto saved_before = SumTabletCounters(&METRIC_transaction_heartbeat_rpcs_saved);
+
+  // Nothing is sent while limit is zero, so all heartbeats are queued.
+  SetAtomicFlag(0, &FLAGS_transaction_rpc_max_concurrent_batches);
+  std::vector<std::promise<Status>> results(kTransactions + 1);
+  for (size_t i = 0; i != kTransactions; ++i) {
+    transaction_manager_->Heartbeat(
+        status_tablet, GenerateTransactionId(), TransactionStatus::CREATED,
+        [&result = results[i]](const Status& status) { result.set_value(status); });
+  }
+
+  // Coordinator does not know this transaction, so its heartbeat should fail, while heartbeats
+  // from the same batch succeed.
+  SetAtomicFlag(1, &FLAGS_transaction_rpc_max_concurrent_batches);
+  transaction_manager_->Heartbeat(
+      status_tablet, GenerateTransactionId(), TransactionStatus::PENDING,
+      [&result = results.back()](const Status& status) { result.set_value(status); });
+
+  for (size_t i = 0; i != kTransactions; ++i) {
+    ASSERT_OK(results[i].get_future().get());
+  }
+  auto status = results.back().get_future().get();
+  ASSERT_TRUE(status.IsExpired()) << status;
+
+  ASSERT_EQ(kTransactions,
+            SumTabletCounters(&METRIC_transaction_heartbeat_rpcs_saved) - saved_before);
+}
+
+// Checks that status requests of transactions with the same status tablet are sent in a single
+// RPC, while status RPC to this tablet is in flight.
+TEST_F(QLTransactionTest, BatchedStatusRequests) {
+  // Use single status tablet, so all requests from participant could be batched.
+  transaction_manager_.emplace(client_, clock_, [](std::vector<const TabletId*>* ids) {
+    std::sort(ids->begin(), ids->end(), [](const TabletId* lhs, const TabletId* rhs) {
+      return *lhs < *rhs;
+    });
+    ids->resize(1);
+  });
+
+  // Write pending transactions, until some tablet has at least 3 of them. So when status of
+  // the first one is requested, others should be queued and sent in a single RPC.
+  std::vector<YBTransactionPtr> transactions;
+  int32_t num_keys = 0;
+  for (;;) {
+    size_t max_running = 0;
+    for (int i = 0; i != cluster_->num_tablet_servers(); ++i) {
+      auto peers = cluster_->mini_tablet_server(i)->server()->tablet_manager()->GetTabletPeers();
+      for (const auto& peer : peers) {
+        auto* participant = peer->tablet()->transaction_participant();
+        if (participant) {
+          max_running = std::max(max_running, participant->TEST_GetNumRunningTransactions());
+        }
+      }
+    }
+    if (max_running >= 3) {
+      break;
+    }
+    auto txn = CreateTransaction();
+    ASSERT_OK(WriteRow(CreateSession(txn), num_keys, num_keys));
+    transactions.push_back(std::move(txn));
+    ++num_keys;
+  }
+
+  auto saved_before = SumTabletCounters(&METRIC_transaction_status_rpcs_saved);
+  SetAtomicFlag(1, &FLAGS_transaction_rpc_max_concurrent_batches);
+  SetAtomicFlag(100, &FLAGS_transaction_status_inject_latency_ms);
+
+  // Non transactional write resolves conflicts with all pending transactions, so their statuses
+  // are requested concurrently.
+  auto session = CreateSession();
+  for (int32_t key = 0; key != num_keys; ++key) {
+    ASSERT_OK(WriteRow(session, key, -key, WriteOpType::INSERT, Flush::kFalse));
+  }
+  ASSERT_OK(session->Flush());
+
+  for (int32_t key = 0; key != num_keys; ++key) {
+    VERIFY_ROW(session, key, -key);
+  }
+  auto saved = SumTabletCounters(&METRIC_transaction_status_rpcs_saved) - saved_before;
+  LOG(INFO) << "Transaction status RPCs saved: " << saved;
+  ASSERT_GT(saved, 0);
+}
+
 TEST_F(QLTransactionTest, ResolveIntentsWriteReadWithinTransactionAndRollback) {
   SetAtomicFlag(0ULL, &FLAGS_max_clock_skew_usec); // To avoid read restart in this test.
   DisableApplyingIntents();
@@ -1596,6 +1923,64 @@ TEST_F(QLTransactionTest, FlushIntents) {
   VerifyData(2);
 }
 
+// Test that transaction that writes to a single tablet in its only flush is committed without
+// intents and status tablet.
+TEST_F(QLTransactionTest, SingleShard) {
+  FLAGS_transaction_single_shard_fast_path = true;
+  auto txn = CreateTransaction();
+  auto session = CreateSession(txn);
+  txn->ExpectCommit();
+  ASSERT_OK(WriteRow(session, 1, 1, WriteOpType::INSERT, Flush::kFalse));
+  ASSERT_OK(WriteRow(session, 1, 2, WriteOpType::UPDATE, Flush::kFalse));
+  ASSERT_OK(session->Flush());
+  ASSERT_EQ(0, CountIntents());
+  ASSERT_OK(txn->CommitFuture().get());
+  ASSERT_EQ(0, CountTransactions());
+
+  VERIFY_ROW(CreateSession(), 1, 2);
+}
+
+// Test that single shard write resolves conflicts with intents of another transaction, i.e. aborts
+// that transaction.
+TEST_F(QLTransactionTest, SingleShardConflict) {
+  FLAGS_transaction_single_shard_fast_path = true;
+  auto txn1 = CreateTransaction();
+  ASSERT_OK(WriteRow(CreateSession(txn1), 1, 1));
+  ASSERT_GT(CountIntents(), 0);
+
+  auto txn2 = CreateTransaction();
+  auto session = CreateSession(txn2);
+  txn2->ExpectCommit();
+  ASSERT_OK(WriteRow(session, 1, 2));
+  ASSERT_OK(txn2->CommitFuture().get());
+
+  ASSERT_NOK(txn1->CommitFuture().get());
+  VERIFY_ROW(CreateSession(), 1, 2);
+}
+
+// Test that transaction, that read a row before its only write, is not written as a single shard
+// operation. So a write to the same row, committed after the read time of the transaction, aborts
+// or restarts it.
+TEST_F(QLTransactionTest, SingleShardAfterRead) {
+  FLAGS_transaction_single_shard_fast_path = true;
+  ASSERT_OK(WriteRow(CreateSession(), 1, 1));
+
+  auto txn = CreateTransaction();
+  auto session = CreateSession(txn);
+  auto value = ASSERT_RESULT(SelectRow(session, 1));
+  ASSERT_EQ(1, value);
+
+  ASSERT_OK(WriteRow(CreateSession(), 1, 10));
+
+  txn->ExpectCommit();
+  auto status = WriteRow(session, 1, value + 1);
+  if (status.ok()) {
+    status = txn->CommitFuture().get();
+  }
+  ASSERT_NOK(status);
+  VERIFY_ROW(CreateSession(), 1, 10);
+}
+
 // Test that we could init transaction after it was originally created.
 TEST_F(QLTransactionTest, DelayedInit) {
   SetAtomicFlag(0ULL, &FLAGS_max_clock_skew_usec); // To avoid read restart in this test.
@@ -32,6 +32,7 @@
 #include "yb/rpc/rpc.h"
 #include "yb/rpc/scheduler.h"
 
+#include "yb/util/flag_tags.h"
 #include "yb/util/logging.h"
 #include "yb/util/random_util.h"
 #include "yb/util/result.h"
@@ -44,6 +45,11 @@ DEFINE_uint64(transaction_heartbeat_usec, 500000, "Interval of transaction heart
 DEFINE_bool(transaction_disable_heartbeat_in_tests, false, "Disable heartbeat during test.");
 DEFINE_bool(transaction_disable_proactive_cleanup_in_tests, false,
             "Disable cleanup of intents in abort path.");
+DEFINE_bool(transaction_single_shard_fast_path, false,
+            "Write transaction that is committed right after its first flush, has not read "
+            "anything and touches only one tablet directly to regular DB, without intents and "
+            "status tablet.");
+TAG_FLAG(transaction_single_shard_fast_path, advanced);
 DECLARE_uint64(max_clock_skew_usec);
 
 namespace yb {
@@ -96,7 +102,7 @@ class YBTransaction::Impl final {
   }
 
   ~Impl() {
-    manager_->rpcs().Abort({&heartbeat_handle_, &commit_handle_, &abort_handle_});
+    manager_->rpcs().Abort({&commit_handle_, &abort_handle_});
     LOG_IF_WITH_PREFIX(DFATAL, !waiters_.empty()) << "Non empty waiters";
   }
 
@@ -140,6 +146,9 @@ class YBTransaction::Impl final {
       other->metadata_.isolation = metadata_.isolation;
       other->metadata_.start_time = other->read_point_.Now();
       state_.store(TransactionState::kAborted, std::memory_order_release);
+      if (single_shard_) {
+        return;
+      }
     }
     DoAbort(Status::OK(), transaction);
   }
@@ -155,6 +164,36 @@ class YBTransaction::Impl final {
     bool has_tablets_without_metadata = false;
     {
       std::unique_lock<std::mutex> lock(mutex_);
+      for (const auto& op : ops) {
+        if (op->yb_op->read_only()) {
+          has_reads_ = true;
+          break;
+        }
+      }
+      if (single_shard_) {
+        // Operations of the single shard flush are already written, so they cannot be part of
+        // the same atomic write anymore.
+        LOG_WITH_PREFIX(DFATAL) << "Flush after single shard flush";
+        if (error_.ok()) {
+          error_ = STATUS(IllegalState, "Flush after single shard flush");
+          state_.store(TransactionState::kAborted, std::memory_order_release);
+        }
+        auto status = error_;
+        lock.unlock();
+        // Batcher invokes Prepare under its own lock, so waiter is notified asynchronously.
+        manager_->client()->messenger()->scheduler().Schedule(
+            [waiter, status](const Status&) { waiter(status); },
+            std::chrono::steady_clock::duration::zero());
+        return false;
+      }
+      if (expect_commit_ && CanWriteSingleShard(ops)) {
+        // Transaction metadata is left empty, so operations are sent as a regular write. Such
+        // write is atomic and resolves conflicts with intents of other transactions, i.e. it
+        // commits this transaction in a single Raft round without status tablet.
+        single_shard_ = true;
+        VLOG_WITH_PREFIX(2) << "Prepare, single shard";
+        return true;
+      }
       if (!ready_) {
         waiters_.push_back(std::move(waiter));
         lock.unlock();
@@ -208,6 +247,9 @@ class YBTransaction::Impl final {
   void Flushed(const internal::InFlightOps& ops, const Status& status) {
     if (status.ok()) {
       std::lock_guard<std::mutex> lock(mutex_);
+      if (single_shard_) {
+        return;
+      }
       TabletStates::iterator it = tablets_.end();
       for (const auto& op : ops) {
         if (op->yb_op->succeeded() && !op->yb_op->read_only()) {
@@ -246,6 +288,13 @@ class YBTransaction::Impl final {
         return;
       }
       state_.store(TransactionState::kCommitted, std::memory_order_release);
+      if (single_shard_) {
+        // All writes were already committed by the single shard flush.
+        lock.unlock();
+        VLOG_WITH_PREFIX(1) << "Commit, single shard";
+        callback(Status::OK());
+        return;
+      }
       commit_callback_ = std::move(callback);
       if (!ready_) {
         waiters_.emplace_back(std::bind(&Impl::DoCommit, this, _1, transaction));
@@ -271,6 +320,10 @@ class YBTransaction::Impl final {
         return;
       }
       state_.store(TransactionState::kAborted, std::memory_order_release);
+      if (single_shard_) {
+        // There are no intents and status record to abort.
+        return;
+      }
       if (!ready_) {
         waiters_.emplace_back(std::bind(&Impl::DoAbort, this, _1, transaction));
         lock.unlock();
@@ -281,6 +334,11 @@ class YBTransaction::Impl final {
     DoAbort(Status::OK(), transaction);
   }
 
+  void ExpectCommit() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    expect_commit_ = true;
+  }
+
   bool IsRestartRequired() const {
     return read_point_.IsRestartRequired();
   }
@@ -382,11 +440,31 @@ class YBTransaction::Impl final {
  private:
   void CompleteConstruction() {
     log_prefix_ = Format("$0: ", to_string(metadata_.transaction_id));
-    heartbeat_handle_ = manager_->rpcs().InvalidHandle();
     commit_handle_ = manager_->rpcs().InvalidHandle();
     abort_handle_ = manager_->rpcs().InvalidHandle();
   }
 
+  // Whether ops could be written as a single shard operation. It is possible when this is the first
+  // flush of the transaction, the transaction has not read anything and the flush contains only
+  // writes to the same tablet that do not read existing data.
+  // A single shard operation is a regular write, so the tablet does not check that data read by the
+  // transaction was not changed after its read time. Such writes are safe only when their result
+  // does not depend on the read time.
+  bool CanWriteSingleShard(const std::unordered_set<internal::InFlightOpPtr>& ops) {
+    if (!FLAGS_transaction_single_shard_fast_path || child_ || has_reads_ || !tablets_.empty() ||
+        requested_status_tablet_.load(std::memory_order_acquire) || ops.empty()) {
+      return false;
+    }
+    const auto& tablet_id = (**ops.begin()).tablet->tablet_id();
+    for (const auto& op : ops) {
+      if (op->yb_op->read_only() || op->yb_op->RequireRead() ||
+          op->tablet->tablet_id() != tablet_id) {
+        return false;
+      }
+    }
+    return true;
+  }
+
   CHECKED_STATUS CheckRunning(std::unique_lock<std::mutex>* lock) {
     if (state_.load(std::memory_order_acquire) != TransactionState::kRunning) {
       auto status = error_;
@@ -621,33 +699,19 @@ class YBTransaction::Impl final {
 
     if (status != TransactionStatus::CREATED &&
         GetAtomicFlag(&FLAGS_transaction_disable_heartbeat_in_tests)) {
-      HeartbeatDone(Status::OK(), HybridTime::kInvalid, status, transaction);
+      HeartbeatDone(Status::OK(), status, transaction);
       return;
     }
 
-    tserver::UpdateTransactionRequestPB req;
-    req.set_tablet_id(status_tablet_->tablet_id());
-    req.set_propagated_hybrid_time(manager_->Now().ToUint64());
-    auto& state = *req.mutable_state();
-    state.set_transaction_id(metadata_.transaction_id.begin(), metadata_.transaction_id.size());
-    state.set_status(status);
-    manager_->rpcs().RegisterAndStart(
-        UpdateTransaction(
-            TransactionRpcDeadline(),
-            status_tablet_.get(),
-            manager_->client().get(),
-            &req,
-            std::bind(&Impl::HeartbeatDone, this, _1, _2, status, transaction)),
-        &heartbeat_handle_);
+    // Heartbeats of transactions with the same status tablet are sent by manager in batches.
+    manager_->Heartbeat(
+        status_tablet_, metadata_.transaction_id, status,
+        std::bind(&Impl::HeartbeatDone, this, _1, status, transaction));
   }
 
   void HeartbeatDone(const Status& status,
-                     HybridTime propagated_hybrid_time,
                      TransactionStatus transaction_status,
                      const YBTransactionPtr& transaction) {
-    manager_->UpdateClock(propagated_hybrid_time);
-    manager_->rpcs().Unregister(&heartbeat_handle_);
-
     if (status.ok()) {
       if (transaction_status == TransactionStatus::CREATED) {
         std::vector<Waiter> waiters;
@@ -732,9 +796,14 @@ class YBTransaction::Impl final {
   // Transaction is successfully initialized and ready to process intents.
   const bool child_;
   bool ready_ = false;
+  // Transaction will be committed right after the next flush.
+  bool expect_commit_ = false;
+  // Operations of this transaction were written as a single shard operation.
+  bool single_shard_ = false;
+  // Transaction was used to read data.
+  bool has_reads_ = false;
   CommitCallback commit_callback_;
   Status error_;
-  rpc::Rpcs::Handle heartbeat_handle_;
   rpc::Rpcs::Handle commit_handle_;
   rpc::Rpcs::Handle abort_handle_;
 
@@ -833,6 +902,10 @@ void YBTransaction::Abort() {
   impl_->Abort();
 }
 
+void YBTransaction::ExpectCommit() {
+  impl_->ExpectCommit();
+}
+
 bool YBTransaction::IsRestartRequired() const {
   return impl_->IsRestartRequired();
 }
@@ -92,6 +92,13 @@ class YBTransaction : public std::enable_shared_from_this<YBTransaction> {
   // Aborts this transaction.
   void Abort();
 
+  // Notifies transaction that it will be committed right after the next flush, i.e. that flush
+  // contains all its remaining operations. If it is also the first flush of this transaction and
+  // all its operations are writes to the same tablet, that do not read existing data, they are sent
+  // as a single shard operation: written directly to regular DB, without intents, status tablet and
+  // heartbeats. Transactions that have already read data are never written this way.
+  void ExpectCommit();
+
   // Returns transaction ID.
   const TransactionId& id() const;
 
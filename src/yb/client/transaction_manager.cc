@@ -15,6 +15,8 @@
 
 #include "yb/client/transaction_manager.h"
 
+#include <unordered_map>
+
 #include "yb/rpc/rpc.h"
 #include "yb/rpc/thread_pool.h"
 #include "yb/rpc/tasks_pool.h"
@@ -23,11 +25,20 @@
 #include "yb/util/thread_restrictions.h"
 
 #include "yb/client/client.h"
+#include "yb/client/meta_cache.h"
+#include "yb/client/transaction_rpc.h"
 
 #include "yb/common/transaction.h"
+#include "yb/common/wire_protocol.h"
 
 #include "yb/master/master_defaults.h"
 
+#include "yb/tserver/tserver_service.pb.h"
+
+using namespace std::placeholders;
+
+DECLARE_int32(transaction_rpc_max_concurrent_batches);
+
 namespace yb {
 namespace client {
 
@@ -192,12 +203,194 @@ class TransactionManager::Impl {
     clock_->Update(time);
   }
 
+  void Heartbeat(const internal::RemoteTabletPtr& status_tablet,
+                 const TransactionId& transaction_id,
+                 TransactionStatus status,
+                 TransactionHeartbeatCallback callback) {
+    StatusTabletHeartbeats* heartbeats;
+    PendingHeartbeats batch;
+    {
+      std::lock_guard<std::mutex> lock(heartbeats_mutex_);
+      heartbeats = &heartbeats_[status_tablet->tablet_id()];
+      if (!heartbeats->tablet) {
+        heartbeats->tablet = status_tablet;
+      }
+      if (heartbeats->batching_supported) {
+        heartbeats->queue.push_back({transaction_id, status, std::move(callback)});
+        if (heartbeats->in_flight >= FLAGS_transaction_rpc_max_concurrent_batches) {
+          return;
+        }
+        ++heartbeats->in_flight;
+        heartbeats->queue.swap(batch);
+      }
+    }
+    if (batch.empty()) {
+      SendHeartbeat(
+          heartbeats, {transaction_id, status, std::move(callback)}, false /* accounted */);
+    } else {
+      SendHeartbeats(heartbeats, std::move(batch));
+    }
+  }
+
   void Shutdown() {
     rpcs_.Shutdown();
     thread_pool_.Shutdown();
   }
 
  private:
+  struct PendingHeartbeat {
+    TransactionId transaction_id;
+    TransactionStatus status;
+    TransactionHeartbeatCallback callback;
+  };
+
+  typedef std::vector<PendingHeartbeat> PendingHeartbeats;
+
+  // Heartbeats sent in a single RPC.
+  struct HeartbeatBatch {
+    PendingHeartbeats heartbeats;
+    rpc::Rpcs::Handle handle;
+    // Whether this RPC is accounted in in_flight of status tablet heartbeats.
+    bool accounted;
+  };
+
+  typedef std::shared_ptr<HeartbeatBatch> HeartbeatBatchPtr;
+
+  // Heartbeats of transactions that have the same status tablet.
+  struct StatusTabletHeartbeats {
+    internal::RemoteTabletPtr tablet;
+    // Heartbeats that wait for one of in flight RPCs to complete.
+    PendingHeartbeats queue;
+    // Number of in flight RPCs, limited by FLAGS_transaction_rpc_max_concurrent_batches.
+    int in_flight = 0;
+    // Reset when leader of status tablet does not support HeartbeatTransactions RPC.
+    // After that heartbeats are sent to this tablet one by one, without any limit.
+    bool batching_supported = true;
+  };
+
+  HeartbeatBatchPtr MakeBatch(PendingHeartbeats heartbeats, bool accounted) {
+    return std::make_shared<HeartbeatBatch>(
+        HeartbeatBatch{std::move(heartbeats), rpcs_.InvalidHandle(), accounted});
+  }
+
+  void SendHeartbeats(StatusTabletHeartbeats* heartbeats, PendingHeartbeats heartbeats_batch) {
+    if (heartbeats_batch.size() == 1) {
+      // UpdateTransaction is supported by all servers, so it is used when there is nothing to
+      // batch.
+      SendHeartbeat(heartbeats, std::move(heartbeats_batch.front()), true /* accounted */);
+      return;
+    }
+
+    tserver::HeartbeatTransactionsRequestPB req;
+    req.set_tablet_id(heartbeats->tablet->tablet_id());
+    req.set_propagated_hybrid_time(Now().ToUint64());
+    for (const auto& heartbeat : heartbeats_batch) {
+      auto& state = *req.add_states();
+      state.set_transaction_id(heartbeat.transaction_id.begin(), heartbeat.transaction_id.size());
+      state.set_status(heartbeat.status);
+    }
+    auto batch = MakeBatch(std::move(heartbeats_batch), true /* accounted */);
+    rpcs_.RegisterAndStart(
+        HeartbeatTransactions(
+            TransactionRpcDeadline(),
+            heartbeats->tablet.get(),
+            client_.get(),
+            &req,
+            std::bind(&Impl::HeartbeatsDone, this, heartbeats, batch, _1, _2)),
+        &batch->handle);
+  }
+
+  void SendHeartbeat(
+      StatusTabletHeartbeats* heartbeats, PendingHeartbeat heartbeat, bool accounted) {
+    tserver::UpdateTransactionRequestPB req;
+    req.set_tablet_id(heartbeats->tablet->tablet_id());
+    req.set_propagated_hybrid_time(Now().ToUint64());
+    auto& state = *req.mutable_state();
+    state.set_transaction_id(heartbeat.transaction_id.begin(), heartbeat.transaction_id.size());
+    state.set_status(heartbeat.status);
+    auto batch = MakeBatch({std::move(heartbeat)}, accounted);
+    rpcs_.RegisterAndStart(
+        UpdateTransaction(
+            TransactionRpcDeadline(),
+            heartbeats->tablet.get(),
+            client_.get(),
+            &req,
+            std::bind(&Impl::HeartbeatDone, this, heartbeats, batch, _1, _2)),
+        &batch->handle);
+  }
+
+  void HeartbeatDone(StatusTabletHeartbeats* heartbeats,
+                     const HeartbeatBatchPtr& batch,
+                     const Status& status,
+                     HybridTime propagated_hybrid_time) {
+    UpdateClock(propagated_hybrid_time);
+    rpcs_.Unregister(&batch->handle);
+    batch->heartbeats.front().callback(status);
+    if (batch->accounted) {
+      BatchDone(heartbeats);
+    }
+  }
+
+  void HeartbeatsDone(StatusTabletHeartbeats* heartbeats,
+                      const HeartbeatBatchPtr& batch,
+                      const Status& status,
+                      const tserver::HeartbeatTransactionsResponsePB& response) {
+    if (response.has_propagated_hybrid_time()) {
+      UpdateClock(HybridTime(response.propagated_hybrid_time()));
+    }
+    rpcs_.Unregister(&batch->handle);
+
+    if (status.IsNotSupported()) {
+      LOG(INFO) << "Batched heartbeats are not supported by " << heartbeats->tablet->tablet_id()
+                << ": " << status;
+      {
+        std::lock_guard<std::mutex> lock(heartbeats_mutex_);
+        heartbeats->batching_supported = false;
+      }
+      for (auto& heartbeat : batch->heartbeats) {
+        SendHeartbeat(heartbeats, std::move(heartbeat), false /* accounted */);
+      }
+      BatchDone(heartbeats);
+      return;
+    }
+
+    Status batch_status = status;
+    if (batch_status.ok() && response.statuses_size() != batch->heartbeats.size()) {
+      batch_status = STATUS_FORMAT(
+          IllegalState, "Wrong number of heartbeat statuses: $0, expected: $1",
+          response.statuses_size(), batch->heartbeats.size());
+    }
+    for (size_t i = 0; i != batch->heartbeats.size(); ++i) {
+      batch->heartbeats[i].callback(
+          batch_status.ok() ? StatusFromPB(response.statuses(i)) : batch_status);
+    }
+
+    BatchDone(heartbeats);
+  }
+
+  // Invoked when RPC accounted in in_flight completes, to send heartbeats queued meanwhile.
+  void BatchDone(StatusTabletHeartbeats* heartbeats) {
+    PendingHeartbeats next_batch;
+    bool batching_supported;
+    {
+      std::lock_guard<std::mutex> lock(heartbeats_mutex_);
+      heartbeats->queue.swap(next_batch);
+      batching_supported = heartbeats->batching_supported;
+      if (next_batch.empty() || !batching_supported) {
+        --heartbeats->in_flight;
+      }
+    }
+    if (batching_supported) {
+      if (!next_batch.empty()) {
+        SendHeartbeats(heartbeats, std::move(next_batch));
+      }
+      return;
+    }
+    for (auto& heartbeat : next_batch) {
+      SendHeartbeat(heartbeats, std::move(heartbeat), false /* accounted */);
+    }
+  }
+
   YBClientPtr client_;
   scoped_refptr<ClockBase> clock_;
   TransactionTableState table_state_;
@@ -206,6 +399,10 @@ class TransactionManager::Impl {
   yb::rpc::TasksPool<PickStatusTabletTask> tasks_pool_;
   yb::rpc::TasksPool<InvokeCallbackTask> invoke_callback_tasks_;
   yb::rpc::Rpcs rpcs_;
+
+  std::mutex heartbeats_mutex_;
+  // Heartbeats by status tablet id.
+  std::unordered_map<TabletId, StatusTabletHeartbeats> heartbeats_;
 };
 
 TransactionManager::TransactionManager(
@@ -221,6 +418,13 @@ void TransactionManager::PickStatusTablet(PickStatusTabletCallback callback) {
   impl_->PickStatusTablet(std::move(callback));
 }
 
+void TransactionManager::Heartbeat(const internal::RemoteTabletPtr& status_tablet,
+                                   const TransactionId& transaction_id,
+                                   TransactionStatus status,
+                                   TransactionHeartbeatCallback callback) {
+  impl_->Heartbeat(status_tablet, transaction_id, status, std::move(callback));
+}
+
 const YBClientPtr& TransactionManager::client() const {
   return impl_->client();
 }
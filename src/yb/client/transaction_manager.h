@@ -23,6 +23,7 @@
 
 #include "yb/common/clock.h"
 #include "yb/common/hybrid_time.h"
+#include "yb/common/transaction.h"
 
 #include "yb/rpc/rpc_fwd.h"
 
@@ -32,6 +33,7 @@ namespace yb {
 namespace client {
 
 typedef std::function<void(const Result<std::string>&)> PickStatusTabletCallback;
+typedef std::function<void(const Status&)> TransactionHeartbeatCallback;
 
 // TransactionManager manages multiple transactions. It lives at the YQL engine layer.
 class TransactionManager {
@@ -42,6 +44,15 @@ class TransactionManager {
 
   void PickStatusTablet(PickStatusTabletCallback callback);
 
+  // Sends heartbeat with specified status, i.e. CREATED or PENDING, of transaction to its status
+  // tablet. Heartbeats of transactions that have the same status tablet are sent in a single RPC.
+  // When FLAGS_transaction_rpc_max_concurrent_batches such RPCs are in flight, new heartbeats are
+  // queued and sent together when one of them completes.
+  void Heartbeat(const internal::RemoteTabletPtr& status_tablet,
+                 const TransactionId& transaction_id,
+                 TransactionStatus status,
+                 TransactionHeartbeatCallback callback);
+
   rpc::Rpcs& rpcs();
   const YBClientPtr& client() const;
 
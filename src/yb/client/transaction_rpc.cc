@@ -20,12 +20,21 @@
 #include "yb/client/tablet_rpc.h"
 
 #include "yb/rpc/rpc.h"
+#include "yb/rpc/rpc_header.pb.h"
 
 #include "yb/tserver/tserver_service.pb.h"
 #include "yb/tserver/tserver_service.proxy.h"
 
+#include "yb/util/flag_tags.h"
+
 using namespace std::literals;
 
+DEFINE_int32(transaction_rpc_max_concurrent_batches, 4,
+             "Max number of batched transaction RPCs, i.e. heartbeats or status requests, that "
+             "could be in flight to a single status tablet at the same time. Further requests "
+             "are queued and sent in a single RPC when one of them completes.");
+TAG_FLAG(transaction_rpc_max_concurrent_batches, advanced);
+
 namespace yb {
 namespace client {
 
@@ -58,6 +67,14 @@ class TransactionRpcBase : public rpc::Rpc, public internal::TabletRpc {
     Status new_status = status;
     if (invoker_.Done(&new_status)) {
       auto retain_self = shared_from_this();
+      if (new_status.IsRemoteError()) {
+        const auto* error = retrier().controller().error_response();
+        if (error && error->code() == rpc::ErrorStatusPB::ERROR_NO_SUCH_METHOD) {
+          // Server was not upgraded yet, so caller could fall back to older RPC.
+          new_status = STATUS_FORMAT(NotSupported, "$0 is not supported: $1",
+                                     method_name(), new_status);
+        }
+      }
       InvokeCallback(new_status);
     }
   }
@@ -77,6 +94,7 @@ class TransactionRpcBase : public rpc::Rpc, public internal::TabletRpc {
   }
 
   virtual void InvokeCallback(const Status& status) = 0;
+  virtual const char* method_name() const = 0;
   virtual const TabletId& tablet_id() const = 0;
   virtual void InvokeAsync(tserver::TabletServerServiceProxy* proxy,
                            rpc::RpcController* controller,
@@ -111,6 +129,10 @@ class TransactionRpc : public TransactionRpcBase {
     return req_.tablet_id();
   }
 
+  const char* method_name() const override {
+    return Traits::kName;
+  }
+
   std::string ToString() const override {
     return Format("$0: $1, retrier: $2", Traits::kName, req_, retrier());
   }
@@ -153,6 +175,29 @@ struct UpdateTransactionTraits {
 
 constexpr const char* UpdateTransactionTraits::kName;
 
+struct HeartbeatTransactionsTraits {
+  static constexpr const char* kName = "HeartbeatTransactions";
+
+  typedef tserver::HeartbeatTransactionsRequestPB Request;
+  typedef tserver::HeartbeatTransactionsResponsePB Response;
+  typedef HeartbeatTransactionsCallback Callback;
+
+  static void CallCallback(
+      const Callback& callback, const Status& status, const Response& response) {
+    callback(status, response);
+  }
+
+  static void InvokeAsync(tserver::TabletServerServiceProxy* proxy,
+                          const Request& request,
+                          Response* response,
+                          rpc::RpcController* controller,
+                          rpc::ResponseCallback callback) {
+    proxy->HeartbeatTransactionsAsync(request, response, controller, std::move(callback));
+  }
+};
+
+constexpr const char* HeartbeatTransactionsTraits::kName;
+
 struct GetTransactionStatusTraits {
   static constexpr const char* kName = "GetTransactionStatus";
 
@@ -211,6 +256,16 @@ rpc::RpcCommandPtr UpdateTransaction(
       deadline, tablet, client, req, std::move(callback));
 }
 
+rpc::RpcCommandPtr HeartbeatTransactions(
+    const MonoTime& deadline,
+    internal::RemoteTablet* tablet,
+    YBClient* client,
+    tserver::HeartbeatTransactionsRequestPB* req,
+    HeartbeatTransactionsCallback callback) {
+  return std::make_shared<TransactionRpc<HeartbeatTransactionsTraits>>(
+      deadline, tablet, client, req, std::move(callback));
+}
+
 rpc::RpcCommandPtr GetTransactionStatus(
     const MonoTime& deadline,
     internal::RemoteTablet* tablet,
@@ -35,6 +35,8 @@ class AbortTransactionRequestPB;
 class AbortTransactionResponsePB;
 class GetTransactionStatusRequestPB;
 class GetTransactionStatusResponsePB;
+class HeartbeatTransactionsRequestPB;
+class HeartbeatTransactionsResponsePB;
 class UpdateTransactionRequestPB;
 
 }
@@ -58,10 +60,21 @@ MUST_USE_RESULT rpc::RpcCommandPtr UpdateTransaction(
     tserver::UpdateTransactionRequestPB* req,
     UpdateTransactionCallback callback);
 
+typedef std::function<void(const Status&, const tserver::HeartbeatTransactionsResponsePB&)>
+    HeartbeatTransactionsCallback;
+
+// Sends heartbeats of several transactions with the same status tablet.
+MUST_USE_RESULT rpc::RpcCommandPtr HeartbeatTransactions(
+    const MonoTime& deadline,
+    internal::RemoteTablet* tablet,
+    YBClient* client,
+    tserver::HeartbeatTransactionsRequestPB* req,
+    HeartbeatTransactionsCallback callback);
+
 typedef std::function<void(const Status&, const tserver::GetTransactionStatusResponsePB&)>
     GetTransactionStatusCallback;
 
-// Gets status of specified transaction.
+// Gets statuses of specified transactions with the same status tablet.
 MUST_USE_RESULT rpc::RpcCommandPtr GetTransactionStatus(
     const MonoTime& deadline,
     internal::RemoteTablet* tablet,
@@ -40,6 +40,7 @@
 #include "yb/common/wire_protocol.h"
 #include "yb/common/redis_protocol.pb.h"
 #include "yb/common/ql_protocol.pb.h"
+#include "yb/common/ql_protocol_util.h"
 #include "yb/common/ql_rowblock.h"
 #include "yb/yql/redis/redisserver/redis_constants.h"
 
@@ -223,6 +224,20 @@ uint16_t YBqlWriteOp::GetHashCode() const {
   return ql_write_request_->hash_code();
 }
 
+bool YBqlWriteOp::RequireRead() const {
+  if (yb::RequireRead(*ql_write_request_, table_->InternalSchema())) {
+    return true;
+  }
+  // List element assignment reads the list to locate the element, and JSON attribute assignment
+  // reads the document to update it.
+  for (const auto& column_value : ql_write_request_->column_values()) {
+    if (!column_value.subscript_args().empty() || !column_value.json_args().empty()) {
+      return true;
+    }
+  }
+  return false;
+}
+
 bool YBqlWriteOp::ReadsStaticRow() const {
   // A QL write op reads the static row if it reads a static column, or it writes to the static row
   // and has a user-defined timestamp (which DocDB requires a read-modify-write by the timestamp).
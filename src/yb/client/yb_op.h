@@ -41,6 +41,8 @@
 #include "yb/common/partition.h"
 #include "yb/common/read_hybrid_time.h"
 
+#include "yb/util/monotime.h"
+
 namespace yb {
 
 class RedisWriteRequestPB;
@@ -100,6 +102,10 @@ class YBOperation {
   virtual bool succeeded() = 0;
   virtual bool returns_sidecar() = 0;
 
+  // Whether the operation reads existing data to find out what to write, so its result depends on
+  // the read time it is executed at.
+  virtual bool RequireRead() const { return true; }
+
   virtual void SetHashCode(uint16_t hash_code) = 0;
 
   const scoped_refptr<internal::RemoteTablet>& tablet() const {
@@ -214,12 +220,18 @@ class YBRedisReadOp : public YBRedisOp {
 
   CHECKED_STATUS GetPartitionKey(std::string* partition_key) const override;
 
+  // If set, the read may be served by the closest replica, returning data that is at most this
+  // stale.
+  const MonoDelta& max_staleness() const { return max_staleness_; }
+  void set_max_staleness(const MonoDelta& value) { max_staleness_ = value; }
+
  protected:
   virtual Type type() const override { return REDIS_READ; }
 
  private:
   friend class YBTable;
   std::unique_ptr<RedisReadRequestPB> redis_read_request_;
+  MonoDelta max_staleness_;
 };
 
 //--------------------------------------------------------------------------------------------------
@@ -288,6 +300,8 @@ class YBqlWriteOp : public YBqlOp {
     bool operator() (const YBqlWriteOpPtr& op1, const YBqlWriteOpPtr& op2) const override;
   };
 
+  bool RequireRead() const override;
+
   // Does this operation read/write the static or primary row?
   bool ReadsStaticRow() const;
   bool ReadsPrimaryRow() const;
@@ -353,6 +367,15 @@ class YBqlReadOp : public YBqlOp {
   const ReadHybridTime& read_time() const { return read_time_; }
   void SetReadTime(const ReadHybridTime& value) { read_time_ = value; }
 
+  // If set, the read is served by the closest replica like a CONSISTENT_PREFIX read, but returns
+  // data that is at most this stale.
+  const MonoDelta& max_staleness() const { return max_staleness_; }
+  void set_max_staleness(const MonoDelta& value) { max_staleness_ = value; }
+
+  // Read time chosen by the replica that served a bounded staleness read. Invalid for other reads.
+  HybridTime used_read_time() const { return used_read_time_; }
+  void SetUsedReadTime(HybridTime value) { used_read_time_ = value; }
+
  protected:
   virtual Type type() const override { return QL_READ; }
 
@@ -362,6 +385,8 @@ class YBqlReadOp : public YBqlOp {
   std::unique_ptr<QLReadRequestPB> ql_read_request_;
   YBConsistencyLevel yb_consistency_level_;
   ReadHybridTime read_time_;
+  MonoDelta max_staleness_;
+  HybridTime used_read_time_;
 };
 
 std::vector<ColumnSchema> MakeColumnSchemasFromColDesc(
@@ -459,6 +459,19 @@ TEST(TestSchema, TestTableProperties) {
   ASSERT_FALSE(pb.has_default_time_to_live());
   auto properties3 = TableProperties::FromTablePropertiesPB(pb);
   ASSERT_FALSE(properties3.HasDefaultTimeToLive());
+  ASSERT_EQ(TableCompactionStyle::UNIVERSAL_COMPACTION, properties3.compaction_style());
+
+  properties.SetCompactionStyle(TableCompactionStyle::LEVELED_COMPACTION);
+  properties.ToTablePropertiesPB(&pb);
+  ASSERT_EQ(TableCompactionStyle::LEVELED_COMPACTION, pb.compaction_style());
+  auto properties4 = TableProperties::FromTablePropertiesPB(pb);
+  ASSERT_EQ(TableCompactionStyle::LEVELED_COMPACTION, properties4.compaction_style());
+
+  // The compaction style is fixed when the table is created.
+  TablePropertiesPB alter_pb;
+  alter_pb.set_compaction_style(TableCompactionStyle::UNIVERSAL_COMPACTION);
+  properties4.AlterFromTablePropertiesPB(alter_pb);
+  ASSERT_EQ(TableCompactionStyle::LEVELED_COMPACTION, properties4.compaction_style());
 }
 
 #ifdef NDEBUG
@@ -83,6 +83,7 @@ void TableProperties::ToTablePropertiesPB(TablePropertiesPB *pb) const {
   if (HasCopartitionTableId()) {
     pb->set_copartition_table_id(copartition_table_id_);
   }
+  pb->set_compaction_style(compaction_style_);
 }
 
 TableProperties TableProperties::FromTablePropertiesPB(const TablePropertiesPB& pb) {
@@ -102,6 +103,9 @@ TableProperties TableProperties::FromTablePropertiesPB(const TablePropertiesPB&
   if (pb.has_copartition_table_id()) {
     table_properties.SetCopartitionTableId(pb.copartition_table_id());
   }
+  if (pb.has_compaction_style()) {
+    table_properties.SetCompactionStyle(pb.compaction_style());
+  }
   return table_properties;
 }
 
@@ -126,6 +130,7 @@ void TableProperties::Reset() {
   is_transactional_ = false;
   consistency_level_ = YBConsistencyLevel::STRONG;
   copartition_table_id_ = kNoCopartitionTableId;
+  compaction_style_ = TableCompactionStyle::UNIVERSAL_COMPACTION;
 }
 
 Schema::Schema(const Schema& other)
@@ -407,6 +407,16 @@ class TableProperties {
     consistency_level_ = consistency_level;
   }
 
+  // The compaction style is chosen when the table is created and cannot be altered, because
+  // RocksDB cannot reopen leveled data with universal compaction over a single level.
+  TableCompactionStyle compaction_style() const {
+    return compaction_style_;
+  }
+
+  void SetCompactionStyle(TableCompactionStyle compaction_style) {
+    compaction_style_ = compaction_style;
+  }
+
   TableId CopartitionTableId() const {
     return copartition_table_id_;
   }
@@ -434,6 +444,7 @@ class TableProperties {
   bool is_transactional_ = false;
   YBConsistencyLevel consistency_level_ = YBConsistencyLevel::STRONG;
   TableId copartition_table_id_ = kNoCopartitionTableId;
+  TableCompactionStyle compaction_style_ = TableCompactionStyle::UNIVERSAL_COMPACTION;
 };
 
 // The schema for a set of rows.
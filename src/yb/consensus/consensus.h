@@ -330,7 +330,8 @@ class Consensus {
   // operations would not be added with hybrid time below this lease.
   //
   // `min_allowed` - result should be greater or equal to `min_allowed`, otherwise
-  // it tries to wait until ht lease reaches this value or `deadline` happens.
+  // it tries to wait until ht lease reaches this value or `deadline` happens. MonoTime::kMin as
+  // `deadline` only checks the current value, without blocking.
   //
   // Returns 0 if timeout happened.
   virtual MicrosTime MajorityReplicatedHtLeaseExpiration(
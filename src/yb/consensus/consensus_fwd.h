@@ -21,6 +21,7 @@ namespace yb {
 namespace consensus {
 
 class Consensus;
+class MultiRaftManager;
 class PeerProxyFactory;
 class PeerMessageQueue;
 class ReplicaOperationFactory;
@@ -46,6 +47,9 @@ typedef std::unique_ptr<ConsensusServiceProxy> ConsensusServiceProxyPtr;
 class PeerProxy;
 typedef std::unique_ptr<PeerProxy> PeerProxyPtr;
 
+class MultiRaftBatcher;
+typedef std::shared_ptr<MultiRaftBatcher> MultiRaftBatcherPtr;
+
 // The elected Leader (this peer) can be in not-ready state because it's not yet synced.
 // The state reflects the real leader status: not-leader, leader-not-ready, leader-ready.
 // Not-ready status means that the leader is not ready to serve up-to-date read requests.
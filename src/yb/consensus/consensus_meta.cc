@@ -114,6 +114,19 @@ void ConsensusMetadata::set_voted_for(const string& uuid) {
   pb_.set_voted_for(uuid);
 }
 
+bool ConsensusMetadata::has_leader_term() const {
+  return pb_.has_leader_term();
+}
+
+int64_t ConsensusMetadata::leader_term() const {
+  return pb_.leader_term();
+}
+
+void ConsensusMetadata::set_leader_term(int64_t term) {
+  pb_.set_leader_term(term);
+  leader_term_unflushed_ = true;
+}
+
 const RaftConfigPB& ConsensusMetadata::committed_config() const {
   DCHECK(pb_.has_committed_config());
   return pb_.committed_config();
@@ -223,6 +236,7 @@ Status ConsensusMetadata::Flush() {
       pb_util::SYNC),
           Substitute("Unable to write consensus meta file for tablet $0 to path $1",
                      tablet_id_, meta_file_path));
+  leader_term_unflushed_ = false;
   RETURN_NOT_OK(UpdateOnDiskSize());
   return Status::OK();
 }
@@ -103,6 +103,15 @@ class ConsensusMetadata {
   void clear_voted_for();
   void set_voted_for(const std::string& uuid);
 
+  // Accessors for the last term in which this server was the leader. The leader term is only a
+  // hint, so setting it does not require a flush. It is persisted by the next Flush().
+  bool has_leader_term() const;
+  int64_t leader_term() const;
+  void set_leader_term(int64_t term);
+
+  // Whether the leader term was changed since the last call to Load() or Flush().
+  bool leader_term_unflushed() const { return leader_term_unflushed_; }
+
   // Accessors for committed configuration.
   const RaftConfigPB& committed_config() const;
   void set_committed_config(const RaftConfigPB& config);
@@ -189,6 +198,8 @@ class ConsensusMetadata {
   // Durable fields.
   ConsensusMetadataPB pb_;
 
+  bool leader_term_unflushed_ = false;
+
   // The on-disk size of the consensus metadata, as of the last call to Load() or Flush().
   std::atomic<uint64_t> on_disk_size_;
 
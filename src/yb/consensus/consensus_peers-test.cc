@@ -110,7 +110,8 @@ class ConsensusPeersTest : public YBTest {
         FakeRaftPeerPB(kLeaderUuid),
         kTabletId,
         clock_,
-        raft_pool_->NewToken(ThreadPool::ExecutionMode::SERIAL)));
+        raft_pool_->NewToken(ThreadPool::ExecutionMode::SERIAL),
+        nullptr /* log_cache_token */));
     message_queue_->RegisterObserver(consensus_.get());
 
     message_queue_->Init(MinimumOpId());
@@ -49,6 +49,7 @@
 #include "yb/consensus/consensus_meta.h"
 #include "yb/consensus/consensus_queue.h"
 #include "yb/consensus/log.h"
+#include "yb/consensus/multi_raft_batcher.h"
 #include "yb/gutil/map-util.h"
 #include "yb/gutil/stl_util.h"
 #include "yb/gutil/strings/substitute.h"
@@ -478,8 +479,10 @@ void Peer::ReleaseResourcesUnlocked() {
   LOG_WITH_PREFIX(INFO) << "Closed peer";
 }
 
-RpcPeerProxy::RpcPeerProxy(HostPort hostport, ConsensusServiceProxyPtr consensus_proxy)
-    : hostport_(std::move(hostport)), consensus_proxy_(std::move(consensus_proxy)) {
+RpcPeerProxy::RpcPeerProxy(HostPort hostport, ConsensusServiceProxyPtr consensus_proxy,
+                           MultiRaftBatcherPtr multi_raft_batcher)
+    : hostport_(std::move(hostport)), consensus_proxy_(std::move(consensus_proxy)),
+      multi_raft_batcher_(std::move(multi_raft_batcher)) {
 }
 
 void RpcPeerProxy::UpdateAsync(const ConsensusRequestPB* request,
@@ -487,6 +490,10 @@ void RpcPeerProxy::UpdateAsync(const ConsensusRequestPB* request,
                                ConsensusResponsePB* response,
                                rpc::RpcController* controller,
                                const rpc::ResponseCallback& callback) {
+  if (multi_raft_batcher_ && MultiRaftBatcher::ShouldBatch(*request)) {
+    multi_raft_batcher_->AddRequest(request, response, controller, callback);
+    return;
+  }
   controller->set_timeout(MonoDelta::FromMilliseconds(FLAGS_consensus_rpc_timeout_ms));
   consensus_proxy_->UpdateConsensusAsync(*request, response, controller, callback);
 }
@@ -523,13 +530,20 @@ void RpcPeerProxy::StartRemoteBootstrap(const StartRemoteBootstrapRequestPB* req
 RpcPeerProxy::~RpcPeerProxy() {}
 
 RpcPeerProxyFactory::RpcPeerProxyFactory(
-    shared_ptr<Messenger> messenger, rpc::ProxyCache* proxy_cache, CloudInfoPB from)
-    : messenger_(std::move(messenger)), proxy_cache_(proxy_cache), from_(std::move(from)) {}
+    shared_ptr<Messenger> messenger, rpc::ProxyCache* proxy_cache, CloudInfoPB from,
+    MultiRaftManager* multi_raft_manager)
+    : messenger_(std::move(messenger)), proxy_cache_(proxy_cache), from_(std::move(from)),
+      multi_raft_manager_(multi_raft_manager) {}
 
 PeerProxyPtr RpcPeerProxyFactory::NewProxy(const RaftPeerPB& peer_pb) {
   auto hostport = HostPortFromPB(DesiredHostPort(peer_pb, from_));
   auto proxy = std::make_unique<ConsensusServiceProxy>(proxy_cache_, hostport);
-  return std::make_unique<RpcPeerProxy>(std::move(hostport), std::move(proxy));
+  MultiRaftBatcherPtr multi_raft_batcher;
+  if (multi_raft_manager_) {
+    multi_raft_batcher = multi_raft_manager_->AddOrGetBatcher(hostport);
+  }
+  return std::make_unique<RpcPeerProxy>(
+      std::move(hostport), std::move(proxy), std::move(multi_raft_batcher));
 }
 
 RpcPeerProxyFactory::~RpcPeerProxyFactory() {}
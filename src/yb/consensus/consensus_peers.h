@@ -328,7 +328,8 @@ class PeerProxyFactory {
 // PeerProxy implementation that does RPC calls
 class RpcPeerProxy : public PeerProxy {
  public:
-  RpcPeerProxy(HostPort hostport, ConsensusServiceProxyPtr consensus_proxy);
+  RpcPeerProxy(HostPort hostport, ConsensusServiceProxyPtr consensus_proxy,
+               MultiRaftBatcherPtr multi_raft_batcher = nullptr);
 
   virtual void UpdateAsync(const ConsensusRequestPB* request,
                            RequestTriggerMode trigger_mode,
@@ -361,13 +362,16 @@ class RpcPeerProxy : public PeerProxy {
  private:
   HostPort hostport_;
   ConsensusServiceProxyPtr consensus_proxy_;
+  // Batcher shared with the peers of other tablets on the same server, or nullptr.
+  MultiRaftBatcherPtr multi_raft_batcher_;
 };
 
 // PeerProxyFactory implementation that generates RPCPeerProxies
 class RpcPeerProxyFactory : public PeerProxyFactory {
  public:
+  // multi_raft_manager is optional, it is used to batch the requests of different tablets.
   RpcPeerProxyFactory(std::shared_ptr<rpc::Messenger> messenger, rpc::ProxyCache* proxy_cache,
-                      CloudInfoPB from);
+                      CloudInfoPB from, MultiRaftManager* multi_raft_manager = nullptr);
 
   PeerProxyPtr NewProxy(const RaftPeerPB& peer_pb) override;
 
@@ -379,6 +383,7 @@ class RpcPeerProxyFactory : public PeerProxyFactory {
   std::shared_ptr<rpc::Messenger> messenger_;
   rpc::ProxyCache* const proxy_cache_;
   const CloudInfoPB from_;
+  MultiRaftManager* const multi_raft_manager_;
 };
 
 // Query the consensus service at last known host/port that is specified in 'remote_peer' and set
@@ -107,7 +107,8 @@ class ConsensusQueueTest : public YBTest {
                                       FakeRaftPeerPB(kLeaderUuid),
                                       kTestTablet,
                                       clock_,
-    raft_pool_->NewToken(ThreadPool::ExecutionMode::SERIAL)));
+    raft_pool_->NewToken(ThreadPool::ExecutionMode::SERIAL),
+    nullptr /* log_cache_token */));
   }
 
   void TearDown() override {
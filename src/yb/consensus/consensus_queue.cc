@@ -138,13 +138,15 @@ PeerMessageQueue::PeerMessageQueue(const scoped_refptr<MetricEntity>& metric_ent
                                    const RaftPeerPB& local_peer_pb,
                                    const string& tablet_id,
                                    const server::ClockPtr& clock,
-                                   unique_ptr<ThreadPoolToken> raft_pool_token)
+                                   unique_ptr<ThreadPoolToken> raft_pool_token,
+                                   unique_ptr<ThreadPoolToken> log_cache_token)
     : raft_pool_observers_token_(std::move(raft_pool_token)),
       local_peer_pb_(local_peer_pb),
       local_peer_uuid_(local_peer_pb_.has_permanent_uuid() ? local_peer_pb_.permanent_uuid()
                                                            : string()),
       tablet_id_(tablet_id),
-      log_cache_(metric_entity, log, server_tracker, local_peer_pb.permanent_uuid(), tablet_id),
+      log_cache_(metric_entity, log, server_tracker, local_peer_pb.permanent_uuid(), tablet_id,
+                 std::move(log_cache_token)),
       metrics_(metric_entity),
       clock_(clock) {
   DCHECK(local_peer_pb_.has_permanent_uuid());
@@ -163,7 +163,8 @@ class PeerMessageQueue {
                    const RaftPeerPB& local_peer_pb,
                    const std::string& tablet_id,
                    const server::ClockPtr& clock,
-                   std::unique_ptr<ThreadPoolToken> raft_pool_observers_token);
+                   std::unique_ptr<ThreadPoolToken> raft_pool_observers_token,
+                   std::unique_ptr<ThreadPoolToken> log_cache_token);
 
   // Initialize the queue.
   virtual void Init(const OpId& last_locally_replicated);
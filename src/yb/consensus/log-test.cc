@@ -47,6 +47,7 @@
 #include "yb/gutil/stl_util.h"
 #include "yb/gutil/strings/substitute.h"
 #include "yb/util/random.h"
+#include "yb/util/size_literals.h"
 
 DEFINE_int32(num_batches, 10000,
              "Number of batches to write to/read from the Log in TestWriteManyBatches");
@@ -57,6 +58,10 @@ DECLARE_bool(writable_file_use_fsync);
 DECLARE_int32(o_direct_block_alignment_bytes);
 DECLARE_int32(o_direct_block_size_bytes);
 
+METRIC_DECLARE_counter(log_bytes_logged);
+
+using namespace yb::size_literals;
+
 namespace yb {
 namespace log {
 
@@ -151,8 +156,119 @@ class LogTest : public LogTestBase {
   void DoCorruptionTest(CorruptionType type, CorruptionPosition place,
                         Status expected_status, int expected_entries);
 
+  int64_t BytesLogged() {
+    return METRIC_log_bytes_logged.Instantiate(metric_entity_)->value();
+  }
+
+  // Appends 'num_batches' batches of 'batch_size' writes with text payloads, similar to the rows of
+  // a wide CQL table. Returns the number of bytes written to the log.
+  Result<int64_t> AppendTextBatches(int num_batches, int batch_size) {
+    const int64_t bytes_logged_before = BytesLogged();
+    for (int i = 0; i < num_batches; i++) {
+      ReplicateMsgs replicates;
+      for (int j = 0; j < batch_size; j++) {
+        auto replicate = std::make_shared<ReplicateMsg>();
+        replicate->set_op_type(WRITE_OP);
+        replicate->mutable_id()->CopyFrom(MakeOpId(1, current_index_));
+        replicate->set_hybrid_time(clock_->Now().ToUint64());
+        WriteRequestPB* write_request = replicate->mutable_write_request();
+        write_request->set_tablet_id(kTestTablet);
+        for (int column = 0; column < 10; column++) {
+          AddKVToPB(current_index_, column,
+                    Format("value of text column $0 in row $1 of the test table",
+                           column, current_index_),
+                    write_request->mutable_write_batch());
+        }
+        replicates.push_back(std::move(replicate));
+        ++current_index_;
+      }
+      Synchronizer s;
+      RETURN_NOT_OK(log_->AsyncAppendReplicates(
+          replicates, yb::OpId() /* committed_op_id */, RestartSafeCoarseTimePoint(),
+          s.AsStatusCallback()));
+      RETURN_NOT_OK(s.Wait());
+    }
+    return BytesLogged() - bytes_logged_before;
+  }
+
+  // Removes the log, so that a new one could be built from scratch.
+  void DeleteLog() {
+    ASSERT_OK(log_->Close());
+    log_.reset();
+    ASSERT_OK(env_->DeleteRecursively(tablet_wal_path_));
+    ASSERT_OK(env_->CreateDir(tablet_wal_path_));
+    current_index_ = 1;
+  }
+
+  void TestCompression(CompressionTypePB compression_type);
 };
 
+void LogTest::TestCompression(CompressionTypePB compression_type) {
+  const int kNumBatches = 20;
+  const int kBatchSize = 10;
+
+  BuildLog();
+  auto uncompressed_bytes = ASSERT_RESULT(AppendTextBatches(kNumBatches, kBatchSize));
+  DeleteLog();
+
+  options_.compression_type = compression_type;
+  BuildLog();
+  auto compressed_bytes = ASSERT_RESULT(AppendTextBatches(kNumBatches, kBatchSize));
+  LOG(INFO) << CompressionTypePB_Name(compression_type) << ": " << uncompressed_bytes
+            << " bytes uncompressed, " << compressed_bytes << " bytes compressed";
+  ASSERT_LT(compressed_bytes * 2, uncompressed_bytes);
+
+  // Ops could be read back while the segment is being written.
+  ReplicateMsgs replicates;
+  ASSERT_OK(log_->GetLogReader()->ReadReplicatesInRange(
+      1, kNumBatches * kBatchSize, LogReader::kNoSizeLimit, &replicates));
+  ASSERT_EQ(kNumBatches * kBatchSize, replicates.size());
+  for (size_t i = 0; i != replicates.size(); ++i) {
+    ASSERT_EQ(i + 1, replicates[i]->id().index());
+    ASSERT_EQ(10, replicates[i]->write_request().write_batch().kv_pairs_size());
+  }
+  ASSERT_OK(log_->Close());
+
+  // And after the segment was closed, by a reader that was not used to write it.
+  std::unique_ptr<LogReader> reader;
+  ASSERT_OK(LogReader::Open(fs_manager_.get(), nullptr, kTestTablet, tablet_wal_path_, nullptr,
+                            &reader));
+  SegmentSequence segments;
+  ASSERT_OK(reader->GetSegmentsSnapshot(&segments));
+  ASSERT_EQ(1, segments.size());
+  ASSERT_EQ(compression_type, segments[0]->header().compression_type());
+  auto read_entries = segments[0]->ReadEntries();
+  ASSERT_OK(read_entries.status);
+  ASSERT_EQ(kNumBatches * kBatchSize, read_entries.entries.size());
+}
+
+TEST_F(LogTest, TestSnappyCompression) {
+  TestCompression(SNAPPY);
+}
+
+TEST_F(LogTest, TestLz4Compression) {
+  TestCompression(LZ4);
+}
+
+// Measures the append throughput and the compression ratio of each codec at different batch sizes.
+TEST_F(LogTest, CompressionBenchmark) {
+  const int kTotalOps = AllowSlowTests() ? 100000 : 1000;
+  for (auto compression_type : {NO_COMPRESSION, SNAPPY, LZ4}) {
+    for (int batch_size : {1, 10, 100}) {
+      options_.compression_type = compression_type;
+      BuildLog();
+      auto start = MonoTime::Now();
+      auto bytes = ASSERT_RESULT(AppendTextBatches(kTotalOps / batch_size, batch_size));
+      auto elapsed = MonoTime::Now() - start;
+      LOG(INFO) << CompressionTypePB_Name(compression_type) << ", batch size " << batch_size
+                << ": " << kTotalOps / elapsed.ToSeconds() << " ops/s, "
+                << bytes / elapsed.ToSeconds() / 1_MB << " MB/s written, "
+                << bytes / kTotalOps << " bytes per op";
+      DeleteLog();
+    }
+  }
+}
+
 // If we write more than one entry in a batch, we should be able to
 // read all of those entries back.
 TEST_F(LogTest, TestMultipleEntriesInABatch) {
@@ -517,7 +517,7 @@ Status Log::AsyncAppendReplicates(const ReplicateMsgs& msgs, const yb::OpId& com
 }
 
 Status Log::DoAppend(LogEntryBatch* entry_batch, bool caller_owns_operation) {
-  RETURN_NOT_OK(entry_batch->Serialize());
+  RETURN_NOT_OK(entry_batch->Serialize(options_.compression_type, &serialization_buffer_));
   Slice entry_batch_data = entry_batch->data();
   LOG_IF(DFATAL, entry_batch_data.size() <= 0 && !entry_batch->flush_marker())
       << "Cannot call DoAppend() with no data";
@@ -997,6 +997,7 @@ Status Log::SwitchToAllocatedSegment() {
   header.set_minor_version(kLogMinorVersion);
   header.set_sequence_number(active_segment_sequence_number_);
   header.set_tablet_id(tablet_id_);
+  header.set_compression_type(options_.compression_type);
 
   // Set up the new footer. This will be maintained as the segment is written.
   footer_builder_.Clear();
@@ -1107,7 +1108,7 @@ bool LogEntryBatch::flush_marker() const {
   return count() == 1 && entry_batch_pb_.entry(0).type() == FLUSH_MARKER;
 }
 
-Status LogEntryBatch::Serialize() {
+Status LogEntryBatch::Serialize(CompressionTypePB compression_type, faststring* tmp_buf) {
   DCHECK_EQ(state_, kEntryReady);
   buffer_.clear();
   // FLUSH_MARKER LogEntries are markers and are not serialized.
@@ -1116,14 +1117,20 @@ Status LogEntryBatch::Serialize() {
     state_ = kEntrySerialized;
     return Status::OK();
   }
-  total_size_bytes_ = entry_batch_pb_.ByteSize();
-  buffer_.reserve(total_size_bytes_);
+  faststring* serialized = compression_type == NO_COMPRESSION ? &buffer_ : tmp_buf;
+  serialized->clear();
+  serialized->reserve(entry_batch_pb_.ByteSize());
 
-  if (!pb_util::AppendToString(entry_batch_pb_, &buffer_)) {
+  if (!pb_util::AppendToString(entry_batch_pb_, serialized)) {
     return STATUS(IOError, Substitute("unable to serialize the entry batch, contents: $1",
                                       entry_batch_pb_.DebugString()));
   }
 
+  if (compression_type != NO_COMPRESSION) {
+    RETURN_NOT_OK(CompressEntryBatch(compression_type, Slice(*serialized), &buffer_));
+  }
+
+  total_size_bytes_ = buffer_.size();
   state_ = kEntrySerialized;
   return Status::OK();
 }
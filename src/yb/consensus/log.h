@@ -334,6 +334,9 @@ class Log : public RefCountedThreadSafe<Log> {
   FsManager *fs_manager_;
   std::string log_dir_;
 
+  // Used by the append thread to serialize entry batches before compressing them.
+  faststring serialization_buffer_;
+
   // The ID of the tablet this log is dedicated to.
   std::string tablet_id_;
 
@@ -456,8 +459,9 @@ class LogEntryBatch {
   friend class Log;
   friend class MultiThreadedLogTest;
 
-  // Serializes contents of the entry to an internal buffer.
-  CHECKED_STATUS Serialize();
+  // Serializes contents of the entry to an internal buffer, compressing them with the given codec.
+  // tmp_buf is used to hold the uncompressed data.
+  CHECKED_STATUS Serialize(CompressionTypePB compression_type, faststring* tmp_buf);
 
   // Sets the callback that will be invoked after the entry is
   // appended and synced to disk
@@ -495,7 +499,7 @@ class LogEntryBatch {
 
   size_t count() const { return count_; }
 
-  // Returns the total size in bytes of the object.
+  // Returns the total size in bytes of the object, after compression.
   size_t total_size_bytes() const {
     return total_size_bytes_;
   }
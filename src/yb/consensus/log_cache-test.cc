@@ -52,6 +52,7 @@
 #include "yb/util/metrics.h"
 #include "yb/util/monotime.h"
 #include "yb/util/test_util.h"
+#include "yb/util/threadpool.h"
 
 using std::atomic;
 using std::shared_ptr;
@@ -59,6 +60,8 @@ using std::thread;
 
 DECLARE_int32(log_cache_size_limit_mb);
 DECLARE_int32(global_log_cache_size_limit_mb);
+DECLARE_bool(log_cache_compression);
+DECLARE_int32(log_cache_prefetch_size_bytes);
 
 METRIC_DECLARE_entity(tablet);
 
@@ -106,12 +109,14 @@ class LogCacheTest : public YBTest {
     ASSERT_OK(log_->WaitUntilAllFlushed());
   }
 
-  void CloseAndReopenCache(const OpId& preceding_id) {
+  void CloseAndReopenCache(const OpId& preceding_id,
+                           std::unique_ptr<ThreadPoolToken> background_token = nullptr) {
     // Blow away the memtrackers before creating the new cache.
     cache_.reset();
 
     cache_.reset(new LogCache(
-        metric_entity_, log_.get(), nullptr /* mem_tracker */, kPeerUuid, kTestTablet));
+        metric_entity_, log_.get(), nullptr /* mem_tracker */, kPeerUuid, kTestTablet,
+        std::move(background_token)));
     cache_->Init(preceding_id);
   }
 
@@ -319,6 +324,90 @@ TEST_F(LogCacheTest, TestGlobalMemoryLimit) {
   ASSERT_LE(cache_->BytesUsed(), 1024 * 1024);
 }
 
+// Test that once the cache passes the compression threshold the oldest ops are compressed, so that
+// ops which would otherwise be evicted stay in memory and can still be read.
+TEST_F(LogCacheTest, TestCompression) {
+  FLAGS_log_cache_size_limit_mb = 1;
+  FLAGS_log_cache_compression = true;
+  FLAGS_log_cache_prefetch_size_bytes = 0;
+  std::unique_ptr<ThreadPool> pool;
+  ASSERT_OK(ThreadPoolBuilder("log-cache").Build(&pool));
+  CloseAndReopenCache(MinimumOpId(), pool->NewToken(ThreadPool::ExecutionMode::SERIAL));
+
+  const int kPayloadSize = 400 * 1024;
+  ASSERT_OK(AppendReplicateMessagesToCache(1, 2, kPayloadSize));
+  ASSERT_OK(log_->WaitUntilAllFlushed());
+  ASSERT_OK(WaitFor([this] { return cache_->num_compressed_ops() == 2; },
+                    10s, "Ops compressed"));
+  ASSERT_GT(cache_->metrics_.log_cache_compression_saved_bytes->value(), 2 * 300 * 1024);
+  ASSERT_LT(cache_->BytesUsed(), 100 * 1024);
+
+  // Without compression, this op would evict the first one.
+  ASSERT_OK(AppendReplicateMessagesToCache(3, 1, kPayloadSize));
+  ASSERT_OK(log_->WaitUntilAllFlushed());
+  ASSERT_EQ(3, cache_->num_cached_ops());
+
+  ReplicateMsgs messages;
+  OpId preceding;
+  ASSERT_OK(cache_->ReadOps(0, 8 * 1024 * 1024, &messages, &preceding));
+  ASSERT_EQ(3, messages.size());
+  for (int i = 0; i != 3; ++i) {
+    EXPECT_EQ(i + 1, messages[i]->id().index());
+    EXPECT_EQ(kPayloadSize, messages[i]->noop_request().payload_for_tests().size());
+  }
+  ASSERT_EQ(3, cache_->metrics_.log_cache_hits->value());
+  ASSERT_EQ(0, cache_->metrics_.log_cache_misses->value());
+  ASSERT_GT(cache_->metrics_.log_cache_catch_up_bytes->value(), 2 * kPayloadSize);
+
+  // Evicting the compressed ops releases their memory.
+  messages.clear();
+  cache_->EvictThroughOp(3);
+  ASSERT_EQ(0, cache_->num_cached_ops());
+  ASSERT_EQ(0, cache_->num_compressed_ops());
+  ASSERT_EQ(0, cache_->metrics_.log_cache_compression_saved_bytes->value());
+  ASSERT_EQ(0, cache_->BytesUsed());
+
+  // The background token must be destroyed before the pool.
+  cache_.reset();
+}
+
+// Test that after a lagging peer read ops from the disk, the following ops are prefetched into the
+// cache, so that the next read is served from memory.
+TEST_F(LogCacheTest, TestPrefetch) {
+  FLAGS_log_cache_prefetch_size_bytes = 64 * 1024;
+  std::unique_ptr<ThreadPool> pool;
+  ASSERT_OK(ThreadPoolBuilder("log-cache").Build(&pool));
+  CloseAndReopenCache(MinimumOpId(), pool->NewToken(ThreadPool::ExecutionMode::SERIAL));
+
+  const int kPayloadSize = 1024;
+  const int kReadSize = 16 * 1024;
+  ASSERT_OK(AppendReplicateMessagesToCache(1, 100, kPayloadSize));
+  ASSERT_OK(log_->WaitUntilAllFlushed());
+  cache_->EvictThroughOp(100);
+  ASSERT_EQ(0, cache_->num_cached_ops());
+
+  ReplicateMsgs messages;
+  OpId preceding;
+  ASSERT_OK(cache_->ReadOps(0, kReadSize, &messages, &preceding));
+  const int64_t num_read = messages.size();
+  ASSERT_GT(num_read, 0);
+  ASSERT_EQ(num_read, cache_->metrics_.log_cache_misses->value());
+
+  ASSERT_OK(WaitFor([this] { return cache_->num_cached_ops() > 0; }, 10s, "Ops prefetched"));
+  const int64_t num_prefetched = cache_->metrics_.log_cache_prefetched_ops->value();
+  ASSERT_GT(num_prefetched, num_read);
+
+  // The next read is served from the prefetched ops.
+  messages.clear();
+  ASSERT_OK(cache_->ReadOps(num_read, kReadSize, &messages, &preceding));
+  ASSERT_EQ(num_read + 1, messages.front()->id().index());
+  ASSERT_EQ(num_read, cache_->metrics_.log_cache_misses->value());
+  ASSERT_EQ(messages.size(), cache_->metrics_.log_cache_hits->value());
+
+  // The background token must be destroyed before the pool.
+  cache_.reset();
+}
+
 // Test that the log cache properly replaces messages when an index
 // is reused. This is a regression test for a bug where the memtracker's
 // consumption wasn't properly managed when messages were replaced.
@@ -40,6 +40,7 @@
 #include <gflags/gflags.h>
 #include <google/protobuf/wire_format_lite.h>
 #include <google/protobuf/wire_format_lite_inl.h>
+#include <snappy.h>
 
 #include "yb/consensus/log.h"
 #include "yb/consensus/log_reader.h"
@@ -55,8 +56,10 @@
 #include "yb/util/locks.h"
 #include "yb/util/logging.h"
 #include "yb/util/size_literals.h"
+#include "yb/util/threadpool.h"
 
 using namespace std::literals;
+using namespace yb::size_literals;
 
 DEFINE_int32(log_cache_size_limit_mb, 128,
              "The total per-tablet size of consensus entries which may be kept in memory. "
@@ -70,6 +73,27 @@ DEFINE_int32(global_log_cache_size_limit_mb, 1024,
              "caching log entries across all tablets is kept under this threshold.");
 TAG_FLAG(global_log_cache_size_limit_mb, advanced);
 
+DEFINE_bool(log_cache_compression, false,
+            "Whether to compress the oldest entries of the log cache once its memory usage passes "
+            "log_cache_compression_threshold_percent of the per-tablet or global limit, so that "
+            "more entries are kept in memory for lagging followers before being evicted. "
+            "Compression runs in the background, on the Raft thread pool.");
+TAG_FLAG(log_cache_compression, advanced);
+TAG_FLAG(log_cache_compression, runtime);
+
+DEFINE_int32(log_cache_compression_threshold_percent, 50,
+             "Percentage of the per-tablet or global log cache size limit above which the oldest "
+             "log cache entries are compressed.");
+TAG_FLAG(log_cache_compression_threshold_percent, advanced);
+TAG_FLAG(log_cache_compression_threshold_percent, runtime);
+
+DEFINE_int32(log_cache_prefetch_size_bytes, 4_MB,
+             "After a lagging follower has read operations that were not in the log cache, up to "
+             "this many bytes of the following operations are read from the disk into the cache "
+             "in the background. 0 to disable.");
+TAG_FLAG(log_cache_prefetch_size_bytes, advanced);
+TAG_FLAG(log_cache_prefetch_size_bytes, runtime);
+
 using strings::Substitute;
 
 namespace yb {
@@ -81,11 +105,34 @@ METRIC_DEFINE_gauge_int64(tablet, log_cache_num_ops, "Log Cache Operation Count"
 METRIC_DEFINE_gauge_int64(tablet, log_cache_size, "Log Cache Memory Usage",
                           MetricUnit::kBytes,
                           "Amount of memory in use for caching the local log.");
+METRIC_DEFINE_gauge_int64(tablet, log_cache_compression_saved_bytes,
+                          "Log Cache Memory Saved By Compression",
+                          MetricUnit::kBytes,
+                          "Amount of memory saved by keeping the oldest log cache entries "
+                          "compressed.");
+METRIC_DEFINE_counter(tablet, log_cache_hits, "Log Cache Hits",
+                      MetricUnit::kOperations,
+                      "Number of operations sent to followers from the log cache.");
+METRIC_DEFINE_counter(tablet, log_cache_misses, "Log Cache Misses",
+                      MetricUnit::kOperations,
+                      "Number of operations sent to followers that were not in the log cache and "
+                      "were read from the disk on demand.");
+METRIC_DEFINE_counter(tablet, log_cache_prefetched_ops, "Log Cache Prefetched Operations",
+                      MetricUnit::kOperations,
+                      "Number of operations read from the disk into the log cache in the "
+                      "background for lagging followers.");
+METRIC_DEFINE_counter(tablet, log_cache_catch_up_bytes, "Log Cache Catch Up Bytes",
+                      MetricUnit::kBytes,
+                      "Bytes of operations sent to lagging followers from compressed or "
+                      "prefetched log cache entries, or from the disk.");
 
 namespace {
 
 const std::string kParentMemTrackerId = "log_cache"s;
 
+// Maximum number of entries compressed at once, outside of the lock.
+const size_t kCompressionBatchSize = 64;
+
 }
 
 typedef vector<const ReplicateMsg*>::const_iterator MsgIter;
@@ -94,10 +141,12 @@ LogCache::LogCache(const scoped_refptr<MetricEntity>& metric_entity,
                    const scoped_refptr<log::Log>& log,
                    const MemTrackerPtr& server_tracker,
                    const string& local_uuid,
-                   const string& tablet_id)
+                   const string& tablet_id,
+                   std::unique_ptr<ThreadPoolToken> background_token)
   : log_(log),
     local_uuid_(local_uuid),
     tablet_id_(tablet_id),
+    background_token_(std::move(background_token)),
     next_sequential_op_index_(0),
     min_pinned_op_index_(0),
     metrics_(metric_entity) {
@@ -120,10 +169,14 @@ LogCache::LogCache(const scoped_refptr<MetricEntity>& metric_entity,
   // Put a fake message at index 0, since this simplifies a lot of our code paths elsewhere.
   auto zero_op = std::make_shared<ReplicateMsg>();
   *zero_op->mutable_id() = MinimumOpId();
-  InsertOrDie(&cache_, 0, { zero_op, zero_op->SpaceUsed() });
+  InsertOrDie(&cache_, 0, CacheEntry::FromMsg(zero_op, zero_op->SpaceUsed()));
 }
 
 LogCache::~LogCache() {
+  // Wait for the background tasks that could still access the cache.
+  if (background_token_) {
+    background_token_->Shutdown();
+  }
   tracker_->Release(tracker_->consumption());
   cache_.clear();
 
@@ -143,7 +196,7 @@ Result<LogCache::PrepareAppendResult> LogCache::PrepareAppendOperations(const Re
   std::vector<CacheEntry> entries_to_insert;
   entries_to_insert.reserve(msgs.size());
   for (const auto& msg : msgs) {
-    CacheEntry e = { msg, static_cast<int64_t>(msg->SpaceUsedLong()) };
+    auto e = CacheEntry::FromMsg(msg, msg->SpaceUsedLong());
     result.mem_required += e.mem_usage;
     entries_to_insert.emplace_back(std::move(e));
   }
@@ -158,6 +211,7 @@ Result<LogCache::PrepareAppendResult> LogCache::PrepareAppendOperations(const Re
     // If the index is not consecutive then it must be lower than or equal to the last index, i.e.
     // we're overwriting.
     CHECK_LE(first_idx_in_batch, next_sequential_op_index_);
+    ++overwrite_generation_;
 
     // Now remove the overwritten operations.
     for (int64_t i = first_idx_in_batch; i < next_sequential_op_index_; ++i) {
@@ -243,10 +297,102 @@ void LogCache::LogCallback(int64_t last_idx_in_batch,
         EvictSomeUnlocked(min_pinned_op_index_, -spare_capacity);
       }
     }
+
+    ScheduleCompressionUnlocked();
   }
   user_callback.Run(log_status);
 }
 
+bool LogCache::ShouldCompress() const {
+  if (!FLAGS_log_cache_compression) {
+    return false;
+  }
+  auto above_threshold = [](const MemTracker& tracker) {
+    return tracker.has_limit() &&
+           tracker.consumption() * 100 >
+               tracker.limit() * FLAGS_log_cache_compression_threshold_percent;
+  };
+  return above_threshold(*tracker_) || above_threshold(*parent_tracker_);
+}
+
+void LogCache::ScheduleCompressionUnlocked() {
+  // Compression is never done inline, to keep it off the log append callback.
+  if (!background_token_ || compression_scheduled_ || !ShouldCompress()) {
+    return;
+  }
+  compression_scheduled_ = true;
+  auto status = background_token_->SubmitFunc(std::bind(&LogCache::CompressOldEntries, this));
+  if (!status.ok()) {
+    LOG_WITH_PREFIX_UNLOCKED(WARNING) << "Failed to schedule log cache compression: " << status;
+    compression_scheduled_ = false;
+  }
+}
+
+void LogCache::CompressOldEntries() {
+  int64_t next_candidate_index = 1;
+  for (;;) {
+    std::vector<std::pair<int64_t, ReplicateMsgPtr>> candidates;
+    {
+      std::lock_guard<simple_spinlock> l(lock_);
+      if (ShouldCompress()) {
+        // Only compress the entries that were already written to the log, and that are not in use
+        // by a peer.
+        for (auto iter = cache_.lower_bound(next_candidate_index);
+             iter != cache_.end() && iter->first < min_pinned_op_index_ &&
+                 candidates.size() < kCompressionBatchSize;
+             ++iter) {
+          const ReplicateMsgPtr& msg = iter->second.msg;
+          if (msg && msg.unique()) {
+            candidates.emplace_back(iter->first, msg);
+          }
+        }
+      }
+      if (candidates.empty()) {
+        compression_scheduled_ = false;
+        return;
+      }
+    }
+    next_candidate_index = candidates.back().first + 1;
+
+    std::vector<std::shared_ptr<const CompressedMsg>> compressed_msgs;
+    compressed_msgs.reserve(candidates.size());
+    for (const auto& candidate : candidates) {
+      auto compressed_msg = std::make_shared<CompressedMsg>();
+      std::string serialized;
+      candidate.second->AppendToString(&serialized);
+      compressed_msg->uncompressed_size = serialized.size();
+      snappy::Compress(serialized.data(), serialized.size(), &compressed_msg->data);
+      compressed_msg->data.shrink_to_fit();
+      compressed_msgs.push_back(std::move(compressed_msg));
+    }
+
+    std::lock_guard<simple_spinlock> l(lock_);
+    for (size_t i = 0; i != candidates.size(); ++i) {
+      auto iter = cache_.find(candidates[i].first);
+      // The entry could have been evicted, overwritten or handed to a peer while the lock was
+      // released.
+      if (iter == cache_.end() || iter->second.msg != candidates[i].second ||
+          candidates[i].second.use_count() != 2) {
+        continue;
+      }
+      CacheEntry& entry = iter->second;
+      const int64_t mem_usage = sizeof(CompressedMsg) + compressed_msgs[i]->data.capacity();
+      if (mem_usage >= entry.mem_usage) {
+        continue;
+      }
+      const int64_t saved_bytes = entry.mem_usage - mem_usage;
+      entry.msg = nullptr;
+      entry.compressed_msg = std::move(compressed_msgs[i]);
+      entry.mem_usage = mem_usage;
+      entry.saved_bytes = saved_bytes;
+      ++num_compressed_ops_;
+      tracker_->Release(saved_bytes);
+      metrics_.log_cache_size->DecrementBy(saved_bytes);
+      metrics_.log_cache_compression_saved_bytes->IncrementBy(saved_bytes);
+    }
+  }
+}
+
 bool LogCache::HasOpBeenWritten(int64_t index) const {
   std::lock_guard<simple_spinlock> l(lock_);
   return index < next_sequential_op_index_;
@@ -267,7 +413,8 @@ Status LogCache::LookupOpId(int64_t op_index, OpId* op_id) const {
     }
     auto iter = cache_.find(op_index);
     if (iter != cache_.end()) {
-      *op_id = iter->second.msg->id();
+      op_id->set_term(iter->second.term);
+      op_id->set_index(op_index);
       return Status::OK();
     }
   }
@@ -280,13 +427,29 @@ namespace {
 
 // Calculate the total byte size that will be used on the wire to replicate this message as part of
 // a consensus update request. This accounts for the length delimiting and tagging of the message.
-int64_t TotalByteSizeForMessage(const ReplicateMsg& msg) {
-  int msg_size = google::protobuf::internal::WireFormatLite::LengthDelimitedSize(
-    msg.ByteSize());
+int64_t TotalByteSizeForSerializedSize(int64_t serialized_size) {
+  int64_t msg_size = google::protobuf::internal::WireFormatLite::LengthDelimitedSize(
+    serialized_size);
   msg_size += 1; // for the type tag
   return msg_size;
 }
 
+int64_t TotalByteSizeForMessage(const ReplicateMsg& msg) {
+  return TotalByteSizeForSerializedSize(msg.ByteSize());
+}
+
+Result<ReplicateMsgPtr> DecompressMsg(const std::string& compressed) {
+  std::string serialized;
+  if (!snappy::Uncompress(compressed.data(), compressed.size(), &serialized)) {
+    return STATUS(Corruption, "Failed to decompress log cache entry");
+  }
+  auto msg = std::make_shared<ReplicateMsg>();
+  if (!msg->ParseFromString(serialized)) {
+    return STATUS(Corruption, "Failed to parse log cache entry");
+  }
+  return msg;
+}
+
 } // anonymous namespace
 
 Status LogCache::ReadOps(int64_t after_op_index,
@@ -305,6 +468,13 @@ Status LogCache::ReadOps(int64_t after_op_index,
   std::unique_lock<simple_spinlock> l(lock_);
   int64_t next_index = after_op_index + 1;
 
+  // Whether the peer has fallen behind the uncompressed entries appended to the cache.
+  bool catching_up = false;
+  bool waited_for_prefetch = false;
+  int64_t num_hits = 0;
+  int64_t num_misses = 0;
+  int64_t catch_up_bytes = 0;
+
   // Return as many operations as we can, up to the limit
   int64_t remaining_space = max_size_bytes;
   while (remaining_space > 0 && next_index < next_sequential_op_index_) {
@@ -312,6 +482,16 @@ Status LogCache::ReadOps(int64_t after_op_index,
     // If the messages the peer needs haven't been loaded into the queue yet, load them.
     MessageCache::const_iterator iter = cache_.lower_bound(next_index);
     if (iter == cache_.end() || iter->first != next_index) {
+      catching_up = true;
+      if (background_token_ && !waited_for_prefetch) {
+        // If the messages are being prefetched, wait for them instead of reading them again.
+        waited_for_prefetch = true;
+        l.unlock();
+        WaitForPrefetch(next_index);
+        l.lock();
+        continue;
+      }
+
       int64_t up_to;
       if (iter == cache_.end()) {
         // Read all the way to the current op.
@@ -335,10 +515,13 @@ Status LogCache::ReadOps(int64_t after_op_index,
       for (auto& msg : raw_replicate_ptrs) {
         CHECK_EQ(next_index, msg->id().index());
 
-        remaining_space -= TotalByteSizeForMessage(*msg);
+        const int64_t msg_size = TotalByteSizeForMessage(*msg);
+        remaining_space -= msg_size;
         if (remaining_space > 0 || messages->empty()) {
           messages->push_back(msg);
           next_index++;
+          ++num_misses;
+          catch_up_bytes += msg_size;
         } else if (have_more_messages) {
           *have_more_messages = true;
         }
@@ -346,14 +529,12 @@ Status LogCache::ReadOps(int64_t after_op_index,
 
     } else {
       // Pull contiguous messages from the cache until the size limit is achieved.
-      for (; iter != cache_.end(); ++iter) {
-        const ReplicateMsgPtr& msg = iter->second.msg;
-        int64_t index = msg->id().index();
-        if (index != next_index) {
-          continue;
-        }
-
-        remaining_space -= TotalByteSizeForMessage(*msg);
+      for (; iter != cache_.end() && iter->first == next_index; ++iter) {
+        const CacheEntry& entry = iter->second;
+        const int64_t msg_size = entry.msg
+            ? TotalByteSizeForMessage(*entry.msg)
+            : TotalByteSizeForSerializedSize(entry.compressed_msg->uncompressed_size);
+        remaining_space -= msg_size;
         if (remaining_space < 0 && !messages->empty()) {
           if (have_more_messages) {
             *have_more_messages = true;
@@ -361,14 +542,141 @@ Status LogCache::ReadOps(int64_t after_op_index,
           break;
         }
 
-        messages->push_back(msg);
+        ++num_hits;
+        if (entry.msg) {
+          if (entry.prefetched) {
+            catching_up = true;
+            catch_up_bytes += msg_size;
+          }
+          messages->push_back(entry.msg);
+          next_index++;
+          continue;
+        }
+
+        // Decompress the message outside of the lock. The compressed message is not replaced by the
+        // decompressed one, since it is usually read only once, by the lagging peer.
+        catching_up = true;
+        catch_up_bytes += msg_size;
+        auto compressed_msg = entry.compressed_msg;
+        l.unlock();
+        auto msg = DecompressMsg(compressed_msg->data);
+        l.lock();
+        if (!msg.ok()) {
+          return msg.status().CloneAndPrepend(Format("Failed to read op $0", next_index));
+        }
+        messages->push_back(std::move(*msg));
         next_index++;
+        // The cache could have been modified while the lock was released.
+        break;
       }
     }
   }
+
+  // Prefetch the messages that follow the ones we've just read from the disk or from the
+  // prefetched entries, so that the peer does not have to wait for the disk on its next request.
+  int64_t prefetch_from_index = -1;
+  int64_t prefetch_to_index = -1;
+  int64_t generation = overwrite_generation_;
+  if (catching_up && background_token_ && FLAGS_log_cache_prefetch_size_bytes > 0) {
+    auto iter = cache_.lower_bound(next_index);
+    int64_t index = next_index;
+    while (iter != cache_.end() && iter->first == index && iter->second.prefetched) {
+      ++iter;
+      ++index;
+    }
+    if (index < next_sequential_op_index_ && (iter == cache_.end() || iter->first != index)) {
+      prefetch_from_index = index;
+      prefetch_to_index = iter == cache_.end() ? next_sequential_op_index_ - 1 : iter->first - 1;
+    }
+  }
+  l.unlock();
+
+  metrics_.log_cache_hits->IncrementBy(num_hits);
+  metrics_.log_cache_misses->IncrementBy(num_misses);
+  metrics_.log_cache_catch_up_bytes->IncrementBy(catch_up_bytes);
+
+  if (prefetch_from_index >= 0) {
+    SchedulePrefetch(prefetch_from_index, prefetch_to_index, generation);
+  }
   return Status::OK();
 }
 
+void LogCache::SchedulePrefetch(int64_t from_index, int64_t to_index, int64_t generation) {
+  {
+    std::lock_guard<std::mutex> lock(prefetch_mutex_);
+    if (prefetch_from_index_ <= prefetch_to_index_) {
+      return;
+    }
+    prefetch_from_index_ = from_index;
+    prefetch_to_index_ = to_index;
+  }
+  auto status = background_token_->SubmitFunc(
+      std::bind(&LogCache::Prefetch, this, from_index, to_index, generation));
+  if (!status.ok()) {
+    LOG_WITH_PREFIX_UNLOCKED(WARNING) << "Failed to schedule prefetch of ops " << from_index
+                                      << ".." << to_index << ": " << status;
+    std::lock_guard<std::mutex> lock(prefetch_mutex_);
+    prefetch_from_index_ = 0;
+    prefetch_to_index_ = -1;
+  }
+}
+
+void LogCache::Prefetch(int64_t from_index, int64_t to_index, int64_t generation) {
+  ReplicateMsgs msgs;
+  auto status = log_->GetLogReader()->ReadReplicatesInRange(
+      from_index, to_index, FLAGS_log_cache_prefetch_size_bytes, &msgs);
+  if (!status.ok()) {
+    LOG_WITH_PREFIX_UNLOCKED(WARNING) << "Failed to prefetch ops " << from_index << ".."
+                                      << to_index << ": " << status;
+    msgs.clear();
+  }
+
+  // SpaceUsed is relatively expensive, so do calculations outside the lock
+  std::vector<CacheEntry> entries;
+  entries.reserve(msgs.size());
+  for (auto& msg : msgs) {
+    const int64_t mem_usage = msg->SpaceUsedLong();
+    auto entry = CacheEntry::FromMsg(std::move(msg), mem_usage);
+    entry.prefetched = true;
+    entries.push_back(std::move(entry));
+  }
+
+  {
+    std::lock_guard<simple_spinlock> l(lock_);
+    // Ops that were overwritten since the prefetch was scheduled could have been read.
+    if (generation == overwrite_generation_) {
+      for (auto& entry : entries) {
+        const int64_t index = entry.msg->id().index();
+        if (cache_.count(index)) {
+          continue;
+        }
+        // Unlike appended ops, prefetched ops are not worth evicting anything.
+        if (!tracker_->TryConsume(entry.mem_usage)) {
+          break;
+        }
+        metrics_.log_cache_size->IncrementBy(entry.mem_usage);
+        metrics_.log_cache_num_ops->Increment();
+        metrics_.log_cache_prefetched_ops->Increment();
+        cache_.emplace(index, std::move(entry));
+      }
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(prefetch_mutex_);
+    prefetch_from_index_ = 0;
+    prefetch_to_index_ = -1;
+  }
+  prefetch_cond_.notify_all();
+}
+
+void LogCache::WaitForPrefetch(int64_t op_index) {
+  std::unique_lock<std::mutex> lock(prefetch_mutex_);
+  prefetch_cond_.wait(lock, [this, op_index] {
+    return op_index < prefetch_from_index_ || op_index > prefetch_to_index_;
+  });
+}
+
 
 void LogCache::EvictThroughOp(int64_t index) {
   std::lock_guard<simple_spinlock> lock(lock_);
@@ -387,8 +695,8 @@ void LogCache::EvictSomeUnlocked(int64_t stop_after_index, int64_t bytes_to_evic
   for (auto iter = cache_.begin(); iter != cache_.end();) {
     const CacheEntry& entry = iter->second;
     const ReplicateMsgPtr& msg = entry.msg;
-    VLOG_WITH_PREFIX_UNLOCKED(2) << "considering for eviction: " << msg->id();
-    int64_t msg_index = msg->id().index();
+    int64_t msg_index = iter->first;
+    VLOG_WITH_PREFIX_UNLOCKED(2) << "considering for eviction: " << entry.term << "." << msg_index;
     if (msg_index == 0) {
       // Always keep our special '0' op.
       ++iter;
@@ -399,14 +707,17 @@ void LogCache::EvictSomeUnlocked(int64_t stop_after_index, int64_t bytes_to_evic
       break;
     }
 
-    if (!msg.unique()) {
+    // Compressed entries are decompressed into a new message by readers, so they can always be
+    // evicted.
+    if (msg && !msg.unique()) {
       VLOG_WITH_PREFIX_UNLOCKED(2) << "Evicting cache: cannot remove " << msg->id()
                                    << " because it is in-use by a peer.";
       ++iter;
       continue;
     }
 
-    VLOG_WITH_PREFIX_UNLOCKED(2) << "Evicting cache. Removing: " << msg->id();
+    VLOG_WITH_PREFIX_UNLOCKED(2) << "Evicting cache. Removing: " << entry.term << "."
+                                 << msg_index;
     AccountForMessageRemovalUnlocked(entry);
     bytes_evicted += entry.mem_usage;
     cache_.erase(iter++);
@@ -422,6 +733,15 @@ void LogCache::AccountForMessageRemovalUnlocked(const CacheEntry& entry) {
   tracker_->Release(entry.mem_usage);
   metrics_.log_cache_size->DecrementBy(entry.mem_usage);
   metrics_.log_cache_num_ops->Decrement();
+  if (entry.compressed_msg) {
+    metrics_.log_cache_compression_saved_bytes->DecrementBy(entry.saved_bytes);
+    --num_compressed_ops_;
+  }
+}
+
+int64_t LogCache::num_compressed_ops() const {
+  std::lock_guard<simple_spinlock> lock(lock_);
+  return num_compressed_ops_;
 }
 
 int64_t LogCache::BytesUsed() const {
@@ -471,6 +791,13 @@ void LogCache::DumpToStrings(vector<string>* lines) const {
   lines->push_back("Messages:");
   for (const auto& entry : cache_) {
     const ReplicateMsgPtr msg = entry.second.msg;
+    if (!msg) {
+      lines->push_back(
+        Substitute("Message[$0] $1.$2 : REPLICATE. Compressed, Size: $3",
+                   counter++, entry.second.term, entry.first,
+                   entry.second.compressed_msg->uncompressed_size));
+      continue;
+    }
     lines->push_back(
       Substitute("Message[$0] $1.$2 : REPLICATE. Type: $3, Size: $4",
                  counter++, msg->id().term(), msg->id().index(),
@@ -490,6 +817,13 @@ void LogCache::DumpToHtml(std::ostream& out) const {
   int counter = 0;
   for (const auto& entry : cache_) {
     const ReplicateMsgPtr msg = entry.second.msg;
+    if (!msg) {
+      out << Substitute("<tr><th>$0</th><th>$1.$2</th><td>COMPRESSED</td>"
+                        "<td>$3</td><td></td></tr>",
+                        counter++, entry.second.term, entry.first,
+                        entry.second.compressed_msg->uncompressed_size) << endl;
+      continue;
+    }
     out << Substitute("<tr><th>$0</th><th>$1.$2</th><td>REPLICATE $3</td>"
                       "<td>$4</td><td>$5</td></tr>",
                       counter++, msg->id().term(), msg->id().index(),
@@ -503,7 +837,13 @@ void LogCache::DumpToHtml(std::ostream& out) const {
   x.Instantiate(metric_entity, 0)
 LogCache::Metrics::Metrics(const scoped_refptr<MetricEntity>& metric_entity)
   : log_cache_num_ops(INSTANTIATE_METRIC(METRIC_log_cache_num_ops)),
-    log_cache_size(INSTANTIATE_METRIC(METRIC_log_cache_size)) {
+    log_cache_size(INSTANTIATE_METRIC(METRIC_log_cache_size)),
+    log_cache_compression_saved_bytes(
+        INSTANTIATE_METRIC(METRIC_log_cache_compression_saved_bytes)),
+    log_cache_hits(METRIC_log_cache_hits.Instantiate(metric_entity)),
+    log_cache_misses(METRIC_log_cache_misses.Instantiate(metric_entity)),
+    log_cache_prefetched_ops(METRIC_log_cache_prefetched_ops.Instantiate(metric_entity)),
+    log_cache_catch_up_bytes(METRIC_log_cache_catch_up_bytes.Instantiate(metric_entity)) {
 }
 #undef INSTANTIATE_METRIC
 
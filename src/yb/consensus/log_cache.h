@@ -32,8 +32,10 @@
 #ifndef YB_CONSENSUS_LOG_CACHE_H
 #define YB_CONSENSUS_LOG_CACHE_H
 
+#include <condition_variable>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -54,6 +56,7 @@ namespace yb {
 
 class MetricEntity;
 class MemTracker;
+class ThreadPoolToken;
 
 namespace log {
 class Log;
@@ -68,14 +71,22 @@ class ReplicateMsg;
 //
 // This stores a set of log messages by their index. New operations can be appended to the end as
 // they are written to the log. Readers fetch entries that were explicitly appended, or they can
-// fetch older entries which are asynchronously fetched from the disk.
+// fetch older entries which are read from the disk.
+//
+// Once the memory used by the cache passes a threshold, the oldest entries are compressed in the
+// background, so that the same memory budget covers more log history for lagging followers. When a
+// read has to go to the disk, the following ops are prefetched into the cache in the background,
+// so that the next read of the same follower does not block on the disk.
 class LogCache {
  public:
+  // background_token is used to compress and prefetch entries. If it is null, entries are neither
+  // compressed nor prefetched.
   LogCache(const scoped_refptr<MetricEntity>& metric_entity,
            const scoped_refptr<log::Log>& log,
            const std::shared_ptr<MemTracker>& server_tracker,
            const std::string& local_uuid,
-           const std::string& tablet_id);
+           const std::string& tablet_id,
+           std::unique_ptr<ThreadPoolToken> background_token);
   ~LogCache();
 
   // Initialize the cache.
@@ -129,6 +140,9 @@ class LogCache {
     return metrics_.log_cache_num_ops->value();
   }
 
+  // Return the number of cached operations that are compressed.
+  int64_t num_compressed_ops() const;
+
   // Dump the current contents of the cache to the log.
   void DumpToLog() const;
 
@@ -153,14 +167,40 @@ class LogCache {
   FRIEND_TEST(LogCacheTest, TestAppendAndGetMessages);
   FRIEND_TEST(LogCacheTest, TestGlobalMemoryLimit);
   FRIEND_TEST(LogCacheTest, TestReplaceMessages);
+  FRIEND_TEST(LogCacheTest, TestCompression);
+  FRIEND_TEST(LogCacheTest, TestPrefetch);
   friend class LogCacheTest;
 
+  // Serialized and compressed ReplicateMsg.
+  struct CompressedMsg {
+    std::string data;
+    // Size of the serialized message.
+    int64_t uncompressed_size;
+  };
+
   // An entry in the cache.
   struct CacheEntry {
+    // The message, or nullptr if the entry is compressed.
     ReplicateMsgPtr msg;
-    // The cached value of msg->SpaceUsedLong(). This method is expensive
-    // to compute, so we compute it only once upon insertion.
+    // The compressed message, or nullptr if the entry is not compressed.
+    std::shared_ptr<const CompressedMsg> compressed_msg;
+    // Term of the operation, so that its OpId is known without decompressing it.
+    int64_t term;
+    // The cached value of msg->SpaceUsedLong(), or the memory used by the compressed message. This
+    // method is expensive to compute, so we compute it only once upon insertion.
     int64_t mem_usage;
+    // Memory saved by compressing the entry.
+    int64_t saved_bytes = 0;
+    // Whether the entry was prefetched from the disk.
+    bool prefetched = false;
+
+    static CacheEntry FromMsg(ReplicateMsgPtr msg, int64_t mem_usage) {
+      CacheEntry result;
+      result.term = msg->id().term();
+      result.msg = std::move(msg);
+      result.mem_usage = mem_usage;
+      return result;
+    }
   };
 
   // Try to evict the oldest operations from the queue, stopping either when
@@ -168,6 +208,25 @@ class LogCache {
   // 'stop_after_index' has been evicted, whichever comes first.
   void EvictSomeUnlocked(int64_t stop_after_index, int64_t bytes_to_evict);
 
+  // Whether the memory used by this cache or by all log caches is above the compression threshold.
+  bool ShouldCompress() const;
+
+  // Schedules compression of the oldest entries on the background token if the cache is above the
+  // compression threshold.
+  void ScheduleCompressionUnlocked();
+
+  // Compresses the oldest unpinned entries until the cache is below the compression threshold.
+  void CompressOldEntries();
+
+  // Starts reading ops in [from_index, to_index] from the disk into the cache in the background,
+  // unless another prefetch is in progress.
+  void SchedulePrefetch(int64_t from_index, int64_t to_index, int64_t generation);
+
+  void Prefetch(int64_t from_index, int64_t to_index, int64_t generation);
+
+  // Waits until there is no prefetch in progress that contains op_index.
+  void WaitForPrefetch(int64_t op_index);
+
   // Update metrics and MemTracker to account for the removal of the
   // given message.
   void AccountForMessageRemovalUnlocked(const CacheEntry& entry);
@@ -212,6 +271,24 @@ class LogCache {
   typedef std::map<uint64_t, CacheEntry> MessageCache;
   MessageCache cache_;
 
+  // Incremented every time operations are overwritten, so that a prefetch does not insert ops read
+  // before they were overwritten.
+  int64_t overwrite_generation_ = 0;
+
+  int64_t num_compressed_ops_ = 0;
+
+  // Used to compress and prefetch entries.
+  std::unique_ptr<ThreadPoolToken> background_token_;
+
+  bool compression_scheduled_ = false;
+
+  // The range of ops being prefetched, protected by prefetch_mutex_. Empty if there is no prefetch
+  // in progress.
+  std::mutex prefetch_mutex_;
+  std::condition_variable prefetch_cond_;
+  int64_t prefetch_from_index_ = 0;
+  int64_t prefetch_to_index_ = -1;
+
   // The next log index to append. Each append operation must either start with this log index, or
   // go backward (but never skip forward).
   int64_t next_sequential_op_index_;
@@ -239,6 +316,21 @@ class LogCache {
 
     // Keeps track of the memory consumed by the cache, in bytes.
     scoped_refptr<AtomicGauge<int64_t> > log_cache_size;
+
+    // Memory saved by keeping the oldest entries compressed.
+    scoped_refptr<AtomicGauge<int64_t> > log_cache_compression_saved_bytes;
+
+    // Number of operations that were read from the cache.
+    scoped_refptr<Counter> log_cache_hits;
+
+    // Number of operations that were not in the cache and had to be read from the disk.
+    scoped_refptr<Counter> log_cache_misses;
+
+    // Number of operations prefetched from the disk.
+    scoped_refptr<Counter> log_cache_prefetched_ops;
+
+    // Bytes of operations read by followers that have fallen behind the uncompressed entries.
+    scoped_refptr<Counter> log_cache_catch_up_bytes;
   };
   Metrics metrics_;
 
@@ -39,6 +39,8 @@
 
 #include <gflags/gflags.h>
 #include <glog/logging.h>
+#include <lz4.h>
+#include <snappy.h>
 
 #include "yb/consensus/opid_util.h"
 #include "yb/fs/fs_manager.h"
@@ -50,6 +52,7 @@
 
 #include "yb/util/coding-inl.h"
 #include "yb/util/coding.h"
+#include "yb/util/cast.h"
 #include "yb/util/crc.h"
 #include "yb/util/debug/trace_event.h"
 #include "yb/util/env_util.h"
@@ -95,6 +98,24 @@ DEFINE_bool(require_durable_wal_write, false, "Whether durable WAL write is requ
     "the system will soft downgrade the durable_wal_write flag.");
 TAG_FLAG(require_durable_wal_write, stable);
 
+DEFINE_string(log_compression_type, "NO_COMPRESSION",
+              "Codec used to compress the entry batches of new WAL segments: NO_COMPRESSION, "
+              "SNAPPY or LZ4. Compressed segments can't be read by versions that don't support "
+              "WAL compression.");
+TAG_FLAG(log_compression_type, advanced);
+TAG_FLAG(log_compression_type, evolving);
+
+static bool ValidateLogCompressionType(const char* flagname, const std::string& value) {
+  yb::log::CompressionTypePB compression_type;
+  if (yb::log::CompressionTypePB_Parse(value, &compression_type)) {
+    return true;
+  }
+  LOG(ERROR) << "Invalid value for " << flagname << ": " << value;
+  return false;
+}
+__attribute__((unused))
+DEFINE_validator(log_compression_type, &ValidateLogCompressionType);
+
 namespace yb {
 namespace log {
 
@@ -106,6 +127,16 @@ using strings::SubstituteAndAppend;
 
 const char kTmpSuffix[] = ".tmp";
 
+namespace {
+
+CompressionTypePB CompressionTypeFromFlag() {
+  CompressionTypePB result = NO_COMPRESSION;
+  CompressionTypePB_Parse(FLAGS_log_compression_type, &result);
+  return result;
+}
+
+} // namespace
+
 const char kLogSegmentHeaderMagicString[] = "yugalogf";
 
 // A magic that is written as the very last thing when a segment is closed.
@@ -136,7 +167,8 @@ LogOptions::LogOptions()
                                          FLAGS_interval_durable_wal_write_ms) : MonoDelta()),
       bytes_durable_wal_write_mb(FLAGS_bytes_durable_wal_write_mb),
       preallocate_segments(FLAGS_log_preallocate_segments),
-      async_preallocate_segments(FLAGS_log_async_preallocate_segments) {
+      async_preallocate_segments(FLAGS_log_async_preallocate_segments),
+      compression_type(CompressionTypeFromFlag()) {
 }
 
 Status ReadableLogSegment::Open(Env* env,
@@ -718,15 +750,25 @@ Status ReadableLogSegment::ReadEntryBatch(int64_t *offset,
   }
 
 
+  *offset += entry_batch_slice.size();
+
+  faststring uncompressed;
+  if (header_.compression_type() != NO_COMPRESSION) {
+    RETURN_NOT_OK_PREPEND(
+        UncompressEntryBatch(header_.compression_type(), entry_batch_slice, &uncompressed),
+        Format("Could not uncompress entry in $0 at offset $1",
+               path_, *offset - entry_batch_slice.size()));
+    entry_batch_slice = Slice(uncompressed);
+  }
+
   LogEntryBatchPB read_entry_batch;
   s = pb_util::ParseFromArray(&read_entry_batch,
                               entry_batch_slice.data(),
-                              header.msg_length);
+                              entry_batch_slice.size());
 
   if (!s.ok()) return STATUS(Corruption, Substitute("Could parse PB. Cause: $0",
                                                     s.ToString()));
 
-  *offset += entry_batch_slice.size();
   entry_batch->Swap(&read_entry_batch);
   return Status::OK();
 }
@@ -819,6 +861,74 @@ Status WritableLogSegment::WriteEntryBatch(const Slice& data) {
   return Status::OK();
 }
 
+Status CompressEntryBatch(CompressionTypePB compression_type,
+                          const Slice& data,
+                          faststring* out) {
+  out->clear();
+  PutVarint32(out, data.size());
+  const size_t prefix_size = out->size();
+  switch (compression_type) {
+    case SNAPPY: {
+      out->resize(prefix_size + snappy::MaxCompressedLength(data.size()));
+      size_t compressed_size = 0;
+      snappy::RawCompress(
+          data.cdata(), data.size(), util::to_char_ptr(out->data() + prefix_size),
+          &compressed_size);
+      out->resize(prefix_size + compressed_size);
+      return Status::OK();
+    }
+    case LZ4: {
+      const int max_compressed_size = LZ4_compressBound(data.size());
+      out->resize(prefix_size + max_compressed_size);
+      const int compressed_size = LZ4_compress_default(
+          data.cdata(), util::to_char_ptr(out->data() + prefix_size), data.size(),
+          max_compressed_size);
+      if (compressed_size <= 0) {
+        return STATUS(RuntimeError, "LZ4 compression failed");
+      }
+      out->resize(prefix_size + compressed_size);
+      return Status::OK();
+    }
+    case NO_COMPRESSION:
+      break;
+  }
+  return STATUS_FORMAT(InvalidArgument, "Unsupported log compression type: $0",
+                       CompressionTypePB_Name(compression_type));
+}
+
+Status UncompressEntryBatch(CompressionTypePB compression_type,
+                            Slice data,
+                            faststring* out) {
+  uint32_t uncompressed_size = 0;
+  if (!GetVarint32(&data, &uncompressed_size)) {
+    return STATUS(Corruption, "Could not decode uncompressed entry batch size");
+  }
+  out->resize(uncompressed_size);
+  switch (compression_type) {
+    case SNAPPY: {
+      size_t snappy_size = 0;
+      if (!snappy::GetUncompressedLength(data.cdata(), data.size(), &snappy_size) ||
+          snappy_size != uncompressed_size ||
+          !snappy::RawUncompress(data.cdata(), data.size(), util::to_char_ptr(out->data()))) {
+        return STATUS(Corruption, "Invalid Snappy compressed entry batch");
+      }
+      return Status::OK();
+    }
+    case LZ4: {
+      const int size = LZ4_decompress_safe(
+          data.cdata(), util::to_char_ptr(out->data()), data.size(), uncompressed_size);
+      if (size < 0 || implicit_cast<uint32_t>(size) != uncompressed_size) {
+        return STATUS(Corruption, "Invalid LZ4 compressed entry batch");
+      }
+      return Status::OK();
+    }
+    case NO_COMPRESSION:
+      break;
+  }
+  return STATUS_FORMAT(Corruption, "Unsupported log compression type: $0",
+                       static_cast<int>(compression_type));
+}
+
 // Creates a LogEntryBatchPB from pre-allocated ReplicateMsgs managed using shared pointers. The
 // caller has to ensure these messages are not deleted twice, both by LogEntryBatchPB and by
 // the shared pointers.
@@ -101,6 +101,9 @@ struct LogOptions {
   // Whether the allocation should happen asynchronously.
   bool async_preallocate_segments;
 
+  // Codec used to compress the entry batches of new segments.
+  CompressionTypePB compression_type;
+
   LogOptions();
 };
 
@@ -432,6 +435,17 @@ using consensus::ReplicateMsgs;
 // in some hot paths.
 LogEntryBatchPB CreateBatchFromAllocatedOperations(const ReplicateMsgs& msgs);
 
+// Compresses the serialized entry batch 'data' into 'out', prefixed with the varint encoded size
+// of 'data'.
+CHECKED_STATUS CompressEntryBatch(CompressionTypePB compression_type,
+                                  const Slice& data,
+                                  faststring* out);
+
+// Reverse of CompressEntryBatch().
+CHECKED_STATUS UncompressEntryBatch(CompressionTypePB compression_type,
+                                    Slice data,
+                                    faststring* out);
+
 // Checks if 'fname' is a correctly formatted name of log segment file.
 bool IsLogFileName(const std::string& fname);
 
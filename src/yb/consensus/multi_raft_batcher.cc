@@ -0,0 +1,168 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/consensus/multi_raft_batcher.h"
+
+#include "yb/consensus/consensus.proxy.h"
+
+#include "yb/rpc/messenger.h"
+#include "yb/rpc/rpc_controller.h"
+
+#include "yb/util/flag_tags.h"
+#include "yb/util/logging.h"
+
+DEFINE_int32(multi_raft_batch_window_ms, 0,
+             "If positive, UpdateConsensus requests without operations, like heartbeats, that are "
+             "sent to the same server within this many milliseconds are merged into a single "
+             "MultiRaftUpdateConsensus RPC. 0 to disable. Every server of the cluster should "
+             "support MultiRaftUpdateConsensus before this is enabled.");
+TAG_FLAG(multi_raft_batch_window_ms, advanced);
+TAG_FLAG(multi_raft_batch_window_ms, runtime);
+
+DEFINE_int32(multi_raft_batch_max_replicate_bytes, 0,
+             "UpdateConsensus requests with operations are batched too if their size does not "
+             "exceed this many bytes. 0 to batch requests without operations only.");
+TAG_FLAG(multi_raft_batch_max_replicate_bytes, advanced);
+TAG_FLAG(multi_raft_batch_max_replicate_bytes, runtime);
+
+DEFINE_int32(multi_raft_batch_max_requests, 256,
+             "A MultiRaftUpdateConsensus RPC is sent without waiting for the batch window to pass "
+             "once it has this many requests.");
+TAG_FLAG(multi_raft_batch_max_requests, advanced);
+
+DECLARE_int32(consensus_rpc_timeout_ms);
+
+namespace yb {
+namespace consensus {
+
+struct MultiRaftBatcher::Batch {
+  std::vector<PendingRequest> requests;
+  MultiRaftUpdateConsensusRequestPB request;
+  MultiRaftUpdateConsensusResponsePB response;
+  rpc::RpcController controller;
+};
+
+MultiRaftBatcher::MultiRaftBatcher(
+    rpc::Messenger* messenger, rpc::ProxyCache* proxy_cache, HostPort hostport)
+    : messenger_(messenger),
+      proxy_(std::make_unique<ConsensusServiceProxy>(proxy_cache, hostport)) {
+}
+
+MultiRaftBatcher::~MultiRaftBatcher() {}
+
+bool MultiRaftBatcher::ShouldBatch(const ConsensusRequestPB& request) {
+  if (FLAGS_multi_raft_batch_window_ms <= 0) {
+    return false;
+  }
+  if (request.ops_size() == 0) {
+    return true;
+  }
+  return FLAGS_multi_raft_batch_max_replicate_bytes > 0 &&
+         request.ByteSize() <= FLAGS_multi_raft_batch_max_replicate_bytes;
+}
+
+void MultiRaftBatcher::AddRequest(const ConsensusRequestPB* request,
+                                  ConsensusResponsePB* response,
+                                  rpc::RpcController* controller,
+                                  rpc::ResponseCallback callback) {
+  bool flush_now = false;
+  bool schedule_flush = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_requests_.push_back(PendingRequest{
+        request, response, controller, std::move(callback),
+        MonoTime::Now() + MonoDelta::FromMilliseconds(FLAGS_consensus_rpc_timeout_ms)});
+    if (pending_requests_.size() >= implicit_cast<size_t>(FLAGS_multi_raft_batch_max_requests)) {
+      flush_now = true;
+    } else if (!flush_scheduled_) {
+      flush_scheduled_ = true;
+      schedule_flush = true;
+    }
+  }
+
+  if (flush_now) {
+    FlushBatch();
+  } else if (schedule_flush) {
+    // The batch is flushed even if the task is aborted during shutdown, so that every request gets
+    // its callback invoked. Requests added after an early flush could be sent by an already
+    // scheduled task, i.e. before the batch window passes, which is fine.
+    messenger_->scheduler().Schedule(
+        [self = shared_from_this()](const Status&) { self->FlushBatch(); },
+        std::chrono::milliseconds(FLAGS_multi_raft_batch_window_ms));
+  }
+}
+
+void MultiRaftBatcher::FlushBatch() {
+  auto batch = std::make_shared<Batch>();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    batch->requests.swap(pending_requests_);
+    flush_scheduled_ = false;
+  }
+  if (batch->requests.empty()) {
+    return;
+  }
+
+  batch->request.mutable_consensus_request()->Reserve(batch->requests.size());
+  auto deadline = MonoTime::Max();
+  for (const auto& pending : batch->requests) {
+    *batch->request.add_consensus_request() = *pending.request;
+    deadline = std::min(deadline, pending.deadline);
+  }
+  batch->controller.set_deadline(deadline);
+  proxy_->MultiRaftUpdateConsensusAsync(
+      batch->request, &batch->response, &batch->controller,
+      [self = shared_from_this(), batch] { self->BatchDone(batch); });
+}
+
+void MultiRaftBatcher::BatchDone(const std::shared_ptr<Batch>& batch) {
+  auto& requests = batch->requests;
+  auto& responses = *batch->response.mutable_consensus_response();
+  if (!batch->controller.status().ok() || responses.size() != requests.size()) {
+    YB_LOG_EVERY_N_SECS(WARNING, 10)
+        << "MultiRaftUpdateConsensus with " << requests.size() << " requests failed: "
+        << batch->controller.status() << ", " << responses.size()
+        << " responses, sending them separately";
+    // A request whose deadline has already passed fails right away, like it would have without
+    // batching, instead of getting another full timeout.
+    for (auto& pending : requests) {
+      pending.controller->set_deadline(pending.deadline);
+      proxy_->UpdateConsensusAsync(
+          *pending.request, pending.response, pending.controller, pending.callback);
+    }
+    return;
+  }
+
+  for (size_t i = 0; i != requests.size(); ++i) {
+    requests[i].response->Swap(responses.Mutable(i));
+    requests[i].callback();
+  }
+}
+
+MultiRaftManager::MultiRaftManager(rpc::Messenger* messenger, rpc::ProxyCache* proxy_cache)
+    : messenger_(messenger), proxy_cache_(proxy_cache) {
+}
+
+MultiRaftBatcherPtr MultiRaftManager::AddOrGetBatcher(const HostPort& hostport) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& weak_batcher = batchers_[hostport];
+  auto result = weak_batcher.lock();
+  if (!result) {
+    result = std::make_shared<MultiRaftBatcher>(messenger_, proxy_cache_, hostport);
+    weak_batcher = result;
+  }
+  return result;
+}
+
+} // namespace consensus
+} // namespace yb
@@ -0,0 +1,99 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#ifndef YB_CONSENSUS_MULTI_RAFT_BATCHER_H
+#define YB_CONSENSUS_MULTI_RAFT_BATCHER_H
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "yb/consensus/consensus_fwd.h"
+#include "yb/consensus/consensus.pb.h"
+
+#include "yb/rpc/response_callback.h"
+#include "yb/rpc/rpc_fwd.h"
+
+#include "yb/util/monotime.h"
+#include "yb/util/net/net_util.h"
+
+namespace yb {
+namespace consensus {
+
+// Merges UpdateConsensus requests of different tablets that are sent to the same server into
+// MultiRaftUpdateConsensus RPCs.
+//
+// Requests are collected for --multi_raft_batch_window_ms after the first one of a batch arrives.
+// If the batch RPC fails, its requests are sent again as separate UpdateConsensus RPCs, so that
+// every peer gets the error through its own controller, exactly as without batching. Each request
+// has the deadline it got when it was queued, the batch RPC and the resent request included.
+class MultiRaftBatcher : public std::enable_shared_from_this<MultiRaftBatcher> {
+ public:
+  MultiRaftBatcher(rpc::Messenger* messenger, rpc::ProxyCache* proxy_cache, HostPort hostport);
+  ~MultiRaftBatcher();
+
+  // Returns whether the request should be sent as a part of a batch.
+  static bool ShouldBatch(const ConsensusRequestPB& request);
+
+  // Queues the request. The callback is invoked after the response or the controller were filled,
+  // like for ConsensusServiceProxy::UpdateConsensusAsync().
+  void AddRequest(const ConsensusRequestPB* request,
+                  ConsensusResponsePB* response,
+                  rpc::RpcController* controller,
+                  rpc::ResponseCallback callback);
+
+ private:
+  struct PendingRequest {
+    const ConsensusRequestPB* request;
+    ConsensusResponsePB* response;
+    rpc::RpcController* controller;
+    rpc::ResponseCallback callback;
+    MonoTime deadline;
+  };
+
+  struct Batch;
+
+  void FlushBatch();
+
+  void BatchDone(const std::shared_ptr<Batch>& batch);
+
+  rpc::Messenger* const messenger_;
+  const ConsensusServiceProxyPtr proxy_;
+
+  std::mutex mutex_;
+  std::vector<PendingRequest> pending_requests_;
+  bool flush_scheduled_ = false;
+};
+
+// Keeps a single MultiRaftBatcher per destination server, shared by the consensus peers of all
+// tablets of this server.
+class MultiRaftManager {
+ public:
+  MultiRaftManager(rpc::Messenger* messenger, rpc::ProxyCache* proxy_cache);
+
+  MultiRaftBatcherPtr AddOrGetBatcher(const HostPort& hostport);
+
+ private:
+  rpc::Messenger* const messenger_;
+  rpc::ProxyCache* const proxy_cache_;
+
+  std::mutex mutex_;
+  // Batchers are owned by the peer proxies that use them.
+  std::unordered_map<HostPort, std::weak_ptr<MultiRaftBatcher>, HostPortHash> batchers_;
+};
+
+} // namespace consensus
+} // namespace yb
+
+#endif // YB_CONSENSUS_MULTI_RAFT_BATCHER_H
@@ -85,7 +85,8 @@ class MockQueue : public PeerMessageQueue {
                      std::unique_ptr<ThreadPoolToken> raft_pool_observers_token)
       : PeerMessageQueue(metric_entity, log, nullptr /* server_tracker */,
                          FakeRaftPeerPB(kLocalPeerUuid), kTestTablet, clock,
-                         std::move(raft_pool_observers_token)) {}
+                         std::move(raft_pool_observers_token),
+                         nullptr /* log_cache_token */) {}
 
   MOCK_METHOD1(Init, void(const OpId& locally_replicated_index));
   MOCK_METHOD3(SetLeaderMode, void(const OpId& committed_opid,
@@ -201,9 +201,10 @@ shared_ptr<RaftConsensus> RaftConsensus::Create(
     const Callback<void(std::shared_ptr<StateChangeContext> context)> mark_dirty_clbk,
     TableType table_type,
     ThreadPool* raft_pool,
-    RetryableRequests* retryable_requests) {
+    RetryableRequests* retryable_requests,
+    MultiRaftManager* multi_raft_manager) {
   gscoped_ptr<PeerProxyFactory> rpc_factory(new RpcPeerProxyFactory(
-      messenger, proxy_cache, local_peer_pb.cloud_info()));
+      messenger, proxy_cache, local_peer_pb.cloud_info(), multi_raft_manager));
 
   // The message queue that keeps track of which operations need to be replicated
   // where.
@@ -214,6 +215,7 @@ shared_ptr<RaftConsensus> RaftConsensus::Create(
                            local_peer_pb,
                            options.tablet_id,
                            clock,
+                           raft_pool->NewToken(ThreadPool::ExecutionMode::SERIAL),
                            raft_pool->NewToken(ThreadPool::ExecutionMode::SERIAL)));
 
   DCHECK(local_peer_pb.has_permanent_uuid());
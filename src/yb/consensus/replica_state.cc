@@ -287,6 +287,9 @@ Status ReplicaState::ShutdownUnlocked() {
   DCHECK(IsLocked());
   CHECK_EQ(state_, kShuttingDown);
   state_ = kShutDown;
+  if (cmeta_->leader_term_unflushed()) {
+    RETURN_NOT_OK(cmeta_->Flush());
+  }
   return Status::OK();
 }
 
@@ -446,6 +449,11 @@ const int64_t ReplicaState::GetCurrentTermUnlocked() const {
 void ReplicaState::SetLeaderUuidUnlocked(const std::string& uuid) {
   DCHECK(IsLocked());
   cmeta_->set_leader_uuid(uuid);
+  if (uuid == GetPeerUuid() && cmeta_->leader_term() != cmeta_->current_term()) {
+    // Persisted by the next metadata flush or at shutdown, so tablets led by this server could be
+    // bootstrapped first after restart. Not flushed here, to keep elections free of extra fsyncs.
+    cmeta_->set_leader_term(cmeta_->current_term());
+  }
   StoreRoleAndTerm(cmeta_->active_role(), cmeta_->current_term());
 }
 
@@ -1180,6 +1188,11 @@ MicrosTime ReplicaState::MajorityReplicatedHtLeaseExpiration(
     return result;
   }
 
+  // A caller that does not wait, i.e. passes a deadline of MonoTime::kMin, does not need the lock.
+  if (deadline == MonoTime::kMin) {
+    return 0;
+  }
+
   // Slow path
   UniqueLock l(update_lock_);
   auto predicate = [this, &result, min_allowed] {
@@ -391,7 +391,8 @@ class ReplicaState {
   // timestamp.
   // @param min_allowed - will wait until the majority-replicated hybrid time leader lease reaches
   //                      at least this microsecond timestamp.
-  // @param deadline - won't wait past this deadline.
+  // @param deadline - won't wait past this deadline. MonoTime::kMin only checks the current value,
+  //                   without taking update_lock_.
   // @return leader lease or 0 if timed out.
   MicrosTime MajorityReplicatedHtLeaseExpiration(MicrosTime min_allowed, MonoTime deadline) const;
 
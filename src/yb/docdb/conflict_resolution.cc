@@ -22,6 +22,7 @@
 #include "yb/docdb/docdb.pb.h"
 #include "yb/docdb/docdb_rocksdb_util.h"
 #include "yb/docdb/intent.h"
+#include "yb/docdb/intent_index.h"
 #include "yb/docdb/shared_lock_manager.h"
 
 #include "yb/util/countdown_latch.h"
@@ -88,10 +89,12 @@ class ConflictResolverContext {
 class ConflictResolver {
  public:
   ConflictResolver(const DocDB& doc_db,
+                   const IntentIndex* intent_index,
                    TransactionStatusManager* status_manager,
                    ConflictResolverContext* context)
-      : doc_db_(doc_db), status_manager_(*status_manager), request_scope_(status_manager),
-        context_(*context) {}
+      : doc_db_(doc_db),
+        intent_index_(intent_index && intent_index->ready() ? intent_index : nullptr),
+        status_manager_(*status_manager), request_scope_(status_manager), context_(*context) {}
 
   TransactionStatusManager& status_manager() {
     return status_manager_;
@@ -110,12 +113,24 @@ class ConflictResolver {
     return ResolveConflicts();
   }
 
-  // Reads conflicts for specified intent from DB.
+  // Reads conflicts for specified intent from intent index if it is ready, otherwise from DB.
   CHECKED_STATUS ReadIntentConflicts(IntentType type, KeyBytes* intent_key_prefix) {
-    EnsureIntentIteratorCreated();
-
     const auto& conflicting_intent_types = kIntentConflicts[static_cast<size_t>(type)];
 
+    // Index could be disabled meanwhile, then the rest of intents are read from DB.
+    if (intent_index_ && intent_index_->ForEachIntent(
+            intent_key_prefix->AsSlice(),
+            [this, &conflicting_intent_types](const TransactionId& id, IntentType existing_type) {
+          if (conflicting_intent_types.test(static_cast<size_t>(existing_type)) &&
+              !context_.IgnoreConflictsWith(id)) {
+            conflicts_.insert(id);
+          }
+        })) {
+      return Status::OK();
+    }
+
+    EnsureIntentIteratorCreated();
+
     KeyBytes upperbound_key(*intent_key_prefix);
     upperbound_key.AppendValueType(ValueType::kMaxByte);
     intent_key_upperbound_ = upperbound_key.AsSlice();
@@ -309,6 +324,8 @@ class ConflictResolver {
   }
 
   DocDB doc_db_;
+  // Used instead of intent_iter_ when set.
+  const IntentIndex* intent_index_;
   std::unique_ptr<rocksdb::Iterator> intent_iter_;
   Slice intent_key_upperbound_;
   TransactionStatusManager& status_manager_;
@@ -506,20 +523,22 @@ class OperationConflictResolverContext : public ConflictResolverContext {
 Status ResolveTransactionConflicts(const KeyValueWriteBatchPB& write_batch,
                                    HybridTime hybrid_time,
                                    const DocDB& doc_db,
+                                   const IntentIndex* intent_index,
                                    TransactionStatusManager* status_manager,
                                    Counter* conflicts_metric) {
   DCHECK(hybrid_time.is_valid());
   TransactionConflictResolverContext context(write_batch, hybrid_time, conflicts_metric);
-  ConflictResolver resolver(doc_db, status_manager, &context);
+  ConflictResolver resolver(doc_db, intent_index, status_manager, &context);
   return resolver.Resolve();
 }
 
 Result<HybridTime> ResolveOperationConflicts(const DocOperations& doc_ops,
                                              HybridTime hybrid_time,
                                              const DocDB& doc_db,
+                                             const IntentIndex* intent_index,
                                              TransactionStatusManager* status_manager) {
   OperationConflictResolverContext context(&doc_ops, hybrid_time);
-  ConflictResolver resolver(doc_db, status_manager, &context);
+  ConflictResolver resolver(doc_db, intent_index, status_manager, &context);
   RETURN_NOT_OK(resolver.Resolve());
   return context.GetHybridTime();
 }
@@ -33,6 +33,7 @@ class TransactionStatusManager;
 
 namespace docdb {
 
+class IntentIndex;
 class KeyValueWriteBatchPB;
 
 // Resolves conflicts for write batch of transaction.
@@ -44,11 +45,13 @@ class KeyValueWriteBatchPB;
 // write_batch - values that would be written as part of transaction.
 // hybrid_time - current hybrid time.
 // db - db that contains tablet data.
+// intent_index - in-memory index of intents, used instead of intents db when ready. Could be null.
 // status_manager - status manager that should be used during this conflict resolution.
 // conflicts_metric - transaction_conflicts metric to update.
 CHECKED_STATUS ResolveTransactionConflicts(const KeyValueWriteBatchPB& write_batch,
                                            HybridTime hybrid_time,
                                            const DocDB& doc_db,
+                                           const IntentIndex* intent_index,
                                            TransactionStatusManager* status_manager,
                                            Counter* conflicts_metric);
 
@@ -63,10 +66,12 @@ CHECKED_STATUS ResolveTransactionConflicts(const KeyValueWriteBatchPB& write_bat
 // doc_ops - doc operations that would be applied as part of operation.
 // hybrid_time - current hybrid time.
 // db - db that contains tablet data.
+// intent_index - in-memory index of intents, used instead of intents db when ready. Could be null.
 // status_manager - status manager that should be used during this conflict resolution.
 Result<HybridTime> ResolveOperationConflicts(const DocOperations& doc_ops,
                                              HybridTime hybrid_time,
                                              const DocDB& doc_db,
+                                             const IntentIndex* intent_index,
                                              TransactionStatusManager* status_manager);
 
 struct ParsedIntent {
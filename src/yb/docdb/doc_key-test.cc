@@ -373,6 +373,57 @@ TEST(DocKeyTest, TestKeyMatching) {
   ASSERT_FALSE(may_match(EncodeSimpleSubDocKey(absent_key))) << "Key: " << absent_key;
 }
 
+TEST(DocKeyTest, TestFirstSubkeyFilterGranularity) {
+  DocDbAwareFilterPolicy policy(rocksdb::FilterPolicy::kDefaultFixedSizeFilterBits, nullptr,
+                                DocDbFilterGranularity::kFirstSubkey);
+  const auto* transformer = policy.GetKeyTransformer();
+
+  DocKey doc_key(0, PrimitiveValues("hash_key"), PrimitiveValues("range_key"));
+  const std::string encoded_doc_key = doc_key.Encode().AsStringRef();
+  const std::string hashed_components = encoded_doc_key.substr(
+      0, ASSERT_RESULT(DocKey::EncodedSize(encoded_doc_key, DocKeyPart::HASHED_PART_ONLY)));
+  const std::string subkey_filter_key =
+      SubDocKey(doc_key, PrimitiveValue("sub_key")).EncodeWithoutHt().AsStringRef();
+  const std::string document_filter_key = encoded_doc_key + ValueTypeAsChar::kHybridTime;
+
+  const std::string subkey_record = EncodeSubDocKey("hash_key", "range_key", "sub_key", 12345L);
+  const std::string document_record =
+      SubDocKey(doc_key, HybridTime::FromMicros(12345L)).Encode().AsStringRef();
+
+  // Lookup keys are transformed to the finest part they contain.
+  ASSERT_EQ(subkey_filter_key, transformer->Transform(subkey_record).ToBuffer());
+  ASSERT_EQ(subkey_filter_key, transformer->Transform(subkey_filter_key).ToBuffer());
+  ASSERT_EQ(document_filter_key, transformer->Transform(document_record).ToBuffer());
+  ASSERT_EQ(encoded_doc_key, transformer->Transform(encoded_doc_key).ToBuffer());
+  ASSERT_EQ(hashed_components, transformer->Transform(hashed_components).ToBuffer());
+
+  ASSERT_EQ(encoded_doc_key, transformer->CoarserKey(subkey_filter_key).ToBuffer());
+  ASSERT_EQ(encoded_doc_key, transformer->CoarserKey(document_filter_key).ToBuffer());
+  ASSERT_EQ(hashed_components, transformer->CoarserKey(encoded_doc_key).ToBuffer());
+  ASSERT_TRUE(transformer->CoarserKey(hashed_components).empty());
+
+  std::unique_ptr<FilterBitsBuilder> builder(policy.GetFilterBitsBuilder());
+  for (auto key = transformer->Transform(subkey_record); !key.empty();
+       key = transformer->CoarserKey(key)) {
+    builder->AddKey(key);
+  }
+  std::unique_ptr<const char[]> buf;
+  rocksdb::Slice filter = builder->Finish(&buf);
+  std::unique_ptr<FilterBitsReader> reader(policy.GetFilterBitsReader(filter));
+
+  auto may_match = [&](const std::string& key) {
+    return reader->MayMatch(transformer->Transform(key));
+  };
+  ASSERT_TRUE(may_match(subkey_record));
+  ASSERT_TRUE(may_match(encoded_doc_key));
+  ASSERT_TRUE(may_match(hashed_components));
+  ASSERT_FALSE(may_match(document_record));
+  ASSERT_FALSE(may_match(EncodeSubDocKey("hash_key", "range_key", "another_sub_key", 12345L)));
+  ASSERT_FALSE(may_match(
+      DocKey(0, PrimitiveValues("hash_key"), PrimitiveValues("another_range_key"))
+          .Encode().AsStringRef()));
+}
+
 TEST(DocKeyTest, TestWriteId) {
   SubDocKey subdoc_key(DocKey({PrimitiveValue("a"), PrimitiveValue(135)}),
                        DocHybridTime(1000000, 4091, 135));
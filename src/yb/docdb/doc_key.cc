@@ -743,8 +743,79 @@ class HashedComponentsExtractor : public rocksdb::FilterPolicy::KeyTransformer {
   }
 };
 
+// Extracts whole DocKey, or DocKey with the first subkey, falling back to coarser parts of the key
+// when it does not contain the finer ones. So the lookup key passed to the filter could be just the
+// hashed components or the DocKey.
+class DocKeyComponentsExtractor : public rocksdb::FilterPolicy::KeyTransformer {
+ public:
+  explicit DocKeyComponentsExtractor(bool include_first_subkey)
+      : include_first_subkey_(include_first_subkey) {}
+  DocKeyComponentsExtractor(const DocKeyComponentsExtractor&) = delete;
+  DocKeyComponentsExtractor& operator=(const DocKeyComponentsExtractor&) = delete;
+
+  static DocKeyComponentsExtractor& GetInstance(bool include_first_subkey) {
+    static DocKeyComponentsExtractor doc_key_instance(false);
+    static DocKeyComponentsExtractor first_subkey_instance(true);
+    return include_first_subkey ? first_subkey_instance : doc_key_instance;
+  }
+
+  Slice Transform(Slice key) const override {
+    auto hashed_size = CHECK_RESULT(DocKey::EncodedSize(key, DocKeyPart::HASHED_PART_ONLY));
+    if (key.size() == hashed_size) {
+      return key;
+    }
+    auto doc_key_size = DocKey::EncodedSize(key, DocKeyPart::WHOLE_DOC_KEY);
+    if (!doc_key_size.ok()) {
+      return Slice(key.data(), hashed_size);
+    }
+    if (!include_first_subkey_ || key.size() == *doc_key_size) {
+      return Slice(key.data(), *doc_key_size);
+    }
+    Slice subkey(key.data() + *doc_key_size, key.end());
+    if (subkey[0] == ValueTypeAsChar::kHybridTime) {
+      return Slice(key.data(), *doc_key_size + 1);
+    }
+    auto decoded = SubDocKey::DecodeSubkey(&subkey);
+    if (!decoded.ok() || !*decoded) {
+      return Slice(key.data(), *doc_key_size);
+    }
+    return Slice(key.data(), subkey.data());
+  }
+
+  Slice CoarserKey(Slice filter_key) const override {
+    auto hashed_size = DocKey::EncodedSize(filter_key, DocKeyPart::HASHED_PART_ONLY);
+    if (!hashed_size.ok() || filter_key.size() == *hashed_size) {
+      return Slice();
+    }
+    auto doc_key_size = DocKey::EncodedSize(filter_key, DocKeyPart::WHOLE_DOC_KEY);
+    if (!doc_key_size.ok()) {
+      return Slice();
+    }
+    if (filter_key.size() == *doc_key_size) {
+      // Empty for keys without hashed components.
+      return Slice(filter_key.data(), *hashed_size);
+    }
+    return Slice(filter_key.data(), *doc_key_size);
+  }
+
+ private:
+  const bool include_first_subkey_;
+};
+
 } // namespace
 
+const char* DocDbAwareFilterPolicy::Name() const {
+  switch (granularity_) {
+    case DocDbFilterGranularity::kHashedComponents:
+      return "DocKeyHashedComponentsFilter";
+    case DocDbFilterGranularity::kDocKey:
+      return "DocKeyFilter";
+    case DocDbFilterGranularity::kFirstSubkey:
+      return "DocKeyFirstSubkeyFilter";
+  }
+  FATAL_INVALID_ENUM_VALUE(DocDbFilterGranularity, granularity_);
+}
+
 
 void DocDbAwareFilterPolicy::CreateFilter(
     const rocksdb::Slice* keys, int n, std::string* dst) const {
@@ -771,7 +842,15 @@ rocksdb::FilterPolicy::FilterType DocDbAwareFilterPolicy::GetFilterType() const
 }
 
 const rocksdb::FilterPolicy::KeyTransformer* DocDbAwareFilterPolicy::GetKeyTransformer() const {
-  return &HashedComponentsExtractor::GetInstance();
+  switch (granularity_) {
+    case DocDbFilterGranularity::kHashedComponents:
+      return &HashedComponentsExtractor::GetInstance();
+    case DocDbFilterGranularity::kDocKey:
+      return &DocKeyComponentsExtractor::GetInstance(false /* include_first_subkey */);
+    case DocDbFilterGranularity::kFirstSubkey:
+      return &DocKeyComponentsExtractor::GetInstance(true /* include_first_subkey */);
+  }
+  FATAL_INVALID_ENUM_VALUE(DocDbFilterGranularity, granularity_);
 }
 
 }  // namespace docdb
@@ -21,6 +21,7 @@
 
 #include "yb/rocksdb/env.h"
 #include "yb/rocksdb/filter_policy.h"
+#include "yb/util/enums.h"
 #include "yb/util/slice.h"
 #include "yb/util/strongly_typed_bool.h"
 
@@ -527,15 +528,36 @@ inline std::ostream& operator <<(std::ostream& out, const SubDocKey& subdoc_key)
 std::string BestEffortDocDBKeyToStr(const KeyBytes &key_bytes);
 std::string BestEffortDocDBKeyToStr(const rocksdb::Slice &slice);
 
-// This filter policy only takes into account hashed components of keys for filtering.
+// Finest part of the key that DocDbAwareFilterPolicy adds to the bloom filter.
+YB_DEFINE_ENUM(DocDbFilterGranularity,
+  // Hashed components of the DocKey.
+  (kHashedComponents)
+
+  // Whole DocKey including range components. Hashed components are also added, so lookups by them
+  // still could use the filter.
+  (kDocKey)
+
+  // DocKey with the first subkey, or DocKey followed by the hybrid time marker for records of the
+  // document itself. Hashed components and whole DocKeys are also added.
+  (kFirstSubkey)
+);
+
+// This filter policy only takes into account the prefix of keys for filtering that is determined by
+// granularity. Lookups should use the finest prefix that all keys they read start with, so they
+// should not use more than hashed components for range scans within them.
 class DocDbAwareFilterPolicy : public rocksdb::FilterPolicy {
  public:
-  explicit DocDbAwareFilterPolicy(size_t filter_block_size_bits, rocksdb::Logger* logger) {
+  DocDbAwareFilterPolicy(
+      size_t filter_block_size_bits, rocksdb::Logger* logger,
+      DocDbFilterGranularity granularity = DocDbFilterGranularity::kHashedComponents)
+      : granularity_(granularity) {
     builtin_policy_.reset(rocksdb::NewFixedSizeFilterPolicy(
         filter_block_size_bits, rocksdb::FilterPolicy::kDefaultFixedSizeFilterErrorRate, logger));
   }
 
-  const char* Name() const override { return "DocKeyHashedComponentsFilter"; }
+  // The name is stored in SST files, so filters of files written with another granularity are not
+  // used.
+  const char* Name() const override;
 
   void CreateFilter(const rocksdb::Slice* keys, int n, std::string* dst) const override;
 
@@ -550,6 +572,7 @@ class DocDbAwareFilterPolicy : public rocksdb::FilterPolicy {
   const KeyTransformer* GetKeyTransformer() const override;
 
  private:
+  const DocDbFilterGranularity granularity_;
   std::unique_ptr<const rocksdb::FilterPolicy> builtin_policy_;
 };
 
@@ -35,6 +35,7 @@
 DECLARE_uint64(rocksdb_max_file_size_for_compaction);
 DECLARE_int32(rocksdb_level0_slowdown_writes_trigger);
 DECLARE_int32(rocksdb_level0_stop_writes_trigger);
+DECLARE_bool(ql_batch_aggregate);
 
 using namespace std::literals; // NOLINT
 
@@ -490,6 +491,123 @@ int32_t NewInt(std::mt19937_64* rng, std::unordered_set<int32_t>* existing) {
   }
 }
 
+class DocOperationAggregateTest : public DocOperationTest {
+ protected:
+  static constexpr int64_t kTtlMs = 1000000;
+
+  // Inserts rows with random values into columns c1, c2 and c3.
+  void InsertRows(const Schema& schema, int32_t num_rows) {
+    std::mt19937_64 rng;
+    Seed(&rng);
+    std::uniform_int_distribution<int32_t> distribution;
+    for (int32_t k = 0; k != num_rows; ++k) {
+      const vector<int32_t> row = {k, distribution(rng), distribution(rng), distribution(rng)};
+      WriteQLRow(QLWriteRequestPB_QLStmtType_QL_STMT_INSERT, schema, row, kTtlMs,
+                 HybridClock::HybridTimeFromMicrosecondsAndLogicalValue(1000, 0));
+      rows_.push_back(row);
+    }
+  }
+
+  void AddAggregate(bfql::TSOpcode opcode, int32_t column_id, DataType result_type,
+                    QLReadRequestPB* request) {
+    QLBCallPB* tscall = request->add_selected_exprs()->mutable_tscall();
+    tscall->set_opcode(static_cast<int32_t>(opcode));
+    if (column_id >= 0) {
+      tscall->add_operands()->set_column_id(column_id);
+    } else {
+      tscall->add_operands()->mutable_value()->set_int64_value(1);
+    }
+    QLRSColDescPB* rscol_desc = request->mutable_rsrow_desc()->add_rscol_descs();
+    rscol_desc->set_name(Format("aggregate_$0", request->selected_exprs_size()));
+    QLType::Create(result_type)->ToQLTypePB(rscol_desc->mutable_ql_type());
+  }
+
+  // Computes COUNT(*), COUNT(c1), SUM(c1), MIN(c2) and MAX(c3) over the whole table.
+  QLRowBlock ReadAggregates(const Schema& schema, MonoDelta* elapsed) {
+    QLReadRequestPB request;
+    request.set_is_aggregate(true);
+    for (int32_t i = 0; i <= 3; i++) {
+      request.mutable_column_refs()->add_ids(i);
+    }
+    AddAggregate(bfql::TSOpcode::kCount, -1, INT64, &request);
+    AddAggregate(bfql::TSOpcode::kCount, 1, INT64, &request);
+    AddAggregate(bfql::TSOpcode::kSum, 1, INT32, &request);
+    AddAggregate(bfql::TSOpcode::kMin, 2, INT32, &request);
+    AddAggregate(bfql::TSOpcode::kMax, 3, INT32, &request);
+
+    QLReadOperation read_op(request, kNonTransactionalOperationContext);
+    QLRocksDBStorage ql_storage(doc_db());
+    const QLRSRowDesc rsrow_desc(request.rsrow_desc());
+    faststring rows_data;
+    QLResultSet resultset(&rsrow_desc, &rows_data);
+    HybridTime read_restart_ht;
+    const auto start = MonoTime::Now();
+    EXPECT_OK(read_op.Execute(
+        ql_storage, MonoTime::Max() /* deadline */,
+        ReadHybridTime::SingleTime(HybridClock::HybridTimeFromMicrosecondsAndLogicalValue(2000, 0)),
+        schema, schema, &resultset, &read_restart_ht));
+    *elapsed = MonoTime::Now() - start;
+
+    const vector<ColumnSchema> result_columns = {
+        ColumnSchema("count", INT64), ColumnSchema("count_c1", INT64),
+        ColumnSchema("sum_c1", INT32), ColumnSchema("min_c2", INT32),
+        ColumnSchema("max_c3", INT32) };
+    QLRowBlock row_block(Schema(result_columns, 0));
+    Slice data(rows_data.data(), rows_data.size());
+    EXPECT_OK(row_block.Deserialize(YQL_CLIENT_CQL, &data));
+    return row_block;
+  }
+
+  void CheckAggregates(QLRowBlock* row_block) {
+    uint32_t sum = 0;
+    int32_t min = std::numeric_limits<int32_t>::max();
+    int32_t max = std::numeric_limits<int32_t>::min();
+    for (const auto& row : rows_) {
+      sum += static_cast<uint32_t>(row[1]);
+      min = std::min(min, row[2]);
+      max = std::max(max, row[3]);
+    }
+    ASSERT_EQ(1, row_block->row_count());
+    const QLRow& row = row_block->row(0);
+    ASSERT_EQ(rows_.size(), static_cast<size_t>(row.column(0).int64_value()));
+    ASSERT_EQ(rows_.size(), static_cast<size_t>(row.column(1).int64_value()));
+    ASSERT_EQ(static_cast<int32_t>(sum), row.column(2).int32_value());
+    ASSERT_EQ(min, row.column(3).int32_value());
+    ASSERT_EQ(max, row.column(4).int32_value());
+  }
+
+  // Reads the aggregates with and without batch aggregation and returns rows per second of each.
+  void TestAggregates(double* batch_rows_per_sec, double* generic_rows_per_sec) {
+    for (bool batch : {true, false}) {
+      FLAGS_ql_batch_aggregate = batch;
+      MonoDelta elapsed;
+      QLRowBlock row_block = ReadAggregates(schema_, &elapsed);
+      ASSERT_NO_FATALS(CheckAggregates(&row_block));
+      *(batch ? batch_rows_per_sec : generic_rows_per_sec) =
+          rows_.size() / std::max(elapsed.ToSeconds(), 1e-6);
+    }
+  }
+
+  Schema schema_ = CreateSchema();
+  vector<vector<int32_t>> rows_;
+};
+
+TEST_F_EX(DocOperationTest, QLBatchAggregate, DocOperationAggregateTest) {
+  // Span several batches, including a partial one.
+  InsertRows(schema_, DocQLBatchAggregator::kBatchSize * 2 + 10);
+  double batch_rows_per_sec, generic_rows_per_sec;
+  ASSERT_NO_FATALS(TestAggregates(&batch_rows_per_sec, &generic_rows_per_sec));
+}
+
+TEST_F_EX(DocOperationTest, BenchmarkQLBatchAggregate, DocOperationAggregateTest) {
+  InsertRows(schema_, AllowSlowTests() ? 200000 : 10000);
+  ASSERT_OK(FlushRocksDbAndWait());
+  double batch_rows_per_sec, generic_rows_per_sec;
+  ASSERT_NO_FATALS(TestAggregates(&batch_rows_per_sec, &generic_rows_per_sec));
+  LOG(INFO) << "Aggregated rows per second, batch: " << batch_rows_per_sec
+            << ", generic: " << generic_rows_per_sec;
+}
+
 int32_t NewInt(std::mt19937_64* rng, std::unordered_set<int32_t>* existing,
     const int32_t min, const int32_t max) {
   std::uniform_int_distribution<int32_t> distribution(min, max);
@@ -49,6 +49,12 @@ DEFINE_bool(emulate_redis_responses,
     "and HDEL. If emulate_redis_responses is true, we read the required records to compute the "
     "response as specified by the official Redis API documentation. https://redis.io/commands");
 
+DEFINE_bool(ql_batch_aggregate, true,
+            "Evaluate COUNT, SUM, MIN and MAX over numeric columns in QL reads by reducing batches "
+            "of column values instead of evaluating every row through the expression executor.");
+TAG_FLAG(ql_batch_aggregate, advanced);
+TAG_FLAG(ql_batch_aggregate, runtime);
+
 DEFINE_test_flag(bool, pause_write_apply_after_if, false,
                  "Pause application of QLWriteOperation after evaluating if condition.");
 
@@ -1327,11 +1333,20 @@ Status RedisWriteOperation::ApplyRemove(const DocOperationApplyData& data) {
 }
 
 Status RedisReadOperation::Execute() {
-  SubDocKey doc_key(
-      DocKey::FromRedisKey(request_.key_value().hash_code(), request_.key_value().key()));
+  auto filter_key = DocKey::EncodedFromRedisKey(
+      request_.key_value().hash_code(), request_.key_value().key());
+  // HGET only reads the field and records of the hash itself, so the field could be checked
+  // against bloom filters that contain subkeys.
+  if (request_.request_case() == RedisReadRequestPB::RequestCase::kGetRequest &&
+      request_.get_request().request_type() == RedisGetRequestPB_GetRequestType_HGET &&
+      request_.key_value().subkey().size() == 1) {
+    PrimitiveValue subkey;
+    RETURN_NOT_OK(PrimitiveValueFromSubKey(request_.key_value().subkey(0), &subkey));
+    subkey.AppendToKey(&filter_key);
+  }
   auto iter = yb::docdb::CreateIntentAwareIterator(
       doc_db_, BloomFilterMode::USE_BLOOM_FILTER,
-      doc_key.Encode().AsSlice(),
+      filter_key.AsSlice(),
       redis_query_id(), /* txn_op_context */ boost::none, deadline_, read_time_);
   iterator_ = std::move(iter);
 
@@ -1777,34 +1792,30 @@ Status RedisReadOperation::ExecuteGet() {
       response_.set_allocated_array_response(new RedisArrayPB());
       const auto& req_kv = request_.key_value();
       size_t num_subkeys = req_kv.subkey_size();
-      vector<int> indices(num_subkeys);
+      auto encoded_doc_key = DocKey::EncodedFromRedisKey(req_kv.hash_code(), req_kv.key());
+
+      // Look up all the fields at once, so that the iterator makes a single forward pass over the
+      // hash instead of seeking separately for every field.
+      std::vector<KeyBytes> encoded_subkeys(num_subkeys, encoded_doc_key);
+      std::vector<SubDocument> values(num_subkeys);
+      std::unique_ptr<bool[]> values_found(new bool[num_subkeys]);
+      std::vector<GetSubDocumentData> batch;
+      batch.reserve(num_subkeys);
       for (int i = 0; i < num_subkeys; ++i) {
-        indices[i] = i;
+        PrimitiveValue subkey_primitive;
+        RETURN_NOT_OK(PrimitiveValueFromSubKey(req_kv.subkey(i), &subkey_primitive));
+        subkey_primitive.AppendToKey(&encoded_subkeys[i]);
+        batch.emplace_back(encoded_subkeys[i], &values[i], &values_found[i]);
       }
-      std::sort(indices.begin(), indices.end(), [&req_kv](int i, int j) {
-            return req_kv.subkey(i).string_subkey() < req_kv.subkey(j).string_subkey();
-          });
+      RETURN_NOT_OK(GetSubDocuments(iterator_.get(), batch));
 
-      string current_value = "";
       response_.mutable_array_response()->mutable_elements()->Reserve(num_subkeys);
       for (int i = 0; i < num_subkeys; ++i) {
-        response_.mutable_array_response()->add_elements();
-      }
-      for (int i = 0; i < num_subkeys; ++i) {
-        if (i == 0 ||
-            req_kv.subkey(indices[i]).string_subkey() !=
-            req_kv.subkey(indices[i - 1]).string_subkey()) {
-          // If the condition above is false, we encountered the same key again, no need to call
-          // GetValue() once more, current_value is already correct.
-          auto value = GetValue(indices[i]);
-          RETURN_NOT_OK(value);
-          if (value->type == REDIS_TYPE_STRING) {
-            current_value = std::move(value->value);
-          } else {
-            current_value = ""; // Empty string is nil response.
-          }
+        if (values_found[i] && values[i].IsString()) {
+          response_.mutable_array_response()->add_elements(values[i].GetString());
+        } else {
+          response_.mutable_array_response()->add_elements(); // Empty string is nil response.
         }
-        *response_.mutable_array_response()->mutable_elements(indices[i]) = current_value;
       }
 
       response_.set_code(RedisResponsePB_RedisStatusCode_OK);
@@ -2860,6 +2871,10 @@ Status QLReadOperation::Execute(const common::YQLStorageIf& ql_storage,
   const bool read_static_columns = !static_projection.columns().empty();
   const bool read_distinct_columns = request_.distinct();
 
+  if (request_.is_aggregate() && FLAGS_ql_batch_aggregate) {
+    batch_aggregator_ = DocQLBatchAggregator::Create(request_, schema);
+  }
+
   std::unique_ptr<common::YQLRowwiseIteratorIf> iter;
   std::unique_ptr<common::QLScanSpec> spec, static_row_spec;
   ReadHybridTime req_read_time;
@@ -3002,6 +3017,10 @@ CHECKED_STATUS QLReadOperation::PopulateResultSet(const QLTableRow& table_row,
 }
 
 CHECKED_STATUS QLReadOperation::EvalAggregate(const QLTableRow& table_row) {
+  if (batch_aggregator_) {
+    return batch_aggregator_->AddRow(table_row);
+  }
+
   if (aggr_result_.empty()) {
     int column_count = request_.selected_exprs().size();
     aggr_result_.resize(column_count);
@@ -3017,6 +3036,9 @@ CHECKED_STATUS QLReadOperation::EvalAggregate(const QLTableRow& table_row) {
 
 CHECKED_STATUS QLReadOperation::PopulateAggregate(const QLTableRow& table_row,
                                                   QLResultSet *resultset) {
+  if (batch_aggregator_) {
+    RETURN_NOT_OK(batch_aggregator_->Finish(&aggr_result_));
+  }
   resultset->AllocateRow();
   int column_count = request_.selected_exprs().size();
   for (int rscol_index = 0; rscol_index < column_count; rscol_index++) {
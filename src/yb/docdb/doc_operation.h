@@ -36,6 +36,7 @@
 #include "yb/docdb/primitive_value.h"
 #include "yb/docdb/value.h"
 #include "yb/docdb/doc_expr.h"
+#include "yb/docdb/doc_ql_aggregate.h"
 #include "yb/docdb/intent_aware_iterator.h"
 
 #include "yb/server/hybrid_clock.h"
@@ -393,6 +394,8 @@ class QLReadOperation : public DocExprExecutor {
   const QLReadRequestPB& request_;
   const TransactionOperationContextOpt txn_op_context_;
   QLResponsePB response_;
+  // Set when the aggregates of the request are evaluated in batches.
+  std::unique_ptr<DocQLBatchAggregator> batch_aggregator_;
 };
 
 //--------------------------------------------------------------------------------------------------
@@ -0,0 +1,348 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/docdb/doc_ql_aggregate.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "yb/gutil/macros.h"
+#include "yb/util/logging.h"
+
+namespace yb {
+namespace docdb {
+
+using bfql::TSOpcode;
+
+namespace {
+
+bool IsIntegerType(DataType type) {
+  return type == INT8 || type == INT16 || type == INT32 || type == INT64;
+}
+
+bool IsFloatingPointType(DataType type) {
+  return type == FLOAT || type == DOUBLE;
+}
+
+// The integer reductions below are plain loops over contiguous arrays without data dependent
+// branches, so that they are auto-vectorized.
+
+uint64_t SumInts(const std::vector<int64_t>& values) {
+  uint64_t sum = 0;
+  for (const int64_t value : values) {
+    sum += static_cast<uint64_t>(value);
+  }
+  return sum;
+}
+
+int64_t MinInt(const std::vector<int64_t>& values, int64_t result) {
+  for (const int64_t value : values) {
+    result = std::min(result, value);
+  }
+  return result;
+}
+
+int64_t MaxInt(const std::vector<int64_t>& values, int64_t result) {
+  for (const int64_t value : values) {
+    result = std::max(result, value);
+  }
+  return result;
+}
+
+// Floating point sums are accumulated sequentially in the precision of the column type, so that
+// the result does not depend on how rows are batched.
+template <class Float>
+Float SumFloats(const std::vector<double>& values, size_t begin, Float sum) {
+  for (size_t i = begin; i < values.size(); ++i) {
+    sum += static_cast<Float>(values[i]);
+  }
+  return sum;
+}
+
+// Same order as QLValue::CompareTo(): NaN is greater than any other value.
+bool FloatLess(double lhs, double rhs) {
+  return !std::isnan(lhs) && (std::isnan(rhs) || lhs < rhs);
+}
+
+double MinFloat(const std::vector<double>& values, size_t begin, double result) {
+  for (size_t i = begin; i < values.size(); ++i) {
+    if (FloatLess(values[i], result)) {
+      result = values[i];
+    }
+  }
+  return result;
+}
+
+double MaxFloat(const std::vector<double>& values, size_t begin, double result) {
+  for (size_t i = begin; i < values.size(); ++i) {
+    if (FloatLess(result, values[i])) {
+      result = values[i];
+    }
+  }
+  return result;
+}
+
+Result<int64_t> IntValue(const QLValuePB& value, DataType type) {
+  switch (type) {
+    case INT8:
+      if (value.value_case() == QLValuePB::kInt8Value) return value.int8_value();
+      break;
+    case INT16:
+      if (value.value_case() == QLValuePB::kInt16Value) return value.int16_value();
+      break;
+    case INT32:
+      if (value.value_case() == QLValuePB::kInt32Value) return value.int32_value();
+      break;
+    case INT64:
+      if (value.value_case() == QLValuePB::kInt64Value) return value.int64_value();
+      break;
+    default:
+      break;
+  }
+  return STATUS_FORMAT(Corruption, "Unexpected value $0 for column of type $1",
+                       value.ShortDebugString(), DataType_Name(type));
+}
+
+Result<double> FloatValue(const QLValuePB& value, DataType type) {
+  switch (type) {
+    case FLOAT:
+      if (value.value_case() == QLValuePB::kFloatValue) return value.float_value();
+      break;
+    case DOUBLE:
+      if (value.value_case() == QLValuePB::kDoubleValue) return value.double_value();
+      break;
+    default:
+      break;
+  }
+  return STATUS_FORMAT(Corruption, "Unexpected value $0 for column of type $1",
+                       value.ShortDebugString(), DataType_Name(type));
+}
+
+void SetIntValue(DataType type, int64_t value, QLValue* result) {
+  switch (type) {
+    case INT8: result->set_int8_value(static_cast<int8_t>(value)); return;
+    case INT16: result->set_int16_value(static_cast<int16_t>(value)); return;
+    case INT32: result->set_int32_value(static_cast<int32_t>(value)); return;
+    case INT64: result->set_int64_value(value); return;
+    default: break;
+  }
+  LOG(FATAL) << "Unexpected integer type " << DataType_Name(type);
+}
+
+void SetFloatValue(DataType type, double value, QLValue* result) {
+  if (type == FLOAT) {
+    result->set_float_value(static_cast<float>(value));
+  } else {
+    result->set_double_value(value);
+  }
+}
+
+} // namespace
+
+std::unique_ptr<DocQLBatchAggregator> DocQLBatchAggregator::Create(
+    const QLReadRequestPB& request, const Schema& schema) {
+  std::unique_ptr<DocQLBatchAggregator> aggregator(new DocQLBatchAggregator());
+  for (const QLExpressionPB& expr : request.selected_exprs()) {
+    if (!expr.has_tscall()) {
+      return nullptr;
+    }
+    const QLBCallPB& tscall = expr.tscall();
+    Aggregate aggregate;
+    aggregate.opcode = static_cast<TSOpcode>(tscall.opcode());
+    aggregate.buffer_index = kNoBuffer;
+
+    DataType type = UNKNOWN_DATA;
+    const bool column_operand =
+        tscall.operands_size() == 1 && tscall.operands(0).has_column_id() &&
+        tscall.operands(0).column_id() >= 0;
+    if (column_operand) {
+      auto column = schema.column_by_id(ColumnId(tscall.operands(0).column_id()));
+      if (!column.ok()) {
+        return nullptr;
+      }
+      type = column->type()->main();
+    }
+
+    switch (aggregate.opcode) {
+      case TSOpcode::kCount:
+        // COUNT(*) counts rows, COUNT(column) counts non-null values of any type.
+        if (column_operand) {
+          aggregate.buffer_index =
+              aggregator->BufferIndex(tscall.operands(0).column_id(), type);
+        }
+        break;
+      case TSOpcode::kSum: FALLTHROUGH_INTENDED;
+      case TSOpcode::kMin: FALLTHROUGH_INTENDED;
+      case TSOpcode::kMax:
+        if (!column_operand || !(IsIntegerType(type) || IsFloatingPointType(type))) {
+          return nullptr;
+        }
+        aggregate.buffer_index = aggregator->BufferIndex(tscall.operands(0).column_id(), type);
+        break;
+      default:
+        return nullptr;
+    }
+    aggregator->aggregates_.push_back(aggregate);
+  }
+  return aggregator;
+}
+
+size_t DocQLBatchAggregator::BufferIndex(ColumnIdRep column_id, DataType type) {
+  for (size_t i = 0; i != buffers_.size(); ++i) {
+    if (buffers_[i].column_id == column_id) {
+      return i;
+    }
+  }
+  ColumnBuffer buffer;
+  buffer.column_id = column_id;
+  buffer.type = type;
+  if (IsIntegerType(type)) {
+    buffer.int_values.reserve(kBatchSize);
+  } else if (IsFloatingPointType(type)) {
+    buffer.float_values.reserve(kBatchSize);
+  }
+  buffers_.push_back(std::move(buffer));
+  return buffers_.size() - 1;
+}
+
+Status DocQLBatchAggregator::AddRow(const QLTableRow& row) {
+  for (ColumnBuffer& buffer : buffers_) {
+    auto value = row.GetValue(buffer.column_id);
+    if (!value || value->value_case() == QLValuePB::VALUE_NOT_SET) {
+      continue;
+    }
+    if (IsIntegerType(buffer.type)) {
+      buffer.int_values.push_back(VERIFY_RESULT(IntValue(*value, buffer.type)));
+    } else if (IsFloatingPointType(buffer.type)) {
+      buffer.float_values.push_back(VERIFY_RESULT(FloatValue(*value, buffer.type)));
+    } else {
+      ++buffer.num_other_values;
+    }
+  }
+  if (++num_buffered_rows_ == kBatchSize) {
+    return Flush();
+  }
+  return Status::OK();
+}
+
+Status DocQLBatchAggregator::Flush() {
+  for (Aggregate& aggregate : aggregates_) {
+    if (aggregate.buffer_index == kNoBuffer) {
+      aggregate.count += num_buffered_rows_;
+      continue;
+    }
+    const ColumnBuffer& buffer = buffers_[aggregate.buffer_index];
+    const size_t num_values =
+        buffer.int_values.size() + buffer.float_values.size() + buffer.num_other_values;
+    if (num_values == 0) {
+      continue;
+    }
+    aggregate.count += num_values;
+    if (aggregate.opcode == TSOpcode::kCount) {
+      continue;
+    }
+
+    if (IsIntegerType(buffer.type)) {
+      const auto& values = buffer.int_values;
+      if (!aggregate.has_value) {
+        aggregate.int_extreme = values.front();
+      }
+      switch (aggregate.opcode) {
+        case TSOpcode::kSum:
+          aggregate.int_sum += SumInts(values);
+          break;
+        case TSOpcode::kMin:
+          aggregate.int_extreme = MinInt(values, aggregate.int_extreme);
+          break;
+        case TSOpcode::kMax:
+          aggregate.int_extreme = MaxInt(values, aggregate.int_extreme);
+          break;
+        default:
+          return STATUS_FORMAT(IllegalState, "Unexpected aggregate opcode $0",
+                               static_cast<int>(aggregate.opcode));
+      }
+    } else {
+      const auto& values = buffer.float_values;
+      // The first value initializes the accumulator, so that e.g. the sum of a single -0.0 is -0.0.
+      size_t begin = 0;
+      if (!aggregate.has_value) {
+        aggregate.double_value = values.front();
+        aggregate.float_sum = static_cast<float>(values.front());
+        begin = 1;
+      }
+      switch (aggregate.opcode) {
+        case TSOpcode::kSum:
+          if (buffer.type == FLOAT) {
+            aggregate.float_sum = SumFloats(values, begin, aggregate.float_sum);
+          } else {
+            aggregate.double_value = SumFloats(values, begin, aggregate.double_value);
+          }
+          break;
+        case TSOpcode::kMin:
+          aggregate.double_value = MinFloat(values, begin, aggregate.double_value);
+          break;
+        case TSOpcode::kMax:
+          aggregate.double_value = MaxFloat(values, begin, aggregate.double_value);
+          break;
+        default:
+          return STATUS_FORMAT(IllegalState, "Unexpected aggregate opcode $0",
+                               static_cast<int>(aggregate.opcode));
+      }
+    }
+    aggregate.has_value = true;
+  }
+
+  for (ColumnBuffer& buffer : buffers_) {
+    buffer.int_values.clear();
+    buffer.float_values.clear();
+    buffer.num_other_values = 0;
+  }
+  num_buffered_rows_ = 0;
+  return Status::OK();
+}
+
+Status DocQLBatchAggregator::Finish(std::vector<QLValue>* results) {
+  RETURN_NOT_OK(Flush());
+
+  results->clear();
+  results->resize(aggregates_.size());
+  for (size_t i = 0; i != aggregates_.size(); ++i) {
+    const Aggregate& aggregate = aggregates_[i];
+    QLValue* result = &(*results)[i];
+    // Like DocExprExecutor, aggregates over no values are NULL.
+    if (aggregate.opcode == TSOpcode::kCount) {
+      if (aggregate.count != 0) {
+        result->set_int64_value(aggregate.count);
+      }
+      continue;
+    }
+    if (!aggregate.has_value) {
+      continue;
+    }
+    const DataType type = buffers_[aggregate.buffer_index].type;
+    if (IsIntegerType(type)) {
+      SetIntValue(type,
+                  aggregate.opcode == TSOpcode::kSum ? static_cast<int64_t>(aggregate.int_sum)
+                                                     : aggregate.int_extreme,
+                  result);
+    } else if (aggregate.opcode == TSOpcode::kSum && type == FLOAT) {
+      result->set_float_value(aggregate.float_sum);
+    } else {
+      SetFloatValue(type, aggregate.double_value, result);
+    }
+  }
+  return Status::OK();
+}
+
+} // namespace docdb
+} // namespace yb
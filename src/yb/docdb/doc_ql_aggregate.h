@@ -0,0 +1,104 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#ifndef YB_DOCDB_DOC_QL_AGGREGATE_H
+#define YB_DOCDB_DOC_QL_AGGREGATE_H
+
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "yb/common/ql_expr.h"
+#include "yb/common/ql_protocol.pb.h"
+#include "yb/common/ql_value.h"
+#include "yb/common/schema.h"
+
+#include "yb/util/bfql/tserver_opcodes.h"
+#include "yb/util/status.h"
+
+namespace yb {
+namespace docdb {
+
+// Batched evaluation of the aggregate functions of a QL read request.
+//
+// Instead of folding every row into boxed QLValue accumulators through DocExprExecutor, the values
+// of the aggregated columns are copied out of each row into typed column buffers, and once a
+// buffer is full it is reduced by tight loops over plain arrays that the compiler can vectorize.
+// Only COUNT, SUM, MIN and MAX over plain columns of integer and floating point types are
+// supported; requests with any other selected expression use the generic per-row path. Results
+// are identical to the ones DocExprExecutor produces for the same rows.
+class DocQLBatchAggregator {
+ public:
+  // Number of rows buffered before reducing them.
+  static constexpr size_t kBatchSize = 1024;
+
+  // Returns a batch aggregator for the request, or nullptr if some selected expression is not
+  // supported by it.
+  static std::unique_ptr<DocQLBatchAggregator> Create(
+      const QLReadRequestPB& request, const Schema& schema);
+
+  // Adds the next matching row.
+  CHECKED_STATUS AddRow(const QLTableRow& row);
+
+  // Reduces the buffered rows and returns the aggregate value of every selected expression.
+  CHECKED_STATUS Finish(std::vector<QLValue>* results);
+
+ private:
+  // Non-null values of one column seen since the last flush. Integers of all widths are widened to
+  // int64_t and floats to double, which is lossless.
+  struct ColumnBuffer {
+    ColumnIdRep column_id;
+    DataType type;
+    std::vector<int64_t> int_values;
+    std::vector<double> float_values;
+    // Number of non-null values of other types, which can only be counted.
+    size_t num_other_values = 0;
+  };
+
+  struct Aggregate {
+    bfql::TSOpcode opcode;
+    // Buffer of the aggregated column, or kNoBuffer for COUNT(*).
+    size_t buffer_index;
+    // Whether some non-null value was aggregated.
+    bool has_value = false;
+    int64_t count = 0;
+    // SUM of integers is computed modulo 2^64 and truncated to the column type in the end, which
+    // matches the wrapping per-row sums of DocExprExecutor.
+    uint64_t int_sum = 0;
+    // MIN or MAX of integers.
+    int64_t int_extreme = 0;
+    // SUM of doubles, or MIN or MAX of floats and doubles.
+    double double_value = 0;
+    // SUM of floats, accumulated in single precision like DocExprExecutor does.
+    float float_sum = 0;
+  };
+
+  static constexpr size_t kNoBuffer = std::numeric_limits<size_t>::max();
+
+  DocQLBatchAggregator() = default;
+
+  // Returns the index of the buffer of the given column, allocating it if needed.
+  size_t BufferIndex(ColumnIdRep column_id, DataType type);
+
+  CHECKED_STATUS Flush();
+
+  std::vector<ColumnBuffer> buffers_;
+  std::vector<Aggregate> aggregates_;
+  // Rows added since the last flush.
+  size_t num_buffered_rows_ = 0;
+};
+
+} // namespace docdb
+} // namespace yb
+
+#endif // YB_DOCDB_DOC_QL_AGGREGATE_H
@@ -36,6 +36,53 @@ using yb::FormatRocksDBSliceAsStr;
 namespace yb {
 namespace docdb {
 
+namespace {
+
+// Whether the scan bounds select a single row. The scan specs make the upper bound inclusive by
+// appending kHighest to it, so this is the case when all range components of the lower bound are
+// specified and the upper bound is the lower bound followed by kHighest.
+bool IsSingleRowScan(const DocKey& lower_doc_key, const DocKey& upper_doc_key,
+                     const Schema& schema) {
+  const auto& lower_range = lower_doc_key.range_group();
+  const auto& upper_range = upper_doc_key.range_group();
+  if (lower_range.size() != schema.num_range_key_columns() ||
+      upper_range.size() != lower_range.size() + 1 ||
+      upper_range.back().value_type() != ValueType::kHighest ||
+      !upper_doc_key.HashedComponentsEqual(lower_doc_key)) {
+    return false;
+  }
+  for (size_t i = 0; i != lower_range.size(); ++i) {
+    const auto value_type = lower_range[i].value_type();
+    if (value_type == ValueType::kLowest || value_type == ValueType::kHighest ||
+        lower_range[i] != upper_range[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Returns the key to check bloom filters against for a scan within the same hashed components.
+// Bloom filters could contain whole DocKeys, but the lower bound is not present in the DB unless
+// the scan is a point lookup of a single row, so only the hashed components are used otherwise.
+// Returns an empty key when there are no hashed components to filter by.
+KeyBytes BloomFilterKey(const DocKey& lower_doc_key, const DocKey& upper_doc_key,
+                        const Schema& schema) {
+  KeyBytes result = lower_doc_key.Encode();
+  if (IsSingleRowScan(lower_doc_key, upper_doc_key, schema)) {
+    return result;
+  }
+  auto hashed_size = DocKey::EncodedSize(result.AsSlice(), DocKeyPart::HASHED_PART_ONLY);
+  if (!hashed_size.ok()) {
+    LOG(DFATAL) << "Failed to decode hashed components of " << lower_doc_key << ": "
+                << hashed_size.status();
+    return KeyBytes();
+  }
+  result.Truncate(*hashed_size);
+  return result;
+}
+
+} // namespace
+
 DocRowwiseIterator::DocRowwiseIterator(
     const Schema &projection,
     const Schema &schema,
@@ -69,7 +116,8 @@ Status DocRowwiseIterator::Init() {
 
   db_iter_ = CreateIntentAwareIterator(
       doc_db_, BloomFilterMode::DONT_USE_BLOOM_FILTER,
-      boost::none /* user_key_for_filter */, query_id, txn_op_context_, deadline_, read_time_);
+      boost::none /* user_key_for_filter */, query_id, txn_op_context_, deadline_, read_time_,
+      nullptr /* file_filter */, nullptr /* iterate_upper_bound */, SequentialScan::kTrue);
 
   row_key_ = DocKey(schema_);
   db_iter_->Seek(row_key_);
@@ -94,15 +142,15 @@ Status DocRowwiseIterator::Init(const common::QLScanSpec& spec) {
   // TODO(bogdan): decide if this is a good enough heuristic for using blooms for scans.
   const bool is_fixed_point_get = !lower_doc_key.empty() &&
       upper_doc_key.HashedComponentsEqual(lower_doc_key);
-  const auto mode = is_fixed_point_get ? BloomFilterMode::USE_BLOOM_FILTER :
+  const KeyBytes filter_key = is_fixed_point_get ?
+      BloomFilterKey(lower_doc_key, upper_doc_key, schema_) : KeyBytes();
+  const auto mode = filter_key.size() != 0 ? BloomFilterMode::USE_BLOOM_FILTER :
       BloomFilterMode::DONT_USE_BLOOM_FILTER;
 
-  const KeyBytes row_key_encoded = lower_doc_key.Encode();
-  const Slice row_key_encoded_as_slice = row_key_encoded.AsSlice();
-
   db_iter_ = CreateIntentAwareIterator(
-      doc_db_, mode, row_key_encoded_as_slice, doc_spec.QueryId(), txn_op_context_,
-      deadline_, read_time_, doc_spec.CreateFileFilter());
+      doc_db_, mode, filter_key.AsSlice(), doc_spec.QueryId(), txn_op_context_,
+      deadline_, read_time_, doc_spec.CreateFileFilter(), nullptr /* iterate_upper_bound */,
+      SequentialScan(!is_fixed_point_get));
 
   row_ready_ = false;
 
@@ -171,15 +219,15 @@ Status DocRowwiseIterator::Init(const common::PgsqlScanSpec& spec) {
   // TODO(bogdan): decide if this is a good enough heuristic for using blooms for scans.
   const bool is_fixed_point_get = !lower_doc_key.empty() &&
       upper_doc_key.HashedComponentsEqual(lower_doc_key);
-  const auto mode = is_fixed_point_get ? BloomFilterMode::USE_BLOOM_FILTER :
+  const KeyBytes filter_key = is_fixed_point_get ?
+      BloomFilterKey(lower_doc_key, upper_doc_key, schema_) : KeyBytes();
+  const auto mode = filter_key.size() != 0 ? BloomFilterMode::USE_BLOOM_FILTER :
       BloomFilterMode::DONT_USE_BLOOM_FILTER;
 
-  const KeyBytes row_key_encoded = lower_doc_key.Encode();
-  const Slice row_key_encoded_as_slice = row_key_encoded.AsSlice();
-
   db_iter_ = CreateIntentAwareIterator(
-      doc_db_, mode, row_key_encoded_as_slice, doc_spec.QueryId(), txn_op_context_,
-      deadline_, read_time_, doc_spec.CreateFileFilter());
+      doc_db_, mode, filter_key.AsSlice(), doc_spec.QueryId(), txn_op_context_,
+      deadline_, read_time_, doc_spec.CreateFileFilter(), nullptr /* iterate_upper_bound */,
+      SequentialScan(!is_fixed_point_get));
 
   row_ready_ = false;
 
@@ -214,7 +262,10 @@ Status DocRowwiseIterator::EnsureIteratorPositionCorrect() const {
     // Seek to the current target doc key if needed.
     if (current_scan_target_ != row_key_ && !FinishedScanTargetsList()) {
       if (is_forward_scan_) {
-        db_iter_->Seek(current_scan_target_);
+        // Scan targets are visited in increasing order and the iterator is never positioned past
+        // the current one, so seeking forward avoids re-seeking the underlying iterators.
+        KeyBytes target = current_scan_target_.Encode();
+        db_iter_->SeekForward(&target);
       } else {
         DocKey tmp = current_scan_target_;
         tmp.AddRangeComponent(PrimitiveValue(ValueType::kHighest));
@@ -23,6 +23,7 @@
 #include "yb/common/hybrid_time.h"
 #include "yb/docdb/docdb-internal.h"
 #include "yb/docdb/docdb_compaction_filter.h"
+#include "yb/docdb/docdb_rocksdb_util.h"
 #include "yb/docdb/docdb_test_base.h"
 #include "yb/docdb/docdb_test_util.h"
 #include "yb/docdb/in_mem_docdb.h"
@@ -694,6 +695,61 @@ TEST_F(DocDBTest, GetSubDocumentTest) {
 
 }
 
+TEST_F(DocDBTest, GetSubDocumentsTest) {
+  const DocKey doc_key1(PrimitiveValues("mydockey", 123456));
+  const DocKey doc_key2(PrimitiveValues("mydockey", 654321));
+  const DocKey missing_doc_key(PrimitiveValues("mydockey", 999999));
+  SetupRocksDBState(doc_key1.Encode());
+  SetupRocksDBState(doc_key2.Encode());
+
+  // Unsorted, with a duplicate, nested and missing keys. Keys of doc_key2 are all direct children
+  // of the document, so they are read as a projection.
+  const std::vector<SubDocKey> keys = {
+      SubDocKey(doc_key2, PrimitiveValue("u")),
+      SubDocKey(doc_key1, PrimitiveValue("b")),
+      SubDocKey(missing_doc_key, PrimitiveValue("a")),
+      SubDocKey(doc_key1, PrimitiveValue("a")),
+      SubDocKey(doc_key2, PrimitiveValue("a")),
+      SubDocKey(doc_key1, PrimitiveValue("b"), PrimitiveValue("e")),
+      SubDocKey(doc_key2, PrimitiveValue("missing")),
+      SubDocKey(doc_key1, PrimitiveValue("a")),
+  };
+
+  for (auto ht : {500_usec_ht, 2500_usec_ht, 5500_usec_ht}) {
+    SCOPED_TRACE(Format("Read time: $0", ht));
+    std::vector<KeyBytes> encoded_keys;
+    for (const auto& key : keys) {
+      encoded_keys.push_back(key.EncodeWithoutHt());
+    }
+    std::vector<SubDocument> docs(keys.size());
+    std::unique_ptr<bool[]> docs_found(new bool[keys.size()]);
+    std::vector<GetSubDocumentData> batch;
+    for (size_t i = 0; i != keys.size(); ++i) {
+      batch.emplace_back(encoded_keys[i], &docs[i], &docs_found[i]);
+    }
+    auto iter = CreateIntentAwareIterator(
+        doc_db(), BloomFilterMode::DONT_USE_BLOOM_FILTER, boost::none, rocksdb::kDefaultQueryId,
+        kNonTransactionalOperationContext, MonoTime::Max() /* deadline */,
+        ReadHybridTime::SingleTime(ht));
+    ASSERT_OK(GetSubDocuments(iter.get(), batch));
+
+    // Every entry should match an independent lookup.
+    for (size_t i = 0; i != keys.size(); ++i) {
+      SCOPED_TRACE(keys[i].ToString());
+      SubDocument expected_doc;
+      bool expected_found = false;
+      GetSubDocumentData data = { encoded_keys[i], &expected_doc, &expected_found };
+      ASSERT_OK(GetSubDocument(
+          doc_db(), data, rocksdb::kDefaultQueryId, kNonTransactionalOperationContext,
+          MonoTime::Max() /* deadline */, ReadHybridTime::SingleTime(ht)));
+      ASSERT_EQ(expected_found, docs_found[i]);
+      if (expected_found) {
+        ASSERT_EQ(expected_doc.ToString(), docs[i].ToString());
+      }
+    }
+  }
+}
+
 TEST_F(DocDBTest, ListInsertAndGetTest) {
   SubDocument parent;
   SubDocument list({PrimitiveValue(10), PrimitiveValue(2)});
@@ -31,6 +31,7 @@
 #include "yb/docdb/docdb_util.h"
 #include "yb/docdb/intent.h"
 #include "yb/docdb/intent_aware_iterator.h"
+#include "yb/docdb/intent_index.h"
 #include "yb/docdb/shared_lock_manager.h"
 #include "yb/docdb/subdocument.h"
 #include "yb/docdb/value.h"
@@ -292,12 +293,14 @@ class PrepareTransactionWriteBatchHelper {
                                      rocksdb::WriteBatch* rocksdb_write_batch,
                                      const TransactionId& transaction_id,
                                      IsolationLevel isolation_level,
-                                     IntraTxnWriteId* intra_txn_write_id)
+                                     IntraTxnWriteId* intra_txn_write_id,
+                                     IntentIndex* intent_index)
       : hybrid_time_(hybrid_time),
         rocksdb_write_batch_(rocksdb_write_batch),
         transaction_id_(transaction_id),
         intent_types_(GetWriteIntentsForIsolationLevel(isolation_level)),
-        intra_txn_write_id_(intra_txn_write_id) {
+        intra_txn_write_id_(intra_txn_write_id),
+        intent_index_(intent_index) {
   }
 
   // Using operator() to pass this object conveniently to EnumerateIntents.
@@ -330,6 +333,9 @@ class PrepareTransactionWriteBatchHelper {
         doc_ht_buffer.EncodeWithValueType(hybrid_time_, write_id_++),
     }};
     AddIntent(transaction_id_, key_parts, value, rocksdb_write_batch_);
+    if (intent_index_) {
+      intent_index_->Add(transaction_id_, key->AsSlice(), intent_types_.strong);
+    }
 
     return Status::OK();
   }
@@ -353,6 +359,9 @@ class PrepareTransactionWriteBatchHelper {
       }};
 
       AddIntent(transaction_id_, key, value, rocksdb_write_batch_);
+      if (intent_index_) {
+        intent_index_->Add(transaction_id_, intent, intent_types_.weak);
+      }
     }
   }
 
@@ -366,6 +375,7 @@ class PrepareTransactionWriteBatchHelper {
   std::unordered_set<std::string> weak_intents_;
   IntraTxnWriteId write_id_ = 0;
   IntraTxnWriteId* intra_txn_write_id_;
+  IntentIndex* intent_index_;
 };
 
 // We have the following distinct types of data in this "intent store":
@@ -384,11 +394,12 @@ void PrepareTransactionWriteBatch(
     rocksdb::WriteBatch* rocksdb_write_batch,
     const TransactionId& transaction_id,
     IsolationLevel isolation_level,
-    IntraTxnWriteId* write_id) {
+    IntraTxnWriteId* write_id,
+    IntentIndex* intent_index) {
   VLOG(4) << "PrepareTransactionWriteBatch(), write_id = " << *write_id;
 
   PrepareTransactionWriteBatchHelper helper(
-      hybrid_time, rocksdb_write_batch, transaction_id, isolation_level, write_id);
+      hybrid_time, rocksdb_write_batch, transaction_id, isolation_level, write_id, intent_index);
 
   // We cannot recover from failures here, because it means that we cannot apply replicated
   // operation.
@@ -841,6 +852,106 @@ yb::Status GetSubDocument(
   return Status::OK();
 }
 
+namespace {
+
+// Returns true if data is a plain point lookup of a direct child of its document, i.e. it could be
+// served as part of a projection over that document.
+Result<bool> IsPlainChildLookup(const GetSubDocumentData& data, size_t dockey_size) {
+  if (data.return_type_only || data.count_only || data.limit != 0 ||
+      data.low_subkey->is_valid() || data.high_subkey->is_valid() ||
+      data.low_index != &IndexBound::Empty() || data.high_index != &IndexBound::Empty()) {
+    return false;
+  }
+  Slice subkeys(data.subdocument_key.data() + dockey_size,
+                data.subdocument_key.size() - dockey_size);
+  // Exactly one subkey after the document key.
+  return VERIFY_RESULT(SubDocKey::DecodeSubkey(&subkeys)) && subkeys.empty();
+}
+
+} // namespace
+
+yb::Status GetSubDocuments(
+    IntentAwareIterator *db_iter,
+    const std::vector<GetSubDocumentData>& batch) {
+  std::vector<size_t> order(batch.size());
+  for (size_t i = 0; i != order.size(); ++i) {
+    order[i] = i;
+  }
+  std::sort(order.begin(), order.end(), [&batch](size_t lhs, size_t rhs) {
+    return batch[lhs].subdocument_key.compare(batch[rhs].subdocument_key) < 0;
+  });
+
+  // The iterator is not positioned before the first lookup, so it requires a regular seek.
+  auto seek_fwd_suffices = SeekFwdSuffices::kFalse;
+  size_t run_begin = 0;
+  while (run_begin != order.size()) {
+    const GetSubDocumentData& first = batch[order[run_begin]];
+    const auto dockey_size =
+        VERIFY_RESULT(DocKey::EncodedSize(first.subdocument_key, DocKeyPart::WHOLE_DOC_KEY));
+    const Slice doc_key(first.subdocument_key.data(), dockey_size);
+
+    // Find the run of keys that belong to the same document, and check whether all of them could
+    // be read as a single projection over that document.
+    bool use_projection = VERIFY_RESULT(IsPlainChildLookup(first, dockey_size));
+    size_t run_end = run_begin + 1;
+    for (; run_end != order.size(); ++run_end) {
+      const GetSubDocumentData& data = batch[order[run_end]];
+      if (!data.subdocument_key.starts_with(doc_key)) {
+        break;
+      }
+      use_projection = use_projection && data.exp.ttl == first.exp.ttl &&
+                       VERIFY_RESULT(IsPlainChildLookup(data, dockey_size));
+    }
+    use_projection = use_projection && run_end - run_begin > 1;
+
+    if (use_projection) {
+      std::vector<PrimitiveValue> projection;
+      projection.reserve(run_end - run_begin);
+      for (size_t i = run_begin; i != run_end; ++i) {
+        Slice subkey(batch[order[i]].subdocument_key);
+        subkey.remove_prefix(dockey_size);
+        PrimitiveValue subkey_value;
+        RETURN_NOT_OK(SubDocKey::DecodeSubkey(&subkey, &subkey_value));
+        // Keys are sorted, so duplicates are adjacent.
+        if (projection.empty() || projection.back() != subkey_value) {
+          projection.push_back(std::move(subkey_value));
+        }
+      }
+
+      SubDocument doc;
+      bool doc_found = false;
+      GetSubDocumentData doc_data(doc_key, &doc, &doc_found, first.exp.ttl);
+      RETURN_NOT_OK(GetSubDocument(db_iter, doc_data, &projection, seek_fwd_suffices));
+
+      size_t projection_idx = 0;
+      for (size_t i = run_begin; i != run_end; ++i) {
+        const GetSubDocumentData& data = batch[order[i]];
+        if (i != run_begin &&
+            data.subdocument_key != batch[order[i - 1]].subdocument_key) {
+          ++projection_idx;
+        }
+        const SubDocument* child = doc.GetChild(projection[projection_idx]);
+        const bool found = child != nullptr && child->value_type() != ValueType::kInvalid;
+        *data.result = found ? *child : SubDocument(ValueType::kInvalid);
+        *data.doc_found = found;
+        data.exp = doc_data.exp;
+      }
+    } else {
+      for (size_t i = run_begin; i != run_end; ++i) {
+        // Ancestors of keys in this document may already be behind the iterator after the first
+        // lookup, so only the first key of the document could be reached by seeking forward.
+        RETURN_NOT_OK(GetSubDocument(
+            db_iter, batch[order[i]], /* projection */ nullptr,
+            i == run_begin ? seek_fwd_suffices : SeekFwdSuffices::kFalse));
+      }
+    }
+
+    seek_fwd_suffices = SeekFwdSuffices::kTrue;
+    run_begin = run_end;
+  }
+  return Status::OK();
+}
+
 // Note: Do not use if also retrieving other value, as some work will be repeated.
 // Assumes every value has a TTL, and the TTL is stored in the row with this key.
 // Also observe that tombstone checking only works because we assume the key has
@@ -1104,8 +1215,13 @@ CHECKED_STATUS IntentToWriteRequest(
   return Status::OK();
 }
 
-Status PrepareApplyIntentsBatch(
+std::string ApplyTransactionState::ToString() const {
+  return Format("{ key: $0 write_id: $1 }", Slice(key).ToDebugString(), write_id);
+}
+
+Result<ApplyTransactionState> PrepareApplyIntentsBatch(
     const TransactionId &transaction_id, HybridTime commit_ht,
+    const ApplyTransactionState* apply_state, size_t max_records,
     rocksdb::WriteBatch *regular_batch,
     rocksdb::DB *intents_db, rocksdb::WriteBatch *intents_batch) {
   Slice reverse_index_upperbound;
@@ -1129,11 +1245,15 @@ Status PrepareApplyIntentsBatch(
   txn_reverse_index_upperbound.AppendValueType(ValueType::kMaxByte);
   reverse_index_upperbound = txn_reverse_index_upperbound.AsSlice();
 
-  reverse_index_iter->Seek(txn_reverse_index_prefix.data());
-
-  DocHybridTimeBuffer doc_ht_buffer;
-
   IntraTxnWriteId write_id = 0;
+  if (apply_state && apply_state->active()) {
+    reverse_index_iter->Seek(apply_state->key);
+    write_id = apply_state->write_id;
+  } else {
+    reverse_index_iter->Seek(txn_reverse_index_prefix.data());
+  }
+
+  size_t num_records = 0;
   while (reverse_index_iter->Valid()) {
     rocksdb::Slice key_slice(reverse_index_iter->key());
 
@@ -1141,6 +1261,11 @@ Status PrepareApplyIntentsBatch(
       break;
     }
 
+    if (num_records == max_records) {
+      return ApplyTransactionState{key_slice.ToBuffer(), write_id};
+    }
+    ++num_records;
+
     VLOG(4) << "Apply reverse index record: "
             << EntryToString(*reverse_index_iter, StorageDbType::kIntents);
 
@@ -1154,15 +1279,19 @@ Status PrepareApplyIntentsBatch(
             regular_batch, &write_id));
       }
 
-      intents_batch->Delete(reverse_index_iter->value());
+      if (intents_batch) {
+        intents_batch->Delete(reverse_index_iter->value());
+      }
     }
 
-    intents_batch->Delete(reverse_index_iter->key());
+    if (intents_batch) {
+      intents_batch->Delete(reverse_index_iter->key());
+    }
 
     reverse_index_iter->Next();
   }
 
-  return Status::OK();
+  return ApplyTransactionState();
 }
 
 }  // namespace docdb
@@ -39,6 +39,7 @@
 #include "yb/docdb/value.h"
 #include "yb/docdb/subdocument.h"
 
+#include "yb/util/result.h"
 #include "yb/util/status.h"
 #include "yb/util/strongly_typed_bool.h"
 
@@ -81,6 +82,8 @@ class Histogram;
 
 namespace docdb {
 
+class IntentIndex;
+
 // This function prepares the transaction by taking locks. The set of keys locked are returned to
 // the caller via the keys_locked argument (because they need to be saved and unlocked when the
 // transaction commits). A flag is also returned to indicate if any of the write operations
@@ -148,16 +151,41 @@ CHECKED_STATUS EnumerateIntents(
     const google::protobuf::RepeatedPtrField<yb::docdb::KeyValuePairPB> &kv_pairs,
     boost::function<Status(IntentKind, Slice, KeyBytes*)> functor);
 
+// Fills rocksdb_write_batch with intents of put_batch. If intent_index is specified, written intents
+// are also recorded in it.
 void PrepareTransactionWriteBatch(
     const docdb::KeyValueWriteBatchPB& put_batch,
     HybridTime hybrid_time,
     rocksdb::WriteBatch* rocksdb_write_batch,
     const TransactionId& transaction_id,
     IsolationLevel isolation_level,
-    IntraTxnWriteId* write_id);
+    IntraTxnWriteId* write_id,
+    IntentIndex* intent_index = nullptr);
+
+// Position of partially applied transaction, used to apply intents of a big transaction in
+// several write batches.
+struct ApplyTransactionState {
+  // Reverse index key to continue from. Empty when there is nothing left to apply.
+  std::string key;
+
+  // Write id of the next strong intent.
+  IntraTxnWriteId write_id = 0;
+
+  bool active() const {
+    return !key.empty();
+  }
 
-CHECKED_STATUS PrepareApplyIntentsBatch(
+  std::string ToString() const;
+};
+
+// Converts intents of committed transaction into regular records in regular_batch and deletes
+// them in intents_batch. Any of the batches could be null, so intents could be applied and removed
+// in separate passes.
+// Processes at most max_records reverse index records starting from apply_state, that could be
+// null to start from the beginning. Returns the state to continue from.
+Result<ApplyTransactionState> PrepareApplyIntentsBatch(
     const TransactionId& transaction_id, HybridTime commit_ht,
+    const ApplyTransactionState* apply_state, size_t max_records,
     rocksdb::WriteBatch* regular_batch,
     rocksdb::DB* intents_db, rocksdb::WriteBatch* intents_batch);
 
@@ -420,6 +448,17 @@ yb::Status GetSubDocument(
     const std::vector<PrimitiveValue>* projection = nullptr,
     SeekFwdSuffices seek_fwd_suffices = SeekFwdSuffices::kTrue);
 
+// Batched version of GetSubDocument for point lookups of many keys using a single iterator.
+// Lookups are performed in key order, so the underlying regular and intents iterators only move
+// forward between documents instead of re-seeking for every key, and transaction statuses
+// resolved for one key are reused for the rest through the iterator's TransactionStatusCache.
+// Several keys addressing direct children of the same document are read in a single pass as a
+// projection of that document; for those entries exp is the expiration of the document itself.
+// The iterator does not have to be positioned, and is left positioned after the last key.
+yb::Status GetSubDocuments(
+    IntentAwareIterator *db_iter,
+    const std::vector<GetSubDocumentData>& batch);
+
 // This version of GetSubDocument creates a new iterator every time. This is not recommended for
 // multiple calls to subdocs that are sequential or near each other, in e.g. doc_rowwise_iterator.
 // low_subkey and high_subkey are optional ranges that we can specify for the subkeys to ensure
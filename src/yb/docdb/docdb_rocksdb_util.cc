@@ -13,6 +13,7 @@
 
 #include "yb/docdb/docdb_rocksdb_util.h"
 
+#include <algorithm>
 #include <thread>
 #include <memory>
 
@@ -25,6 +26,8 @@
 #include "yb/rocksutil/yb_rocksdb.h"
 #include "yb/rocksutil/yb_rocksdb_logger.h"
 #include "yb/server/hybrid_clock.h"
+#include "yb/util/flag_tags.h"
+#include "yb/util/priority_thread_pool.h"
 #include "yb/util/size_literals.h"
 #include "yb/util/trace.h"
 
@@ -50,11 +53,37 @@ DEFINE_int32(rocksdb_universal_compaction_size_ratio, 20,
 DEFINE_int32(rocksdb_universal_compaction_min_merge_width, 4,
              "The minimum number of files in a single compaction run.");
 DEFINE_int64(rocksdb_compact_flush_rate_limit_bytes_per_sec, 100 * 1024 * 1024,
-             "Use to control write rate of flush and compaction.");
+             "Use to control write rate of flush and compaction of each RocksDB instance. Not used "
+             "when rocksdb_compact_flush_node_rate_limit_bytes_per_sec is set.");
+DEFINE_int64(rocksdb_compact_flush_node_rate_limit_bytes_per_sec, 0,
+             "Write rate limit of flushes and compactions shared by all RocksDB instances of the "
+             "server. 0 to limit every instance separately with "
+             "rocksdb_compact_flush_rate_limit_bytes_per_sec.");
 DEFINE_uint64(rocksdb_compaction_size_threshold_bytes, 2ULL * 1024 * 1024 * 1024,
              "Threshold beyond which compaction is considered large.");
 DEFINE_uint64(rocksdb_max_file_size_for_compaction, 0,
              "Maximal allowed file size to participate in RocksDB compaction. 0 - unlimited.");
+DEFINE_int32(rocksdb_priority_thread_pool_size, -1,
+             "Number of threads of the pool that runs flushes and compactions of all tablets of "
+             "the server, ordered by how close each tablet is to a write stall. -1 to pick it "
+             "based on the number of CPUs, 0 to let every tablet schedule its own flushes and "
+             "compactions.");
+DEFINE_int32(rocksdb_priority_thread_pool_urgent_threads, 1,
+             "Number of threads of the flush and compaction pool that are reserved for flushes "
+             "and compactions of tablets whose writes are being delayed.");
+DEFINE_int32(rocksdb_leveled_compaction_num_levels, 7,
+             "Number of levels of RocksDB instances of tables that use leveled compaction.");
+DEFINE_bool(rocksdb_leveled_compaction_dynamic_level_bytes, true,
+            "Whether level target sizes of tables that use leveled compaction are derived from "
+            "the size of the last level, which bounds space amplification.");
+DEFINE_uint64(rocksdb_leveled_compaction_level_base_bytes, 256_MB,
+              "Target size of the first level below level 0 for tables that use leveled "
+              "compaction.");
+DEFINE_int32(rocksdb_leveled_compaction_level_multiplier, 10,
+             "Ratio between target sizes of consecutive levels for tables that use leveled "
+             "compaction.");
+DEFINE_uint64(rocksdb_leveled_compaction_target_file_size_bytes, 64_MB,
+              "Target size of files produced by leveled compaction.");
 
 DEFINE_int64(db_block_size_bytes, 32_KB,
              "Size of RocksDB data block (in bytes).");
@@ -73,10 +102,25 @@ DEFINE_int64(db_write_buffer_size, -1,
 
 DEFINE_bool(use_docdb_aware_bloom_filter, true,
             "Whether to use the DocDbAwareFilterPolicy for both bloom storage and seeks.");
+DEFINE_bool(docdb_bloom_filter_include_doc_key, false,
+            "Whether DocDB bloom filters contain whole DocKeys including range components in "
+            "addition to hashed components, so that lookups of absent rows within a partition "
+            "could skip files. Filters of files written with another setting are not used.");
+TAG_FLAG(docdb_bloom_filter_include_doc_key, advanced);
+DEFINE_bool(docdb_bloom_filter_include_first_subkey, false,
+            "Whether DocDB bloom filters also contain DocKeys with the first subkey, e.g. a Redis "
+            "hash field. Requires docdb_bloom_filter_include_doc_key.");
+TAG_FLAG(docdb_bloom_filter_include_first_subkey, advanced);
 DEFINE_int32(max_nexts_to_avoid_seek, 1,
              "The number of next calls to try before doing resorting to do a rocksdb seek.");
 DEFINE_bool(trace_docdb_calls, false, "Whether we should trace calls into the docdb.");
 DEFINE_bool(use_multi_level_index, true, "Whether to use multi-level data index.");
+DEFINE_bool(docdb_scan_bypass_block_cache, false,
+            "Whether data blocks read by scans that are not limited to a single hash key are not "
+            "added to the block cache, so that such scans do not evict frequently used blocks.");
+DEFINE_uint64(docdb_scan_readahead_size_bytes, 256_KB,
+              "Number of bytes of SST files read ahead by scans that are not limited to a single "
+              "hash key, once they move to the next data block. 0 disables readahead.");
 
 DEFINE_uint64(initial_seqno, 1ULL << 50, "Initial seqno for new RocksDB instances.");
 
@@ -319,20 +363,71 @@ void PerformRocksDBReverseSeek(
 
 namespace {
 
+DocDbFilterGranularity BloomFilterGranularity() {
+  if (!FLAGS_docdb_bloom_filter_include_doc_key) {
+    return DocDbFilterGranularity::kHashedComponents;
+  }
+  return FLAGS_docdb_bloom_filter_include_first_subkey ? DocDbFilterGranularity::kFirstSubkey
+                                                       : DocDbFilterGranularity::kDocKey;
+}
+
+// Takes an SST file into account if any of the filters does.
+class AnyOfTableAwareReadFileFilter : public rocksdb::TableAwareReadFileFilter {
+ public:
+  AnyOfTableAwareReadFileFilter(
+      std::shared_ptr<rocksdb::TableAwareReadFileFilter> first,
+      std::shared_ptr<rocksdb::TableAwareReadFileFilter> second)
+      : first_(std::move(first)), second_(std::move(second)) {}
+
+  bool Filter(rocksdb::TableReader* reader) const override {
+    return first_->Filter(reader) || second_->Filter(reader);
+  }
+
+ private:
+  std::shared_ptr<rocksdb::TableAwareReadFileFilter> first_;
+  std::shared_ptr<rocksdb::TableAwareReadFileFilter> second_;
+};
+
+std::shared_ptr<rocksdb::TableAwareReadFileFilter> NewBloomFilterAwareFileFilter(
+    rocksdb::DB* rocksdb, const rocksdb::ReadOptions& read_opts, const Slice& user_key) {
+  const auto& table_factory = rocksdb->GetOptions().table_factory;
+  auto result = table_factory->NewTableAwareReadFileFilter(read_opts, user_key);
+  if (BloomFilterGranularity() != DocDbFilterGranularity::kFirstSubkey || !result) {
+    return result;
+  }
+  auto doc_key_size = DocKey::EncodedSize(user_key, DocKeyPart::WHOLE_DOC_KEY);
+  if (!doc_key_size.ok() || user_key.size() == *doc_key_size ||
+      user_key[*doc_key_size] == ValueTypeAsChar::kHybridTime) {
+    return result;
+  }
+  // The filter key contains the first subkey, but records of the document itself, e.g. its
+  // tombstone, could be stored in other files and should be read as well.
+  KeyBytes document_record_key(
+      Slice(user_key.data(), *doc_key_size), ValueTypeAsChar::kHybridTime);
+  return std::make_shared<AnyOfTableAwareReadFileFilter>(
+      std::move(result),
+      table_factory->NewTableAwareReadFileFilter(read_opts, document_record_key.AsSlice()));
+}
+
 rocksdb::ReadOptions PrepareReadOptions(
     rocksdb::DB* rocksdb,
     BloomFilterMode bloom_filter_mode,
     const boost::optional<const Slice>& user_key_for_filter,
     const rocksdb::QueryId query_id,
     std::shared_ptr<rocksdb::ReadFileFilter> file_filter,
-    const Slice* iterate_upper_bound) {
+    const Slice* iterate_upper_bound,
+    SequentialScan sequential_scan) {
   rocksdb::ReadOptions read_opts;
   read_opts.query_id = query_id;
+  if (sequential_scan) {
+    read_opts.fill_cache = !FLAGS_docdb_scan_bypass_block_cache;
+    read_opts.readahead_size = FLAGS_docdb_scan_readahead_size_bytes;
+  }
   if (FLAGS_use_docdb_aware_bloom_filter &&
     bloom_filter_mode == BloomFilterMode::USE_BLOOM_FILTER) {
     DCHECK(user_key_for_filter);
-    read_opts.table_aware_file_filter = rocksdb->GetOptions().table_factory->
-        NewTableAwareReadFileFilter(read_opts, user_key_for_filter.get());
+    read_opts.table_aware_file_filter = NewBloomFilterAwareFileFilter(
+        rocksdb, read_opts, user_key_for_filter.get());
   }
   read_opts.file_filter = std::move(file_filter);
   read_opts.iterate_upper_bound = iterate_upper_bound;
@@ -349,7 +444,8 @@ unique_ptr<rocksdb::Iterator> CreateRocksDBIterator(
     std::shared_ptr<rocksdb::ReadFileFilter> file_filter,
     const Slice* iterate_upper_bound) {
   rocksdb::ReadOptions read_opts = PrepareReadOptions(rocksdb, bloom_filter_mode,
-      user_key_for_filter, query_id, std::move(file_filter), iterate_upper_bound);
+      user_key_for_filter, query_id, std::move(file_filter), iterate_upper_bound,
+      SequentialScan::kFalse);
   return unique_ptr<rocksdb::Iterator>(rocksdb->NewIterator(read_opts));
 }
 
@@ -362,10 +458,12 @@ unique_ptr<IntentAwareIterator> CreateIntentAwareIterator(
     MonoTime deadline,
     const ReadHybridTime& read_time,
     std::shared_ptr<rocksdb::ReadFileFilter> file_filter,
-    const Slice* iterate_upper_bound) {
+    const Slice* iterate_upper_bound,
+    SequentialScan sequential_scan) {
   // TODO(dtxn) do we need separate options for intents db?
   rocksdb::ReadOptions read_opts = PrepareReadOptions(doc_db.regular, bloom_filter_mode,
-      user_key_for_filter, query_id, std::move(file_filter), iterate_upper_bound);
+      user_key_for_filter, query_id, std::move(file_filter), iterate_upper_bound,
+      sequential_scan);
   return std::make_unique<IntentAwareIterator>(
       doc_db, read_opts, deadline, read_time, txn_op_context);
 }
@@ -396,6 +494,7 @@ void InitRocksDBOptions(
     table_options.block_cache = tablet_options.block_cache;
     // Cache the bloom filters in the block cache.
     table_options.cache_index_and_filter_blocks = true;
+    table_options.pinned_blocks_budget = tablet_options.pinned_blocks_budget;
   } else {
     table_options.no_block_cache = true;
     table_options.cache_index_and_filter_blocks = false;
@@ -408,7 +507,7 @@ void InitRocksDBOptions(
   // Set our custom bloom filter that is docdb aware.
   if (FLAGS_use_docdb_aware_bloom_filter) {
     table_options.filter_policy.reset(new DocDbAwareFilterPolicy(
-        table_options.filter_block_size * 8, options->info_log.get()));
+        table_options.filter_block_size * 8, options->info_log.get(), BloomFilterGranularity()));
   }
 
   if (FLAGS_use_multi_level_index) {
@@ -462,11 +561,13 @@ void InitRocksDBOptions(
     options->compaction_options_universal.min_merge_width =
         FLAGS_rocksdb_universal_compaction_min_merge_width;
     options->compaction_size_threshold_bytes = FLAGS_rocksdb_compaction_size_threshold_bytes;
-    if (FLAGS_rocksdb_compact_flush_rate_limit_bytes_per_sec > 0) {
-      options->rate_limiter.reset(
-          rocksdb::NewGenericRateLimiter(FLAGS_rocksdb_compact_flush_rate_limit_bytes_per_sec));
+    if (tablet_options.rate_limiter) {
+      options->rate_limiter = tablet_options.rate_limiter;
+    } else {
+      options->rate_limiter = CreateRocksDBRateLimiter();
     }
   }
+  options->priority_thread_pool_for_compactions_and_flushes = tablet_options.priority_thread_pool;
 
   uint64_t max_file_size_for_compaction = FLAGS_rocksdb_max_file_size_for_compaction;
   if (max_file_size_for_compaction != 0) {
@@ -474,5 +575,69 @@ void InitRocksDBOptions(
   }
 }
 
+namespace {
+
+std::shared_ptr<rocksdb::RateLimiter> CreateRateLimiter(int64_t bytes_per_sec) {
+  if (bytes_per_sec <= 0) {
+    return nullptr;
+  }
+  return std::shared_ptr<rocksdb::RateLimiter>(rocksdb::NewGenericRateLimiter(bytes_per_sec));
+}
+
+} // namespace
+
+std::shared_ptr<rocksdb::RateLimiter> CreateRocksDBRateLimiter() {
+  return CreateRateLimiter(FLAGS_rocksdb_compact_flush_rate_limit_bytes_per_sec);
+}
+
+std::shared_ptr<rocksdb::RateLimiter> CreateRocksDBNodeRateLimiter() {
+  return CreateRateLimiter(FLAGS_rocksdb_compact_flush_node_rate_limit_bytes_per_sec);
+}
+
+std::shared_ptr<PriorityThreadPool> CreateRocksDBPriorityThreadPool() {
+  int num_threads = FLAGS_rocksdb_priority_thread_pool_size;
+  if (num_threads == 0) {
+    return nullptr;
+  }
+  if (num_threads < 0) {
+    num_threads = std::max<int>(2, std::thread::hardware_concurrency() / 2);
+  }
+  const int urgent_threads = std::max(
+      0, std::min(FLAGS_rocksdb_priority_thread_pool_urgent_threads, num_threads - 1));
+  LOG(INFO) << "Flush and compaction pool threads: " << num_threads
+            << ", reserved for urgent tasks: " << urgent_threads;
+  return std::make_shared<PriorityThreadPool>(
+      "rocksdb-bg", num_threads, urgent_threads, rocksdb::kUrgentTaskPriority);
+}
+
+void SetRocksDBCompactionStyle(
+    rocksdb::Options* options, const TableProperties& table_properties) {
+  if (table_properties.compaction_style() != TableCompactionStyle::LEVELED_COMPACTION) {
+    return;
+  }
+
+  // The level layout is applied even when compactions are disabled, so that an existing leveled
+  // DB, which has files below level 0, still opens. The compaction style stays
+  // kCompactionStyleNone in that case, and RocksDB ignores level_compaction_dynamic_level_bytes.
+  if (!FLAGS_rocksdb_disable_compactions) {
+    options->compaction_style = rocksdb::CompactionStyle::kCompactionStyleLevel;
+  }
+  options->num_levels = FLAGS_rocksdb_leveled_compaction_num_levels;
+  options->level_compaction_dynamic_level_bytes =
+      FLAGS_rocksdb_leveled_compaction_dynamic_level_bytes;
+  options->max_bytes_for_level_base = FLAGS_rocksdb_leveled_compaction_level_base_bytes;
+  options->max_bytes_for_level_multiplier = FLAGS_rocksdb_leveled_compaction_level_multiplier;
+  options->target_file_size_base = FLAGS_rocksdb_leveled_compaction_target_file_size_bytes;
+
+  // Entries overwritten below the history cutoff are only dropped when the overwriting entry is
+  // compacted together with them, and TTL expiration only turns values into tombstones outside of
+  // full compactions. For tables with a default TTL, compacting the files with the oldest data
+  // first moves expired data to the bottom where it meets the rest of its history. Otherwise, pick
+  // the files that overlap the next level the least, which minimizes write amplification.
+  options->compaction_pri = table_properties.HasDefaultTimeToLive()
+      ? rocksdb::CompactionPri::kOldestLargestSeqFirst
+      : rocksdb::CompactionPri::kMinOverlappingRatio;
+}
+
 }  // namespace docdb
 }  // namespace yb
@@ -17,6 +17,7 @@
 #include <boost/optional.hpp>
 
 #include "yb/common/read_hybrid_time.h"
+#include "yb/common/schema.h"
 #include "yb/common/transaction.h"
 
 #include "yb/docdb/doc_key.h"
@@ -29,8 +30,12 @@
 #include "yb/tablet/tablet_options.h"
 
 #include "yb/util/slice.h"
+#include "yb/util/strongly_typed_bool.h"
 
 namespace yb {
+
+class PriorityThreadPool;
+
 namespace docdb {
 
 class IntentAwareIterator;
@@ -102,6 +107,11 @@ enum class BloomFilterMode {
   DONT_USE_BLOOM_FILTER,
 };
 
+// Whether an iterator is expected to read through many data blocks, like a scan that is not
+// limited to a single hash key. Data blocks read by such iterators are not admitted into the block
+// cache, and the following data blocks are read ahead.
+YB_STRONGLY_TYPED_BOOL(SequentialScan);
+
 // It is only allowed to use bloom filters on scans within the same hashed components of the key,
 // because BloomFilterAwareIterator relies on it and ignores SST file completely if there are no
 // keys with the same hashed components as key specified for seek operation.
@@ -127,7 +137,8 @@ std::unique_ptr<IntentAwareIterator> CreateIntentAwareIterator(
     MonoTime deadline,
     const ReadHybridTime& read_time,
     std::shared_ptr<rocksdb::ReadFileFilter> file_filter = nullptr,
-    const Slice* iterate_upper_bound = nullptr);
+    const Slice* iterate_upper_bound = nullptr,
+    SequentialScan sequential_scan = SequentialScan::kFalse);
 
 // Initialize the RocksDB 'options' object for tablet identified by 'tablet_id'. The 'statistics'
 // object provided by the caller will be used by RocksDB to maintain the stats for the tablet
@@ -137,6 +148,25 @@ void InitRocksDBOptions(
     const std::shared_ptr<rocksdb::Statistics>& statistics,
     const tablet::TabletOptions& tablet_options);
 
+// Creates the flush and compaction rate limiter of a single RocksDB instance. Returns nullptr if
+// rate limiting is disabled.
+std::shared_ptr<rocksdb::RateLimiter> CreateRocksDBRateLimiter();
+
+// Creates the flush and compaction rate limiter shared by all tablets of the server. Returns
+// nullptr if it is disabled, so every RocksDB instance gets its own rate limiter.
+std::shared_ptr<rocksdb::RateLimiter> CreateRocksDBNodeRateLimiter();
+
+// Creates the pool that runs flushes and compactions of all tablets of the server. Returns nullptr
+// if it is disabled. The caller is responsible for initializing and shutting down the pool.
+std::shared_ptr<PriorityThreadPool> CreateRocksDBPriorityThreadPool();
+
+// Switches 'options' initialized by InitRocksDBOptions from universal to leveled compaction if the
+// table requested it. Only applies to the regular DB, the intents DB always uses universal
+// compaction. The level layout is set even if rocksdb_disable_compactions is on, so that an
+// existing leveled DB opens with its levels.
+void SetRocksDBCompactionStyle(
+    rocksdb::Options* options, const TableProperties& table_properties);
+
 }  // namespace docdb
 }  // namespace yb
 
@@ -16,18 +16,23 @@
 
 #include "yb/common/transaction-test-util.h"
 
+#include "yb/docdb/doc_ql_scanspec.h"
 #include "yb/docdb/doc_rowwise_iterator.h"
 #include "yb/docdb/docdb.h"
 #include "yb/docdb/docdb_test_base.h"
 #include "yb/docdb/docdb_test_util.h"
 #include "yb/docdb/intent.h"
 
+#include "yb/rocksdb/statistics.h"
+
 #include "yb/server/hybrid_clock.h"
 
 #include "yb/util/size_literals.h"
 #include "yb/util/test_macros.h"
 #include "yb/util/test_util.h"
 
+DECLARE_bool(docdb_bloom_filter_include_doc_key);
+
 namespace yb {
 namespace docdb {
 
@@ -1007,5 +1012,64 @@ TEST_F(DocRowwiseIteratorTest, ScanWithinTheSameTxn) {
   ASSERT_FALSE(iter.HasNext());
 }
 
+TEST_F(DocRowwiseIteratorTest, PointGetSkipsFilesWithoutDocKey) {
+  FLAGS_docdb_bloom_filter_include_doc_key = true;
+  ASSERT_OK(ReinitDBOptions());
+
+  const Schema schema({
+          ColumnSchema("h", DataType::INT32, /* is_nullable = */ false, /* is_hash_key = */ true),
+          ColumnSchema("r", DataType::INT32, false),
+          ColumnSchema("v", DataType::INT32, true)
+      }, {
+          10_ColId,
+          20_ColId,
+          30_ColId
+      }, 2);
+  Schema projection;
+  ASSERT_OK(schema.CreateProjectionByNames({"v"}, &projection));
+
+  auto doc_key = [](int32_t range_value) {
+    return DocKey(0 /* hash */, {PrimitiveValue::Int32(1)}, {PrimitiveValue::Int32(range_value)});
+  };
+  // Each file contains a single row, all of them with the same hashed components.
+  for (int32_t r = 1; r <= 2; ++r) {
+    ASSERT_OK(SetPrimitive(
+        DocPath(doc_key(r).Encode(), PrimitiveValue(30_ColId)), PrimitiveValue::Int32(r * 10),
+        HybridTime::FromMicros(1000)));
+    ASSERT_OK(FlushRocksDbAndWait());
+  }
+
+  auto ticker = [this](rocksdb::Tickers ticker) {
+    return options().statistics->getTickerCount(ticker);
+  };
+  auto check_point_get = [&](int32_t r, int expected_value, int expected_table_iterators) {
+    const auto bloom_useful = ticker(rocksdb::BLOOM_FILTER_USEFUL);
+    const auto table_iterators = ticker(rocksdb::NO_TABLE_CACHE_ITERATORS);
+    DocQLScanSpec spec(schema, doc_key(r), rocksdb::kDefaultQueryId);
+    DocRowwiseIterator iter(
+        projection, schema, kNonTransactionalOperationContext, doc_db(),
+        MonoTime::Max() /* deadline */, ReadHybridTime::FromMicros(2000));
+    ASSERT_OK(iter.Init(spec));
+    if (expected_value) {
+      ASSERT_TRUE(iter.HasNext());
+      QLTableRow row;
+      ASSERT_OK(iter.NextRow(&row));
+      QLValue value;
+      ASSERT_OK(row.GetValue(projection.column_id(0), &value));
+      ASSERT_EQ(expected_value, value.int32_value());
+    }
+    ASSERT_FALSE(iter.HasNext());
+    // Both files have the same hashed components, so only DocKey filters could skip them.
+    ASSERT_GT(ticker(rocksdb::BLOOM_FILTER_USEFUL), bloom_useful);
+    ASSERT_EQ(table_iterators + expected_table_iterators,
+              ticker(rocksdb::NO_TABLE_CACHE_ITERATORS));
+  };
+
+  ASSERT_NO_FATALS(check_point_get(1, 10, 1));
+  ASSERT_NO_FATALS(check_point_get(2, 20, 1));
+  // Neither file is read for an absent range key.
+  ASSERT_NO_FATALS(check_point_get(3, 0, 0));
+}
+
 }  // namespace docdb
 }  // namespace yb
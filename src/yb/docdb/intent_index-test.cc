@@ -0,0 +1,139 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/docdb/intent_index.h"
+
+#include "yb/docdb/docdb_test_base.h"
+
+#include "yb/util/mem_tracker.h"
+
+DECLARE_int64(intent_index_memory_limit_bytes);
+
+namespace yb {
+namespace docdb {
+
+namespace {
+
+typedef std::vector<std::pair<TransactionId, IntentType>> IntentsVector;
+
+IntentsVector GetIntents(const IntentIndex& index, Slice doc_path) {
+  IntentsVector result;
+  index.ForEachIntent(doc_path, [&result](const TransactionId& id, IntentType type) {
+    result.emplace_back(id, type);
+  });
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+} // namespace
+
+class IntentIndexTest : public DocDBTestBase {
+};
+
+TEST_F(IntentIndexTest, AddRemove) {
+  auto txn1 = ASSERT_RESULT(FullyDecodeTransactionId("0000000000000001"));
+  auto txn2 = ASSERT_RESULT(FullyDecodeTransactionId("0000000000000002"));
+
+  IntentIndex index;
+  ASSERT_OK(index.Rebuild(intents_db()));
+  index.Add(txn1, "a", IntentType::kStrongSnapshotWrite);
+  index.Add(txn1, "a", IntentType::kStrongSnapshotWrite);
+  index.Add(txn1, "a", IntentType::kWeakSnapshotWrite);
+  index.Add(txn1, "b", IntentType::kStrongSnapshotWrite);
+  index.Add(txn2, "a", IntentType::kWeakSnapshotWrite);
+  ASSERT_EQ(2, index.TEST_size());
+
+  auto expected = IntentsVector{
+      {txn1, IntentType::kStrongSnapshotWrite},
+      {txn1, IntentType::kWeakSnapshotWrite},
+      {txn2, IntentType::kWeakSnapshotWrite}};
+  std::sort(expected.begin(), expected.end());
+  ASSERT_EQ(expected, GetIntents(index, "a"));
+  ASSERT_TRUE(GetIntents(index, "c").empty());
+
+  index.Remove(txn1);
+  ASSERT_EQ(IntentsVector({{txn2, IntentType::kWeakSnapshotWrite}}), GetIntents(index, "a"));
+  ASSERT_TRUE(GetIntents(index, "b").empty());
+  ASSERT_EQ(1, index.TEST_size());
+
+  index.Remove(txn2);
+  ASSERT_EQ(0, index.TEST_size());
+}
+
+TEST_F(IntentIndexTest, Rebuild) {
+  auto txn = ASSERT_RESULT(FullyDecodeTransactionId("0000000000000001"));
+  const DocKey doc_key(PrimitiveValues("mydockey", 123456));
+  KeyBytes encoded_doc_key(doc_key.Encode());
+
+  SetTransactionIsolationLevel(IsolationLevel::SNAPSHOT_ISOLATION);
+  SetCurrentTransactionId(txn);
+  ASSERT_OK(SetPrimitive(
+      DocPath(encoded_doc_key, "subkey1"), PrimitiveValue("value1"), HybridTime::FromMicros(1000)));
+
+  IntentIndex index;
+  ASSERT_FALSE(index.ready());
+  ASSERT_OK(index.Rebuild(intents_db()));
+  ASSERT_TRUE(index.ready());
+
+  ASSERT_EQ(IntentsVector({{txn, IntentType::kWeakSnapshotWrite}}),
+            GetIntents(index, encoded_doc_key.AsSlice()));
+  KeyBytes subkey_path(encoded_doc_key);
+  PrimitiveValue("subkey1").AppendToKey(&subkey_path);
+  ASSERT_EQ(IntentsVector({{txn, IntentType::kStrongSnapshotWrite}}),
+            GetIntents(index, subkey_path.AsSlice()));
+
+  IntentIndex stopped_index;
+  stopped_index.StopRebuild();
+  ASSERT_TRUE(stopped_index.Rebuild(intents_db()).IsAborted());
+  ASSERT_FALSE(stopped_index.ready());
+  ASSERT_EQ(0, stopped_index.TEST_size());
+}
+
+TEST_F(IntentIndexTest, MemoryLimit) {
+  auto txn1 = ASSERT_RESULT(FullyDecodeTransactionId("0000000000000001"));
+  auto txn2 = ASSERT_RESULT(FullyDecodeTransactionId("0000000000000002"));
+  auto mem_tracker = MemTracker::CreateTracker("IntentIndexTest");
+
+  IntentIndex index(mem_tracker);
+  ASSERT_OK(index.Rebuild(intents_db()));
+  index.Add(txn1, "a", IntentType::kStrongSnapshotWrite);
+  index.Add(txn1, "b", IntentType::kStrongSnapshotWrite);
+  const auto two_intents_usage = mem_tracker->consumption();
+  ASSERT_GT(two_intents_usage, 0);
+  index.Remove(txn1);
+  ASSERT_EQ(0, mem_tracker->consumption());
+
+  FLAGS_intent_index_memory_limit_bytes = two_intents_usage;
+  index.Add(txn1, "a", IntentType::kStrongSnapshotWrite);
+  index.Add(txn1, "b", IntentType::kStrongSnapshotWrite);
+  ASSERT_TRUE(index.ready());
+  ASSERT_EQ(two_intents_usage, mem_tracker->consumption());
+
+  // Index is cleared and disabled when its memory limit is exceeded, so intents should be read
+  // from intents DB.
+  index.Add(txn2, "c", IntentType::kStrongSnapshotWrite);
+  ASSERT_TRUE(index.TEST_disabled());
+  ASSERT_FALSE(index.ready());
+  ASSERT_EQ(0, index.TEST_size());
+  ASSERT_EQ(0, mem_tracker->consumption());
+  ASSERT_FALSE(index.ForEachIntent("a", [](const TransactionId&, IntentType) {}));
+
+  // Disabled index ignores new intents and is not enabled by rebuild.
+  index.Add(txn2, "d", IntentType::kStrongSnapshotWrite);
+  ASSERT_EQ(0, index.TEST_size());
+  ASSERT_OK(index.Rebuild(intents_db()));
+  ASSERT_FALSE(index.ready());
+}
+
+}  // namespace docdb
+}  // namespace yb
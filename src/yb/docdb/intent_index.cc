@@ -0,0 +1,274 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/docdb/intent_index.h"
+
+#include <algorithm>
+
+#include "yb/docdb/conflict_resolution.h"
+#include "yb/docdb/docdb_rocksdb_util.h"
+
+#include "yb/util/flag_tags.h"
+#include "yb/util/logging.h"
+#include "yb/util/mem_tracker.h"
+#include "yb/util/size_literals.h"
+
+using namespace yb::size_literals;  // NOLINT.
+
+DEFINE_int64(intent_index_memory_limit_bytes, 64_MB,
+             "Memory limit of in-memory intent index of a tablet. When it is exceeded, the index "
+             "is disabled and conflict resolution reads intents DB until the tablet is reopened.");
+TAG_FLAG(intent_index_memory_limit_bytes, runtime);
+TAG_FLAG(intent_index_memory_limit_bytes, advanced);
+
+namespace yb {
+namespace docdb {
+
+namespace {
+
+// Approximate memory used by a doc path intent of a transaction: map node with doc path and
+// intents, and reference from the transaction.
+int64_t IntentMemoryUsage(size_t doc_path_size) {
+  return doc_path_size + sizeof(std::string) + 4 * sizeof(void*) + 2 * sizeof(TransactionId) +
+         sizeof(const std::string*);
+}
+
+} // namespace
+
+IntentIndex::IntentIndex(std::shared_ptr<MemTracker> mem_tracker)
+    : mem_tracker_(std::move(mem_tracker)) {
+}
+
+IntentIndex::~IntentIndex() {
+  if (mem_tracker_) {
+    mem_tracker_->Release(memory_usage_);
+  }
+}
+
+IntentIndex::Shard& IntentIndex::ShardForDocPath(Slice doc_path) {
+  return shards_[doc_path.hash() % kNumShards];
+}
+
+const IntentIndex::Shard& IntentIndex::ShardForDocPath(Slice doc_path) const {
+  return shards_[doc_path.hash() % kNumShards];
+}
+
+const std::string* IntentIndex::AddToShard(
+    const TransactionId& id, Slice doc_path, IntentType type) {
+  auto& shard = ShardForDocPath(doc_path);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  auto it = shard.intents.find(doc_path, DocPathHash(), DocPathEqual());
+  if (it == shard.intents.end()) {
+    it = shard.intents.emplace(doc_path.ToBuffer(), Intents()).first;
+  }
+  auto& intents = it->second;
+  bool first = true;
+  for (const auto& intent : intents) {
+    if (intent.id == id) {
+      if (intent.type == type) {
+        return nullptr;
+      }
+      first = false;
+    }
+  }
+  intents.push_back(Intent{id, type});
+  return first ? &it->first : nullptr;
+}
+
+void IntentIndex::DoAdd(const TransactionId& id, Slice doc_path, IntentType type) {
+  const auto* stored_doc_path = AddToShard(id, doc_path, type);
+  if (!stored_doc_path) {
+    return;
+  }
+  transactions_[id].push_back(stored_doc_path);
+
+  auto memory_usage = IntentMemoryUsage(doc_path.size());
+  memory_usage_ += memory_usage;
+  if (memory_usage_ > FLAGS_intent_index_memory_limit_bytes) {
+    Disable("memory limit exceeded");
+    return;
+  }
+  if (mem_tracker_ && !mem_tracker_->TryConsume(memory_usage)) {
+    memory_usage_ -= memory_usage;
+    Disable("mem tracker limit exceeded");
+  }
+}
+
+void IntentIndex::Add(const TransactionId& id, Slice doc_path, IntentType type) {
+  std::lock_guard<std::mutex> lock(transactions_mutex_);
+  if (disabled_) {
+    return;
+  }
+  DoAdd(id, doc_path, type);
+}
+
+void IntentIndex::Remove(const TransactionId& id) {
+  std::lock_guard<std::mutex> lock(transactions_mutex_);
+  if (rebuilding_) {
+    removed_during_rebuild_.insert(id);
+  }
+  auto it = transactions_.find(id);
+  if (it == transactions_.end()) {
+    return;
+  }
+
+  int64_t memory_usage = 0;
+  for (const auto* doc_path : it->second) {
+    memory_usage += IntentMemoryUsage(doc_path->size());
+    auto& shard = ShardForDocPath(*doc_path);
+    std::lock_guard<std::mutex> shard_lock(shard.mutex);
+    // The doc path is the key of this entry, so it should not be used after the entry is erased.
+    auto intents_it = shard.intents.find(*doc_path, DocPathHash(), DocPathEqual());
+    if (intents_it == shard.intents.end()) {
+      continue;
+    }
+    auto& intents = intents_it->second;
+    intents.erase(std::remove_if(intents.begin(), intents.end(),
+                                 [&id](const Intent& intent) { return intent.id == id; }),
+                  intents.end());
+    if (intents.empty()) {
+      shard.intents.erase(intents_it);
+    }
+  }
+  transactions_.erase(it);
+
+  memory_usage_ -= memory_usage;
+  if (mem_tracker_) {
+    mem_tracker_->Release(memory_usage);
+  }
+}
+
+void IntentIndex::Disable(const char* reason) {
+  LOG(WARNING) << "Disabling intent index, " << reason << ": " << memory_usage_ << " bytes, "
+               << transactions_.size() << " transactions";
+  disabled_ = true;
+  ready_.store(false, std::memory_order_release);
+  transactions_.clear();
+  for (auto& shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.intents.clear();
+  }
+  if (mem_tracker_) {
+    mem_tracker_->Release(memory_usage_);
+  }
+  memory_usage_ = 0;
+}
+
+Status IntentIndex::Rebuild(rocksdb::DB* intents_db) {
+  {
+    std::lock_guard<std::mutex> lock(transactions_mutex_);
+    if (stop_rebuild_) {
+      return STATUS(Aborted, "Intent index rebuild stopped");
+    }
+    rebuilding_ = true;
+  }
+
+  Status status;
+  auto iter = CreateRocksDBIterator(
+      intents_db, BloomFilterMode::DONT_USE_BLOOM_FILTER, boost::none /* user_key_for_filter */,
+      rocksdb::kDefaultQueryId);
+  iter->SeekToFirst();
+  size_t num_intents = 0;
+  for (; iter->Valid(); iter->Next()) {
+    auto key = iter->key();
+    // Transaction metadata and reverse index records are prefixed with transaction id.
+    if (key.empty() || key[0] == ValueTypeAsChar::kTransactionId) {
+      continue;
+    }
+    auto value = iter->value();
+    if (value.empty() || value[0] != ValueTypeAsChar::kTransactionId) {
+      status = STATUS_FORMAT(Corruption, "Transaction prefix expected in intent: $0 => $1",
+                             key.ToDebugHexString(), value.ToDebugHexString());
+      break;
+    }
+    value.consume_byte();
+    auto intent = ParseIntentKey(key, value);
+    if (!intent.ok()) {
+      status = intent.status();
+      break;
+    }
+    auto id = FullyDecodeTransactionId(Slice(value.data(), TransactionId::static_size()));
+    if (!id.ok()) {
+      status = id.status();
+      break;
+    }
+
+    std::lock_guard<std::mutex> lock(transactions_mutex_);
+    if (++num_intents % kRebuildStopCheckInterval == 0 && stop_rebuild_) {
+      status = STATUS(Aborted, "Intent index rebuild stopped");
+      break;
+    }
+    if (disabled_) {
+      break;
+    }
+    if (removed_during_rebuild_.count(*id)) {
+      continue;
+    }
+    DoAdd(*id, intent->doc_path, intent->type);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(transactions_mutex_);
+    rebuilding_ = false;
+    removed_during_rebuild_.clear();
+    if (status.ok() && !stop_rebuild_ && !disabled_) {
+      ready_.store(true, std::memory_order_release);
+    }
+  }
+  rebuild_cond_.notify_all();
+
+  if (status.ok() && ready()) {
+    LOG(INFO) << "Intent index rebuilt, loaded " << num_intents << " intents";
+  }
+  return status;
+}
+
+void IntentIndex::StopRebuild() {
+  std::unique_lock<std::mutex> lock(transactions_mutex_);
+  stop_rebuild_ = true;
+  rebuild_cond_.wait(lock, [this] { return !rebuilding_; });
+}
+
+bool IntentIndex::ForEachIntent(Slice doc_path, const IntentCallback& callback) const {
+  const auto& shard = ShardForDocPath(doc_path);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  // Disable resets ready before clearing shards, so shard contents are complete while it is set.
+  if (!ready()) {
+    return false;
+  }
+  auto it = shard.intents.find(doc_path, DocPathHash(), DocPathEqual());
+  if (it == shard.intents.end()) {
+    return true;
+  }
+  for (const auto& intent : it->second) {
+    callback(intent.id, intent.type);
+  }
+  return true;
+}
+
+size_t IntentIndex::TEST_size() const {
+  size_t result = 0;
+  for (const auto& shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    result += shard.intents.size();
+  }
+  return result;
+}
+
+bool IntentIndex::TEST_disabled() const {
+  std::lock_guard<std::mutex> lock(transactions_mutex_);
+  return disabled_;
+}
+
+} // namespace docdb
+} // namespace yb
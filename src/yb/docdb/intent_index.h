@@ -0,0 +1,181 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#ifndef YB_DOCDB_INTENT_INDEX_H
+#define YB_DOCDB_INTENT_INDEX_H
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/container/small_vector.hpp>
+#include <boost/unordered_map.hpp>
+
+#include "yb/common/transaction.h"
+
+#include "yb/docdb/value_type.h"
+
+#include "yb/gutil/port.h"
+
+#include "yb/util/slice.h"
+#include "yb/util/status.h"
+
+namespace rocksdb {
+
+class DB;
+
+}
+
+namespace yb {
+
+class MemTracker;
+
+namespace docdb {
+
+// In-memory index of intents stored in intents DB of a tablet, so conflict resolution could find
+// transactions with intents for a doc path without seeking in intents DB.
+//
+// Intents are indexed by their doc path, i.e. intent key without intent type and hybrid time.
+// After restart intents DB could contain intents that are not present in the index, so the index
+// should not be used until it is rebuilt from intents DB, see ready().
+//
+// Memory used by the index is accounted in the provided mem tracker. When it exceeds
+// intent_index_memory_limit_bytes, or the mem tracker limit, the index is cleared and disabled, so
+// conflict resolution falls back to intents DB until the tablet is reopened.
+class IntentIndex {
+ public:
+  typedef std::function<void(const TransactionId&, IntentType)> IntentCallback;
+
+  explicit IntentIndex(std::shared_ptr<MemTracker> mem_tracker = nullptr);
+  ~IntentIndex();
+
+  IntentIndex(const IntentIndex&) = delete;
+  void operator=(const IntentIndex&) = delete;
+
+  // Records that transaction has intent of specified type for doc path.
+  void Add(const TransactionId& id, Slice doc_path, IntentType type);
+
+  // Forgets all intents of transaction. Should be invoked after they are removed from intents DB.
+  void Remove(const TransactionId& id);
+
+  // Loads intents from intents DB and marks index as ready. Could be invoked concurrently with Add
+  // and Remove.
+  CHECKED_STATUS Rebuild(rocksdb::DB* intents_db);
+
+  // Interrupts running Rebuild and waits until it returns. Rebuild that is invoked after this call
+  // does nothing. So it is safe to destroy intents DB after this call.
+  void StopRebuild();
+
+  // Whether the index contains all intents stored in intents DB. Always false after the index was
+  // disabled.
+  bool ready() const {
+    return ready_.load(std::memory_order_acquire);
+  }
+
+  // Invokes callback for each intent with specified doc path. The callback is invoked under the
+  // index lock, so it should not access the index. Returns false without invoking callback when
+  // the index is not ready, so intents should be read from intents DB.
+  bool ForEachIntent(Slice doc_path, const IntentCallback& callback) const;
+
+  // Returns number of doc paths that have intents.
+  size_t TEST_size() const;
+
+  bool TEST_disabled() const;
+
+ private:
+  // Number of independent shards in the index. Doc paths are distributed between shards by hash.
+  static constexpr size_t kNumShards = 32;
+
+  // Check for stop request after this number of loaded intents.
+  static constexpr size_t kRebuildStopCheckInterval = 1024;
+
+  struct Intent {
+    TransactionId id;
+    IntentType type;
+  };
+
+  typedef boost::container::small_vector<Intent, 2> Intents;
+
+  // Hashes and compares doc paths, so shard could be searched by slice without building a string.
+  struct DocPathHash {
+    size_t operator()(Slice doc_path) const {
+      return doc_path.hash();
+    }
+  };
+
+  struct DocPathEqual {
+    bool operator()(Slice lhs, Slice rhs) const {
+      return lhs == rhs;
+    }
+  };
+
+  struct Shard {
+    mutable std::mutex mutex;
+
+    // Intents of all transactions by doc path. Keys are not moved by rehash, so transactions
+    // refer to them by pointer.
+    boost::unordered_map<std::string, Intents, DocPathHash, DocPathEqual> intents;
+  } CACHELINE_ALIGNED;
+
+  Shard& ShardForDocPath(Slice doc_path);
+  const Shard& ShardForDocPath(Slice doc_path) const;
+
+  // Adds intent to the shard. Returns the stored doc path if it is the first intent of this
+  // transaction for the doc path, nullptr otherwise.
+  const std::string* AddToShard(const TransactionId& id, Slice doc_path, IntentType type);
+
+  // Adds intent of the transaction to the index and accounts its memory, disables the index when
+  // memory limit is exceeded. Should be invoked under transactions_mutex_.
+  void DoAdd(const TransactionId& id, Slice doc_path, IntentType type);
+
+  // Clears and disables the index. Should be invoked under transactions_mutex_.
+  void Disable(const char* reason);
+
+  std::shared_ptr<MemTracker> mem_tracker_;
+
+  std::array<Shard, kNumShards> shards_;
+
+  // Set when all intents of intents DB were loaded.
+  std::atomic<bool> ready_{false};
+
+  // Protects fields below and serializes modifications of shards, so shard mutex only protects them
+  // from concurrent readers. When both are required, it is taken before shard mutex.
+  mutable std::mutex transactions_mutex_;
+
+  // Doc paths of intents of each transaction, used to remove them. Point to keys of shard maps.
+  std::unordered_map<TransactionId, std::vector<const std::string*>, TransactionIdHash>
+      transactions_;
+
+  // Approximate memory used by the index.
+  int64_t memory_usage_ = 0;
+
+  bool disabled_ = false;
+
+  // Transactions removed while the index is rebuilt. Their intents that are still visible to the
+  // rebuild iterator should not be loaded.
+  TransactionIdSet removed_during_rebuild_;
+
+  bool rebuilding_ = false;
+  bool stop_rebuild_ = false;
+  std::condition_variable rebuild_cond_;
+};
+
+} // namespace docdb
+} // namespace yb
+
+#endif // YB_DOCDB_INTENT_INDEX_H
@@ -19,6 +19,7 @@
 
 #include "yb/docdb/shared_lock_manager.h"
 
+#include "yb/util/monotime.h"
 #include "yb/util/test_macros.h"
 #include "yb/util/test_util.h"
 
@@ -383,5 +384,36 @@ TEST_F(SharedLockManagerTest, LockBatchReset) {
   EXPECT_TRUE(lb.empty());
 }
 
+// Measures lock/unlock throughput of batches typical for a single row write: weak intents on the
+// shared parent key and a strong intent on a row key, that is distinct in most of batches.
+TEST_F(SharedLockManagerTest, BenchmarkLockUnlock) {
+  const int kBatchesPerThread = AllowSlowTests() ? 200000 : 20000;
+  const int kNumRowKeys = 1000;
+  for (int num_threads : {1, 2, 4, 8, 16, 32, 64}) {
+    std::atomic<int64_t> total_batches{0};
+    vector<thread> threads;
+    auto start = MonoTime::Now();
+    for (int i = 0; i < num_threads; i++) {
+      threads.emplace_back([this, i, kBatchesPerThread, &total_batches]() {
+        std::mt19937 gen(i);
+        std::uniform_int_distribution<> key_dis(0, kNumRowKeys - 1);
+        for (int j = 0; j < kBatchesPerThread; j++) {
+          LockBatch lb(&lm_, {
+              {"table", IntentType::kWeakSnapshotWrite},
+              {"table.row" + std::to_string(key_dis(gen)), IntentType::kStrongSnapshotWrite}});
+        }
+        total_batches += kBatchesPerThread;
+      });
+    }
+    for (auto& t : threads) {
+      t.join();
+    }
+    auto elapsed = MonoTime::Now().GetDeltaSince(start);
+    LOG(INFO) << num_threads << " threads: " << total_batches.load() << " batches in "
+              << elapsed.ToString() << ", " << total_batches.load() / elapsed.ToSeconds()
+              << " batches/sec";
+  }
+}
+
 } // namespace docdb
 } // namespace yb
@@ -31,6 +31,13 @@ namespace docdb {
 
 namespace {
 
+// Number of bits used to count holders of one intent type in LockEntry::num_holding.
+constexpr size_t kIntentTypeCounterBits = 10;
+
+// Max number of holders of one intent type. Lock requests beyond this limit wait, as if there
+// was a conflicting lock.
+constexpr uint64_t kMaxIntentTypeHolders = (1ULL << kIntentTypeCounterBits) - 1;
+
 LockState Combine(std::initializer_list<IntentType> lock_types) {
   LockState state;
   for (auto type : lock_types) {
@@ -79,6 +86,19 @@ std::array<LockState, kIntentTypeMapSize> MakeConflicts() {
   return result;
 }
 
+// Bit offset of the holder counter for each intent type in LockEntry::num_holding.
+std::array<size_t, kIntentTypeMapSize> MakeCounterShifts() {
+  std::array<size_t, kIntentTypeMapSize> result;
+  result.fill(0);
+  size_t shift = 0;
+  for (auto type : kIntentTypeList) {
+    result[static_cast<size_t>(type)] = shift;
+    shift += kIntentTypeCounterBits;
+  }
+  CHECK_LE(shift, sizeof(uint64_t) * 8);
+  return result;
+}
+
 } // namespace
 
 // The conflict matrix. (CONFLICTS[i] & (1 << j)) is one iff LockTypes i and j conflict.
@@ -86,6 +106,30 @@ std::array<LockState, kIntentTypeMapSize> MakeConflicts() {
 // https://docs.google.com/spreadsheets/d/1h8GosY5XnJvrsyjEqyuXdKYlwvfKIaqx_RyDQGd7rSc
 const std::array<LockState, kIntentTypeMapSize> kIntentConflicts = MakeConflicts();
 
+namespace {
+
+const std::array<size_t, kIntentTypeMapSize> kCounterShifts = MakeCounterShifts();
+
+// kIntentConflicts converted to masks over packed holder counters.
+std::array<uint64_t, kIntentTypeMapSize> MakeConflictMasks() {
+  std::array<uint64_t, kIntentTypeMapSize> result;
+  result.fill(0);
+  for (auto type : kIntentTypeList) {
+    const size_t idx = static_cast<size_t>(type);
+    for (auto other : kIntentTypeList) {
+      const size_t other_idx = static_cast<size_t>(other);
+      if (kIntentConflicts[idx].test(other_idx)) {
+        result[idx] |= kMaxIntentTypeHolders << kCounterShifts[other_idx];
+      }
+    }
+  }
+  return result;
+}
+
+const std::array<uint64_t, kIntentTypeMapSize> kConflictMasks = MakeConflictMasks();
+
+} // namespace
+
 bool SharedLockManager::VerifyState(const LockState& state) {
   LockState not_allowed;
   for (auto intent : kIntentTypeList) {
@@ -194,38 +238,56 @@ IntentType SharedLockManager::CombineIntents(const IntentType i1, const IntentTy
   FATAL_INVALID_ENUM_VALUE(IntentType, i1);
 }
 
+bool SharedLockManager::LockEntry::TryLock(IntentType lock_type) {
+  const size_t type_idx = static_cast<size_t>(lock_type);
+  const size_t shift = kCounterShifts[type_idx];
+  const uint64_t conflict_mask = kConflictMasks[type_idx];
+  uint64_t old_value = num_holding.load(std::memory_order_acquire);
+  for (;;) {
+    if ((old_value & conflict_mask) != 0 ||
+        ((old_value >> shift) & kMaxIntentTypeHolders) == kMaxIntentTypeHolders) {
+      return false;
+    }
+    if (num_holding.compare_exchange_weak(old_value, old_value + (1ULL << shift))) {
+      return true;
+    }
+  }
+}
+
 void SharedLockManager::LockEntry::Lock(IntentType lock_type) {
-  // TODO(bojanserafimov): Implement CAS fast path. Only wait when CAS fails.
-  int type_idx = static_cast<size_t>(lock_type);
+  if (TryLock(lock_type)) {
+    return;
+  }
+
   std::unique_lock<std::mutex> lock(mutex);
-  auto& state = this->state;
-  cond_var.wait(lock, [&state, type_idx]() {
-    return (state & kIntentConflicts[type_idx]).none();
-  });
-  ++num_holding[type_idx];
-  state.set(type_idx);
+  // Waiter should be registered before rechecking the state, so that Unlock either observes it
+  // or we observe the state updated by Unlock.
+  ++num_waiters;
+  while (!TryLock(lock_type)) {
+    cond_var.wait(lock);
+  }
+  --num_waiters;
 }
 
 void SharedLockManager::LockEntry::Unlock(IntentType lock_type) {
-  int type_idx = static_cast<int>(lock_type);
-  bool should_notify = false;
-  {
-    std::lock_guard<std::mutex> lock(mutex);
-    num_holding[type_idx]--;
-    if (num_holding[type_idx] == 0) {
-      state.reset(type_idx);
-      should_notify = (state == Combine({})
-        || state == Combine({IntentType::kWeakSerializableRead})
-        || state == Combine({IntentType::kWeakSerializableWrite}));
-    }
-  }
+  const size_t shift = kCounterShifts[static_cast<size_t>(lock_type)];
+  const uint64_t old_value = num_holding.fetch_sub(1ULL << shift);
+  const uint64_t old_count = (old_value >> shift) & kMaxIntentTypeHolders;
+  DCHECK_NE(old_count, 0);
 
-  // Notify only if it is possible that a waiting thread can now lock
-  if (should_notify) {
+  // Notify only if it is possible that a waiting thread can now lock, i.e. there are no more
+  // holders of this type or there was a waiter blocked by the holders limit.
+  if ((old_count == 1 || old_count == kMaxIntentTypeHolders) && num_waiters.load() != 0) {
+    // Taking the mutex guarantees that a waiter that has registered itself is already waiting.
+    { std::lock_guard<std::mutex> lock(mutex); }
     cond_var.notify_all();
   }
 }
 
+SharedLockManager::LockShard& SharedLockManager::ShardForKey(const std::string& key) {
+  return shards_[std::hash<std::string>()(key) % kNumShards];
+}
+
 void SharedLockManager::Lock(const KeyToIntentTypeMap& key_to_intent_type) {
   TRACE("Locking a batch of $0 keys", key_to_intent_type.size());
   std::vector<SharedLockManager::LockEntry*> reserved = Reserve(key_to_intent_type);
@@ -244,26 +306,46 @@ std::vector<SharedLockManager::LockEntry*> SharedLockManager::Reserve(
     const KeyToIntentTypeMap& key_to_intent_type) {
   std::vector<SharedLockManager::LockEntry*> reserved;
   reserved.reserve(key_to_intent_type.size());
-  {
-    std::lock_guard<std::mutex> lock(global_mutex_);
-    for (const auto& key_and_intent_type : key_to_intent_type) {
-      auto it = locks_.emplace(key_and_intent_type.first, std::make_unique<LockEntry>()).first;
-      it->second->num_using++;
-      reserved.push_back(&*it->second);
+  for (const auto& key_and_intent_type : key_to_intent_type) {
+    auto& shard = ShardForKey(key_and_intent_type.first);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto& entry = shard.locks[key_and_intent_type.first];
+    if (!entry) {
+      if (shard.free_entries.empty()) {
+        entry = std::make_unique<LockEntry>();
+      } else {
+        entry = std::move(shard.free_entries.back());
+        shard.free_entries.pop_back();
+      }
     }
+    entry->num_using++;
+    reserved.push_back(entry.get());
   }
   return reserved;
 }
 
 void SharedLockManager::Unlock(const KeyToIntentTypeMap& key_to_intent_type) {
   TRACE("Unlocking a batch of $0 keys", key_to_intent_type.size());
-  std::lock_guard<std::mutex> lock(global_mutex_);
   for (const auto& key_and_intent_type : boost::adaptors::reverse(key_to_intent_type)) {
     VLOG(4) << "Unlocking " << docdb::ToString(key_and_intent_type.second) << ": "
             << util::FormatBytesAsStr(key_and_intent_type.first);
-    locks_[key_and_intent_type.first]->Unlock(key_and_intent_type.second);
+    auto& shard = ShardForKey(key_and_intent_type.first);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.locks.find(key_and_intent_type.first);
+    DCHECK(it != shard.locks.end()) << "Unlocking key that is not locked: "
+                                    << util::FormatBytesAsStr(key_and_intent_type.first);
+    auto& entry = it->second;
+    entry->Unlock(key_and_intent_type.second);
+    entry->num_using--;
+    if (entry->num_using == 0) {
+      // Nobody references this entry, so it has no holders and no waiters and could be reused.
+      DCHECK_EQ(entry->num_holding.load(), 0);
+      if (shard.free_entries.size() < kMaxFreeEntriesPerShard) {
+        shard.free_entries.push_back(std::move(entry));
+      }
+      shard.locks.erase(it);
+    }
   }
-  Cleanup(key_to_intent_type);
 }
 
 void SharedLockManager::LockInTest(const string& key, IntentType intent_type) {
@@ -274,15 +356,5 @@ void SharedLockManager::UnlockInTest(const string& key, IntentType intent_type)
   Unlock({{key, intent_type}});
 }
 
-void SharedLockManager::Cleanup(const KeyToIntentTypeMap& key_to_intent_type) {
-  for (const auto& item : key_to_intent_type) {
-    auto it = locks_.find(item.first);
-    it->second->num_using--;
-    if (it->second->num_using == 0) {
-      locks_.erase(it);
-    }
-  }
-}
-
 }  // namespace docdb
 }  // namespace yb
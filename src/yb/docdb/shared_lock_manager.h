@@ -14,6 +14,9 @@
 #ifndef YB_DOCDB_SHARED_LOCK_MANAGER_H
 #define YB_DOCDB_SHARED_LOCK_MANAGER_H
 
+#include <array>
+#include <atomic>
+#include <condition_variable>
 #include <map>
 #include <mutex>
 #include <string>
@@ -22,6 +25,7 @@
 
 #include "yb/docdb/shared_lock_manager_fwd.h"
 #include "yb/docdb/lock_batch.h"
+#include "yb/gutil/port.h"
 #include "yb/gutil/spinlock.h"
 #include "yb/util/cross_thread_mutex.h"
 
@@ -34,6 +38,10 @@ namespace docdb {
 // - Multiple kStrongSerializableRead and kWeakSerializableRead
 // - Multiple kStrongSerializableWrite and kWeakSerializableWrite
 // - Multiple kWeakSnapshotWrite, kWeakSerializableRead, and kWeakSerializableWrite
+//
+// The lock table is split into shards by key hash, so concurrent batches on different keys do not
+// contend on a single mutex. Lock state of an entry is packed into a single atomic word, so
+// acquiring a non-conflicting lock does not take the entry mutex.
 class SharedLockManager {
  public:
 
@@ -56,44 +64,58 @@ class SharedLockManager {
   static std::string ToString(const LockState& state);
 
  private:
+  // Number of independent shards in the lock table. Keys are distributed between shards by hash.
+  static constexpr size_t kNumShards = 32;
+
+  // Max number of free LockEntry objects retained by a shard for reuse.
+  static constexpr size_t kMaxFreeEntriesPerShard = 128;
 
   struct LockEntry {
-    // Taken only for short duration, with no blocking wait.
+    // Packed holder counters, a fixed number of bits per intent type. Lock and unlock in the
+    // uncontended case are a single CAS on this word, without touching mutex or cond_var.
+    std::atomic<uint64_t> num_holding{0};
+
+    // Number of threads waiting on cond_var. Unlock takes the mutex to notify only when there
+    // are waiters.
+    std::atomic<size_t> num_waiters{0};
+
+    // Protects waiting on cond_var. Taken only on the slow path.
     std::mutex mutex;
 
     std::condition_variable cond_var;
 
-    // Refcounting for garbage collection. Can only be used while the global lock is held.
+    // Refcounting for garbage collection. Can only be used while the shard lock is held.
     size_t num_using = 0;
 
-    // Number of holders for each type
-    std::array<size_t, kIntentTypeMapSize> num_holding;
-    LockState state;
+    // Returns true if lock of specified type was acquired without waiting.
+    bool TryLock(IntentType lock_type);
 
     void Lock(IntentType lock_type);
 
     void Unlock(IntentType lock_type);
-
-    LockEntry() {
-      num_holding.fill(0);
-    }
   };
 
   typedef std::unordered_map<std::string, std::unique_ptr<LockEntry>> LockEntryMap;
 
-  // Make sure the entries exist in the locks_ map and return pointers so we can access
-  // them without holding the global lock. Returns a vector with pointers in the same order
-  // as the keys in the batch.
-  std::vector<LockEntry*> Reserve(const KeyToIntentTypeMap& batch);
+  struct LockShard {
+    // Taken only for short duration, with no blocking wait.
+    std::mutex mutex;
 
-  // Update refcounts and maybe collect garbage.
-  void Cleanup(const KeyToIntentTypeMap& key_to_intent_type);
+    // Can only be modified if the shard mutex is held.
+    LockEntryMap locks;
 
-  // The global mutex should be taken only for very short duration, with no blocking wait.
-  std::mutex global_mutex_;
+    // Entries that are not currently in use, kept for reuse to avoid allocation per lock.
+    std::vector<std::unique_ptr<LockEntry>> free_entries;
+  } CACHELINE_ALIGNED;
+
+  LockShard& ShardForKey(const std::string& key);
+
+  // Make sure the entries exist in the locks map of corresponding shards and return pointers so
+  // we can access them without holding the shard locks. Returns a vector with pointers in the
+  // same order as the keys in the batch.
+  std::vector<LockEntry*> Reserve(const KeyToIntentTypeMap& batch);
 
-  // Can only be modified if the global mutex is held.
-  LockEntryMap locks_;
+  std::array<LockShard, kNumShards> shards_;
 };
 
 extern const std::array<LockState, kIntentTypeMapSize> kIntentConflicts;
@@ -30,6 +30,7 @@
 // under the License.
 //
 
+#include <map>
 #include <memory>
 #include <thread>
 #include <boost/bind.hpp>
@@ -40,6 +41,7 @@
 #include "yb/client/client.h"
 #include "yb/common/schema.h"
 #include "yb/common/wire_protocol.h"
+#include "yb/consensus/consensus.h"
 #include "yb/fs/fs_manager.h"
 #include "yb/integration-tests/cluster_itest_util.h"
 #include "yb/integration-tests/mini_cluster.h"
@@ -48,8 +50,10 @@
 #include "yb/master/mini_master.h"
 #include "yb/master/master-test-util.h"
 #include "yb/rpc/messenger.h"
+#include "yb/tablet/tablet_peer.h"
 #include "yb/tserver/mini_tablet_server.h"
 #include "yb/tserver/tablet_server.h"
+#include "yb/util/metrics.h"
 #include "yb/util/stopwatch.h"
 #include "yb/util/test_util.h"
 
@@ -71,6 +75,11 @@ DECLARE_int32(heartbeat_interval_ms);
 DECLARE_bool(log_preallocate_segments);
 DECLARE_bool(enable_remote_bootstrap);
 DECLARE_int32(tserver_unresponsive_timeout_ms);
+DECLARE_int32(multi_raft_batch_window_ms);
+DECLARE_bool(reject_multi_raft_update_consensus);
+
+METRIC_DECLARE_histogram(handler_latency_yb_consensus_ConsensusService_UpdateConsensus);
+METRIC_DECLARE_histogram(handler_latency_yb_consensus_ConsensusService_MultiRaftUpdateConsensus);
 
 DEFINE_int32(num_test_tablets, 60, "Number of tablets for stress test");
 
@@ -133,6 +142,12 @@ class CreateTableStressTest : public YBMiniClusterTestBase<MiniCluster> {
 
   void CreateBigTable(const YBTableName& table_name, int num_tablets);
 
+  // Returns the number of RPCs handled by all tablet servers for the given method.
+  int64_t CountHandledRpcs(const HistogramPrototype* handler_latency);
+
+  // Returns the current Raft term of every tablet peer of all tablet servers.
+  std::map<std::string, int64_t> TabletPeerTerms();
+
  protected:
   std::shared_ptr<YBClient> client_;
   YBSchema schema_;
@@ -160,6 +175,119 @@ void CreateTableStressTest::CreateBigTable(const YBTableName& table_name, int nu
             .Create());
 }
 
+int64_t CreateTableStressTest::CountHandledRpcs(const HistogramPrototype* handler_latency) {
+  int64_t result = 0;
+  for (int i = 0; i < cluster_->num_tablet_servers(); ++i) {
+    auto histogram = cluster_->mini_tablet_server(i)->server()->metric_entity()->
+        FindOrCreateHistogram(handler_latency);
+    result += histogram->TotalCount();
+  }
+  return result;
+}
+
+std::map<std::string, int64_t> CreateTableStressTest::TabletPeerTerms() {
+  std::map<std::string, int64_t> result;
+  for (int i = 0; i < cluster_->num_tablet_servers(); ++i) {
+    for (const auto& peer : cluster_->GetTabletPeers(i)) {
+      auto consensus = peer->shared_consensus();
+      if (consensus) {
+        result[peer->tablet_id() + "/" + peer->permanent_uuid()] =
+            consensus->ConsensusState(consensus::CONSENSUS_CONFIG_COMMITTED).current_term();
+      }
+    }
+  }
+  return result;
+}
+
+// Heartbeats are sent in MultiRaftUpdateConsensus calls when batching is enabled, and as separate
+// UpdateConsensus calls when the destination server rejects the batched calls. Leaders stay the
+// same throughout, so heartbeats are delivered in both cases.
+TEST_F(CreateTableStressTest, MultiRaftBatching) {
+  constexpr int kNumTablets = 10;
+  const auto kPhaseTime = MonoDelta::FromSeconds(3);
+  YBTableName table_name("my_keyspace", "test_table");
+  ASSERT_NO_FATALS(CreateBigTable(table_name, kNumTablets));
+  master::GetTableLocationsResponsePB resp;
+  ASSERT_OK(WaitForRunningTabletCount(cluster_->mini_master(), table_name, kNumTablets, &resp));
+
+  FLAGS_multi_raft_batch_window_ms = 10;
+  // Let leader elections settle.
+  SleepFor(kPhaseTime);
+  auto terms = TabletPeerTerms();
+  ASSERT_EQ(kNumTablets * cluster_->num_tablet_servers(), static_cast<int>(terms.size()));
+
+  auto multi_raft_rpcs = CountHandledRpcs(
+      &METRIC_handler_latency_yb_consensus_ConsensusService_MultiRaftUpdateConsensus);
+  SleepFor(kPhaseTime);
+  ASSERT_GT(CountHandledRpcs(
+                &METRIC_handler_latency_yb_consensus_ConsensusService_MultiRaftUpdateConsensus),
+            multi_raft_rpcs);
+  ASSERT_EQ(terms, TabletPeerTerms());
+
+  FLAGS_reject_multi_raft_update_consensus = true;
+  auto update_consensus_rpcs = CountHandledRpcs(
+      &METRIC_handler_latency_yb_consensus_ConsensusService_UpdateConsensus);
+  SleepFor(kPhaseTime);
+  // Every idle tablet has a heartbeat for each of its two followers in each heartbeat interval.
+  ASSERT_GE(CountHandledRpcs(
+                &METRIC_handler_latency_yb_consensus_ConsensusService_UpdateConsensus) -
+                update_consensus_rpcs,
+            kNumTablets * 2);
+  ASSERT_EQ(terms, TabletPeerTerms());
+}
+
+// Measures the CPU usage of an idle cluster, where the only work is Raft heartbeats, as the number
+// of tablets grows, with and without batching of the heartbeats of different tablets.
+TEST_F(CreateTableStressTest, IdleHeartbeatCpuUsage) {
+  if (!AllowSlowTests()) {
+    LOG(INFO) << "Skipping slow test";
+    return;
+  }
+  const auto kMeasureTime = MonoDelta::FromSeconds(10);
+  int total_tablets = 0;
+  for (int num_tablets : {10, 100, 300}) {
+    YBTableName table_name("my_keyspace", Format("test_table_$0", num_tablets));
+    ASSERT_NO_FATALS(CreateBigTable(table_name, num_tablets));
+    master::GetTableLocationsResponsePB resp;
+    ASSERT_OK(WaitForRunningTabletCount(cluster_->mini_master(), table_name, num_tablets, &resp));
+    total_tablets += num_tablets;
+
+    for (int batch_window_ms : {0, 10}) {
+      FLAGS_multi_raft_batch_window_ms = batch_window_ms;
+      // Let leader elections and the switch of the batching mode settle.
+      SleepFor(MonoDelta::FromSeconds(3));
+
+      auto update_consensus_rpcs = CountHandledRpcs(
+          &METRIC_handler_latency_yb_consensus_ConsensusService_UpdateConsensus);
+      auto multi_raft_rpcs = CountHandledRpcs(
+          &METRIC_handler_latency_yb_consensus_ConsensusService_MultiRaftUpdateConsensus);
+      Stopwatch stopwatch(Stopwatch::ALL_THREADS);
+      stopwatch.start();
+      SleepFor(kMeasureTime);
+      stopwatch.stop();
+      update_consensus_rpcs = CountHandledRpcs(
+          &METRIC_handler_latency_yb_consensus_ConsensusService_UpdateConsensus) -
+          update_consensus_rpcs;
+      multi_raft_rpcs = CountHandledRpcs(
+          &METRIC_handler_latency_yb_consensus_ConsensusService_MultiRaftUpdateConsensus) -
+          multi_raft_rpcs;
+
+      auto times = stopwatch.elapsed();
+      LOG(INFO) << "Tablets: " << total_tablets << ", batch window: " << batch_window_ms
+                << "ms, CPU: " << (times.user_cpu_seconds() + times.system_cpu_seconds()) /
+                                  times.wall_seconds() * 100 << "%"
+                << ", UpdateConsensus RPCs/s: "
+                << update_consensus_rpcs / kMeasureTime.ToSeconds()
+                << ", MultiRaftUpdateConsensus RPCs/s: "
+                << multi_raft_rpcs / kMeasureTime.ToSeconds();
+      if (batch_window_ms != 0) {
+        ASSERT_GT(multi_raft_rpcs, 0);
+      }
+    }
+  }
+  FLAGS_multi_raft_batch_window_ms = 0;
+}
+
 TEST_F(CreateTableStressTest, CreateAndDeleteBigTable) {
   DontVerifyClusterBeforeNextTearDown();
   if (!AllowSlowTests()) {
@@ -50,7 +50,16 @@ using std::shared_ptr;
 // Classifies the type of the subcache.
 enum SubCacheType {
   SINGLE_TOUCH,
-  MULTI_TOUCH
+  MULTI_TOUCH,
+  // Index and filter blocks, which are kept apart from data blocks, see NewLRUCache.
+  HIGH_PRIORITY
+};
+
+// Type of a block looked up in the block cache, used to report hit rates by block type.
+enum class CacheBlockType {
+  kIndex,
+  kFilter,
+  kData
 };
 
 class Cache;
@@ -61,10 +70,17 @@ class Cache;
 //
 // The parameter num_shard_bits defaults to 4, and strict_capacity_limit
 // defaults to false.
+//
+// high_priority_ratio is the fraction of the capacity reserved for entries inserted with
+// kHighPriorityQueryId, i.e. index and filter blocks. Data blocks cannot evict them from the
+// reserved part, so large scans cannot push them out of the cache. They may also use the part of
+// the cache that data blocks do not use, until data blocks need it back. With the default of 0
+// they share the multi-touch part of the cache with frequently used data blocks.
 extern shared_ptr<Cache> NewLRUCache(size_t capacity);
 extern shared_ptr<Cache> NewLRUCache(size_t capacity, int num_shard_bits);
 extern shared_ptr<Cache> NewLRUCache(size_t capacity, int num_shard_bits,
-                                     bool strict_capacity_limit);
+                                     bool strict_capacity_limit,
+                                     double high_priority_ratio = 0);
 
 using QueryId = int64_t;
 // Query ids to represent values for the default query id.
@@ -73,6 +89,8 @@ constexpr QueryId kDefaultQueryId = 0;
 constexpr QueryId kInMultiTouchId = -1;
 // Query ids to represent values that should not be in any cache.
 constexpr QueryId kNoCacheQueryId = -2;
+// Query ids to represent values that should be in the high priority part of the cache.
+constexpr QueryId kHighPriorityQueryId = -3;
 
 class Cache {
  public:
@@ -190,6 +208,9 @@ class Cache {
 
   virtual void SetMetrics(const scoped_refptr<yb::MetricEntity>& entity) = 0;
 
+  // Counts a lookup of a block of the given type in the cache metrics.
+  virtual void RecordLookup(CacheBlockType block_type, bool hit) {}
+
  private:
   void LRU_Remove(Handle* e);
   void LRU_Append(Handle* e);
@@ -54,6 +54,8 @@
 #include "yb/util/logging.h"
 #include "yb/util/debug-util.h"
 #include "yb/util/fault_injection.h"
+#include "yb/util/format.h"
+#include "yb/util/priority_thread_pool.h"
 
 #include "yb/rocksdb/db/auto_roll_logger.h"
 #include "yb/rocksdb/db/builder.h"
@@ -380,6 +382,10 @@ DBImpl::~DBImpl() {
   CancelAllBackgroundWork(false);
   int compactions_unscheduled = env_->UnSchedule(this, Env::Priority::LOW);
   int flushes_unscheduled = env_->UnSchedule(this, Env::Priority::HIGH);
+  if (db_options_.priority_thread_pool_for_compactions_and_flushes) {
+    // Removed tasks update bg_compaction_scheduled_ and bg_flush_scheduled_ themselves.
+    db_options_.priority_thread_pool_for_compactions_and_flushes->Remove(this);
+  }
   mutex_.Lock();
   bg_compaction_scheduled_ -= compactions_unscheduled;
   bg_flush_scheduled_ -= flushes_unscheduled;
@@ -2636,11 +2642,16 @@ void DBImpl::MaybeScheduleFlushOrCompaction() {
     return;
   }
 
+  const bool use_priority_thread_pool =
+      db_options_.priority_thread_pool_for_compactions_and_flushes != nullptr;
+
   while (unscheduled_flushes_ > 0 &&
          bg_flush_scheduled_ < db_options_.max_background_flushes) {
     unscheduled_flushes_--;
     bg_flush_scheduled_++;
-    env_->Schedule(&DBImpl::BGWorkFlush, this, Env::Priority::HIGH, this);
+    if (!use_priority_thread_pool || !SubmitToPriorityThreadPool(true /* is_flush */)) {
+      env_->Schedule(&DBImpl::BGWorkFlush, this, Env::Priority::HIGH, this);
+    }
   }
 
   auto bg_compactions_allowed = BGCompactionsAllowed();
@@ -2664,16 +2675,96 @@ void DBImpl::MaybeScheduleFlushOrCompaction() {
 
   while (bg_compaction_scheduled_ < bg_compactions_allowed &&
          unscheduled_compactions_ > 0) {
+    bg_compaction_scheduled_++;
+    unscheduled_compactions_--;
+    if (use_priority_thread_pool && SubmitToPriorityThreadPool(false /* is_flush */)) {
+      continue;
+    }
     CompactionArg* ca = new CompactionArg;
     ca->db = this;
     ca->m = nullptr;
-    bg_compaction_scheduled_++;
-    unscheduled_compactions_--;
     env_->Schedule(&DBImpl::BGWorkCompaction, ca, Env::Priority::LOW, this,
                    &DBImpl::UnscheduleCallback);
   }
 }
 
+class DBImpl::ThreadPoolTask : public yb::PriorityThreadPoolTask {
+ public:
+  ThreadPoolTask(DBImpl* db, bool is_flush) : db_(db), is_flush_(is_flush) {}
+
+  void Run(const Status& status) override {
+    if (!status.ok()) {
+      db_->PriorityThreadPoolTaskAborted(is_flush_);
+      return;
+    }
+    if (is_flush_) {
+      BGWorkFlush(db_);
+    } else {
+      IOSTATS_SET_THREAD_POOL_ID(Env::Priority::LOW);
+      db_->BackgroundCallCompaction(nullptr /* arg */);
+    }
+  }
+
+  bool BelongsTo(void* key) override {
+    return key == db_;
+  }
+
+  std::string ToString() const override {
+    return yb::Format("$0 $1", is_flush_ ? "Flush" : "Compaction", db_->dbname_);
+  }
+
+ private:
+  DBImpl* const db_;
+  const bool is_flush_;
+};
+
+bool DBImpl::SubmitToPriorityThreadPool(bool is_flush) {
+  mutex_.AssertHeld();
+  std::unique_ptr<yb::PriorityThreadPoolTask> task(new ThreadPoolTask(this, is_flush));
+  const int priority = is_flush ? kFlushTaskPriority : CompactionTaskPriority();
+  auto status = db_options_.priority_thread_pool_for_compactions_and_flushes->Submit(
+      priority, &task);
+  if (!status.ok()) {
+    RLOG(InfoLogLevel::WARN_LEVEL, db_options_.info_log,
+         "Failed to submit background work to priority thread pool: %s",
+         status.ToString().c_str());
+    return false;
+  }
+  return true;
+}
+
+int DBImpl::CompactionTaskPriority() {
+  mutex_.AssertHeld();
+  auto cfd = default_cf_handle_->cfd();
+  const int slowdown_trigger = cfd->GetLatestMutableCFOptions()->level0_slowdown_writes_trigger;
+  int result = 0;
+  if (slowdown_trigger > 0) {
+    result = std::min(
+        kFlushTaskPriority - 1,
+        cfd->current()->storage_info()->l0_delay_trigger_count() * kUrgentTaskPriority /
+            slowdown_trigger);
+  }
+  if (write_controller_.IsStopped() || write_controller_.NeedsDelay()) {
+    result = std::max(result, kUrgentTaskPriority);
+  }
+  return result;
+}
+
+void DBImpl::PriorityThreadPoolTaskAborted(bool is_flush) {
+  InstrumentedMutexLock lock(&mutex_);
+  // Return the work to the unscheduled state, so it is rescheduled in the Env if the pool was shut
+  // down while this DB is still running.
+  if (is_flush) {
+    bg_flush_scheduled_--;
+    unscheduled_flushes_++;
+  } else {
+    bg_compaction_scheduled_--;
+    unscheduled_compactions_++;
+  }
+  MaybeScheduleFlushOrCompaction();
+  bg_cv_.SignalAll();
+}
+
 int DBImpl::BGCompactionsAllowed() const {
   if (write_controller_.NeedSpeedupCompaction()) {
     return db_options_.max_background_compactions;
@@ -504,6 +504,8 @@ class DBImpl : public DB {
                    WriteCallback* callback);
 
  private:
+  class ThreadPoolTask;
+
   friend class DB;
   friend class InternalStats;
 #ifndef ROCKSDB_LITE
@@ -604,6 +606,13 @@ class DBImpl : public DB {
   static void BGWorkCompaction(void* arg);
   static void BGWorkFlush(void* db);
   static void UnscheduleCallback(void* arg);
+  // Submits a flush or a compaction to priority_thread_pool_for_compactions_and_flushes. Returns
+  // false if the pool is shutting down, so the work should be scheduled in the Env instead.
+  bool SubmitToPriorityThreadPool(bool is_flush);
+  // Priority of the next compaction in the priority thread pool.
+  int CompactionTaskPriority();
+  // Called for a task that was removed from the priority thread pool before it started.
+  void PriorityThreadPoolTaskAborted(bool is_flush);
   void BackgroundCallCompaction(void* arg);
   void BackgroundCallFlush();
   Status BackgroundCompaction(bool* madeProgress, JobContext* job_context,
@@ -23,6 +23,7 @@
 #include <cstdlib>
 #include "yb/rocksdb/db/db_test_util.h"
 #include "yb/rocksdb/port/stack_trace.h"
+#include "yb/util/priority_thread_pool.h"
 
 namespace rocksdb {
 
@@ -72,6 +73,60 @@ TEST_F(DBTest2, IteratorPropertyVersionNumber) {
   delete iter2;
   delete iter3;
 }
+TEST_F(DBTest2, PriorityThreadPoolForCompactionsAndFlushes) {
+  constexpr int kNumFiles = 10;
+
+  auto pool = std::make_shared<yb::PriorityThreadPool>(
+      "test-bg", 2 /* max_running_tasks */, 1 /* reserved_for_urgent */, kUrgentTaskPriority);
+  ASSERT_OK(pool->Init());
+
+  Options options = CurrentOptions();
+  options.compaction_style = kCompactionStyleUniversal;
+  options.num_levels = 1;
+  options.level0_file_num_compaction_trigger = 2;
+  options.priority_thread_pool_for_compactions_and_flushes = pool;
+  DestroyAndReopen(options);
+
+  // Compactions that go through the pool skip DBImpl::BGWorkCompaction.
+  std::atomic<int> env_compactions(0);
+  std::atomic<int> compactions(0);
+  rocksdb::SyncPoint::GetInstance()->SetCallBack(
+      "DBImpl::BGWorkCompaction", [&env_compactions](void*) { ++env_compactions; });
+  rocksdb::SyncPoint::GetInstance()->SetCallBack(
+      "DBImpl::BackgroundCompaction:NonTrivial:AfterRun",
+      [&compactions](void*) { ++compactions; });
+  rocksdb::SyncPoint::GetInstance()->EnableProcessing();
+
+  auto write_files = [this](int first) {
+    for (int i = first; i != first + kNumFiles; ++i) {
+      ASSERT_OK(Put(Key(i), "value" + ToString(i)));
+      ASSERT_OK(Flush());
+    }
+    ASSERT_OK(dbfull()->TEST_WaitForCompact());
+  };
+
+  ASSERT_NO_FATAL_FAILURE(write_files(0));
+  ASSERT_GT(compactions.load(), 0);
+  ASSERT_EQ(0, env_compactions.load());
+  ASSERT_LT(NumTableFilesAtLevel(0), kNumFiles);
+
+  // Once the pool is shut down, background work falls back to the Env thread pools.
+  pool->Shutdown();
+  compactions = 0;
+  ASSERT_NO_FATAL_FAILURE(write_files(kNumFiles));
+  ASSERT_GT(compactions.load(), 0);
+  ASSERT_GT(env_compactions.load(), 0);
+  ASSERT_LT(NumTableFilesAtLevel(0), kNumFiles);
+
+  rocksdb::SyncPoint::GetInstance()->DisableProcessing();
+  rocksdb::SyncPoint::GetInstance()->ClearAllCallBacks();
+
+  for (int i = 0; i != 2 * kNumFiles; ++i) {
+    ASSERT_EQ("value" + ToString(i), Get(Key(i)));
+  }
+  Close();
+}
+
 }  // namespace rocksdb
 
 int main(int argc, char** argv) {
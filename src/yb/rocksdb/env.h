@@ -490,6 +490,10 @@ class RandomAccessFile : public File {
 
   virtual void Hint(AccessPattern pattern) {}
 
+  // Asks the platform to start reading the given range of the file in background, so that
+  // following reads of it do not wait for the device. This is only a hint.
+  virtual void Readahead(uint64_t offset, size_t length) {}
+
   // Remove any kind of caching of data from the offset to offset+length
   // of this file. If the length is 0, then it refers to the end of file.
   // If the system is not caching the file contents, then this is a noop.
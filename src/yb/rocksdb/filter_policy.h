@@ -148,6 +148,13 @@ class FilterPolicy {
 
     // Transform a key.
     virtual Slice Transform(Slice key) const = 0;
+
+    // Returns the key for a coarser lookup that should also be added to the filter together with
+    // the transformed key filter_key, or an empty slice if there is none. It should be a proper
+    // prefix of filter_key, and is added to the filter only for the first transformed key starting
+    // with it. So it could be looked up in the filter like a transformed key, this method is
+    // applied again to the returned key to get even coarser keys.
+    virtual Slice CoarserKey(Slice filter_key) const { return Slice(); }
   };
 
   // Filter policy can optionally return key transformer to be used before writing key to filter or
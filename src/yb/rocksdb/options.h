@@ -45,6 +45,7 @@
 namespace yb {
 
 class MemTracker;
+class PriorityThreadPool;
 
 }
 
@@ -126,6 +127,10 @@ enum CompactionPri : char {
   kMinOverlappingRatio = 0x3,
 };
 
+// Priorities of tasks submitted to DBOptions::priority_thread_pool_for_compactions_and_flushes.
+constexpr int kUrgentTaskPriority = 100;
+constexpr int kFlushTaskPriority = 2 * kUrgentTaskPriority;
+
 enum class WALRecoveryMode : char {
   // Original levelDB recovery
   // We tolerate incomplete record in trailing data on all logs
@@ -1125,6 +1130,15 @@ struct DBOptions {
   // Default: nullptr (disabled)
   std::shared_ptr<MemoryMonitor> memory_monitor;
 
+  // Pool shared by multiple DBs to run their automatic flushes and compactions, instead of the
+  // Env thread pools. Flushes are submitted with kFlushTaskPriority, compactions with the
+  // percentage of level0_slowdown_writes_trigger reached by the level 0 files, so compactions of
+  // DBs that are closer to a write stall run first. Priorities of kUrgentTaskPriority and above
+  // mean that writes are already being delayed. Manual compactions still run in the Env pool.
+  //
+  // Default: nullptr (disabled)
+  std::shared_ptr<yb::PriorityThreadPool> priority_thread_pool_for_compactions_and_flushes;
+
   // Specify the file access pattern once a compaction is started.
   // It will be applied to all input files of a compaction.
   // Default: NORMAL
@@ -1486,6 +1500,12 @@ struct ReadOptions {
   // Query id designated for the read.
   QueryId query_id = kDefaultQueryId;
 
+  // If non-zero, once an iterator moves from a data block to the next one in an SST file, the
+  // following readahead_size bytes of the file are read ahead in background. Useful for long
+  // sequential scans, usually together with fill_cache = false.
+  // Default: 0
+  size_t readahead_size = 0;
+
   // Filter for pruning SST files. RocksDB user can provide its own implementation to exclude SST
   // files from being added to MergeIterator. By default doesn't filter files.
   std::shared_ptr<TableAwareReadFileFilter> table_aware_file_filter;
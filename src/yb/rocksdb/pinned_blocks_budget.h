@@ -0,0 +1,128 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+#ifndef ROCKSDB_INCLUDE_ROCKSDB_PINNED_BLOCKS_BUDGET_H
+#define ROCKSDB_INCLUDE_ROCKSDB_PINNED_BLOCKS_BUDGET_H
+
+#include <atomic>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+
+#include "yb/util/monotime.h"
+
+namespace yb {
+
+class MemTracker;
+
+} // namespace yb
+
+namespace rocksdb {
+
+// Memory budget for index and filter blocks that table readers keep pinned in memory, so they are
+// not looked up in the block cache on every read. The budget is shared by all tables of the server
+// and is enforced through the limit of its mem tracker. When a new block does not fit, all blocks
+// of the least recently used tables are unpinned. Uses are timed with the coarse monotonic clock,
+// so the order of tables used within the same clock tick is arbitrary.
+//
+// Owners are kept in a list ordered by the time they were last moved to its front, i.e. when they
+// reserved bytes or were found used during eviction. Uses themselves do not take the lock and only
+// update the use time, so eviction gives an owner that was used since it was moved a second chance
+// by moving it to the front again, instead of scanning all owners.
+class PinnedBlocksBudget {
+ public:
+  // Blocks pinned by a single table reader.
+  class Owner {
+   public:
+    explicit Owner(PinnedBlocksBudget* budget) : budget_(budget) {}
+
+    // Derived classes should call budget()->Unregister(this) in their destructor.
+    virtual ~Owner() = default;
+
+    // Drops all pinned blocks. Invoked by the budget under its lock when the owner is demoted.
+    virtual void Unpin() = 0;
+
+    // Records that pinned blocks of the owner were used. Does not take any locks, and only writes
+    // once per clock tick.
+    void Touch() {
+      const int64_t now = Now();
+      if (last_use_.load(std::memory_order_relaxed) != now) {
+        last_use_.store(now, std::memory_order_relaxed);
+      }
+    }
+
+    PinnedBlocksBudget* budget() const { return budget_; }
+
+   private:
+    friend class PinnedBlocksBudget;
+
+    PinnedBlocksBudget* const budget_;
+    std::atomic<int64_t> last_use_{0};
+
+    // Fields below are protected by the budget mutex.
+    // Bytes reserved by the owner. The owner is in the list of the budget iff it is not zero.
+    size_t reserved_bytes_ = 0;
+    std::list<Owner*>::iterator position_;
+    // Value of last_use_ when the owner was moved to the front of the list.
+    int64_t queued_use_ = 0;
+  };
+
+  explicit PinnedBlocksBudget(std::shared_ptr<yb::MemTracker> mem_tracker);
+  ~PinnedBlocksBudget();
+
+  PinnedBlocksBudget(const PinnedBlocksBudget&) = delete;
+  void operator=(const PinnedBlocksBudget&) = delete;
+
+  // Reserves bytes for a block of the owner, unpinning least recently used other owners when
+  // needed. On success invokes pin under the budget lock, pin should take ownership of the block
+  // and return true, or return false if the block was not pinned, e.g. because it was pinned
+  // concurrently, so the reservation is returned.
+  // Returns whether the block was pinned.
+  bool Reserve(Owner* owner, size_t bytes, const std::function<bool()>& pin);
+
+  // Same as Reserve, but only succeeds if the block fits without unpinning other owners.
+  bool ReserveIfFree(Owner* owner, size_t bytes, const std::function<bool()>& pin);
+
+  // Whether a block of the specified size fits into the budget without unpinning any owner.
+  bool HasRoom(size_t bytes) const;
+
+  // Returns all bytes reserved by the owner.
+  void Unregister(Owner* owner);
+
+  int64_t limit() const;
+  int64_t consumption() const;
+
+ private:
+  // Time used for the least recently used order of owners.
+  static int64_t Now() {
+    return yb::CoarseMonoClock::Now().time_since_epoch().count();
+  }
+
+  bool DoReserve(Owner* owner, size_t bytes, bool unpin_others, const std::function<bool()>& pin);
+
+  // Moves the owner to the front of the list, adding it if needed.
+  void MoveToFront(Owner* owner);
+
+  // Unpins the least recently used owner other than the specified one.
+  void UnpinLeastRecentlyUsed(Owner* owner);
+
+  std::shared_ptr<yb::MemTracker> mem_tracker_;
+
+  std::mutex mutex_;
+  // Owners with reserved bytes, the most recently used first.
+  std::list<Owner*> owners_;
+};
+
+}  // namespace rocksdb
+
+#endif // ROCKSDB_INCLUDE_ROCKSDB_PINNED_BLOCKS_BUDGET_H
@@ -47,6 +47,7 @@ namespace rocksdb {
 
 // -- Block-based Table
 class FlushBlockPolicyFactory;
+class PinnedBlocksBudget;
 class RandomAccessFile;
 struct TableReaderOptions;
 struct TableBuilderOptions;
@@ -123,6 +124,11 @@ struct BlockBasedTableOptions {
   // If NULL, rocksdb will not use a compressed block cache.
   std::shared_ptr<Cache> block_cache_compressed = nullptr;
 
+  // If non-NULL and cache_index_and_filter_blocks is true, top-level data index and fixed-size
+  // filter blocks loaded by the table reader are pinned in memory instead of being inserted into
+  // block_cache, while they fit into this budget shared by all tables.
+  std::shared_ptr<PinnedBlocksBudget> pinned_blocks_budget = nullptr;
+
   // Approximate size of user data packed per block, in bytes. Note that the
   // block size specified here corresponds to uncompressed data.  The
   // actual size of the unit read from disk may be smaller if
@@ -477,8 +483,8 @@ class TableFactory {
 
   // Returns SST file filter for pruning out files which doesn't contain some part of user_key.
   // It should be in sync with FilterPolicy used for bloom filter construction. For example,
-  // file filter should only consider hashed components of the key when using with
-  // DocDbAwareFilterPolicy and HashedComponentsExtractor.
+  // file filter should only consider the part of the key returned by the key transformer of
+  // DocDbAwareFilterPolicy.
   virtual std::shared_ptr<TableAwareReadFileFilter> NewTableAwareReadFileFilter(
       const ReadOptions &read_options, const Slice &user_key) const { return nullptr; }
 };
@@ -465,6 +465,9 @@ void BlockBasedTableBuilder::Add(const Slice& key, const Slice& value) {
         FlushFilterBlock(key);
       }
       r->filter_block_builder->Add(filter_key);
+      if (r->filter_key_transformer) {
+        AddCoarserFilterKeys(filter_key);
+      }
       r->last_filter_key.assign(filter_key.cdata(), filter_key.size());
     }
   }
@@ -482,6 +485,19 @@ void BlockBasedTableBuilder::Add(const Slice& key, const Slice& value) {
       r->ioptions.info_log);
 }
 
+void BlockBasedTableBuilder::AddCoarserFilterKeys(const Slice& filter_key) {
+  Rep* const r = rep_;
+  const Slice last_filter_key(r->last_filter_key);
+  for (auto key = r->filter_key_transformer->CoarserKey(filter_key); !key.empty();
+       key = r->filter_key_transformer->CoarserKey(key)) {
+    // Coarser keys of the previous filter key were already added.
+    if (r->props.num_entries > 0 && last_filter_key.starts_with(key)) {
+      break;
+    }
+    r->filter_block_builder->Add(key);
+  }
+}
+
 void BlockBasedTableBuilder::FlushDataBlock(const Slice& next_block_first_key) {
   Rep* const r = rep_;
   assert(!r->closed);
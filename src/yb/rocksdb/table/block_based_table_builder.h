@@ -135,6 +135,10 @@ class BlockBasedTableBuilder : public TableBuilder {
   // REQUIRES: Finish(), Abandon() have not been called.
   void FlushFilterBlock(const Slice& next_block_first_key);
 
+  // Adds keys for coarser lookups of the transformed key filter_key to the current filter block,
+  // see FilterPolicy::KeyTransformer::CoarserKey.
+  void AddCoarserFilterKeys(const Slice& filter_key);
+
   // Some compression libraries fail when the raw size is bigger than int. If
   // uncompressed size is bigger than kCompressionSizeLimit, don't compress it
   const uint64_t kCompressionSizeLimit = std::numeric_limits<int>::max();
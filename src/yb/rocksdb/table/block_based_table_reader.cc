@@ -23,7 +23,9 @@
 
 #include "yb/rocksdb/table/block_based_table_reader.h"
 
+#include <limits>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <cinttypes>
 
@@ -35,6 +37,7 @@
 #include "yb/rocksdb/filter_policy.h"
 #include "yb/rocksdb/iterator.h"
 #include "yb/rocksdb/options.h"
+#include "yb/rocksdb/pinned_blocks_budget.h"
 #include "yb/rocksdb/statistics.h"
 #include "yb/rocksdb/table.h"
 #include "yb/rocksdb/table_properties.h"
@@ -64,6 +67,7 @@
 #include "yb/gutil/macros.h"
 #include "yb/util/logging.h"
 #include "yb/util/atomic.h"
+#include "yb/util/locks.h"
 #include "yb/util/mem_tracker.h"
 
 namespace rocksdb {
@@ -97,20 +101,50 @@ void ReleaseCachedEntry(void* arg, void* h) {
   cache->Release(handle);
 }
 
+// Release the reference to the pinned entry.
+template <class Entry>
+void ReleasePinnedEntry(void* arg, void* /* unused */) {
+  delete static_cast<std::shared_ptr<Entry>*>(arg);
+}
+
+Tickers GetBlockCacheMissTicker(CacheBlockType block_type) {
+  switch (block_type) {
+    case CacheBlockType::kIndex:
+      return BLOCK_CACHE_INDEX_MISS;
+    case CacheBlockType::kFilter:
+      return BLOCK_CACHE_FILTER_MISS;
+    case CacheBlockType::kData:
+      return BLOCK_CACHE_DATA_MISS;
+  }
+  FATAL_INVALID_ENUM_VALUE(CacheBlockType, block_type);
+}
+
+Tickers GetBlockCacheHitTicker(CacheBlockType block_type) {
+  switch (block_type) {
+    case CacheBlockType::kIndex:
+      return BLOCK_CACHE_INDEX_HIT;
+    case CacheBlockType::kFilter:
+      return BLOCK_CACHE_FILTER_HIT;
+    case CacheBlockType::kData:
+      return BLOCK_CACHE_DATA_HIT;
+  }
+  FATAL_INVALID_ENUM_VALUE(CacheBlockType, block_type);
+}
+
 Cache::Handle* GetEntryFromCache(Cache* block_cache, const Slice& key,
-                                 Tickers block_cache_miss_ticker,
-                                 Tickers block_cache_hit_ticker,
+                                 CacheBlockType block_type,
                                  Statistics* statistics,
                                  const QueryId query_id) {
   auto cache_handle = block_cache->Lookup(key, query_id, statistics);
   if (cache_handle != nullptr) {
     PERF_COUNTER_ADD(block_cache_hit_count, 1);
     // block-type specific cache hit
-    RecordTick(statistics, block_cache_hit_ticker);
+    RecordTick(statistics, GetBlockCacheHitTicker(block_type));
   } else {
     // block-type specific cache miss
-    RecordTick(statistics, block_cache_miss_ticker);
+    RecordTick(statistics, GetBlockCacheMissTicker(block_type));
   }
+  block_cache->RecordLookup(block_type, cache_handle != nullptr);
 
   return cache_handle;
 }
@@ -155,22 +189,132 @@ struct BlockBasedTable::FileReaderWithCachePrefix {
 //  field `value` is the item we want to get.
 //  field `cache_handle` is the cache handle to the block cache. If the value
 //    was not read from cache, `cache_handle` will be nullptr.
+//  field `pinned` holds the reference to the value if it is pinned by the table, see
+//    BlockBasedTableOptions::pinned_blocks_budget.
 template <class TValue>
 struct BlockBasedTable::CachableEntry {
   CachableEntry(TValue* _value, Cache::Handle* _cache_handle)
       : value(_value), cache_handle(_cache_handle) {}
+  explicit CachableEntry(std::shared_ptr<TValue> _pinned)
+      : value(_pinned.get()), pinned(std::move(_pinned)) {}
   CachableEntry() : CachableEntry(nullptr, nullptr) {}
   void Release(Cache* cache) {
     if (cache_handle) {
       cache->Release(cache_handle);
       value = nullptr;
       cache_handle = nullptr;
+    } else if (pinned) {
+      value = nullptr;
+      pinned.reset();
     }
   }
 
   TValue* value = nullptr;
   // if the entry is from the cache, cache_handle will be populated.
   Cache::Handle* cache_handle = nullptr;
+  std::shared_ptr<TValue> pinned;
+};
+
+// Top-level data index reader and fixed-size filter blocks that the table keeps in memory within
+// BlockBasedTableOptions::pinned_blocks_budget. Blocks are pinned when they are loaded from the
+// file and all of them are dropped when the budget demotes the table, so they are loaded through
+// the block cache again. A block found in the block cache is pinned again if it fits into the
+// budget without demoting other tables, then it is moved out of the block cache. Readers hold shared references, so blocks could be dropped while in use.
+// Lookups take the lock in shared mode, so concurrent readers of a hot table do not wait for each
+// other, only pinning and unpinning are exclusive.
+class BlockBasedTable::PinnedBlocks : public PinnedBlocksBudget::Owner {
+ public:
+  explicit PinnedBlocks(PinnedBlocksBudget* budget) : Owner(budget) {}
+
+  ~PinnedBlocks() {
+    budget()->Unregister(this);
+  }
+
+  std::shared_ptr<IndexReader> data_index_reader() {
+    yb::shared_lock<yb::rw_spinlock> lock(mutex_);
+    if (data_index_reader_) {
+      Touch();
+    }
+    return data_index_reader_;
+  }
+
+  std::shared_ptr<FilterBlockReader> filter(uint64_t offset) {
+    yb::shared_lock<yb::rw_spinlock> lock(mutex_);
+    auto it = filters_.find(offset);
+    if (it == filters_.end()) {
+      return nullptr;
+    }
+    Touch();
+    return it->second;
+  }
+
+  // Takes ownership of the reader and returns it when it fits into the budget, demoting other
+  // tables if unpin_others is true. Otherwise returns nullptr and leaves the reader intact.
+  std::shared_ptr<IndexReader> PinDataIndexReader(
+      std::unique_ptr<IndexReader>* reader, bool unpin_others) {
+    std::shared_ptr<IndexReader> result;
+    Reserve((*reader)->usable_size(), unpin_others, [this, reader, &result] {
+      std::lock_guard<yb::rw_spinlock> lock(mutex_);
+      if (data_index_reader_) {
+        return false;
+      }
+      data_index_reader_.reset(reader->release());
+      result = data_index_reader_;
+      return true;
+    });
+    return result;
+  }
+
+  // Same as PinDataIndexReader for the filter block at the specified offset.
+  std::shared_ptr<FilterBlockReader> PinFilter(
+      uint64_t offset, size_t size, std::unique_ptr<FilterBlockReader>* filter,
+      bool unpin_others) {
+    std::shared_ptr<FilterBlockReader> result;
+    Reserve(size, unpin_others, [this, offset, filter, &result] {
+      std::lock_guard<yb::rw_spinlock> lock(mutex_);
+      auto& pinned = filters_[offset];
+      if (pinned) {
+        return false;
+      }
+      pinned.reset(filter->release());
+      result = pinned;
+      return true;
+    });
+    return result;
+  }
+
+  void Unpin() override {
+    std::lock_guard<yb::rw_spinlock> lock(mutex_);
+    data_index_reader_.reset();
+    filters_.clear();
+  }
+
+  // Returns whether the caller should pin again a block of the specified size found in the block
+  // cache. Only one block of the table is pinned again at a time, since that requires reading it
+  // from the file. If true is returned, the caller should invoke RepinDone after pinning.
+  bool StartRepin(size_t size) {
+    if (!budget()->HasRoom(size)) {
+      return false;
+    }
+    bool expected = false;
+    return repinning_.compare_exchange_strong(expected, true, std::memory_order_acq_rel);
+  }
+
+  void RepinDone() {
+    repinning_.store(false, std::memory_order_release);
+  }
+
+ private:
+  bool Reserve(size_t size, bool unpin_others, const std::function<bool()>& pin) {
+    return unpin_others ? budget()->Reserve(this, size, pin)
+                        : budget()->ReserveIfFree(this, size, pin);
+  }
+
+  std::atomic<bool> repinning_{false};
+  yb::rw_spinlock mutex_;
+  std::shared_ptr<IndexReader> data_index_reader_;
+  // Fixed-size filter blocks by offset of the block in the file.
+  std::unordered_map<uint64_t, std::shared_ptr<FilterBlockReader>> filters_;
 };
 
 struct BlockBasedTable::Rep {
@@ -196,6 +340,9 @@ struct BlockBasedTable::Rep {
     if (ioptions.mem_tracker) {
       mem_tracker = yb::MemTracker::FindOrCreateTracker("BlockBasedTable", ioptions.mem_tracker);
     }
+    if (_table_opt.pinned_blocks_budget && _table_opt.cache_index_and_filter_blocks) {
+      pinned_blocks = std::make_unique<PinnedBlocks>(_table_opt.pinned_blocks_budget.get());
+    }
   }
 
   const ImmutableCFOptions& ioptions;
@@ -235,11 +382,14 @@ struct BlockBasedTable::Rep {
   unique_ptr<SliceTransform> internal_prefix_transform;
   DataIndexLoadMode data_index_load_mode;
   yb::MemTrackerPtr mem_tracker;
+  // Set when the table pins index and filter blocks, see BlockBasedTableOptions.
+  std::unique_ptr<PinnedBlocks> pinned_blocks;
 };
 
-// BlockEntryIteratorState doesn't actually store any iterator state and is only used as an adapter
-// to BlockBasedTable. It is used by TwoLevelIterator and MultiLevelIterator to call BlockBasedTable
-// functions in order to check if prefix may match or to create a secondary iterator.
+// BlockEntryIteratorState is mostly an adapter to BlockBasedTable. It is used by TwoLevelIterator
+// and MultiLevelIterator to call BlockBasedTable functions in order to check if prefix may match or
+// to create a secondary iterator. The only state it stores is the readahead position of data block
+// iterators, see ReadOptions::readahead_size.
 class BlockBasedTable::BlockEntryIteratorState : public TwoLevelIteratorState {
  public:
   BlockEntryIteratorState(
@@ -252,6 +402,9 @@ class BlockBasedTable::BlockEntryIteratorState : public TwoLevelIteratorState {
         block_type_(block_type) {}
 
   InternalIterator* NewSecondaryIterator(const Slice& index_value) override {
+    if (read_options_.readahead_size > 0 && block_type_ == BlockType::kData) {
+      MaybeReadahead(index_value);
+    }
     return table_->NewDataBlockIterator(read_options_, index_value, block_type_);
   }
 
@@ -263,6 +416,25 @@ class BlockBasedTable::BlockEntryIteratorState : public TwoLevelIteratorState {
   }
 
  private:
+  // Starts reading ahead the following data blocks once the iterator moves from a data block to the
+  // next one in the file, so that point lookups and short scans do not pay for it.
+  void MaybeReadahead(const Slice& index_value) {
+    BlockHandle handle;
+    Slice input = index_value;
+    if (!handle.DecodeFrom(&input).ok()) {
+      // NewDataBlockIterator reports the error.
+      return;
+    }
+    const bool sequential = handle.offset() == next_block_offset_;
+    next_block_offset_ = handle.offset() + handle.size() + kBlockTrailerSize;
+    if (!sequential || next_block_offset_ <= readahead_limit_) {
+      return;
+    }
+    readahead_limit_ = handle.offset() + read_options_.readahead_size;
+    table_->GetBlockReader(BlockType::kData)->reader->file()->Readahead(
+        handle.offset(), read_options_.readahead_size);
+  }
+
   // Don't own table_. BlockEntryIteratorState should only be stored in iterators or in
   // corresponding BlockBasedTable. TableReader (superclass of BlockBasedTable) is only destroyed
   // after iterator is deleted.
@@ -270,6 +442,11 @@ class BlockBasedTable::BlockEntryIteratorState : public TwoLevelIteratorState {
   const ReadOptions read_options_;
   const bool skip_filters_;
   const BlockType block_type_;
+
+  // Offset of the data block following the last one that was read.
+  uint64_t next_block_offset_ = std::numeric_limits<uint64_t>::max();
+  // End of the range of the data file that was already read ahead.
+  uint64_t readahead_limit_ = 0;
 };
 
 
@@ -659,24 +836,20 @@ Status BlockBasedTable::ReadMetaBlock(Rep* rep,
 
 namespace {
 
-Tickers GetBlockCacheMissTicker(BlockType block_type) {
+CacheBlockType ToCacheBlockType(BlockType block_type) {
   switch (block_type) {
     case BlockType::kData:
-      return BLOCK_CACHE_DATA_MISS;
+      return CacheBlockType::kData;
     case BlockType::kIndex:
-      return BLOCK_CACHE_INDEX_MISS;
+      return CacheBlockType::kIndex;
   }
   FATAL_INVALID_ENUM_VALUE(BlockType, block_type);
 }
 
-Tickers GetBlockCacheHitTicker(BlockType block_type) {
-  switch (block_type) {
-    case BlockType::kData:
-      return BLOCK_CACHE_DATA_HIT;
-    case BlockType::kIndex:
-      return BLOCK_CACHE_INDEX_HIT;
-  }
-  FATAL_INVALID_ENUM_VALUE(BlockType, block_type);
+// Index blocks, including the blocks of multi-level index, are kept in the high priority part of
+// the block cache, so that scans reading many data blocks do not evict them.
+QueryId CacheInsertQueryId(const ReadOptions& read_options, BlockType block_type) {
+  return block_type == BlockType::kIndex ? kHighPriorityQueryId : read_options.query_id;
 }
 
 } // namespace
@@ -695,8 +868,8 @@ Status BlockBasedTable::GetDataBlockFromCache(
   if (block_cache != nullptr) {
     block->cache_handle =
         GetEntryFromCache(
-            block_cache, block_cache_key, GetBlockCacheMissTicker(block_type),
-            GetBlockCacheHitTicker(block_type), statistics, read_options.query_id);
+            block_cache, block_cache_key, ToCacheBlockType(block_type), statistics,
+            read_options.query_id);
     if (block->cache_handle != nullptr) {
       block->value =
           static_cast<Block*>(block_cache->Value(block->cache_handle));
@@ -738,9 +911,9 @@ Status BlockBasedTable::GetDataBlockFromCache(
     assert(block->value->compression_type() == kNoCompression);
     if (block_cache != nullptr && block->value->cachable() &&
         read_options.fill_cache) {
-      s = block_cache->Insert(block_cache_key, read_options.query_id, block->value,
-                              block->value->usable_size(), &DeleteCachedEntry<Block>,
-                              &block->cache_handle, statistics);
+      s = block_cache->Insert(block_cache_key, CacheInsertQueryId(read_options, block_type),
+                              block->value, block->value->usable_size(),
+                              &DeleteCachedEntry<Block>, &block->cache_handle, statistics);
       if (!s.ok()) {
         delete block->value;
         block->value = nullptr;
@@ -758,7 +931,7 @@ Status BlockBasedTable::PutDataBlockToCache(
     Cache* block_cache, Cache* block_cache_compressed,
     const ReadOptions& read_options, Statistics* statistics,
     CachableEntry<Block>* block, Block* raw_block, uint32_t format_version,
-    const std::shared_ptr<yb::MemTracker>& mem_tracker) {
+    BlockType block_type, const std::shared_ptr<yb::MemTracker>& mem_tracker) {
   assert(raw_block->compression_type() == kNoCompression ||
          block_cache_compressed != nullptr);
 
@@ -785,7 +958,8 @@ Status BlockBasedTable::PutDataBlockToCache(
   // Release the hold on the compressed cache entry immediately.
   if (block_cache_compressed != nullptr && raw_block != nullptr &&
       raw_block->cachable()) {
-    s = block_cache_compressed->Insert(compressed_block_cache_key, read_options.query_id, raw_block,
+    s = block_cache_compressed->Insert(compressed_block_cache_key,
+                                       CacheInsertQueryId(read_options, block_type), raw_block,
                                        raw_block->usable_size(), &DeleteCachedEntry<Block>);
     if (s.ok()) {
       // Avoid the following code to delete this cached block.
@@ -800,8 +974,8 @@ Status BlockBasedTable::PutDataBlockToCache(
   // insert into uncompressed block cache
   assert((block->value->compression_type() == kNoCompression));
   if (block_cache != nullptr && block->value->cachable()) {
-    s = block_cache->Insert(block_cache_key, read_options.query_id, block->value,
-                            block->value->usable_size(),
+    s = block_cache->Insert(block_cache_key, CacheInsertQueryId(read_options, block_type),
+                            block->value, block->value->usable_size(),
                             &DeleteCachedEntry<Block>, &block->cache_handle, statistics);
     if (!s.ok()) {
       delete block->value;
@@ -954,6 +1128,13 @@ BlockBasedTable::CachableEntry<FilterBlockReader> BlockBasedTable::GetFilter(
     filter_block_handle = &rep_->filter_handle;
   }
 
+  if (is_fixed_size_filter && rep_->pinned_blocks) {
+    auto pinned = rep_->pinned_blocks->filter(filter_block_handle->offset());
+    if (pinned) {
+      return CachableEntry<FilterBlockReader>(std::move(pinned));
+    }
+  }
+
   // Fetching from the cache
   char cache_key_buffer[block_based_table::kMaxCacheKeyPrefixSize + kMaxVarint64Length];
   auto filter_block_cache_key = GetCacheKey(rep_->base_reader_with_cache_prefix->cache_key_prefix,
@@ -961,11 +1142,29 @@ BlockBasedTable::CachableEntry<FilterBlockReader> BlockBasedTable::GetFilter(
 
   Statistics* statistics = rep_->ioptions.statistics;
   auto cache_handle = GetEntryFromCache(block_cache, filter_block_cache_key,
-      BLOCK_CACHE_FILTER_MISS, BLOCK_CACHE_FILTER_HIT, statistics, query_id);
+      CacheBlockType::kFilter, statistics, query_id);
 
   FilterBlockReader* filter = nullptr;
   if (cache_handle != nullptr) {
     filter = static_cast<FilterBlockReader*>(block_cache->Value(cache_handle));
+    if (!no_io && is_fixed_size_filter && rep_->pinned_blocks &&
+        rep_->pinned_blocks->StartRepin(block_cache->GetUsage(cache_handle))) {
+      size_t filter_size = 0;
+      std::unique_ptr<FilterBlockReader> filter_holder(
+          ReadFilterBlock(*filter_block_handle, rep_, &filter_size));
+      std::shared_ptr<FilterBlockReader> pinned;
+      if (filter_holder) {
+        pinned = rep_->pinned_blocks->PinFilter(
+            filter_block_handle->offset(), filter_size, &filter_holder,
+            false /* unpin_others */);
+      }
+      rep_->pinned_blocks->RepinDone();
+      if (pinned) {
+        block_cache->Release(cache_handle);
+        block_cache->Erase(filter_block_cache_key);
+        return CachableEntry<FilterBlockReader>(std::move(pinned));
+      }
+    }
   } else if (no_io && rep_->filter_type != FilterType::kFixedSizeFilter) {
     // Do not invoke any io.
     return CachableEntry<FilterBlockReader>();
@@ -974,9 +1173,18 @@ BlockBasedTable::CachableEntry<FilterBlockReader> BlockBasedTable::GetFilter(
     // loading necessary filter block through block cache.
     size_t filter_size = 0;
     filter = ReadFilterBlock(*filter_block_handle, rep_, &filter_size);
+    if (filter != nullptr && is_fixed_size_filter && rep_->pinned_blocks) {
+      std::unique_ptr<FilterBlockReader> filter_holder(filter);
+      auto pinned = rep_->pinned_blocks->PinFilter(
+          filter_block_handle->offset(), filter_size, &filter_holder, true /* unpin_others */);
+      if (pinned) {
+        return CachableEntry<FilterBlockReader>(std::move(pinned));
+      }
+      filter = filter_holder.release();
+    }
     if (filter != nullptr) {
       assert(filter_size > 0);
-      Status s = block_cache->Insert(filter_block_cache_key, query_id,
+      Status s = block_cache->Insert(filter_block_cache_key, kHighPriorityQueryId,
                                      filter, filter_size,
                                      &DeleteCachedEntry<FilterBlockReader>, &cache_handle,
                                      statistics);
@@ -1023,13 +1231,20 @@ InternalIterator* BlockBasedTable::NewIndexIterator(
 
   if (block_cache && (rep_->data_index_load_mode == DataIndexLoadMode::USE_CACHE ||
       rep_->table_options.cache_index_and_filter_blocks)) {
+    if (rep_->pinned_blocks) {
+      auto pinned = rep_->pinned_blocks->data_index_reader();
+      if (pinned) {
+        return NewPinnedIndexIterator(std::move(pinned), read_options, input_iter);
+      }
+    }
+
     char cache_key[block_based_table::kMaxCacheKeyPrefixSize + kMaxVarint64Length];
     auto key = GetCacheKey(rep_->base_reader_with_cache_prefix->cache_key_prefix,
         rep_->footer.index_handle(), cache_key);
     Statistics* statistics = rep_->ioptions.statistics;
     auto cache_handle =
-        GetEntryFromCache(block_cache, key, BLOCK_CACHE_INDEX_MISS,
-            BLOCK_CACHE_INDEX_HIT, statistics, read_options.query_id);
+        GetEntryFromCache(block_cache, key, CacheBlockType::kIndex, statistics,
+            read_options.query_id);
 
     if (cache_handle == nullptr && no_io) {
       return ReturnNoIOErrorIterator(input_iter);
@@ -1037,12 +1252,34 @@ InternalIterator* BlockBasedTable::NewIndexIterator(
 
     if (cache_handle != nullptr) {
       index_reader = static_cast<IndexReader*>(block_cache->Value(cache_handle));
+      if (!no_io && rep_->pinned_blocks &&
+          rep_->pinned_blocks->StartRepin(index_reader->usable_size())) {
+        std::unique_ptr<IndexReader> index_reader_unique;
+        std::shared_ptr<IndexReader> pinned;
+        if (CreateDataBlockIndexReader(&index_reader_unique).ok()) {
+          pinned = rep_->pinned_blocks->PinDataIndexReader(
+              &index_reader_unique, false /* unpin_others */);
+        }
+        rep_->pinned_blocks->RepinDone();
+        if (pinned) {
+          block_cache->Release(cache_handle);
+          block_cache->Erase(key);
+          return NewPinnedIndexIterator(std::move(pinned), read_options, input_iter);
+        }
+      }
     } else {
-    // Create index reader and put it in the cache.
+    // Create index reader and pin it or put it in the cache.
     std::unique_ptr<IndexReader> index_reader_unique;
     Status s = CreateDataBlockIndexReader(&index_reader_unique);
+    if (s.ok() && rep_->pinned_blocks) {
+      auto pinned = rep_->pinned_blocks->PinDataIndexReader(
+          &index_reader_unique, true /* unpin_others */);
+      if (pinned) {
+        return NewPinnedIndexIterator(std::move(pinned), read_options, input_iter);
+      }
+    }
     if (s.ok()) {
-      s = block_cache->Insert(key, read_options.query_id, index_reader_unique.get(),
+      s = block_cache->Insert(key, kHighPriorityQueryId, index_reader_unique.get(),
                               index_reader_unique->usable_size(),
                               &DeleteCachedEntry<IndexReader>, &cache_handle, statistics);
     }
@@ -1090,6 +1327,18 @@ InternalIterator* BlockBasedTable::NewIndexIterator(
   }
 }
 
+InternalIterator* BlockBasedTable::NewPinnedIndexIterator(
+    std::shared_ptr<IndexReader> index_reader, const ReadOptions& read_options,
+    BlockIter* input_iter) {
+  auto new_iter = index_reader->NewIterator(
+      input_iter, rep_->data_index_iterator_state.get(), read_options.total_order_seek);
+  auto iter = new_iter ? new_iter : implicit_cast<InternalIterator*>(input_iter);
+  iter->RegisterCleanup(
+      &ReleasePinnedEntry<IndexReader>, new std::shared_ptr<IndexReader>(std::move(index_reader)),
+      nullptr);
+  return new_iter;
+}
+
 // Convert an index iterator value (i.e., an encoded BlockHandle)
 // into an iterator over the contents of the corresponding block.
 // If input_iter is null, new a iterator
@@ -1154,7 +1403,8 @@ InternalIterator* BlockBasedTable::NewDataBlockIterator(const ReadOptions& ro,
       if (s.ok()) {
         s = PutDataBlockToCache(key, ckey, block_cache, block_cache_compressed,
                                 ro, statistics, &block, raw_block.release(),
-                                rep_->table_options.format_version, rep_->mem_tracker);
+                                rep_->table_options.format_version, block_type,
+                                rep_->mem_tracker);
       }
     }
   }
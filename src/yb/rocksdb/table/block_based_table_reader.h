@@ -82,11 +82,12 @@ enum class PrefetchFilter {
 
 YB_DEFINE_ENUM(BlockType, (kData)(kIndex));
 
-// BloomFilterAwareFileFilter should only be used when scanning within the same hashed components of
-// the key and it should be used together with DocDbAwareFilterPolicy which only takes into account
-// hashed components of key for filtering.
+// BloomFilterAwareFileFilter should only be used when scanning within keys that start with the
+// filter key of the key specified in constructor, i.e. the key transformed by the filter policy key
+// transformer. With DocDbAwareFilterPolicy it is a prefix of the key that consists of its hashed
+// components, whole DocKey or DocKey with the first subkey, depending on the policy.
 // BloomFilterAwareFileFilter ignores an SST file completely if there are no keys with the same
-// hashed components as the key specified in constructor.
+// filter key as the key specified in constructor.
 class BloomFilterAwareFileFilter : public TableAwareReadFileFilter {
  public:
   BloomFilterAwareFileFilter(const ReadOptions& read_options, const Slice& user_key);
@@ -202,6 +203,7 @@ class BlockBasedTable : public TableReader {
 
   class BlockEntryIteratorState;
   class IndexIteratorHolder;
+  class PinnedBlocks;
 
   // Returns filter block handle for fixed-size bloom filter using filter index and filter key.
   Status GetFixedSizeFilterBlockHandle(const Slice& filter_key,
@@ -233,12 +235,17 @@ class BlockBasedTable : public TableReader {
   // Note: ErrorIterator with Status::Incomplete shall be returned if all the
   // following conditions are met:
   //  1. We enabled table_options.cache_index_and_filter_blocks.
-  //  2. index is not present in block cache.
+  //  2. index is not present in block cache and is not pinned.
   //  3. We disallowed any io to be performed, that is, read_options ==
   //     kBlockCacheTier
   InternalIterator* NewIndexIterator(const ReadOptions& read_options,
                                      BlockIter* input_iter = nullptr);
 
+  // Same as NewIndexIterator for the index reader pinned by the table. The returned iterator keeps
+  // the reference to the reader.
+  InternalIterator* NewPinnedIndexIterator(std::shared_ptr<IndexReader> index_reader,
+                                           const ReadOptions& read_options, BlockIter* input_iter);
+
   // Read block cache from block caches (if set): block_cache and
   // block_cache_compressed.
   // On success, Status::OK with be returned and @block will be populated with
@@ -263,7 +270,7 @@ class BlockBasedTable : public TableReader {
       Cache* block_cache, Cache* block_cache_compressed,
       const ReadOptions& read_options, Statistics* statistics,
       CachableEntry<Block>* block, Block* raw_block, uint32_t format_version,
-      const std::shared_ptr<yb::MemTracker>& mem_tracker);
+      BlockType block_type, const std::shared_ptr<yb::MemTracker>& mem_tracker);
 
   // Calls (*handle_result)(arg, ...) repeatedly, starting with the entry found
   // after a call to Seek(key), until handle_result returns false.
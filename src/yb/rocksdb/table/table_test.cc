@@ -42,6 +42,7 @@
 #include "yb/rocksdb/iterator.h"
 #include "yb/rocksdb/memtablerep.h"
 #include "yb/rocksdb/perf_context.h"
+#include "yb/rocksdb/pinned_blocks_budget.h"
 #include "yb/rocksdb/slice_transform.h"
 #include "yb/rocksdb/statistics.h"
 #include "yb/rocksdb/table.h"
@@ -63,6 +64,9 @@
 #include "yb/rocksdb/util/testharness.h"
 #include "yb/rocksdb/util/testutil.h"
 #include "yb/util/enums.h"
+#include "yb/util/format.h"
+#include "yb/util/mem_tracker.h"
+#include "yb/util/test_macros.h"
 
 DECLARE_double(cache_single_touch_ratio);
 
@@ -2018,6 +2022,86 @@ TEST_F(BlockBasedTableTest, BlockCacheLeak) {
   }
 }
 
+TEST_F(BlockBasedTableTest, PinnedBlocksBudget) {
+  Options options;
+  options.compression = kNoCompression;
+  options.statistics = CreateDBStatistics();
+  BlockBasedTableOptions table_options;
+  table_options.block_size = 1024;
+  table_options.block_cache = NewLRUCache(16 * 1024 * 1024);
+  table_options.cache_index_and_filter_blocks = true;
+  const auto comparator = GetPlainInternalComparator(options.comparator);
+
+  auto make_budget = [](int64_t limit) {
+    return std::make_shared<PinnedBlocksBudget>(yb::MemTracker::CreateTracker(
+        limit, "PinnedBlocksBudget", nullptr, yb::AddToParent::kFalse));
+  };
+  auto index_misses = [&options] {
+    return options.statistics->getTickerCount(BLOCK_CACHE_INDEX_MISS);
+  };
+  auto index_hits = [&options] {
+    return options.statistics->getTickerCount(BLOCK_CACHE_INDEX_HIT);
+  };
+  auto read = [](TableConstructor* table) {
+    unique_ptr<InternalIterator> iter(table->NewIterator());
+    iter->SeekToFirst();
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_OK(iter->status());
+  };
+
+  // Both tables have the same keys, so their data indexes have the same size. Measure it with a
+  // budget that fits everything.
+  auto budget = make_budget(1024 * 1024 * 1024);
+  table_options.pinned_blocks_budget = budget;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  const ImmutableCFOptions ioptions(options);
+  TableConstructor first(BytewiseComparator()), second(BytewiseComparator());
+  for (auto* table : {&first, &second}) {
+    for (int i = 0; i < 1000; ++i) {
+      table->Add(yb::Format("k$0", 100000 + i), std::string(100, 'v'));
+    }
+    std::vector<std::string> keys;
+    stl_wrappers::KVMap kvmap;
+    table->Finish(options, ioptions, table_options, comparator, &keys, &kvmap);
+  }
+  ASSERT_NO_FATALS(read(&first));
+  const int64_t index_size = budget->consumption();
+  ASSERT_GT(index_size, 0);
+
+  // Reopen both tables with a budget that fits a single data index.
+  budget = make_budget(index_size * 3 / 2);
+  table_options.pinned_blocks_budget = budget;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  const ImmutableCFOptions ioptions_with_small_budget(options);
+  ASSERT_OK(first.Reopen(ioptions_with_small_budget));
+  ASSERT_OK(second.Reopen(ioptions_with_small_budget));
+  const auto initial_misses = index_misses();
+  const auto initial_hits = index_hits();
+
+  // The index is loaded from the file and pinned instead of being added to the block cache.
+  ASSERT_NO_FATALS(read(&first));
+  ASSERT_EQ(initial_misses + 1, index_misses());
+  ASSERT_EQ(index_size, budget->consumption());
+
+  // The pinned index is used without looking it up in the block cache.
+  ASSERT_NO_FATALS(read(&first));
+  ASSERT_EQ(initial_misses + 1, index_misses());
+  ASSERT_EQ(initial_hits, index_hits());
+
+  // Pinning the index of the second table demotes the first table.
+  ASSERT_NO_FATALS(read(&second));
+  ASSERT_EQ(initial_misses + 2, index_misses());
+  ASSERT_EQ(index_size, budget->consumption());
+
+  // The first table loads its index again and pins it, demoting the second table.
+  ASSERT_NO_FATALS(read(&first));
+  ASSERT_EQ(initial_misses + 3, index_misses());
+  ASSERT_EQ(index_size, budget->consumption());
+  ASSERT_NO_FATALS(read(&first));
+  ASSERT_EQ(initial_misses + 3, index_misses());
+  ASSERT_EQ(initial_hits, index_hits());
+}
+
 // Plain table is not supported in ROCKSDB_LITE
 #ifndef ROCKSDB_LITE
 TEST_F(PlainTableTest, BasicPlainTableProperties) {
@@ -78,6 +78,10 @@ namespace {
 // that are accessed multiple times by different queries.
 // query_id == kNoCacheQueryId means that this Handle is not going to be added
 // into the cache.
+// query_id == kHighPriorityQueryId means that the handle is an index or filter block. If the
+// cache has a high priority part, such handles live there. Only other high priority values evict
+// them from its reserved capacity, space they borrowed from the data part is given back to data
+// blocks. Otherwise they are treated like handles in the multi touch cache.
 
 struct LRUHandle {
   void* value;
@@ -112,6 +116,8 @@ struct LRUHandle {
         metrics->multi_touch_cache_usage->DecrementBy(charge);
       } else if (GetSubCacheType() == SINGLE_TOUCH) {
         metrics->single_touch_cache_usage->DecrementBy(charge);
+      } else if (GetSubCacheType() == HIGH_PRIORITY) {
+        metrics->high_priority_cache_usage->DecrementBy(charge);
       }
       metrics->cache_usage->DecrementBy(charge);
     }
@@ -119,7 +125,11 @@ struct LRUHandle {
   }
 
   SubCacheType GetSubCacheType() const {
-    return (query_id == kInMultiTouchId) ? MULTI_TOUCH : SINGLE_TOUCH;
+    switch (query_id) {
+      case kInMultiTouchId: return MULTI_TOUCH;
+      case kHighPriorityQueryId: return HIGH_PRIORITY;
+      default: return SINGLE_TOUCH;
+    }
   }
 };
 
@@ -165,8 +175,8 @@ class HandleTable {
   // It checks to see if the same value is in the multi touch cache, or if it is in the single
   // touch cache, checks to see if the query ids are different.
   SubCacheType GetSubCacheTypeCandidate(LRUHandle* h) {
-    if (h->GetSubCacheType() == MULTI_TOUCH) {
-      return MULTI_TOUCH;
+    if (h->GetSubCacheType() != SINGLE_TOUCH) {
+      return h->GetSubCacheType();
     }
 
     LRUHandle* val = Lookup(h->key(), h->hash);
@@ -364,6 +374,12 @@ class LRUCache {
   // free the needed space
   void SetCapacity(size_t capacity);
 
+  // Sets the fraction of the capacity used for high priority values, takes effect on the next
+  // SetCapacity call.
+  void SetHighPriorityRatio(double high_priority_ratio) {
+    high_priority_ratio_ = high_priority_ratio;
+  }
+
   void SetMetrics(shared_ptr<yb::CacheMetrics> metrics) {
     metrics_ = metrics;
     table_.SetMetrics(metrics);
@@ -387,12 +403,14 @@ class LRUCache {
 
   size_t GetUsage() const {
     MutexLock l(&mutex_);
-    return single_touch_sub_cache_.Usage() + multi_touch_sub_cache_.Usage();
+    return single_touch_sub_cache_.Usage() + multi_touch_sub_cache_.Usage() +
+           high_priority_sub_cache_.Usage();
   }
 
   size_t GetPinnedUsage() const {
     MutexLock l(&mutex_);
-    return single_touch_sub_cache_.GetPinnedUsage() + multi_touch_sub_cache_.GetPinnedUsage();
+    return single_touch_sub_cache_.GetPinnedUsage() + multi_touch_sub_cache_.GetPinnedUsage() +
+           high_priority_sub_cache_.GetPinnedUsage();
   }
 
   void ApplyToAllCacheEntries(void (*callback)(void*, size_t),
@@ -407,6 +425,7 @@ class LRUCache {
   LRUSubCache* GetSubCache(const SubCacheType subcache_type);
   LRUSubCache single_touch_sub_cache_;
   LRUSubCache multi_touch_sub_cache_;
+  LRUSubCache high_priority_sub_cache_;
   // Just reduce the reference count by 1.
   // Return true if last reference
   bool Unref(LRUHandle* e);
@@ -417,12 +436,24 @@ class LRUCache {
   // holding the mutex_
   void EvictFromLRU(size_t charge, autovector<LRUHandle*>* deleted, SubCacheType subcache_type);
 
+  // Removes the oldest entry of the sub cache LRU list from the cache.
+  void EvictOldest(LRUSubCache* sub_cache, autovector<LRUHandle*>* deleted);
+
+  // Capacity that the sub cache can currently fill. The high priority sub cache may borrow the
+  // part of the data block sub caches capacity that they do not use, data blocks take it back on
+  // insertion.
+  size_t AvailableCapacity(const LRUSubCache* sub_cache) const;
+
   // Decrements the usage on the appropriate subcache.
   void DecrementUsage(const SubCacheType subcache_type, const size_t charge);
 
   // Whether to reject insertion if cache reaches its full capacity.
   bool strict_capacity_limit_;
 
+  // Fraction of the capacity used by high_priority_sub_cache_. When it is 0, high priority values
+  // are kept in multi_touch_sub_cache_.
+  double high_priority_ratio_ = 0;
+
   // mutex_ protects the following state.
   // We don't count mutex_ as the cache's internal state so semantically we
   // don't mind mutex_ invoking the non-const actions.
@@ -444,13 +475,16 @@ bool LRUCache::Unref(LRUHandle* e) {
 }
 
 LRUSubCache* LRUCache::GetSubCache(const SubCacheType subcache_type) {
+  if (subcache_type == SubCacheType::HIGH_PRIORITY && high_priority_ratio_ > 0) {
+    return &high_priority_sub_cache_;
+  }
   if (FLAGS_cache_single_touch_ratio == 0) {
     return &multi_touch_sub_cache_;
   } else if (FLAGS_cache_single_touch_ratio == 1) {
     return &single_touch_sub_cache_;
   }
-  return (subcache_type == SubCacheType::MULTI_TOUCH) ? &multi_touch_sub_cache_ :
-                                                        &single_touch_sub_cache_;
+  return (subcache_type == SubCacheType::SINGLE_TOUCH) ? &single_touch_sub_cache_ :
+                                                         &multi_touch_sub_cache_;
 }
 
 void LRUCache::DecrementUsage(const SubCacheType subcache_type, const size_t charge) {
@@ -482,19 +516,48 @@ void LRUCache::LRU_Append(LRUHandle* e) {
 }
 
 
+void LRUCache::EvictOldest(LRUSubCache* sub_cache, autovector<LRUHandle*>* deleted) {
+  LRUHandle* old = sub_cache->LRU_Head().next;
+  assert(old->in_cache);
+  assert(old->refs == 1);  // LRU list contains elements which may be evicted
+  sub_cache->LRU_Remove(old);
+  table_.Remove(old->key(), old->hash);
+  old->in_cache = false;
+  Unref(old);
+  sub_cache->DecrementUsage(old->charge);
+  deleted->push_back(old);
+}
+
+size_t LRUCache::AvailableCapacity(const LRUSubCache* sub_cache) const {
+  if (sub_cache != &high_priority_sub_cache_) {
+    return sub_cache->Capacity();
+  }
+  const size_t data_capacity =
+      single_touch_sub_cache_.Capacity() + multi_touch_sub_cache_.Capacity();
+  const size_t data_usage = single_touch_sub_cache_.Usage() + multi_touch_sub_cache_.Usage();
+  return sub_cache->Capacity() + (data_capacity > data_usage ? data_capacity - data_usage : 0);
+}
+
 void LRUCache::EvictFromLRU(size_t charge, autovector<LRUHandle*>* deleted,
                             SubCacheType subcache_type) {
   LRUSubCache* sub_cache = GetSubCache(subcache_type);
-  while (sub_cache->Usage() + charge > sub_cache->Capacity() && !sub_cache->IsLRUEmpty()) {
-    LRUHandle* old = sub_cache->LRU_Head().next;
-    assert(old->in_cache);
-    assert(old->refs == 1);  // LRU list contains elements which may be evicted
-    sub_cache->LRU_Remove(old);
-    table_.Remove(old->key(), old->hash);
-    old->in_cache = false;
-    Unref(old);
-    sub_cache->DecrementUsage(old->charge);
-    deleted->push_back(old);
+  while (sub_cache->Usage() + charge > AvailableCapacity(sub_cache) &&
+         !sub_cache->IsLRUEmpty()) {
+    EvictOldest(sub_cache, deleted);
+  }
+  if (sub_cache == &high_priority_sub_cache_) {
+    return;
+  }
+  // Take back the space borrowed by high priority values, but not their reserved capacity.
+  const size_t data_capacity =
+      single_touch_sub_cache_.Capacity() + multi_touch_sub_cache_.Capacity();
+  const size_t data_usage =
+      single_touch_sub_cache_.Usage() + multi_touch_sub_cache_.Usage() + charge;
+  const size_t lendable = data_capacity > data_usage ? data_capacity - data_usage : 0;
+  LRUSubCache* high_priority = &high_priority_sub_cache_;
+  while (high_priority->Usage() > high_priority->Capacity() + lendable &&
+         !high_priority->IsLRUEmpty()) {
+    EvictOldest(high_priority, deleted);
   }
 }
 
@@ -502,11 +565,15 @@ void LRUCache::SetCapacity(size_t capacity) {
   autovector<LRUHandle*> last_reference_list;
   {
     MutexLock l(&mutex_);
+    high_priority_sub_cache_.SetCapacity(
+      static_cast<size_t>(round(high_priority_ratio_ * capacity)));
+    capacity -= high_priority_sub_cache_.Capacity();
     single_touch_sub_cache_.SetCapacity(
       static_cast<size_t>(round(FLAGS_cache_single_touch_ratio * capacity)));
     multi_touch_sub_cache_.SetCapacity(capacity - single_touch_sub_cache_.Capacity());
     EvictFromLRU(0, &last_reference_list, SINGLE_TOUCH);
     EvictFromLRU(0, &last_reference_list, MULTI_TOUCH);
+    EvictFromLRU(0, &last_reference_list, HIGH_PRIORITY);
   }
   // we free the entries here outside of mutex for
   // performance reasons
@@ -534,7 +601,7 @@ Cache::Handle* LRUCache::Lookup(const Slice& key, uint32_t hash, const QueryId q
     e->refs++;
 
     // Now the handle will be added to the multi touch pool only if it exists.
-    if (FLAGS_cache_single_touch_ratio < 1 && e->GetSubCacheType() != MULTI_TOUCH &&
+    if (FLAGS_cache_single_touch_ratio < 1 && e->GetSubCacheType() == SINGLE_TOUCH &&
         e->query_id != query_id) {
       autovector<LRUHandle*> multi_touch_eviction_list;
       EvictFromLRU(e->charge, &multi_touch_eviction_list, MULTI_TOUCH);
@@ -601,7 +668,7 @@ void LRUCache::Release(Cache::Handle* handle) {
     }
     if (e->refs == 1 && e->in_cache) {
       // The item is still in cache, and nobody else holds a reference to it
-      if (sub_cache->Usage() > sub_cache->Capacity()) {
+      if (sub_cache->Usage() > AvailableCapacity(sub_cache)) {
         // The LRU list must be empty since the cache is full.
         assert(sub_cache->IsLRUEmpty());
         // take this opportunity and remove the item
@@ -658,7 +725,9 @@ Status LRUCache::Insert(const Slice& key, uint32_t hash, const QueryId query_id,
     // is freed or the lru list is empty.
     // Check if there is a single touch cache.
     SubCacheType subcache_type;
-    if (FLAGS_cache_single_touch_ratio == 0) {
+    if (e->GetSubCacheType() == HIGH_PRIORITY) {
+      subcache_type = HIGH_PRIORITY;
+    } else if (FLAGS_cache_single_touch_ratio == 0) {
       e->query_id = kInMultiTouchId;
       subcache_type = MULTI_TOUCH;
     } else if (FLAGS_cache_single_touch_ratio == 1) {
@@ -671,7 +740,7 @@ Status LRUCache::Insert(const Slice& key, uint32_t hash, const QueryId query_id,
     LRUSubCache* sub_cache = GetSubCache(subcache_type);
     // If the cache no longer has any more space in the given pool.
     if (strict_capacity_limit_ &&
-        sub_cache->Usage() - sub_cache->LRU_Usage() + charge > sub_cache->Capacity()) {
+        sub_cache->Usage() - sub_cache->LRU_Usage() + charge > AvailableCapacity(sub_cache)) {
       if (handle == nullptr) {
         last_reference_list.push_back(e);
       } else {
@@ -721,6 +790,8 @@ Status LRUCache::Insert(const Slice& key, uint32_t hash, const QueryId query_id,
     if (metrics_ != nullptr) {
       if (subcache_type == MULTI_TOUCH) {
         metrics_->multi_touch_cache_usage->IncrementBy(charge);
+      } else if (subcache_type == HIGH_PRIORITY) {
+        metrics_->high_priority_cache_usage->IncrementBy(charge);
       } else {
         metrics_->single_touch_cache_usage->IncrementBy(charge);
       }
@@ -785,12 +856,13 @@ class ShardedLRUCache : public Cache {
   }
 
   bool IsValidQueryId(const QueryId query_id) {
-    return query_id >= 0 || query_id == kInMultiTouchId || query_id == kNoCacheQueryId;
+    return query_id >= 0 || query_id == kInMultiTouchId || query_id == kNoCacheQueryId ||
+           query_id == kHighPriorityQueryId;
   }
 
  public:
   ShardedLRUCache(size_t capacity, int num_shard_bits,
-                  bool strict_capacity_limit)
+                  bool strict_capacity_limit, double high_priority_ratio)
       : last_id_(0),
         num_shard_bits_(num_shard_bits),
         capacity_(capacity),
@@ -800,6 +872,7 @@ class ShardedLRUCache : public Cache {
     shards_ = new LRUCache[num_shards];
     const size_t per_shard = (capacity + (num_shards - 1)) / num_shards;
     for (int s = 0; s < num_shards; s++) {
+      shards_[s].SetHighPriorityRatio(high_priority_ratio);
       shards_[s].SetCapacity(per_shard);
       shards_[s].SetStrictCapacityLimit(strict_capacity_limit);
     }
@@ -921,6 +994,23 @@ class ShardedLRUCache : public Cache {
       shards_[s].SetMetrics(metrics_);
     }
   }
+
+  void RecordLookup(CacheBlockType block_type, bool hit) override {
+    if (metrics_ == nullptr) {
+      return;
+    }
+    switch (block_type) {
+      case CacheBlockType::kIndex:
+        (hit ? metrics_->index_hits : metrics_->index_misses)->Increment();
+        return;
+      case CacheBlockType::kFilter:
+        (hit ? metrics_->filter_hits : metrics_->filter_misses)->Increment();
+        return;
+      case CacheBlockType::kData:
+        (hit ? metrics_->data_hits : metrics_->data_misses)->Increment();
+        return;
+    }
+  }
 };
 
 }  // end anonymous namespace
@@ -934,12 +1024,15 @@ shared_ptr<Cache> NewLRUCache(size_t capacity, int num_shard_bits) {
 }
 
 shared_ptr<Cache> NewLRUCache(size_t capacity, int num_shard_bits,
-                              bool strict_capacity_limit) {
+                              bool strict_capacity_limit, double high_priority_ratio) {
   if (num_shard_bits >= 20) {
     return nullptr;  // the cache cannot be sharded into too many fine pieces
   }
+  if (high_priority_ratio < 0 || high_priority_ratio >= 1) {
+    return nullptr;
+  }
   return std::make_shared<ShardedLRUCache>(capacity, num_shard_bits,
-                                           strict_capacity_limit);
+                                           strict_capacity_limit, high_priority_ratio);
 }
 
 }  // namespace rocksdb
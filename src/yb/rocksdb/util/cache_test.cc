@@ -463,6 +463,47 @@ TEST_F(CacheTest, EvictionPolicyMultiTouch) {
   ASSERT_LT(kCacheSize * FLAGS_cache_single_touch_ratio, cache_->GetUsage());
 }
 
+TEST_F(CacheTest, EvictionPolicyHighPriority) {
+  const int kCapacity = 100;
+  const int kHighPriorityCapacity = 10;
+  auto cache = NewLRUCache(kCapacity, 0, false, 0.1);
+
+  // While data blocks do not use the cache, high priority values may fill all of it.
+  for (int i = 0; i < kCapacity; i++) {
+    ASSERT_OK(Insert(cache, i, i + 1, 1, kHighPriorityQueryId));
+  }
+  ASSERT_EQ(kCapacity, cache->GetUsage());
+  for (int i = 0; i < kCapacity; i++) {
+    Cache::Handle* handle = cache->Lookup(EncodeKey(i), kTestQueryId);
+    ASSERT_NE(nullptr, handle);
+    ASSERT_EQ(HIGH_PRIORITY, cache->GetSubCacheType(handle));
+    cache->Release(handle);
+  }
+
+  // Data blocks take back the space they need, both values touched by different queries and values
+  // touched once, but do not evict high priority values from the reserved part of the cache.
+  QueryId qid = 1000;
+  for (int i = 0; i < 2 * kCapacity; i++) {
+    ASSERT_OK(Insert(cache, kCapacity + i, i, 1, qid + i));
+    ASSERT_EQ(i, Lookup(cache, kCapacity + i, qid + i + 1));
+  }
+  for (int i = 0; i < 2 * kCapacity; i++) {
+    ASSERT_OK(Insert(cache, 3 * kCapacity + i, i, 1, qid + i));
+  }
+  ASSERT_EQ(kCapacity, cache->GetUsage());
+  // The most recently used high priority values are kept.
+  for (int i = 0; i < kCapacity; i++) {
+    ASSERT_EQ(i < kCapacity - kHighPriorityCapacity ? -1 : i + 1, Lookup(cache, i));
+  }
+
+  // Once the cache is full, high priority values are evicted by each other.
+  ASSERT_OK(Insert(cache, 10 * kCapacity, 0, 1, kHighPriorityQueryId));
+  ASSERT_EQ(-1, Lookup(cache, kCapacity - kHighPriorityCapacity));
+  ASSERT_EQ(kCapacity - kHighPriorityCapacity + 2,
+            Lookup(cache, kCapacity - kHighPriorityCapacity + 1));
+  ASSERT_EQ(kCapacity, cache->GetUsage());
+}
+
 TEST_F(CacheTest, HeavyEntries) {
   // Add a bunch of light and heavy entries and then count the combined
   // size of items still in the cache, which must be approximately the
@@ -223,6 +223,12 @@ void PosixRandomAccessFile::Hint(AccessPattern pattern) {
   }
 }
 
+void PosixRandomAccessFile::Readahead(uint64_t offset, size_t length) {
+  if (use_os_buffer_) {
+    Fadvise(fd_, offset, length, POSIX_FADV_WILLNEED);
+  }
+}
+
 Status PosixRandomAccessFile::InvalidateCache(size_t offset, size_t length) {
 #ifndef OS_LINUX
   return Status::OK();
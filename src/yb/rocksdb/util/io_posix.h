@@ -75,6 +75,7 @@ class PosixRandomAccessFile : public RandomAccessFile {
   virtual size_t GetUniqueId(char* id, size_t max_size) const override;
 #endif
   virtual void Hint(AccessPattern pattern) override;
+  virtual void Readahead(uint64_t offset, size_t length) override;
   virtual Status InvalidateCache(size_t offset, size_t length) override;
 };
 
@@ -0,0 +1,122 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/rocksdb/pinned_blocks_budget.h"
+
+#include "yb/util/logging.h"
+#include "yb/util/mem_tracker.h"
+
+namespace rocksdb {
+
+PinnedBlocksBudget::PinnedBlocksBudget(std::shared_ptr<yb::MemTracker> mem_tracker)
+    : mem_tracker_(std::move(mem_tracker)) {
+  CHECK(mem_tracker_->has_limit());
+}
+
+PinnedBlocksBudget::~PinnedBlocksBudget() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  LOG_IF(DFATAL, !owners_.empty())
+      << "Pinned blocks budget destroyed with " << owners_.size() << " registered owners";
+}
+
+bool PinnedBlocksBudget::Reserve(Owner* owner, size_t bytes, const std::function<bool()>& pin) {
+  return DoReserve(owner, bytes, true /* unpin_others */, pin);
+}
+
+bool PinnedBlocksBudget::ReserveIfFree(
+    Owner* owner, size_t bytes, const std::function<bool()>& pin) {
+  return DoReserve(owner, bytes, false /* unpin_others */, pin);
+}
+
+bool PinnedBlocksBudget::HasRoom(size_t bytes) const {
+  return mem_tracker_->consumption() + static_cast<int64_t>(bytes) <= mem_tracker_->limit();
+}
+
+bool PinnedBlocksBudget::DoReserve(
+    Owner* owner, size_t bytes, bool unpin_others, const std::function<bool()>& pin) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  owner->last_use_.store(Now(), std::memory_order_relaxed);
+  // Blocks of the owner itself are never demoted to make room for its own block.
+  if (owner->reserved_bytes_ + bytes > static_cast<size_t>(mem_tracker_->limit())) {
+    return false;
+  }
+
+  while (!mem_tracker_->TryConsume(bytes)) {
+    if (!unpin_others) {
+      return false;
+    }
+    UnpinLeastRecentlyUsed(owner);
+  }
+
+  if (!pin()) {
+    mem_tracker_->Release(bytes);
+    return false;
+  }
+  MoveToFront(owner);
+  owner->reserved_bytes_ += bytes;
+  return true;
+}
+
+void PinnedBlocksBudget::MoveToFront(Owner* owner) {
+  if (owner->reserved_bytes_) {
+    owners_.splice(owners_.begin(), owners_, owner->position_);
+  } else {
+    owners_.push_front(owner);
+    owner->position_ = owners_.begin();
+  }
+  owner->queued_use_ = owner->last_use_.load(std::memory_order_relaxed);
+}
+
+void PinnedBlocksBudget::UnpinLeastRecentlyUsed(Owner* owner) {
+  // Other owners hold the consumed bytes, since the block fits if only this owner holds bytes.
+  // Each owner gets at most one second chance, so the loop ends even if owners are used
+  // concurrently.
+  size_t second_chances_left = owners_.size();
+  for (;;) {
+    CHECK(!owners_.empty());
+    Owner* candidate = owners_.back();
+    if (candidate == owner ||
+        (second_chances_left &&
+         candidate->last_use_.load(std::memory_order_relaxed) != candidate->queued_use_)) {
+      MoveToFront(candidate);
+      if (second_chances_left) {
+        --second_chances_left;
+      }
+      continue;
+    }
+    candidate->Unpin();
+    mem_tracker_->Release(candidate->reserved_bytes_);
+    candidate->reserved_bytes_ = 0;
+    owners_.pop_back();
+    return;
+  }
+}
+
+void PinnedBlocksBudget::Unregister(Owner* owner) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (owner->reserved_bytes_) {
+    mem_tracker_->Release(owner->reserved_bytes_);
+    owner->reserved_bytes_ = 0;
+    owners_.erase(owner->position_);
+  }
+}
+
+int64_t PinnedBlocksBudget::limit() const {
+  return mem_tracker_->limit();
+}
+
+int64_t PinnedBlocksBudget::consumption() const {
+  return mem_tracker_->consumption();
+}
+
+}  // namespace rocksdb
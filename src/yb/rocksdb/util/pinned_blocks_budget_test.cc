@@ -0,0 +1,160 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/rocksdb/pinned_blocks_budget.h"
+
+#include <thread>
+
+#include "yb/rocksdb/util/testharness.h"
+#include "yb/util/mem_tracker.h"
+
+namespace rocksdb {
+
+namespace {
+
+class TestOwner : public PinnedBlocksBudget::Owner {
+ public:
+  explicit TestOwner(PinnedBlocksBudget* budget) : Owner(budget) {}
+
+  ~TestOwner() {
+    budget()->Unregister(this);
+  }
+
+  bool Pin(size_t bytes) {
+    return budget()->Reserve(this, bytes, [this, bytes] {
+      pinned_bytes_ += bytes;
+      return true;
+    });
+  }
+
+  bool PinIfFree(size_t bytes) {
+    return budget()->ReserveIfFree(this, bytes, [this, bytes] {
+      pinned_bytes_ += bytes;
+      return true;
+    });
+  }
+
+  void Unpin() override {
+    pinned_bytes_ = 0;
+  }
+
+  size_t pinned_bytes() const { return pinned_bytes_; }
+
+ private:
+  size_t pinned_bytes_ = 0;
+};
+
+// Owners used within the same tick of the coarse clock are ordered arbitrarily.
+void WaitForClockTick() {
+  const auto start = yb::CoarseMonoClock::Now();
+  while (yb::CoarseMonoClock::Now() == start) {
+    std::this_thread::yield();
+  }
+}
+
+} // namespace
+
+class PinnedBlocksBudgetTest : public testing::Test {
+ protected:
+  PinnedBlocksBudgetTest()
+      : budget_(yb::MemTracker::CreateTracker(
+            100, "PinnedBlocksBudgetTest", nullptr, yb::AddToParent::kFalse)) {}
+
+  PinnedBlocksBudget budget_;
+};
+
+TEST_F(PinnedBlocksBudgetTest, DemoteLeastRecentlyUsed) {
+  TestOwner first(&budget_), second(&budget_), third(&budget_);
+  ASSERT_TRUE(first.Pin(40));
+  WaitForClockTick();
+  ASSERT_TRUE(second.Pin(40));
+  ASSERT_EQ(80, budget_.consumption());
+
+  // The first owner is used after the second one was pinned, so the second one is demoted.
+  WaitForClockTick();
+  first.Touch();
+  WaitForClockTick();
+  ASSERT_TRUE(third.Pin(40));
+  ASSERT_EQ(40, first.pinned_bytes());
+  ASSERT_EQ(0, second.pinned_bytes());
+  ASSERT_EQ(40, third.pinned_bytes());
+  ASSERT_EQ(80, budget_.consumption());
+
+  WaitForClockTick();
+  third.Touch();
+  WaitForClockTick();
+  ASSERT_TRUE(second.Pin(40));
+  ASSERT_EQ(0, first.pinned_bytes());
+  ASSERT_EQ(40, second.pinned_bytes());
+  ASSERT_EQ(80, budget_.consumption());
+}
+
+TEST_F(PinnedBlocksBudgetTest, DoesNotDemoteItself) {
+  TestOwner first(&budget_), second(&budget_);
+  ASSERT_TRUE(first.Pin(30));
+  ASSERT_TRUE(second.Pin(60));
+
+  // Block does not fit even if all other owners are demoted.
+  ASSERT_FALSE(second.Pin(50));
+  ASSERT_EQ(30, first.pinned_bytes());
+  ASSERT_EQ(60, second.pinned_bytes());
+
+  ASSERT_TRUE(second.Pin(40));
+  ASSERT_EQ(0, first.pinned_bytes());
+  ASSERT_EQ(100, second.pinned_bytes());
+  ASSERT_EQ(100, budget_.consumption());
+}
+
+TEST_F(PinnedBlocksBudgetTest, PinIfFree) {
+  TestOwner first(&budget_), second(&budget_);
+  ASSERT_TRUE(first.Pin(60));
+  ASSERT_TRUE(budget_.HasRoom(40));
+  ASSERT_FALSE(budget_.HasRoom(50));
+
+  // Blocks pinned again after a block cache hit never demote other owners.
+  ASSERT_FALSE(second.PinIfFree(50));
+  ASSERT_EQ(60, first.pinned_bytes());
+  ASSERT_EQ(0, second.pinned_bytes());
+
+  ASSERT_TRUE(second.PinIfFree(40));
+  ASSERT_EQ(40, second.pinned_bytes());
+  ASSERT_EQ(100, budget_.consumption());
+
+  // Owner pinned by PinIfFree is queued as the most recently used one.
+  TestOwner third(&budget_);
+  ASSERT_TRUE(third.Pin(60));
+  ASSERT_EQ(0, first.pinned_bytes());
+  ASSERT_EQ(40, second.pinned_bytes());
+  ASSERT_EQ(60, third.pinned_bytes());
+  ASSERT_EQ(100, budget_.consumption());
+}
+
+TEST_F(PinnedBlocksBudgetTest, NotPinned) {
+  TestOwner owner(&budget_);
+  ASSERT_FALSE(budget_.Reserve(&owner, 10, [] { return false; }));
+  ASSERT_EQ(0, budget_.consumption());
+
+  {
+    TestOwner other(&budget_);
+    ASSERT_TRUE(other.Pin(10));
+    ASSERT_EQ(10, budget_.consumption());
+  }
+  ASSERT_EQ(0, budget_.consumption());
+}
+
+}  // namespace rocksdb
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -45,6 +45,9 @@ Result<size_t> BinaryCallParser::Parse(const rpc::ConnectionPtr& connection, con
       break;
     }
 
+    // Call data is copied out of the receive buffer, because its blocks are reused for the next
+    // reads while the call is still queued for a service thread. This is the only copy before the
+    // protobuf is parsed, see RpcBench.BenchmarkLargeCalls for its cost on big calls.
     std::vector<char> call_data;
     IoVecsToBuffer(
         data, consumed + (include_header_ ? 0 : header_size), consumed + total_length, &call_data);
@@ -64,6 +64,16 @@ METRIC_DEFINE_histogram(
     yb::MetricUnit::kMicroseconds, "Microseconds spent to queue and write the response to the wire",
     60000000LU, 2);
 
+METRIC_DEFINE_counter(
+    server, rpc_outbound_data_written, "RPC Outbound Data Written", yb::MetricUnit::kRequests,
+    "Number of outbound calls and responses written to sockets");
+
+METRIC_DEFINE_counter(
+    server, rpc_outbound_write_syscalls, "RPC Outbound Write System Calls",
+    yb::MetricUnit::kOperations,
+    "Number of system calls used to write outbound calls and responses to sockets. Divided by "
+    "rpc_outbound_data_written it gives the number of system calls per call or response");
+
 namespace yb {
 namespace rpc {
 
@@ -82,6 +92,10 @@ Connection::Connection(Reactor* reactor,
   const auto metric_entity = reactor->messenger()->metric_entity();
   handler_latency_outbound_transfer_ = metric_entity ?
       METRIC_handler_latency_outbound_transfer.Instantiate(metric_entity) : nullptr;
+  if (metric_entity) {
+    outbound_data_written_ = METRIC_rpc_outbound_data_written.Instantiate(metric_entity);
+    outbound_write_syscalls_ = METRIC_rpc_outbound_write_syscalls.Instantiate(metric_entity);
+  }
 }
 
 Connection::~Connection() {}
@@ -443,9 +457,18 @@ void Connection::UpdateLastActivity() {
 }
 
 void Connection::Transferred(const OutboundDataPtr& data, const Status& status) {
+  if (status.ok() && outbound_data_written_) {
+    outbound_data_written_->Increment();
+  }
   data->Transferred(status, this);
 }
 
+void Connection::Written() {
+  if (outbound_write_syscalls_) {
+    outbound_write_syscalls_->Increment();
+  }
+}
+
 void Connection::Destroy(const Status& status) {
   reactor_->DestroyConnection(this, status);
 }
@@ -189,6 +189,7 @@ class Connection final : public StreamContext, public std::enable_shared_from_th
 
   void UpdateLastActivity() override;
   void Transferred(const OutboundDataPtr& data, const Status& status) override;
+  void Written() override;
   void Destroy(const Status& status) override;
   Result<size_t> ProcessReceived(const IoVecs& data, ReadBufferFull read_buffer_full) override;
   void Connected() override;
@@ -221,6 +222,11 @@ class Connection final : public StreamContext, public std::enable_shared_from_th
   // at connection level.
   scoped_refptr<Histogram> handler_latency_outbound_transfer_;
 
+  // Number of outbound data items, i.e. calls and responses, written to the socket, and number of
+  // system calls used to write them. Their ratio shows how well writes are coalesced.
+  scoped_refptr<Counter> outbound_data_written_;
+  scoped_refptr<Counter> outbound_write_syscalls_;
+
   struct CompareExpiration {
     template<class Pair>
     bool operator()(const Pair& lhs, const Pair& rhs) const {
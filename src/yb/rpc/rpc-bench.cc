@@ -35,19 +35,41 @@
 
 #include <gtest/gtest.h>
 
+#ifdef TCMALLOC_ENABLED
+#include <gperftools/malloc_hook.h>
+#endif
+
 #include "yb/rpc/rpc-test-base.h"
 #include "yb/rpc/rtest.proxy.h"
 #include "yb/util/countdown_latch.h"
+#include "yb/util/size_literals.h"
 #include "yb/util/test_util.h"
 
 using namespace std::literals; // NOLINT
 
+DECLARE_int32(num_connections_to_server);
+
+METRIC_DECLARE_counter(rpc_outbound_data_written);
+METRIC_DECLARE_counter(rpc_outbound_write_syscalls);
+
 using std::string;
 using std::shared_ptr;
 
 namespace yb {
 namespace rpc {
 
+#ifdef TCMALLOC_ENABLED
+namespace {
+
+std::atomic<int64_t> num_allocations{0};
+
+void CountAllocation(const void* ptr, size_t size) {
+  num_allocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+} // namespace
+#endif
+
 class RpcBench : public RpcTestBase {
  public:
   RpcBench()
@@ -56,6 +78,10 @@ class RpcBench : public RpcTestBase {
  protected:
   friend class ClientThread;
 
+  // Runs client threads that send calls for 10 seconds and logs the throughput. Calls are Add
+  // calls when payload_size is 0, otherwise Echo calls with payload_size bytes of data.
+  void RunBenchmark(int num_threads, size_t payload_size);
+
   HostPort server_hostport_;
   shared_ptr<Messenger> client_messenger_;
   std::atomic<bool> should_run_{true};
@@ -63,8 +89,9 @@ class RpcBench : public RpcTestBase {
 
 class ClientThread {
  public:
-  explicit ClientThread(RpcBench *bench)
+  ClientThread(RpcBench *bench, size_t payload_size)
     : bench_(bench),
+      payload_size_(payload_size),
       request_count_(0) {
   }
 
@@ -82,6 +109,11 @@ class ClientThread {
 
     rpc_test::CalculatorServiceProxy p(&proxy_cache, HostPort(bench_->server_hostport_));
 
+    if (payload_size_ != 0) {
+      RunEcho(&p);
+      return;
+    }
+
     rpc_test::AddRequestPB req;
     rpc_test::AddResponsePB resp;
     while (bench_->should_run_.load(std::memory_order_acquire)) {
@@ -95,14 +127,65 @@ class ClientThread {
     }
   }
 
+  void RunEcho(rpc_test::CalculatorServiceProxy* proxy) {
+    rpc_test::EchoRequestPB req;
+    rpc_test::EchoResponsePB resp;
+    req.mutable_data()->assign(payload_size_, 'x');
+    while (bench_->should_run_.load(std::memory_order_acquire)) {
+      RpcController controller;
+      controller.set_timeout(MonoDelta::FromSeconds(10));
+      CHECK_OK(proxy->Echo(req, &resp, &controller));
+      CHECK_EQ(payload_size_, resp.data().size());
+      request_count_++;
+    }
+  }
+
   std::unique_ptr<std::thread> thread_;
   RpcBench *bench_;
+  const size_t payload_size_;
   int request_count_;
 };
 
+// Keeps one asynchronous Echo call in flight over the given proxy until should_run is reset.
+class AsyncCaller {
+ public:
+  AsyncCaller(rpc_test::CalculatorServiceProxy* proxy, size_t payload_size,
+              const std::atomic<bool>* should_run, CountDownLatch* stopped)
+      : proxy_(proxy), should_run_(should_run), stopped_(stopped) {
+    req_.mutable_data()->assign(payload_size, 'x');
+  }
 
-// Test making successful RPC calls.
-TEST_F(RpcBench, BenchmarkCalls) {
+  void Send() {
+    controller_.Reset();
+    controller_.set_timeout(MonoDelta::FromSeconds(10));
+    proxy_->EchoAsync(req_, &resp_, &controller_, std::bind(&AsyncCaller::Done, this));
+  }
+
+  int64_t request_count() const {
+    return request_count_;
+  }
+
+ private:
+  void Done() {
+    CHECK_OK(controller_.status());
+    ++request_count_;
+    if (should_run_->load(std::memory_order_acquire)) {
+      Send();
+    } else {
+      stopped_->CountDown();
+    }
+  }
+
+  rpc_test::CalculatorServiceProxy* const proxy_;
+  const std::atomic<bool>* const should_run_;
+  CountDownLatch* const stopped_;
+  rpc_test::EchoRequestPB req_;
+  rpc_test::EchoResponsePB resp_;
+  RpcController controller_;
+  int64_t request_count_ = 0;
+};
+
+void RpcBench::RunBenchmark(int num_threads, size_t payload_size) {
   TestServerOptions options;
   options.n_worker_threads = 1;
 
@@ -115,17 +198,17 @@ TEST_F(RpcBench, BenchmarkCalls) {
   client_options.n_reactors = 2;
   client_messenger_ = CreateMessenger("Client", client_options);
 
+#ifdef TCMALLOC_ENABLED
+  CHECK(MallocHook::AddNewHook(&CountAllocation));
+  auto allocations_before = num_allocations.load(std::memory_order_relaxed);
+#endif
+
   Stopwatch sw(Stopwatch::ALL_THREADS);
   sw.start();
 
   std::vector<std::unique_ptr<ClientThread>> threads;
-#if defined(THREAD_SANITIZER) || defined(ADDRESS_SANITIZER)
-  constexpr int kNumThreads = 4;
-#else
-  constexpr int kNumThreads = 16;
-#endif
-  for (int i = 0; i < kNumThreads; i++) {
-    auto thr = std::make_unique<ClientThread>(this);
+  for (int i = 0; i < num_threads; i++) {
+    auto thr = std::make_unique<ClientThread>(this, payload_size);
     thr->Start();
     threads.push_back(std::move(thr));
   }
@@ -141,6 +224,11 @@ TEST_F(RpcBench, BenchmarkCalls) {
   }
   sw.stop();
 
+#ifdef TCMALLOC_ENABLED
+  auto allocations = num_allocations.load(std::memory_order_relaxed) - allocations_before;
+  CHECK(MallocHook::RemoveNewHook(&CountAllocation));
+#endif
+
   float reqs_per_second = static_cast<float>(total_reqs / sw.elapsed().wall_seconds());
   float user_cpu_micros_per_req = static_cast<float>(sw.elapsed().user / 1000.0 / total_reqs);
   float sys_cpu_micros_per_req = static_cast<float>(sw.elapsed().system / 1000.0 / total_reqs);
@@ -148,6 +236,98 @@ TEST_F(RpcBench, BenchmarkCalls) {
   LOG(INFO) << "Reqs/sec:         " << reqs_per_second;
   LOG(INFO) << "User CPU per req: " << user_cpu_micros_per_req << "us";
   LOG(INFO) << "Sys CPU per req:  " << sys_cpu_micros_per_req << "us";
+  if (payload_size != 0) {
+    LOG(INFO) << "Request bytes/sec: " << reqs_per_second * payload_size;
+  }
+#ifdef TCMALLOC_ENABLED
+  // Includes allocations of both the client and the server.
+  LOG(INFO) << "Allocations per req: " << static_cast<double>(allocations) / total_reqs;
+#endif
+}
+
+// Test making successful RPC calls.
+TEST_F(RpcBench, BenchmarkCalls) {
+#if defined(THREAD_SANITIZER) || defined(ADDRESS_SANITIZER)
+  constexpr int kNumThreads = 4;
+#else
+  constexpr int kNumThreads = 16;
+#endif
+  RunBenchmark(kNumThreads, 0 /* payload_size */);
+}
+
+// Same as above, but with calls carrying 1MB of data, like large write batches.
+TEST_F(RpcBench, BenchmarkLargeCalls) {
+  constexpr size_t kPayloadSize = 1_MB;
+#if defined(THREAD_SANITIZER) || defined(ADDRESS_SANITIZER)
+  constexpr int kNumThreads = 2;
+#else
+  constexpr int kNumThreads = 4;
+#endif
+  RunBenchmark(kNumThreads, kPayloadSize);
+}
+
+// Small calls and responses over many connections, each with one call in flight, like Redis GETs
+// and CQL point reads from many clients. Shows how well outbound writes are coalesced.
+TEST_F(RpcBench, BenchmarkSmallCallsManyConnections) {
+  constexpr int kNumMessengers = 8;
+  constexpr int kConnectionsPerMessenger = 125;
+  constexpr size_t kPayloadSize = 100;
+
+  gflags::FlagSaver flag_saver;
+  FLAGS_num_connections_to_server = kConnectionsPerMessenger;
+
+  StartTestServerWithGeneratedCode(&server_hostport_);
+
+  auto write_syscalls = METRIC_rpc_outbound_write_syscalls.Instantiate(metric_entity());
+  auto data_written = METRIC_rpc_outbound_data_written.Instantiate(metric_entity());
+
+  std::vector<shared_ptr<Messenger>> messengers;
+  std::vector<std::unique_ptr<ProxyCache>> proxy_caches;
+  std::vector<std::unique_ptr<rpc_test::CalculatorServiceProxy>> proxies;
+  std::vector<std::unique_ptr<AsyncCaller>> callers;
+  CountDownLatch stopped(kNumMessengers * kConnectionsPerMessenger);
+  for (int i = 0; i != kNumMessengers; ++i) {
+    messengers.push_back(CreateMessenger(Format("Client-$0", i)));
+    proxy_caches.push_back(std::make_unique<ProxyCache>(messengers.back()));
+    proxies.push_back(std::make_unique<rpc_test::CalculatorServiceProxy>(
+        proxy_caches.back().get(), server_hostport_));
+    // Calls of a proxy are distributed round robin over its connections.
+    for (int j = 0; j != kConnectionsPerMessenger; ++j) {
+      callers.push_back(std::make_unique<AsyncCaller>(
+          proxies.back().get(), kPayloadSize, &should_run_, &stopped));
+    }
+  }
+
+  const auto write_syscalls_before = write_syscalls->value();
+  const auto data_written_before = data_written->value();
+  Stopwatch sw(Stopwatch::ALL_THREADS);
+  sw.start();
+  for (const auto& caller : callers) {
+    caller->Send();
+  }
+
+  std::this_thread::sleep_for(10s);
+  should_run_.store(false, std::memory_order_release);
+  stopped.Wait();
+  sw.stop();
+
+  int64_t total_reqs = 0;
+  for (const auto& caller : callers) {
+    total_reqs += caller->request_count();
+  }
+  const auto write_syscalls_delta = write_syscalls->value() - write_syscalls_before;
+  const auto data_written_delta = data_written->value() - data_written_before;
+
+  LOG(INFO) << "Connections:      " << kNumMessengers * kConnectionsPerMessenger;
+  LOG(INFO) << "Reqs/sec:         " << total_reqs / sw.elapsed().wall_seconds();
+  // Both client and server messengers report to the same metric entity, so this covers both
+  // calls and responses.
+  LOG(INFO) << "Write syscalls per call or response: "
+            << static_cast<double>(write_syscalls_delta) / data_written_delta;
+
+  for (const auto& messenger : messengers) {
+    messenger->Shutdown();
+  }
 }
 
 } // namespace rpc
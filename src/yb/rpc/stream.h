@@ -34,6 +34,8 @@ class StreamContext {
  public:
   virtual void UpdateLastActivity() = 0;
   virtual void Transferred(const OutboundDataPtr& data, const Status& status) = 0;
+  // Invoked after each system call that wrote outbound data to the socket.
+  virtual void Written() = 0;
   virtual void Destroy(const Status& status) = 0;
   virtual void Connected() = 0;
   virtual Result<size_t> ProcessReceived(const IoVecs& data, ReadBufferFull read_buffer_full) = 0;
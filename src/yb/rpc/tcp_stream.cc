@@ -13,6 +13,8 @@
 
 #include "yb/rpc/tcp_stream.h"
 
+#include <limits.h>
+
 #include "yb/rpc/outbound_data.h"
 
 #include "yb/util/flag_tags.h"
@@ -25,14 +27,19 @@ DECLARE_uint64(rpc_connection_timeout_ms);
 DEFINE_test_flag(int32, TEST_delay_connect_ms, 0,
                  "Delay connect in tests for specified amount of milliseconds.");
 
-namespace yb {
-namespace rpc {
+DEFINE_int32(rpc_max_iov_per_write, 128,
+             "Max number of buffers written to a socket with a single system call. All calls and "
+             "responses queued for a connection are gathered into one write up to this limit.");
+TAG_FLAG(rpc_max_iov_per_write, advanced);
 
-namespace {
+DEFINE_int64(rpc_zerocopy_min_bytes, 0,
+             "Writes to RPC sockets of at least this number of bytes use MSG_ZEROCOPY, so large "
+             "payloads are not copied into the kernel. 0 disables zero copy writes. Requires "
+             "Linux 4.14 or later.");
+TAG_FLAG(rpc_zerocopy_min_bytes, advanced);
 
-const size_t kMaxIov = 16;
-
-}
+namespace yb {
+namespace rpc {
 
 TcpStream::TcpStream(
     const Endpoint& remote, Socket socket, GrowableBufferAllocator* allocator, size_t limit)
@@ -60,6 +67,13 @@ Status TcpStream::Start(bool connect, ev::loop_ref* loop, StreamContext* context
   RETURN_NOT_OK(socket_.SetSendTimeout(FLAGS_rpc_connection_timeout_ms * 1ms));
   RETURN_NOT_OK(socket_.SetRecvTimeout(FLAGS_rpc_connection_timeout_ms * 1ms));
 
+  if (FLAGS_rpc_zerocopy_min_bytes > 0) {
+    auto status = socket_.SetZeroCopy(true);
+    zero_copy_enabled_ = status.ok();
+    YB_LOG_IF_EVERY_N(WARNING, !status.ok(), 100)
+        << "Failed to enable zero copy writes: " << status;
+  }
+
   if (connect && FLAGS_TEST_delay_connect_ms) {
     connect_delayer_.set(*loop);
     connect_delayer_.set<TcpStream, &TcpStream::DelayConnectHandler>(this);
@@ -121,6 +135,17 @@ void TcpStream::Close() {
 void TcpStream::Shutdown(const Status& status) {
   ClearSending(status);
 
+  if (!zero_copy_writes_.empty()) {
+    ProcessZeroCopyCompletions();
+  }
+  if (!zero_copy_writes_.empty()) {
+    // The kernel could still send from buffers of zero copy writes after a regular close, so reset
+    // the connection to make close drop the unsent data. Buffers are released after the close.
+    LOG_WITH_PREFIX(INFO) << "Resetting connection with " << zero_copy_writes_.size()
+                          << " zero copy writes in flight";
+    WARN_NOT_OK(socket_.SetLinger(true, 0 /* timeout_sec */), "Failed to set linger");
+  }
+
   if (!read_buffer_.empty()) {
     LOG_WITH_PREFIX(WARNING) << "Shutting down with pending inbound data ("
                              << read_buffer_ << ", status = " << status << ")";
@@ -129,6 +154,7 @@ void TcpStream::Shutdown(const Status& status) {
   io_.stop();
   is_epoll_registered_ = false;
   WARN_NOT_OK(socket_.Close(), "Error closing socket");
+  zero_copy_writes_.clear();
 }
 
 Status TcpStream::TryWrite() {
@@ -139,10 +165,16 @@ Status TcpStream::TryWrite() {
   return result;
 }
 
-int TcpStream::FillIov(iovec* out) {
+int TcpStream::FillIov(size_t* num_sending) {
+  const int max_iov = std::max(std::min(FLAGS_rpc_max_iov_per_write, IOV_MAX), 1);
+  if (iov_.size() != static_cast<size_t>(max_iov)) {
+    iov_.resize(max_iov);
+  }
   int index = 0;
   size_t offset = send_position_;
+  *num_sending = 0;
   for (auto& data : sending_) {
+    ++*num_sending;
     if (data.skipped || (offset == 0 && data.data && data.data->IsFinished())) {
       data.skipped = true;
       continue;
@@ -153,10 +185,10 @@ int TcpStream::FillIov(iovec* out) {
         continue;
       }
 
-      out[index].iov_base = bytes.data() + offset;
-      out[index].iov_len = bytes.size() - offset;
+      iov_[index].iov_base = bytes.data() + offset;
+      iov_[index].iov_len = bytes.size() - offset;
       offset = 0;
-      if (++index == kMaxIov) {
+      if (++index == max_iov) {
         return index;
       }
     }
@@ -165,6 +197,58 @@ int TcpStream::FillIov(iovec* out) {
   return index;
 }
 
+Status TcpStream::Write(int iov_len, size_t num_sending, int32_t* written) {
+  if (zero_copy_enabled_) {
+    size_t size = 0;
+    for (int i = 0; i != iov_len; ++i) {
+      size += iov_[i].iov_len;
+    }
+    if (size >= static_cast<size_t>(FLAGS_rpc_zerocopy_min_bytes)) {
+      auto status = socket_.WritevZeroCopy(iov_.data(), iov_len, written);
+      if (status.ok()) {
+        context_->Written();
+        // The kernel sends from our buffers, so keep them until it reports the write completed.
+        ZeroCopyWrite write;
+        write.id = next_zero_copy_id_++;
+        for (size_t i = 0; i != num_sending; ++i) {
+          const auto& bytes = sending_[i].bytes;
+          write.bytes.insert(write.bytes.end(), bytes.begin(), bytes.end());
+        }
+        zero_copy_writes_.push_back(std::move(write));
+        return Status::OK();
+      }
+      // ENOBUFS means that the kernel could not pin more pages for this socket, so fall back to
+      // a regular write.
+      if (status.error_code() != ENOBUFS) {
+        return status;
+      }
+    }
+  }
+
+  RETURN_NOT_OK(socket_.Writev(iov_.data(), iov_len, written));
+  context_->Written();
+  return Status::OK();
+}
+
+void TcpStream::ProcessZeroCopyCompletions() {
+  std::vector<std::pair<uint32_t, uint32_t>> ranges;
+  auto status = socket_.ReadZeroCopyCompletions(&ranges);
+  if (!status.ok()) {
+    YB_LOG_WITH_PREFIX_EVERY_N(WARNING, 50) << "Failed to read zero copy completions: " << status;
+  }
+  for (const auto& range : ranges) {
+    for (auto& write : zero_copy_writes_) {
+      // Unsigned arithmetic handles ids wrapping around.
+      if (write.id - range.first <= range.second - range.first) {
+        write.completed = true;
+      }
+    }
+  }
+  while (!zero_copy_writes_.empty() && zero_copy_writes_.front().completed) {
+    zero_copy_writes_.pop_front();
+  }
+}
+
 Status TcpStream::DoWrite() {
   if (!connected_ || waiting_write_ready_ || !is_epoll_registered_) {
     return Status::OK();
@@ -172,13 +256,13 @@ Status TcpStream::DoWrite() {
 
   // If we weren't waiting write to be ready, we could try to write data to socket.
   while (!sending_.empty()) {
-    iovec iov[kMaxIov];
-    int iov_len = FillIov(iov);
+    size_t num_sending = 0;
+    int iov_len = FillIov(&num_sending);
 
     context_->UpdateLastActivity();
 
     int32_t written = 0;
-    auto status = iov_len != 0 ? socket_.Writev(iov, iov_len, &written) : Status::OK();
+    auto status = iov_len != 0 ? Write(iov_len, num_sending, &written) : Status::OK();
     if (PREDICT_FALSE(!status.ok())) {
       if (!Socket::IsTemporarySocketError(status)) {
         YB_LOG_WITH_PREFIX_EVERY_N(WARNING, 50) << "Send failed: " << status;
@@ -214,6 +298,12 @@ Status TcpStream::DoWrite() {
 void TcpStream::Handler(ev::io& watcher, int revents) {  // NOLINT
   DVLOG_WITH_PREFIX(3) << "Handler(revents=" << revents << ")";
   auto status = Status::OK();
+  // Completions of zero copy writes are reported through the socket error queue, which keeps
+  // waking up the loop until it is read.
+  if (!zero_copy_writes_.empty()) {
+    ProcessZeroCopyCompletions();
+  }
+
   if (revents & ev::ERROR) {
     status = STATUS(NetworkError, ToString() + ": Handler encountered an error");
   }
@@ -368,6 +458,13 @@ bool TcpStream::Idle(std::string* reason_not_idle) {
     result = false;
   }
 
+  if (!zero_copy_writes_.empty()) {
+    if (reason_not_idle) {
+      AppendWithSeparator("zero copy writes in flight", reason_not_idle);
+    }
+    result = false;
+  }
+
   return result;
 }
 
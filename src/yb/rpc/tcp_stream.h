@@ -75,7 +75,15 @@ class TcpStream : public Stream {
 
   const std::string& LogPrefix() const;
 
-  int FillIov(iovec* out);
+  // Fills iov_ with the data to send, returns the number of filled entries. Sets 'num_sending' to
+  // the number of entries of sending_ that the filled data belongs to.
+  int FillIov(size_t* num_sending);
+
+  // Writes the first iov_len entries of iov_ to the socket.
+  CHECKED_STATUS Write(int iov_len, size_t num_sending, int32_t* written);
+
+  // Releases the buffers of the zero copy writes that the kernel completed.
+  void ProcessZeroCopyCompletions();
 
   void DelayConnectHandler(ev::timer& watcher, int revents); // NOLINT
 
@@ -131,6 +139,22 @@ class TcpStream : public Stream {
   std::deque<SendingData> sending_;
   size_t send_position_ = 0;
   bool waiting_write_ready_ = false;
+
+  // Buffers for writing to the socket, sized to the max number of buffers per write.
+  std::vector<iovec> iov_;
+
+  // Zero copy write whose buffers are still referenced by the kernel.
+  struct ZeroCopyWrite {
+    uint32_t id;
+    std::vector<RefCntBuffer> bytes;
+    bool completed = false;
+  };
+
+  // Whether large writes use MSG_ZEROCOPY, see FLAGS_rpc_zerocopy_min_bytes.
+  bool zero_copy_enabled_ = false;
+  std::deque<ZeroCopyWrite> zero_copy_writes_;
+  // Id the kernel will assign to the next zero copy write.
+  uint32_t next_zero_copy_id_ = 0;
 };
 
 } // namespace rpc
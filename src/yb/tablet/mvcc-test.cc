@@ -30,6 +30,7 @@
 // under the License.
 //
 
+#include <thread>
 #include <vector>
 
 #include <boost/scope_exit.hpp>
@@ -111,6 +112,25 @@ TEST_F(MvccTest, SafeHybridTimeToReadAt) {
   ASSERT_EQ(now, manager_.SafeTime(now));
 }
 
+TEST_F(MvccTest, SafeTimeIfIdle) {
+  constexpr uint64_t kLease = 10;
+  constexpr uint64_t kDelta = 10;
+  auto ht_lease = AddLogical(clock_->Now(), kLease);
+  clock_->Update(AddLogical(ht_lease, kDelta));
+  ASSERT_EQ(ht_lease, manager_.SafeTimeIfIdle(HybridTime::kMin, ht_lease));
+
+  HybridTime ht1 = clock_->Now();
+  manager_.AddPending(&ht1);
+  ASSERT_FALSE(manager_.SafeTimeIfIdle(HybridTime::kMin, HybridTime::kMax));
+  ASSERT_EQ(ht1.Decremented(), manager_.SafeTime(HybridTime::kMax));
+  // The operation in flight does not matter when the lease is below its hybrid time.
+  ASSERT_EQ(ht_lease, manager_.SafeTimeIfIdle(HybridTime::kMin, ht_lease));
+
+  manager_.Replicated(ht1);
+  auto now = clock_->Now();
+  ASSERT_EQ(now, manager_.SafeTimeIfIdle(HybridTime::kMin, now));
+}
+
 TEST_F(MvccTest, Abort) {
   constexpr size_t kTotalEntries = 10;
   vector<HybridTime> hts(kTotalEntries);
@@ -320,5 +340,55 @@ TEST_F(MvccTest, WaitForSafeTime) {
   ASSERT_FALSE(manager_.SafeTime(ht3, MonoTime::Now() + 100ms, HybridTime::kMax));
 }
 
+// Measures throughput of safe time reads running concurrently with operations being added and
+// replicated.
+TEST_F(MvccTest, BenchmarkMixedReadWrite) {
+  constexpr int kNumThreads = 32;
+  constexpr int kNumWriters = 1;
+  const auto kDuration = AllowSlowTests() ? 10s : 2s;
+
+  std::atomic<bool> stop(false);
+  std::atomic<int64_t> num_reads(0);
+  std::atomic<int64_t> num_writes(0);
+  std::vector<std::thread> threads;
+  for (int i = 0; i != kNumThreads; ++i) {
+    if (i < kNumWriters) {
+      // Operations of a tablet are added and replicated sequentially, so there is a single writer.
+      threads.emplace_back([this, &stop, &num_writes] {
+        int64_t writes = 0;
+        while (!stop.load(std::memory_order_acquire)) {
+          HybridTime ht;
+          manager_.AddPending(&ht);
+          manager_.Replicated(ht);
+          ++writes;
+        }
+        num_writes += writes;
+      });
+    } else {
+      threads.emplace_back([this, &stop, &num_reads] {
+        int64_t reads = 0;
+        HybridTime last_safe_time = HybridTime::kMin;
+        while (!stop.load(std::memory_order_acquire)) {
+          auto safe_time = manager_.SafeTime(HybridTime::kMax);
+          ASSERT_GE(safe_time, last_safe_time);
+          last_safe_time = safe_time;
+          ++reads;
+        }
+        num_reads += reads;
+      });
+    }
+  }
+
+  std::this_thread::sleep_for(kDuration);
+  stop.store(true, std::memory_order_release);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  auto seconds = std::chrono::duration_cast<std::chrono::duration<double>>(kDuration).count();
+  LOG(INFO) << "Readers: " << kNumThreads - kNumWriters << ", reads/sec: "
+            << num_reads.load() / seconds << ", writes/sec: " << num_writes.load() / seconds;
+}
+
 } // namespace tablet
 } // namespace yb
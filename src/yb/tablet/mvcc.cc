@@ -51,6 +51,53 @@ std::string SafeTimeWithSource::ToString() const {
 // MvccManager
 // ------------------------------------------------------------------------------------------------
 
+namespace {
+
+// Number of attempts to calculate safe time without taking the mutex, before falling back to it.
+constexpr int kLockFreeSafeTimeAttempts = 3;
+
+// Sets `value` to `candidate` if it is greater. Returns true if the value was updated.
+bool UpdateAtomicMax(std::atomic<HybridTime>* value, HybridTime candidate) {
+  auto current = value->load(std::memory_order_acquire);
+  while (candidate > current) {
+    if (value->compare_exchange_weak(current, candidate, std::memory_order_acq_rel)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void UpdateMaxSafeTime(HybridTime safe_time, SafeTimeSource source,
+                       std::atomic<HybridTime>* max_safe_time,
+                       std::atomic<SafeTimeSource>* max_safe_time_source) {
+  if (UpdateAtomicMax(max_safe_time, safe_time)) {
+    max_safe_time_source->store(source, std::memory_order_release);
+  }
+}
+
+} // namespace
+
+// Marks the published state as being modified for the lifetime of the object, and publishes the
+// front of the queue at the end. Should be created with the mutex held.
+//
+// The clock is read while the sequence counter is odd, so if a lock-free reader has seen the same
+// even counter before and after reading the clock, any hybrid time assigned by a concurrent
+// AddPending is greater than the one read by the reader.
+class MvccManager::PublishScope {
+ public:
+  explicit PublishScope(MvccManager* manager) : manager_(manager) {
+    manager_->seq_.fetch_add(1);
+  }
+
+  ~PublishScope() {
+    manager_->PublishQueueFront();
+    manager_->seq_.fetch_add(1);
+  }
+
+ private:
+  MvccManager* manager_;
+};
+
 MvccManager::MvccManager(std::string prefix, server::ClockPtr clock)
     : prefix_(std::move(prefix)),
       clock_(std::move(clock)) {}
@@ -60,10 +107,11 @@ void MvccManager::Replicated(HybridTime ht) {
 
   {
     std::lock_guard<std::mutex> lock(mutex_);
+    PublishScope publish_scope(this);
     CHECK(!queue_.empty()) << LogPrefix();
     CHECK_EQ(queue_.front(), ht) << LogPrefix();
     PopFront(&lock);
-    last_replicated_ = ht;
+    last_replicated_.store(ht);
   }
   cond_.notify_all();
 }
@@ -75,6 +123,7 @@ void MvccManager::Aborted(HybridTime ht) {
     std::lock_guard<std::mutex> lock(mutex_);
     CHECK(!queue_.empty()) << LogPrefix();
     if (queue_.front() == ht) {
+      PublishScope publish_scope(this);
       PopFront(&lock);
     } else {
       aborted_.push(ht);
@@ -97,9 +146,28 @@ void MvccManager::PopFront(std::lock_guard<std::mutex>* lock) {
   }
 }
 
+void MvccManager::PublishQueueFront() {
+  queue_front_.store(queue_.empty() ? HybridTime::kInvalid : queue_.front());
+}
+
+SafeTimeWithSource MvccManager::MaxSafeTimeReturnedWithLease() const {
+  return { max_safe_time_returned_with_lease_.load(), max_safe_time_source_with_lease_.load() };
+}
+
+SafeTimeWithSource MvccManager::MaxSafeTimeReturnedWithoutLease() const {
+  return { max_safe_time_returned_without_lease_.load(),
+           max_safe_time_source_without_lease_.load() };
+}
+
+SafeTimeWithSource MvccManager::MaxSafeTimeReturnedForFollower() const {
+  return { max_safe_time_returned_for_follower_.load(),
+           max_safe_time_source_for_follower_.load() };
+}
+
 void MvccManager::AddPending(HybridTime* ht) {
   const bool is_follower_side = ht->is_valid();
   std::lock_guard<std::mutex> lock(mutex_);
+  PublishScope publish_scope(this);
   if (is_follower_side) {
     // This must be a follower-side transaction with already known hybrid time.
     VLOG_WITH_PREFIX(1) << "AddPending(" << *ht << ")";
@@ -130,12 +198,16 @@ void MvccManager::AddPending(HybridTime* ht) {
   }
   HybridTime last_ht_in_queue = queue_.empty() ? HybridTime::kMin : queue_.back();
 
+  const auto max_safe_time_returned_with_lease = MaxSafeTimeReturnedWithLease();
+  const auto max_safe_time_returned_without_lease = MaxSafeTimeReturnedWithoutLease();
+  const auto max_safe_time_returned_for_follower = MaxSafeTimeReturnedForFollower();
+  const auto last_replicated = last_replicated_.load();
   HybridTime sanity_check_lower_bound =
       std::max({
-          max_safe_time_returned_with_lease_.safe_time,
-          max_safe_time_returned_without_lease_.safe_time,
-          max_safe_time_returned_for_follower_.safe_time,
-          last_replicated_,
+          max_safe_time_returned_with_lease.safe_time,
+          max_safe_time_returned_without_lease.safe_time,
+          max_safe_time_returned_for_follower.safe_time,
+          last_replicated,
           last_ht_in_queue});
 
   if (!queue_.empty() && *ht <= sanity_check_lower_bound) {
@@ -150,11 +222,11 @@ void MvccManager::AddPending(HybridTime* ht) {
           << "\n  "
 
       ss << LogPrefix() << ": new operation's hybrid time too low: " << *ht
-         << LOG_INFO_FOR_HT_LOWER_BOUND(max_safe_time_returned_with_lease_)
-         << LOG_INFO_FOR_HT_LOWER_BOUND(max_safe_time_returned_without_lease_)
-         << LOG_INFO_FOR_HT_LOWER_BOUND(max_safe_time_returned_for_follower_)
+         << LOG_INFO_FOR_HT_LOWER_BOUND(max_safe_time_returned_with_lease)
+         << LOG_INFO_FOR_HT_LOWER_BOUND(max_safe_time_returned_without_lease)
+         << LOG_INFO_FOR_HT_LOWER_BOUND(max_safe_time_returned_for_follower)
          << LOG_INFO_FOR_HT_LOWER_BOUND(
-                (SafeTimeWithSource{last_replicated_, SafeTimeSource::kUnknown}))
+                (SafeTimeWithSource{last_replicated, SafeTimeSource::kUnknown}))
          << LOG_INFO_FOR_HT_LOWER_BOUND(
                 (SafeTimeWithSource{last_ht_in_queue, SafeTimeSource::kUnknown}))
          << "\n  " << EXPR_VALUE_FOR_LOG(is_follower_side)
@@ -198,7 +270,8 @@ void MvccManager::SetLastReplicated(HybridTime ht) {
 
   {
     std::lock_guard<std::mutex> lock(mutex_);
-    last_replicated_ = ht;
+    PublishScope publish_scope(this);
+    last_replicated_.store(ht);
   }
   cond_.notify_all();
 }
@@ -208,11 +281,12 @@ void MvccManager::SetPropagatedSafeTimeOnFollower(HybridTime ht) {
 
   {
     std::lock_guard<std::mutex> lock(mutex_);
-    if (ht >= propagated_safe_time_) {
-      propagated_safe_time_ = ht;
+    auto propagated_safe_time = propagated_safe_time_.load();
+    if (ht >= propagated_safe_time) {
+      propagated_safe_time_.store(ht);
     } else {
       LOG(WARNING) << "Received propagated safe time " << ht << " less than the old value: "
-                   << propagated_safe_time_ << ". This could happen on followers when a new leader "
+                   << propagated_safe_time << ". This could happen on followers when a new leader "
                    << "is elected.";
     }
   }
@@ -228,19 +302,20 @@ void MvccManager::UpdatePropagatedSafeTimeOnLeader(HybridTime ht_lease) {
                             MonoTime::kMax,    // deadline
                             ht_lease,
                             &lock);
+    auto propagated_safe_time = propagated_safe_time_.load();
 #ifndef NDEBUG
     // This should only be called from RaftConsensus::UpdateMajorityReplicated, and ht_lease passed
     // in here should keep increasing, so we should not see propagated_safe_time_ going backwards.
-    CHECK_GE(ht, propagated_safe_time_) << LogPrefix();
-    propagated_safe_time_ = ht;
+    CHECK_GE(ht, propagated_safe_time) << LogPrefix();
+    propagated_safe_time_.store(ht);
 #else
     // Do not crash in production.
-    if (ht < propagated_safe_time_) {
+    if (ht < propagated_safe_time) {
       YB_LOG_EVERY_N_SECS(ERROR, 5) << LogPrefix()
-          << "Previously saw " << EXPR_VALUE_FOR_LOG(propagated_safe_time_)
+          << "Previously saw " << EXPR_VALUE_FOR_LOG(propagated_safe_time)
           << ", but now safe time is " << ht;
     } else {
-      propagated_safe_time_ = ht;
+      propagated_safe_time_.store(ht);
     }
 #endif
   }
@@ -249,78 +324,140 @@ void MvccManager::UpdatePropagatedSafeTimeOnLeader(HybridTime ht_lease) {
 
 HybridTime MvccManager::SafeTimeForFollower(
     HybridTime min_allowed, MonoTime deadline) const {
-  std::unique_lock<std::mutex> lock(mutex_);
+  const auto enforced_min_time = max_safe_time_returned_for_follower_.load();
   SafeTimeWithSource result;
   auto predicate = [this, &result, min_allowed] {
     // last_replicated_ is updated earlier than propagated_safe_time_, so because of concurrency it
     // could be greater than propagated_safe_time_.
-    if (propagated_safe_time_ > last_replicated_) {
-      result.safe_time = propagated_safe_time_;
+    auto propagated_safe_time = propagated_safe_time_.load();
+    auto last_replicated = last_replicated_.load();
+    if (propagated_safe_time > last_replicated) {
+      result.safe_time = propagated_safe_time;
       result.source = SafeTimeSource::kPropagated;
     } else {
-      result.safe_time = last_replicated_;
+      result.safe_time = last_replicated;
       result.source = SafeTimeSource::kLastReplicated;
     }
     return result.safe_time >= min_allowed;
   };
-  if (deadline == MonoTime::kMax) {
-    cond_.wait(lock, predicate);
-  } else if (!cond_.wait_until(lock, deadline.ToSteadyTimePoint(), predicate)) {
-    return HybridTime::kInvalid;
+  // Both values only increase, so the mutex is needed only to wait for them.
+  if (!predicate()) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (deadline == MonoTime::kMax) {
+      cond_.wait(lock, predicate);
+    } else if (!cond_.wait_until(lock, deadline.ToSteadyTimePoint(), predicate)) {
+      return HybridTime::kInvalid;
+    }
   }
   VLOG_WITH_PREFIX(1) << "SafeTimeForFollower(" << min_allowed
                       << "), result = " << result.ToString();
-  CHECK_GE(result.safe_time, max_safe_time_returned_for_follower_.safe_time)
+  CHECK_GE(result.safe_time, enforced_min_time)
       << LogPrefix() << "result: " << result.ToString()
       << ", max_safe_time_returned_for_follower_: "
-      << max_safe_time_returned_for_follower_.ToString();
-  max_safe_time_returned_for_follower_ = result;
+      << MaxSafeTimeReturnedForFollower().ToString();
+  UpdateMaxSafeTime(result.safe_time, result.source, &max_safe_time_returned_for_follower_,
+                    &max_safe_time_source_for_follower_);
   return result.safe_time;
 }
 
+bool MvccManager::ApplyHtLease(HybridTime min_allowed, HybridTime ht_lease) const {
+  CHECK(ht_lease.is_valid());
+  CHECK_LE(min_allowed, ht_lease) << LogPrefix();
+
+  const bool has_lease = ht_lease.GetPhysicalValueMicros() < kMaxHybridTimePhysicalMicros;
+  if (has_lease) {
+    UpdateAtomicMax(&max_ht_lease_seen_, ht_lease);
+  }
+  return has_lease;
+}
+
 HybridTime MvccManager::SafeTime(HybridTime min_allowed,
                                  MonoTime deadline,
                                  HybridTime ht_lease) const {
+  const bool has_lease = ApplyHtLease(min_allowed, ht_lease);
+  // Should be loaded before calculating safe time, see SafeTimeReturned.
+  const auto enforced_min_time = has_lease ? max_safe_time_returned_with_lease_.load()
+                                           : max_safe_time_returned_without_lease_.load();
+  for (int attempt = 0; attempt != kLockFreeSafeTimeAttempts; ++attempt) {
+    SafeTimeSource source = SafeTimeSource::kUnknown;
+    auto result = TryGetSafeTimeLockFree(min_allowed, has_lease, &source);
+    if (result.is_valid()) {
+      return SafeTimeReturned(
+          has_lease, enforced_min_time, result, source, min_allowed, ht_lease);
+    }
+  }
+
   std::unique_lock<std::mutex> lock(mutex_);
   return DoGetSafeTime(min_allowed, deadline, ht_lease, &lock);
 }
 
+HybridTime MvccManager::SafeTimeIfIdle(HybridTime min_allowed, HybridTime ht_lease) const {
+  const bool has_lease = ApplyHtLease(min_allowed, ht_lease);
+  const auto enforced_min_time = has_lease ? max_safe_time_returned_with_lease_.load()
+                                           : max_safe_time_returned_without_lease_.load();
+  SafeTimeSource source = SafeTimeSource::kUnknown;
+  auto result = TryGetSafeTimeLockFree(min_allowed, has_lease, &source);
+  if (!result.is_valid() || source == SafeTimeSource::kNextInQueue) {
+    return HybridTime::kInvalid;
+  }
+  return SafeTimeReturned(has_lease, enforced_min_time, result, source, min_allowed, ht_lease);
+}
+
+HybridTime MvccManager::TryGetSafeTimeLockFree(
+    HybridTime min_allowed, bool has_lease, SafeTimeSource* source) const {
+  const auto seq = seq_.load();
+  if (seq & 1) {
+    return HybridTime::kInvalid;
+  }
+  auto result = CalcSafeTime(has_lease, source);
+  if (seq_.load() != seq || result < min_allowed) {
+    return HybridTime::kInvalid;
+  }
+  return result;
+}
+
+HybridTime MvccManager::CalcSafeTime(bool has_lease, SafeTimeSource* source) const {
+  HybridTime result;
+  auto queue_front = queue_front_.load();
+  if (!queue_front.is_valid()) {
+    result = clock_->Now();
+    *source = SafeTimeSource::kNow;
+    VLOG_WITH_PREFIX(2) << "DoGetSafeTime, Now: " << result;
+  } else {
+    result = queue_front.Decremented();
+    *source = SafeTimeSource::kNextInQueue;
+    VLOG_WITH_PREFIX(2) << "DoGetSafeTime, Queue front (decremented): " << result;
+  }
+
+  if (has_lease) {
+    auto max_ht_lease_seen = max_ht_lease_seen_.load();
+    if (result > max_ht_lease_seen) {
+      result = max_ht_lease_seen;
+      *source = SafeTimeSource::kHybridTimeLease;
+    }
+  }
+
+  // This function could be invoked at a follower, so it has a very old ht_lease. In this case it
+  // is safe to read at least at last_replicated_.
+  return std::max(result, last_replicated_.load());
+}
+
 HybridTime MvccManager::DoGetSafeTime(const HybridTime min_allowed,
                                       const MonoTime deadline,
                                       const HybridTime ht_lease,
                                       std::unique_lock<std::mutex>* lock) const {
   DCHECK_ONLY_NOTNULL(lock);
-  CHECK(ht_lease.is_valid());
-  CHECK_LE(min_allowed, ht_lease) << LogPrefix();
-
-  const bool has_lease = ht_lease.GetPhysicalValueMicros() < kMaxHybridTimePhysicalMicros;
-  if (has_lease) {
-    max_ht_lease_seen_ = std::max(ht_lease, max_ht_lease_seen_);
-  }
+  const bool has_lease = ApplyHtLease(min_allowed, ht_lease);
+  const auto enforced_min_time = has_lease ? max_safe_time_returned_with_lease_.load()
+                                           : max_safe_time_returned_without_lease_.load();
 
   HybridTime result;
   SafeTimeSource source = SafeTimeSource::kUnknown;
   auto predicate = [this, &result, &source, min_allowed, has_lease] {
-    if (queue_.empty()) {
-      result = clock_->Now();
-      source = SafeTimeSource::kNow;
+    result = CalcSafeTime(has_lease, &source);
+    if (source == SafeTimeSource::kNow) {
       CHECK_GE(result, min_allowed) << LogPrefix();
-      VLOG_WITH_PREFIX(2) << "DoGetSafeTime, Now: " << result;
-    } else {
-      result = queue_.front().Decremented();
-      source = SafeTimeSource::kNextInQueue;
-      VLOG_WITH_PREFIX(2) << "DoGetSafeTime, Queue front (decremented): " << result;
-    }
-
-    if (has_lease && result > max_ht_lease_seen_) {
-      result = max_ht_lease_seen_;
-      source = SafeTimeSource::kHybridTimeLease;
     }
-
-    // This function could be invoked at a follower, so it has a very old ht_lease. In this case it
-    // is safe to read at least at last_replicated_.
-    result = std::max(result, last_replicated_);
-
     return result >= min_allowed;
   };
 
@@ -331,34 +468,40 @@ HybridTime MvccManager::DoGetSafeTime(const HybridTime min_allowed,
   } else if (!cond_.wait_until(*lock, deadline.ToSteadyTimePoint(), predicate)) {
     return HybridTime::kInvalid;
   }
+  return SafeTimeReturned(has_lease, enforced_min_time, result, source, min_allowed, ht_lease);
+}
+
+HybridTime MvccManager::SafeTimeReturned(
+    bool has_lease, HybridTime enforced_min_time, HybridTime result, SafeTimeSource source,
+    HybridTime min_allowed, HybridTime ht_lease) const {
   VLOG_WITH_PREFIX(1) << "DoGetSafeTime(" << min_allowed << ", "
                       << ht_lease << "), result = " << result;
 
-  auto enforced_min_time = has_lease ? max_safe_time_returned_with_lease_.safe_time
-                                     : max_safe_time_returned_without_lease_.safe_time;
+  // Safe time returned by concurrent readers could be registered in any order, so we only check
+  // against the value that was registered before this safe time was calculated.
   CHECK_GE(result, enforced_min_time) << LogPrefix()
       << ": " << EXPR_VALUE_FOR_LOG(has_lease)
       << ", " << EXPR_VALUE_FOR_LOG(enforced_min_time.ToUint64() - result.ToUint64())
       << ", " << EXPR_VALUE_FOR_LOG(ht_lease)
-      << ", " << EXPR_VALUE_FOR_LOG(max_ht_lease_seen_)
-      << ", " << EXPR_VALUE_FOR_LOG(last_replicated_)
+      << ", " << EXPR_VALUE_FOR_LOG(max_ht_lease_seen_.load())
+      << ", " << EXPR_VALUE_FOR_LOG(last_replicated_.load())
       << ", " << EXPR_VALUE_FOR_LOG(clock_->Now())
-      << ", " << EXPR_VALUE_FOR_LOG(deadline.ToString())
-      << ", " << EXPR_VALUE_FOR_LOG(queue_.size())
-      << ", " << EXPR_VALUE_FOR_LOG(queue_);
+      << ", " << EXPR_VALUE_FOR_LOG(queue_front_.load());
 
   if (has_lease) {
-    max_safe_time_returned_with_lease_ = { result, source };
+    UpdateMaxSafeTime(result, source, &max_safe_time_returned_with_lease_,
+                      &max_safe_time_source_with_lease_);
   } else {
-    max_safe_time_returned_without_lease_ = { result, source };
+    UpdateMaxSafeTime(result, source, &max_safe_time_returned_without_lease_,
+                      &max_safe_time_source_without_lease_);
   }
   return result;
 }
 
 HybridTime MvccManager::LastReplicatedHybridTime() const {
-  std::lock_guard<std::mutex> lock(mutex_);
-  VLOG_WITH_PREFIX(1) << __func__ << "(), result = " << last_replicated_;
-  return last_replicated_;
+  auto result = last_replicated_.load();
+  VLOG_WITH_PREFIX(1) << __func__ << "(), result = " << result;
+  return result;
 }
 
 }  // namespace tablet
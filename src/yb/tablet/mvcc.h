@@ -32,6 +32,7 @@
 #ifndef YB_TABLET_MVCC_H_
 #define YB_TABLET_MVCC_H_
 
+#include <atomic>
 #include <condition_variable>
 #include <mutex>
 #include <deque>
@@ -64,6 +65,10 @@ struct SafeTimeWithSource {
 // methods.
 // Operations could be replicated only in the same order as they were added.
 // Time of newly added operation should be after time of all previously added operations.
+//
+// Operations are added, replicated and aborted under the mutex, but the state required to calculate
+// safe time is also published through atomics guarded by a sequence counter. So readers obtain safe
+// time without taking the mutex, unless they have to wait for it to reach the requested value.
 class MvccManager {
  public:
   // `prefix` is used for logging.
@@ -122,18 +127,53 @@ class MvccManager {
 
   HybridTime SafeTimeForFollower(HybridTime min_allowed, MonoTime deadline) const;
 
+  // Fast path of SafeTime for a leader that holds a valid lease. When no operations are in flight,
+  // the safe time is bounded only by the clock and `ht_lease`, so it is returned without taking the
+  // mutex. Returns invalid hybrid time if the safe time is limited by an operation in flight, the
+  // state is being modified concurrently, or the result would be less than `min_allowed`;
+  // SafeTime should be used then.
+  HybridTime SafeTimeIfIdle(HybridTime min_allowed, HybridTime ht_lease) const;
+
   // Returns time of last replicated operation.
   HybridTime LastReplicatedHybridTime() const;
 
  private:
+  // Helper that updates the sequence counter around modifications of the published state.
+  class PublishScope;
+
   HybridTime DoGetSafeTime(HybridTime min_allowed,
                            MonoTime deadline,
                            HybridTime ht_lease,
                            std::unique_lock<std::mutex>* lock) const;
 
+  // Tries to calculate safe time without taking the mutex. Returns invalid hybrid time if state
+  // was concurrently modified, or safe time is less than `min_allowed`.
+  HybridTime TryGetSafeTimeLockFree(HybridTime min_allowed, bool has_lease,
+                                    SafeTimeSource* source) const;
+
+  // Calculates safe time from the published state and the clock.
+  HybridTime CalcSafeTime(bool has_lease, SafeTimeSource* source) const;
+
+  // Validates arguments of SafeTime and updates max_ht_lease_seen_. Returns whether `ht_lease`
+  // is an actual lease.
+  bool ApplyHtLease(HybridTime min_allowed, HybridTime ht_lease) const;
+
+  // Checks that safe time does not go backwards, i.e. is not less than `enforced_min_time` loaded
+  // before calculating it, and remembers the returned value.
+  HybridTime SafeTimeReturned(bool has_lease, HybridTime enforced_min_time,
+                              HybridTime result, SafeTimeSource source,
+                              HybridTime min_allowed, HybridTime ht_lease) const;
+
   const std::string& LogPrefix() const { return prefix_; }
   void PopFront(std::lock_guard<std::mutex>* lock);
 
+  // Publishes the front of the queue to queue_front_. Should be called with the mutex held.
+  void PublishQueueFront();
+
+  SafeTimeWithSource MaxSafeTimeReturnedWithLease() const;
+  SafeTimeWithSource MaxSafeTimeReturnedWithoutLease() const;
+  SafeTimeWithSource MaxSafeTimeReturnedForFollower() const;
+
   std::string prefix_;
   server::ClockPtr clock_;
   mutable std::mutex mutex_;
@@ -146,21 +186,37 @@ class MvccManager {
   // Required because we could abort operations from the middle of the queue.
   std::priority_queue<HybridTime, std::vector<HybridTime>, std::greater<>> aborted_;
 
-  HybridTime last_replicated_ = HybridTime::kMin;
+  // Sequence counter of the published state, i.e. queue_front_ and last_replicated_. It is odd
+  // while the state is being modified. Readers that observed the same even value before and after
+  // reading the state have seen a consistent snapshot.
+  std::atomic<uint64_t> seq_{0};
+
+  // Front of queue_, or invalid hybrid time if the queue is empty. Modified only with the mutex
+  // held.
+  std::atomic<HybridTime> queue_front_{HybridTime::kInvalid};
+
+  std::atomic<HybridTime> last_replicated_{HybridTime::kMin};
 
   // If we are a follower, this is the latest safe time sent by the leader to us. If we are the
   // leader, this is a safe time that gets updated every time the majority-replicated watermarks
-  // change.
-  HybridTime propagated_safe_time_ = HybridTime::kMin;
+  // change. Modified only with the mutex held.
+  std::atomic<HybridTime> propagated_safe_time_{HybridTime::kMin};
 
   // Because different calls that have current hybrid time leader lease as an argument can come to
   // us out of order, we might see an older value of hybrid time leader lease expiration after a
   // newer value. We mitigate this by always using the highest value we've seen.
-  mutable HybridTime max_ht_lease_seen_ = HybridTime::kMin;
-
-  mutable SafeTimeWithSource max_safe_time_returned_with_lease_;
-  mutable SafeTimeWithSource max_safe_time_returned_without_lease_;
-  mutable SafeTimeWithSource max_safe_time_returned_for_follower_ { HybridTime::kMin };
+  mutable std::atomic<HybridTime> max_ht_lease_seen_{HybridTime::kMin};
+
+  // Max values of safe time returned for sanity checking. Sources are tracked separately and are
+  // used only for diagnostics.
+  mutable std::atomic<HybridTime> max_safe_time_returned_with_lease_{HybridTime::kMin};
+  mutable std::atomic<HybridTime> max_safe_time_returned_without_lease_{HybridTime::kMin};
+  mutable std::atomic<HybridTime> max_safe_time_returned_for_follower_{HybridTime::kMin};
+  mutable std::atomic<SafeTimeSource> max_safe_time_source_with_lease_{SafeTimeSource::kUnknown};
+  mutable std::atomic<SafeTimeSource> max_safe_time_source_without_lease_{
+      SafeTimeSource::kUnknown};
+  mutable std::atomic<SafeTimeSource> max_safe_time_source_for_follower_{
+      SafeTimeSource::kUnknown};
 };
 
 }  // namespace tablet
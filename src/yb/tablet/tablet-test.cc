@@ -50,6 +50,9 @@
 
 #include "yb/util/enums.h"
 
+DECLARE_bool(rocksdb_disable_compactions);
+DECLARE_int32(rocksdb_leveled_compaction_num_levels);
+
 using std::shared_ptr;
 using std::unordered_set;
 
@@ -214,5 +217,52 @@ TYPED_TEST(TestTablet, TestFlushedOpId) {
   ASSERT_EQ(id.index, start_index + 2*kCount);
 }
 
+struct LeveledCompactionTestSetup : public IntKeyTestSetup<INT32> {
+  static Schema CreateSchema() {
+    TableProperties table_properties;
+    table_properties.SetCompactionStyle(TableCompactionStyle::LEVELED_COMPACTION);
+    return Schema({ ColumnSchema("key", INT32, false, true),
+                    ColumnSchema("key_idx", INT32),
+                    ColumnSchema("val", INT32) }, 1, table_properties);
+  }
+};
+
+class LeveledCompactionTabletTest : public TabletTestBase<LeveledCompactionTestSetup> {
+ protected:
+  void CheckFilesBelowLevel0() {
+    auto files = tablet()->TEST_db()->GetLiveFilesMetaData();
+    ASSERT_FALSE(files.empty());
+    for (const auto& file : files) {
+      ASSERT_GT(file.level, 0) << file.name;
+    }
+  }
+};
+
+TEST_F(LeveledCompactionTabletTest, WriteCompactAndReopen) {
+  constexpr int kNumFlushes = 4;
+  constexpr int64_t kRowsPerFlush = 100;
+
+  ASSERT_EQ(FLAGS_rocksdb_leveled_compaction_num_levels, tablet()->TEST_db()->NumberLevels());
+  for (int i = 0; i != kNumFlushes; ++i) {
+    InsertTestRows(i * kRowsPerFlush, kRowsPerFlush, i);
+    ASSERT_OK(tablet()->Flush(FlushMode::kSync));
+  }
+  tablet()->ForceRocksDBCompactInTest();
+  ASSERT_NO_FATALS(CheckFilesBelowLevel0());
+  ASSERT_NO_FATALS(VerifyTestRows(0, kNumFlushes * kRowsPerFlush));
+
+  // A leveled DB must keep its levels when reopened with compactions disabled.
+  FLAGS_rocksdb_disable_compactions = true;
+  tablet()->Shutdown();
+  TabletReOpen();
+  ASSERT_EQ(FLAGS_rocksdb_leveled_compaction_num_levels, tablet()->TEST_db()->NumberLevels());
+  ASSERT_NO_FATALS(CheckFilesBelowLevel0());
+  ASSERT_NO_FATALS(VerifyTestRows(0, kNumFlushes * kRowsPerFlush));
+
+  InsertTestRows(kNumFlushes * kRowsPerFlush, kRowsPerFlush, kNumFlushes);
+  ASSERT_OK(tablet()->Flush(FlushMode::kSync));
+  ASSERT_NO_FATALS(VerifyTestRows(0, (kNumFlushes + 1) * kRowsPerFlush));
+}
+
 } // namespace tablet
 } // namespace yb
@@ -76,6 +76,7 @@
 #include "yb/docdb/docdb_compaction_filter_intents.h"
 #include "yb/docdb/docdb_rocksdb_util.h"
 #include "yb/docdb/intent.h"
+#include "yb/docdb/intent_index.h"
 #include "yb/docdb/primitive_value.h"
 #include "yb/docdb/lock_batch.h"
 
@@ -84,6 +85,7 @@
 #include "yb/gutil/stl_util.h"
 #include "yb/gutil/strings/numbers.h"
 #include "yb/gutil/strings/substitute.h"
+#include "yb/rpc/thread_pool.h"
 #include "yb/rocksutil/yb_rocksdb.h"
 #include "yb/rocksutil/yb_rocksdb_logger.h"
 #include "yb/server/hybrid_clock.h"
@@ -106,11 +108,14 @@
 #include "yb/util/locks.h"
 #include "yb/util/mem_tracker.h"
 #include "yb/util/metrics.h"
+#include "yb/util/size_literals.h"
 #include "yb/util/slice.h"
 #include "yb/util/stopwatch.h"
 #include "yb/util/trace.h"
 #include "yb/util/url-coding.h"
 
+using namespace yb::size_literals;
+
 DEFINE_bool(tablet_do_dup_key_checks, true,
             "Whether to check primary keys for duplicate on insertion. "
             "Use at your own risk!");
@@ -143,6 +148,26 @@ DEFINE_int32(intents_flush_max_delay_ms, 2000,
              "Max time to wait for regular db to flush during flush of intents. "
              "After this time flush of regular db will be forced.");
 
+DEFINE_uint64(txn_max_apply_batch_records, 100000,
+              "Max number of intent records of committed transaction that are applied or removed "
+              "in a single RocksDB write batch.");
+TAG_FLAG(txn_max_apply_batch_records, advanced);
+
+DEFINE_uint64(txn_max_apply_pending_deletes_bytes, 64_MB,
+              "Max size of intent deletes that are kept in memory while regular records of a "
+              "committed transaction are written. Remaining intents are removed in a separate "
+              "pass over the transaction reverse index.");
+TAG_FLAG(txn_max_apply_pending_deletes_bytes, advanced);
+
+DEFINE_test_flag(int32, apply_intents_crash_after_batches, 0,
+                 "If set, apply of transaction intents stops after writing the specified number "
+                 "of write batches, leaving RocksDB as if the tablet server crashed at this "
+                 "point.");
+
+DEFINE_test_flag(bool, apply_intents_flush_before_crash, false,
+                 "If set, intents DB is flushed before apply of transaction intents is stopped "
+                 "by apply_intents_crash_after_batches.");
+
 using namespace std::placeholders;
 
 using std::shared_ptr;
@@ -204,6 +229,40 @@ using docdb::PrimitiveValue;
 
 namespace {
 
+// Loads intents written before restart into the intent index, so tablet could serve requests
+// meanwhile.
+class RebuildIntentIndexTask : public rpc::ThreadPoolTask {
+ public:
+  RebuildIntentIndexTask(std::shared_ptr<docdb::IntentIndex> intent_index,
+                         rocksdb::DB* intents_db,
+                         std::string log_prefix)
+      : intent_index_(std::move(intent_index)), intents_db_(intents_db),
+        log_prefix_(std::move(log_prefix)) {}
+
+  void Prepare(std::shared_ptr<RebuildIntentIndexTask> self) {
+    retain_self_ = std::move(self);
+  }
+
+  void Run() override {
+    // Tablet stops rebuild before destroying intents DB, so it is safe to access it here.
+    auto status = intent_index_->Rebuild(intents_db_);
+    LOG_IF(WARNING, !status.ok() && !status.IsAborted())
+        << log_prefix_ << "Failed to rebuild intent index: " << status;
+  }
+
+  void Done(const Status& status) override {
+    retain_self_ = nullptr;
+  }
+
+  virtual ~RebuildIntentIndexTask() {}
+
+ private:
+  std::shared_ptr<docdb::IntentIndex> intent_index_;
+  rocksdb::DB* intents_db_;
+  std::string log_prefix_;
+  std::shared_ptr<RebuildIntentIndexTask> retain_self_;
+};
+
 void EmitRocksDbMetricsAsJson(
     std::shared_ptr<rocksdb::Statistics> rocksdb_statistics,
     JsonWriter* writer,
@@ -350,7 +409,7 @@ Tablet::Tablet(
 
   if (transaction_participant_context && metadata->schema().table_properties().is_transactional()) {
     transaction_participant_ = std::make_unique<TransactionParticipant>(
-        transaction_participant_context, this);
+        transaction_participant_context, this, metric_entity_);
     // Create transaction manager for secondary index update.
     if (!metadata_->index_map().empty()) {
       transaction_manager_.emplace(client_future_.get(),
@@ -498,8 +557,10 @@ Status Tablet::OpenKeyValueTablet() {
   RETURN_NOT_OK(CreateTabletDirectories(db_dir, metadata()->fs_manager()));
 
   LOG(INFO) << "Opening RocksDB at: " << db_dir;
+  rocksdb::Options regular_db_options = rocksdb_options;
+  docdb::SetRocksDBCompactionStyle(&regular_db_options, metadata()->schema().table_properties());
   rocksdb::DB* db = nullptr;
-  rocksdb::Status rocksdb_open_status = rocksdb::DB::Open(rocksdb_options, db_dir, &db);
+  rocksdb::Status rocksdb_open_status = rocksdb::DB::Open(regular_db_options, db_dir, &db);
   if (!rocksdb_open_status.ok()) {
     LOG_WITH_PREFIX(ERROR) << "Failed to open a RocksDB database in directory " << db_dir << ": "
                            << rocksdb_open_status;
@@ -526,6 +587,16 @@ Status Tablet::OpenKeyValueTablet() {
     rocksdb::DB* intents_db = nullptr;
     RETURN_NOT_OK(rocksdb::DB::Open(rocksdb_options, db_dir + kIntentsDBSuffix, &intents_db));
     intents_db_.reset(intents_db);
+
+    // Intents written before restart are loaded to the index in background, conflict resolution
+    // reads them from intents DB until that is done.
+    intent_index_ = std::make_shared<docdb::IntentIndex>(
+        MemTracker::FindOrCreateTracker("IntentIndex", mem_tracker_));
+    auto rebuild_task = std::make_shared<RebuildIntentIndexTask>(
+        intent_index_, intents_db_.get(), LogPrefix());
+    if (transaction_participant_->context()->thread_pool().Enqueue(rebuild_task.get())) {
+      rebuild_task->Prepare(rebuild_task);
+    }
   }
 
   ql_storage_.reset(new docdb::QLRocksDBStorage({regular_db_.get(), intents_db_.get()}));
@@ -560,6 +631,9 @@ void Tablet::Shutdown() {
   }
 
   std::lock_guard<rw_spinlock> lock(component_lock_);
+  if (intent_index_) {
+    intent_index_->StopRebuild();
+  }
   // Shutdown the RocksDB instance for this table, if present.
   // Destroy intents and regular DBs in reverse order to their creation.
   // Also it makes sure that regular DB is alive during flush filter of intents db.
@@ -693,7 +767,8 @@ void Tablet::PrepareTransactionWriteBatch(
   auto isolation_level = metadata_with_write_id->first.isolation;
   auto write_id = metadata_with_write_id->second;
   yb::docdb::PrepareTransactionWriteBatch(
-      put_batch, hybrid_time, rocksdb_write_batch, transaction_id, isolation_level, &write_id);
+      put_batch, hybrid_time, rocksdb_write_batch, transaction_id, isolation_level, &write_id,
+      intent_index_.get());
   transaction_participant()->UpdateLastWriteId(transaction_id, write_id);
 }
 
@@ -1243,47 +1318,124 @@ Status Tablet::ImportData(const std::string& source_dir) {
 // We apply intents using by iterating over whole transaction reverse index.
 // Using value of reverse index record we find original intent record and apply it.
 // After that we delete both intent record and reverse index record.
+// Big transaction is applied in several write batches, each containing at most
+// FLAGS_txn_max_apply_batch_records records, so it does not produce a single huge write batch.
 // TODO(dtxn) use separate thread for applying intents.
-// TODO(dtxn) use multiple batches when applying really big transaction.
 Status Tablet::ApplyIntents(const TransactionApplyData& data) {
-  rocksdb::WriteBatch regular_write_batch;
-  rocksdb::WriteBatch intents_write_batch;
-  RETURN_NOT_OK(docdb::PrepareApplyIntentsBatch(
-      data.transaction_id, data.commit_ht,
-      &regular_write_batch, intents_db_.get(), &intents_write_batch));
-
   // data.hybrid_time contains transaction commit time.
   // We don't set transaction field of put_batch, otherwise we would write another bunch of intents.
   docdb::ConsensusFrontiers frontiers;
   set_op_id({data.op_id.term(), data.op_id.index()}, &frontiers);
   set_hybrid_time(data.log_ht, &frontiers);
-  WriteBatch(&frontiers, data.commit_ht, &regular_write_batch, regular_db_.get());
-  WriteBatch(&frontiers, data.commit_ht, &intents_write_batch, intents_db_.get());
+
+  const int crash_after_batches = FLAGS_apply_intents_crash_after_batches;
+  int num_written_batches = 0;
+  auto simulate_crash = [this, &data, crash_after_batches, &num_written_batches] {
+    if (PREDICT_TRUE(crash_after_batches <= 0) ||
+        num_written_batches++ != crash_after_batches) {
+      return false;
+    }
+    if (FLAGS_apply_intents_flush_before_crash) {
+      WARN_NOT_OK(Flush(FlushMode::kSync, FlushFlags::kIntents), "Flush intents DB failed");
+    }
+    LOG_WITH_PREFIX(WARNING) << "Simulated crash while applying " << data.transaction_id;
+    return true;
+  };
+
+  // Deletes of intents are collected in the same pass over reverse index, but written only after
+  // all regular records, so readers always see either intents or regular records of the
+  // transaction. Collected deletes are limited by FLAGS_txn_max_apply_pending_deletes_bytes, intents
+  // that were not collected are removed by a second pass over the rest of the reverse index.
+  //
+  // Only the last regular write batch carries frontiers. So if tablet is restarted before all
+  // regular records were flushed, the APPLYING operation is replayed during bootstrap and intents
+  // are applied again from the beginning, producing the same regular records.
+  // Every intents write batch carries frontiers. Intents DB memtable is flushed only after regular
+  // DB was flushed up to the largest operation in the memtable, so intent deletes are never
+  // persisted without regular records. If tablet is restarted after deletes were flushed, but not
+  // all of them were written, bootstrap removes the rest of the intents.
+  std::vector<rocksdb::WriteBatch> intents_write_batches;
+  size_t pending_deletes_bytes = 0;
+  docdb::ApplyTransactionState apply_state;
+  boost::optional<docdb::ApplyTransactionState> remove_state;
+  do {
+    rocksdb::WriteBatch regular_write_batch;
+    rocksdb::WriteBatch* intents_write_batch = nullptr;
+    if (remove_state) {
+      // Deletes are not collected anymore.
+    } else if (pending_deletes_bytes < FLAGS_txn_max_apply_pending_deletes_bytes) {
+      intents_write_batches.emplace_back();
+      intents_write_batch = &intents_write_batches.back();
+    } else {
+      remove_state = apply_state;
+    }
+    apply_state = VERIFY_RESULT(docdb::PrepareApplyIntentsBatch(
+        data.transaction_id, data.commit_ht, &apply_state, FLAGS_txn_max_apply_batch_records,
+        &regular_write_batch, intents_db_.get(), intents_write_batch));
+    if (intents_write_batch) {
+      pending_deletes_bytes += intents_write_batch->GetDataSize();
+    }
+    if (simulate_crash()) {
+      return Status::OK();
+    }
+    WriteBatch(apply_state.active() ? nullptr : &frontiers, data.commit_ht, &regular_write_batch,
+               regular_db_.get());
+  } while (apply_state.active());
+
+  for (auto& intents_write_batch : intents_write_batches) {
+    if (simulate_crash()) {
+      return Status::OK();
+    }
+    WriteBatch(&frontiers, data.commit_ht, &intents_write_batch, intents_db_.get());
+  }
+  intents_write_batches.clear();
+
+  if (remove_state) {
+    do {
+      rocksdb::WriteBatch intents_write_batch;
+      remove_state = VERIFY_RESULT(docdb::PrepareApplyIntentsBatch(
+          data.transaction_id, HybridTime() /* commit_ht */, remove_state.get_ptr(),
+          FLAGS_txn_max_apply_batch_records, nullptr /* regular_batch */, intents_db_.get(),
+          &intents_write_batch));
+      if (simulate_crash()) {
+        return Status::OK();
+      }
+      WriteBatch(&frontiers, data.commit_ht, &intents_write_batch, intents_db_.get());
+    } while (remove_state->active());
+  }
+
+  intent_index_->Remove(data.transaction_id);
   return Status::OK();
 }
 
 CHECKED_STATUS Tablet::RemoveIntents(const TransactionId& id) {
-  rocksdb::WriteBatch intents_write_batch;
-  RETURN_NOT_OK(docdb::PrepareApplyIntentsBatch(
-      id, HybridTime() /* commit_ht */, nullptr /* regular_write_batch */,
-      intents_db_.get(), &intents_write_batch));
+  return RemoveIntents(TransactionIdSet{id});
+}
 
+CHECKED_STATUS Tablet::RemoveIntents(const TransactionIdSet& transactions) {
   rocksdb::WriteOptions write_options;
   InitRocksDBWriteOptions(&write_options);
-  return intents_db_->Write(write_options, &intents_write_batch);
-}
 
-CHECKED_STATUS Tablet::RemoveIntents(const TransactionIdSet& transactions) {
   rocksdb::WriteBatch intents_write_batch;
   for (const TransactionId& id : transactions) {
-    RETURN_NOT_OK(docdb::PrepareApplyIntentsBatch(
-        id, HybridTime() /* commit_ht */, nullptr /* regular_write_batch */,
-        intents_db_.get(), &intents_write_batch));
+    docdb::ApplyTransactionState apply_state;
+    do {
+      apply_state = VERIFY_RESULT(docdb::PrepareApplyIntentsBatch(
+          id, HybridTime() /* commit_ht */, &apply_state, FLAGS_txn_max_apply_batch_records,
+          nullptr /* regular_batch */, intents_db_.get(), &intents_write_batch));
+      // Intents of big transaction don't fit into a single write batch, so write collected ones.
+      if (apply_state.active()) {
+        RETURN_NOT_OK(intents_db_->Write(write_options, &intents_write_batch));
+        intents_write_batch.Clear();
+      }
+    } while (apply_state.active());
   }
 
-  rocksdb::WriteOptions write_options;
-  InitRocksDBWriteOptions(&write_options);
-  return intents_db_->Write(write_options, &intents_write_batch);
+  RETURN_NOT_OK(intents_db_->Write(write_options, &intents_write_batch));
+  for (const TransactionId& id : transactions) {
+    intent_index_->Remove(id);
+  }
+  return Status::OK();
 }
 
 HybridTime Tablet::ApplierSafeTime(HybridTime min_allowed, MonoTime deadline) {
@@ -1417,6 +1569,7 @@ Status Tablet::Truncate(TruncateOperationState *state) {
   Status intents_status;
   if (intents_db_) {
     auto intents_dir = intents_db_->GetName();
+    intent_index_->StopRebuild();
     intents_db_.reset();
     intents_status = rocksdb::DestroyDB(intents_dir, rocksdb_options);
   }
@@ -1594,7 +1747,7 @@ Status Tablet::StartDocWriteOperation(WriteOperation* operation) {
       metadata_->schema().table_properties().is_transactional()) {
     auto now = clock_->Now();
     auto result = docdb::ResolveOperationConflicts(
-        operation->doc_ops(), now, {regular_db_.get(), intents_db_.get()},
+        operation->doc_ops(), now, {regular_db_.get(), intents_db_.get()}, intent_index_.get(),
         transaction_participant_.get());
     RETURN_NOT_OK(result);
     if (now != *result) {
@@ -1621,7 +1774,7 @@ Status Tablet::StartDocWriteOperation(WriteOperation* operation) {
 
   if (*isolation_level != IsolationLevel::NON_TRANSACTIONAL) {
     RETURN_NOT_OK(docdb::ResolveTransactionConflicts(
-        *write_batch, clock_->Now(), {regular_db_.get(), intents_db_.get()},
+        *write_batch, clock_->Now(), {regular_db_.get(), intents_db_.get()}, intent_index_.get(),
         transaction_participant_.get(), metrics_->transaction_conflicts.get()));
   }
   operation->state()->ReplaceDocDBLocks(std::move(keys_locked));
@@ -1632,6 +1785,7 @@ Status Tablet::StartDocWriteOperation(WriteOperation* operation) {
 HybridTime Tablet::DoGetSafeTime(
     tablet::RequireLease require_lease, HybridTime min_allowed, MonoTime deadline) const {
   HybridTime ht_lease;
+  bool waited = false;
   if (!require_lease) {
     return mvcc_.SafeTimeForFollower(min_allowed, deadline);
   }
@@ -1642,11 +1796,17 @@ HybridTime Tablet::DoGetSafeTime(
     if (min_allowed.GetLogicalValue()) {
       ++min_allowed_lease;
     }
-    // This will block until a leader lease reaches the given value or a timeout occurs.
-    ht_lease = ht_lease_provider_(min_allowed_lease, deadline);
+    // Check the current lease without blocking first, so that reads that had to wait for it are
+    // accounted separately.
+    ht_lease = ht_lease_provider_(min_allowed_lease, MonoTime::kMin);
     if (!ht_lease) {
-      // This could happen in case of timeout.
-      return HybridTime::kInvalid;
+      waited = true;
+      // This will block until a leader lease reaches the given value or a timeout occurs.
+      ht_lease = ht_lease_provider_(min_allowed_lease, deadline);
+      if (!ht_lease) {
+        // This could happen in case of timeout.
+        return HybridTime::kInvalid;
+      }
     }
   } else {
     ht_lease = HybridTime::kMax;
@@ -1656,6 +1816,28 @@ HybridTime Tablet::DoGetSafeTime(
         << "Read request hybrid time after leader lease: " << min_allowed << ", " << ht_lease;
     return HybridTime::kInvalid;
   }
+  if (!waited) {
+    // With no writes in flight the read time is limited only by the lease, so there is no need to
+    // go through the MVCC queue.
+    auto result = mvcc_.SafeTimeIfIdle(min_allowed, ht_lease);
+    // The read time comes from the lease only when the hybrid time lease is enabled.
+    const bool served_from_lease = result && ht_lease != HybridTime::kMax;
+    if (!result) {
+      // Writes are in flight, but the read does not have to wait for them if they got hybrid times
+      // after min_allowed.
+      result = mvcc_.SafeTime(min_allowed, MonoTime::kMin, ht_lease);
+    }
+    if (result) {
+      if (metrics_) {
+        (served_from_lease ? metrics_->lease_served_reads : metrics_->safe_time_no_wait_reads)
+            ->Increment();
+      }
+      return result;
+    }
+  }
+  if (metrics_) {
+    metrics_->safe_time_wait_reads->Increment();
+  }
   return mvcc_.SafeTime(min_allowed, deadline, ht_lease);
 }
 
@@ -56,6 +56,7 @@
 #include "yb/docdb/docdb.pb.h"
 #include "yb/docdb/docdb_compaction_filter.h"
 #include "yb/docdb/doc_operation.h"
+#include "yb/docdb/intent_index.h"
 #include "yb/docdb/ql_rocksdb_storage.h"
 #include "yb/docdb/shared_lock_manager.h"
 
@@ -484,6 +485,10 @@ class Tablet : public AbstractTablet, public TransactionIntentApplier {
     return regular_db_.get();
   }
 
+  const docdb::IntentIndex* TEST_intent_index() const {
+    return intent_index_.get();
+  }
+
   CHECKED_STATUS TEST_SwitchMemtable();
 
  protected:
@@ -617,6 +622,10 @@ class Tablet : public AbstractTablet, public TransactionIntentApplier {
 
   std::unique_ptr<rocksdb::DB> intents_db_;
 
+  // In-memory index of intents_db_ used for conflict resolution. Shared with the task that rebuilds
+  // it after the tablet is opened.
+  std::shared_ptr<docdb::IntentIndex> intent_index_;
+
   std::unique_ptr<common::YQLStorageIf> ql_storage_;
 
   // This is for docdb fine-grained locking.
@@ -43,11 +43,13 @@
 #include "yb/tablet/operations/truncate_operation.h"
 #include "yb/tablet/operations/update_txn_operation.h"
 #include "yb/tablet/operations/write_operation.h"
+#include "yb/util/countdown_latch.h"
 #include "yb/util/fault_injection.h"
 #include "yb/util/flag_tags.h"
 #include "yb/util/opid.h"
 #include "yb/util/logging.h"
 #include "yb/util/stopwatch.h"
+#include "yb/util/threadpool.h"
 
 DEFINE_bool(skip_remove_old_recovery_dir, false,
             "Skip removing WAL recovery dir after startup. (useful for debugging)");
@@ -57,6 +59,11 @@ DEFINE_test_flag(double, fault_crash_during_log_replay, 0.0,
                  "Fraction of the time when the tablet will crash immediately "
                  "after processing a log entry during log replay.");
 
+DEFINE_bool(tablet_bootstrap_prefetch_log_segments, true,
+            "Read and decode the next WAL segment in the background while the entries of the "
+            "current one are replayed during tablet bootstrap.");
+TAG_FLAG(tablet_bootstrap_prefetch_log_segments, advanced);
+
 DECLARE_uint64(max_clock_sync_error_usec);
 
 namespace yb {
@@ -102,6 +109,49 @@ static string DebugInfo(const string& tablet_id,
                     segment_path, debug_str);
 }
 
+namespace {
+
+// Entries of a log segment, read in the background when a pool is specified.
+class SegmentReader {
+ public:
+  SegmentReader(const scoped_refptr<ReadableLogSegment>& segment, ThreadPool* pool)
+      : state_(std::make_shared<State>(segment)) {
+    if (pool) {
+      auto state = state_;
+      submitted_ = pool->SubmitFunc([state] { state->Read(); }).ok();
+    }
+  }
+
+  // Waits until the segment is read and returns its entries.
+  log::ReadEntriesResult Get() {
+    if (!submitted_) {
+      state_->Read();
+    }
+    state_->latch.Wait();
+    return std::move(state_->result);
+  }
+
+ private:
+  // Shared with the background task, so the reader could be destroyed before the task completes.
+  struct State {
+    explicit State(const scoped_refptr<ReadableLogSegment>& segment_) : segment(segment_) {}
+
+    void Read() {
+      result = segment->ReadEntries();
+      latch.CountDown();
+    }
+
+    scoped_refptr<ReadableLogSegment> segment;
+    log::ReadEntriesResult result;
+    CountDownLatch latch{1};
+  };
+
+  std::shared_ptr<State> state_;
+  bool submitted_ = false;
+};
+
+} // namespace
+
 // ============================================================================
 //  Class ReplayState.
 // ============================================================================
@@ -660,9 +710,10 @@ Status TabletBootstrap::HandleEntryPair(ReplayState* state, LogEntryPB* replicat
     if (replicate->transaction_state().status() == TransactionStatus::APPLYING) {
       auto index = replicate->id().index();
       if (index <= state->regular_stored_op_id.index() &&
-          index > state->intents_stored_op_id.index()) {
+          index >= state->intents_stored_op_id.index()) {
         // We are in a state when committed intents were applied and flushed to regular DB, but
-        // intents store was not flushed.
+        // intents store was not flushed, or was flushed when only some of the intents were
+        // removed.
         return PlayUpdateTransactionRequest(replicate, AlreadyApplied::kTrue);
       }
     }
@@ -734,11 +785,25 @@ Status TabletBootstrap::PlaySegments(ConsensusBootstrapInfo* consensus_info) {
   // from the log we're reading into the log we're writing.
   RETURN_NOT_OK_PREPEND(OpenNewLog(), "Failed to open new log");
 
+  // Segments are read one ahead of the one being replayed, so that reading and decoding the log
+  // overlaps with applying its entries to RocksDB.
+  auto* prefetch_pool = FLAGS_tablet_bootstrap_prefetch_log_segments ? data_.log_prefetch_pool
+                                                                     : nullptr;
+  std::unique_ptr<SegmentReader> next_reader;
+  if (!segments.empty()) {
+    next_reader = std::make_unique<SegmentReader>(segments.front(), prefetch_pool);
+  }
+
   int segment_count = 0;
   yb::OpId last_committed_op_id;
   RestartSafeCoarseTimePoint last_entry_time;
-  for (const scoped_refptr<ReadableLogSegment>& segment : segments) {
-    auto read_result = segment->ReadEntries();
+  for (size_t segment_idx = 0; segment_idx != segments.size(); ++segment_idx) {
+    const scoped_refptr<ReadableLogSegment>& segment = segments[segment_idx];
+    auto read_result = next_reader->Get();
+    next_reader.reset();
+    if (segment_idx + 1 != segments.size()) {
+      next_reader = std::make_unique<SegmentReader>(segments[segment_idx + 1], prefetch_pool);
+    }
     last_committed_op_id = std::max(last_committed_op_id, read_result.committed_op_id);
     for (int entry_idx = 0; entry_idx < read_result.entries.size(); ++entry_idx) {
       Status s = HandleEntry(
@@ -125,6 +125,9 @@ struct BootstrapTabletData {
   TransactionCoordinatorContext* transaction_coordinator_context;
   ThreadPool* append_pool;
   consensus::RetryableRequests* retryable_requests;
+  // Pool used to read the next log segment while the current one is replayed. Segments are read
+  // synchronously when not specified.
+  ThreadPool* log_prefetch_pool;
 };
 
 // Bootstraps a tablet, initializing it with the provided metadata. If the tablet
@@ -129,6 +129,36 @@ METRIC_DEFINE_counter(tablet, restart_read_requests,
   yb::MetricUnit::kRequests,
   "Number of read requests that require restart.");
 
+METRIC_DEFINE_counter(tablet, lease_served_reads,
+  "Reads Served From Leader Lease",
+  yb::MetricUnit::kRequests,
+  "Number of strongly consistent reads whose read time was taken from the hybrid time leader "
+  "lease without waiting for in-flight writes.");
+
+METRIC_DEFINE_counter(tablet, safe_time_wait_reads,
+  "Reads Waiting For Safe Time",
+  yb::MetricUnit::kRequests,
+  "Number of strongly consistent reads that had to wait for the leader lease or for in-flight "
+  "writes to pick their read time.");
+
+METRIC_DEFINE_counter(tablet, safe_time_no_wait_reads,
+  "Reads Not Waiting For Safe Time",
+  yb::MetricUnit::kRequests,
+  "Number of strongly consistent reads that picked their read time without waiting, but not from "
+  "the leader lease, because writes were in flight or the hybrid time leader lease is disabled.");
+
+METRIC_DEFINE_counter(tablet, transaction_heartbeat_rpcs_saved,
+  "Transaction Heartbeat RPCs Saved",
+  yb::MetricUnit::kRequests,
+  "Number of transaction heartbeat RPCs saved by receiving heartbeats of several transactions "
+  "in a single RPC.");
+
+METRIC_DEFINE_counter(tablet, transaction_status_rpcs_saved,
+  "Transaction Status RPCs Saved",
+  yb::MetricUnit::kRequests,
+  "Number of transaction status RPCs saved by receiving status requests of several transactions "
+  "in a single RPC.");
+
 using strings::Substitute;
 
 namespace yb {
@@ -145,7 +175,12 @@ TabletMetrics::TabletMetrics(const scoped_refptr<MetricEntity>& entity)
     MINIT(leader_memory_pressure_rejections),
     MINIT(transaction_conflicts),
     MINIT(expired_transactions),
-    MINIT(restart_read_requests) {
+    MINIT(restart_read_requests),
+    MINIT(lease_served_reads),
+    MINIT(safe_time_wait_reads),
+    MINIT(safe_time_no_wait_reads),
+    MINIT(transaction_heartbeat_rpcs_saved),
+    MINIT(transaction_status_rpcs_saved) {
 }
 #undef MINIT
 
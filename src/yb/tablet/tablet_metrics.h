@@ -65,6 +65,11 @@ struct TabletMetrics {
   scoped_refptr<Counter> transaction_conflicts;
   scoped_refptr<Counter> expired_transactions;
   scoped_refptr<Counter> restart_read_requests;
+  scoped_refptr<Counter> lease_served_reads;
+  scoped_refptr<Counter> safe_time_wait_reads;
+  scoped_refptr<Counter> safe_time_no_wait_reads;
+  scoped_refptr<Counter> transaction_heartbeat_rpcs_saved;
+  scoped_refptr<Counter> transaction_status_rpcs_saved;
 };
 
 class ScopedTabletMetricsTracker {
@@ -17,15 +17,26 @@ namespace rocksdb {
 class Cache;
 class EventListener;
 class MemoryMonitor;
+class PinnedBlocksBudget;
+class RateLimiter;
 }
 
 namespace yb {
+
+class PriorityThreadPool;
+
 namespace tablet {
 
 struct TabletOptions {
   std::shared_ptr<rocksdb::Cache> block_cache;
+  // Budget for index and filter blocks pinned by tablets, used only together with block_cache.
+  std::shared_ptr<rocksdb::PinnedBlocksBudget> pinned_blocks_budget;
   std::shared_ptr<rocksdb::MemoryMonitor> memory_monitor;
   std::vector<std::shared_ptr<rocksdb::EventListener>> listeners;
+  // Flush and compaction rate limiter and thread pool shared by all tablets of the server. When not
+  // set, every RocksDB instance gets its own rate limiter or uses the Env thread pools.
+  std::shared_ptr<rocksdb::RateLimiter> rate_limiter;
+  std::shared_ptr<PriorityThreadPool> priority_thread_pool;
 };
 
 } // namespace tablet
@@ -172,7 +172,8 @@ class TabletPeerTest : public YBTabletTest,
                                            metric_entity_,
                                            raft_pool_.get(),
                                            tablet_prepare_pool_.get(),
-                                           nullptr /* retryable_requests */));
+                                           nullptr /* retryable_requests */,
+                                           nullptr /* multi_raft_manager */));
   }
 
   Status StartPeer(const ConsensusBootstrapInfo& info) {
@@ -162,7 +162,8 @@ Status TabletPeer::InitTabletPeer(const shared_ptr<TabletClass> &tablet,
                                   const scoped_refptr<MetricEntity> &metric_entity,
                                   ThreadPool* raft_pool,
                                   ThreadPool* tablet_prepare_pool,
-                                  consensus::RetryableRequests* retryable_requests) {
+                                  consensus::RetryableRequests* retryable_requests,
+                                  consensus::MultiRaftManager* multi_raft_manager) {
 
   DCHECK(tablet) << "A TabletPeer must be provided with a Tablet";
   DCHECK(log) << "A TabletPeer must be provided with a Log";
@@ -230,7 +231,8 @@ Status TabletPeer::InitTabletPeer(const shared_ptr<TabletClass> &tablet,
         mark_dirty_clbk_,
         tablet_->table_type(),
         raft_pool,
-        retryable_requests);
+        retryable_requests,
+        multi_raft_manager);
     has_consensus_.store(true, std::memory_order_release);
     auto ht_lease_provider = [this](MicrosTime min_allowed, MonoTime deadline) {
       MicrosTime lease_micros {
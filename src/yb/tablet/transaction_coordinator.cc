@@ -231,15 +231,17 @@ class TransactionState {
     NotifyAbortWaiters(status);
   }
 
-  CHECKED_STATUS GetStatus(tserver::GetTransactionStatusResponsePB* response) const {
+  // Appends status of this transaction to response.
+  void GetStatus(tserver::GetTransactionStatusResponsePB* response) const {
     if (status_ == TransactionStatus::COMMITTED) {
-      response->set_status(TransactionStatus::COMMITTED);
-      response->set_status_hybrid_time(commit_time_.ToUint64());
+      response->add_statuses(TransactionStatus::COMMITTED);
+      response->add_status_hybrid_times(commit_time_.ToUint64());
     } else if (status_ == TransactionStatus::ABORTED) {
-      response->set_status(TransactionStatus::ABORTED);
+      response->add_statuses(TransactionStatus::ABORTED);
+      response->add_status_hybrid_times(HybridTime::kMax.ToUint64());
     } else {
       CHECK_EQ(TransactionStatus::PENDING, status_);
-      response->set_status(TransactionStatus::PENDING);
+      response->add_statuses(TransactionStatus::PENDING);
       HybridTime status_ht = context_.coordinator_context().clock().Now();
       if (replicating_) {
         auto replicating_status = replicating_->request()->status();
@@ -252,9 +254,8 @@ class TransactionState {
         }
       }
       status_ht = std::min(status_ht, context_.coordinator_context().HtLeaseExpiration());
-      response->set_status_hybrid_time(status_ht.Decremented().ToUint64());
+      response->add_status_hybrid_times(status_ht.Decremented().ToUint64());
     }
-    return Status::OK();
   }
 
   TransactionStatus Abort(TransactionAbortCallback* callback) {
@@ -636,20 +637,25 @@ class TransactionCoordinator::Impl : public TransactionStateContext {
     rpcs_.Shutdown();
   }
 
-  CHECKED_STATUS GetStatus(const std::string& transaction_id,
+  CHECKED_STATUS GetStatus(const google::protobuf::RepeatedPtrField<std::string>& transaction_ids,
                            tserver::GetTransactionStatusResponsePB* response) {
-    auto id = FullyDecodeTransactionId(transaction_id);
-    if (!id.ok()) {
-      return std::move(id.status());
+    std::vector<TransactionId> ids;
+    ids.reserve(transaction_ids.size());
+    for (const auto& transaction_id : transaction_ids) {
+      ids.push_back(VERIFY_RESULT(FullyDecodeTransactionId(transaction_id)));
     }
 
     std::lock_guard<std::mutex> lock(managed_mutex_);
-    auto it = managed_transactions_.find(*id);
-    if (it == managed_transactions_.end()) {
-      response->set_status(TransactionStatus::ABORTED);
-      return Status::OK();
+    for (const auto& id : ids) {
+      auto it = managed_transactions_.find(id);
+      if (it == managed_transactions_.end()) {
+        response->add_statuses(TransactionStatus::ABORTED);
+        response->add_status_hybrid_times(HybridTime::kMax.ToUint64());
+      } else {
+        it->GetStatus(response);
+      }
     }
-    return it->GetStatus(response);
+    return Status::OK();
   }
 
   void Abort(const std::string& transaction_id, int64_t term, TransactionAbortCallback callback) {
@@ -749,37 +755,56 @@ class TransactionCoordinator::Impl : public TransactionStateContext {
   }
 
   void Handle(std::unique_ptr<tablet::UpdateTxnOperationState> request, int64_t term) {
-    auto& state = *request->request();
-    auto id = FullyDecodeTransactionId(state.transaction_id());
-    if (!id.ok()) {
-      LOG(WARNING) << "Failed to decode id from " << state.ShortDebugString() << ": " << id;
-      request->CompleteWithStatus(id.status());
-      return;
+    UpdateTxnOperationStates requests;
+    requests.push_back(std::move(request));
+    Handle(&requests, term);
+  }
+
+  void Handle(UpdateTxnOperationStates* requests, int64_t term) {
+    std::vector<std::pair<TransactionId, std::unique_ptr<tablet::UpdateTxnOperationState>>> decoded;
+    decoded.reserve(requests->size());
+    for (auto& request : *requests) {
+      auto& state = *request->request();
+      auto id = FullyDecodeTransactionId(state.transaction_id());
+      if (!id.ok()) {
+        LOG(WARNING) << "Failed to decode id from " << state.ShortDebugString() << ": " << id;
+        request->CompleteWithStatus(id.status());
+        continue;
+      }
+      decoded.emplace_back(*id, std::move(request));
     }
+    requests->clear();
 
+    UpdateTxnOperationStates unknown;
     PostponedLeaderActions actions;
     {
       std::unique_lock<std::mutex> lock(managed_mutex_);
       postponed_leader_actions_.leader_term = term;
-      auto it = managed_transactions_.find(*id);
-      if (it == managed_transactions_.end()) {
-        if (state.status() == TransactionStatus::CREATED) {
+      for (auto& id_and_request : decoded) {
+        const auto& id = id_and_request.first;
+        auto& request = id_and_request.second;
+        auto it = managed_transactions_.find(id);
+        if (it == managed_transactions_.end()) {
+          if (request->request()->status() != TransactionStatus::CREATED) {
+            unknown.push_back(std::move(request));
+            continue;
+          }
           it = managed_transactions_.emplace(
-              this, *id, context_.clock().Now(), log_prefix_).first;
-        } else {
-          lock.unlock();
-          YB_LOG_HIGHER_SEVERITY_WHEN_TOO_MANY(INFO, WARNING, 1s, 50)
-              << LogPrefix() << "Request to unknown transaction " << id << ": "
-              << state.ShortDebugString();
-          request->CompleteWithStatus(STATUS(Expired, "Transaction expired"));
-          return;
+              this, id, context_.clock().Now(), log_prefix_).first;
         }
-      }
 
-      Modify(it).Handle(std::move(request));
+        Modify(it).Handle(std::move(request));
+      }
       postponed_leader_actions_.Swap(&actions);
     }
 
+    for (auto& request : unknown) {
+      YB_LOG_HIGHER_SEVERITY_WHEN_TOO_MANY(INFO, WARNING, 1s, 50)
+          << LogPrefix() << "Request to unknown transaction: "
+          << request->request()->ShortDebugString();
+      request->CompleteWithStatus(STATUS(Expired, "Transaction expired"));
+    }
+
     ExecutePostponedLeaderActions(&actions);
   }
 
@@ -1031,6 +1056,10 @@ void TransactionCoordinator::Handle(
   impl_->Handle(std::move(request), term);
 }
 
+void TransactionCoordinator::Handle(UpdateTxnOperationStates* requests, int64_t term) {
+  impl_->Handle(requests, term);
+}
+
 void TransactionCoordinator::Start() {
   impl_->Start();
 }
@@ -1039,9 +1068,10 @@ void TransactionCoordinator::Shutdown() {
   impl_->Shutdown();
 }
 
-Status TransactionCoordinator::GetStatus(const std::string& transaction_id,
-                                         tserver::GetTransactionStatusResponsePB* response) {
-  return impl_->GetStatus(transaction_id, response);
+Status TransactionCoordinator::GetStatus(
+    const google::protobuf::RepeatedPtrField<std::string>& transaction_ids,
+    tserver::GetTransactionStatusResponsePB* response) {
+  return impl_->GetStatus(transaction_ids, response);
 }
 
 void TransactionCoordinator::Abort(const std::string& transaction_id,
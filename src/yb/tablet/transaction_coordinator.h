@@ -18,6 +18,9 @@
 
 #include <future>
 #include <memory>
+#include <vector>
+
+#include <google/protobuf/repeated_field.h>
 
 #include "yb/client/client_fwd.h"
 
@@ -57,6 +60,8 @@ namespace tablet {
 class TransactionIntentApplier;
 class UpdateTxnOperationState;
 
+typedef std::vector<std::unique_ptr<UpdateTxnOperationState>> UpdateTxnOperationStates;
+
 // Get current transaction timeout.
 std::chrono::microseconds GetTransactionTimeout();
 
@@ -120,6 +125,10 @@ class TransactionCoordinator {
   // Handles new request for transaction update.
   void Handle(std::unique_ptr<tablet::UpdateTxnOperationState> request, int64_t term);
 
+  // Handles requests for update of several transactions, e.g. batched heartbeats, in a single pass.
+  // Each request is completed separately.
+  void Handle(UpdateTxnOperationStates* requests, int64_t term);
+
   // Prepares log garbage collection. Return min index that should be preserved.
   int64_t PrepareGC();
 
@@ -130,7 +139,9 @@ class TransactionCoordinator {
   // And like most of other Shutdowns in our codebase it wait until shutdown completes.
   void Shutdown();
 
-  CHECKED_STATUS GetStatus(const std::string& transaction_id,
+  // Appends statuses of specified transactions to statuses and status_hybrid_times of response,
+  // in the same order.
+  CHECKED_STATUS GetStatus(const google::protobuf::RepeatedPtrField<std::string>& transaction_ids,
                            tserver::GetTransactionStatusResponsePB* response);
 
   void Abort(const std::string& transaction_id, int64_t term, TransactionAbortCallback callback);
@@ -42,11 +42,14 @@
 
 #include "yb/tserver/tserver_service.pb.h"
 
+#include "yb/util/flag_tags.h"
 #include "yb/util/locks.h"
+#include "yb/util/metrics.h"
 #include "yb/util/monotime.h"
 #include "yb/util/random_util.h"
 
 DECLARE_uint64(aborted_intent_cleanup_ms);
+DECLARE_int32(transaction_rpc_max_concurrent_batches);
 
 using namespace std::literals;
 using namespace std::placeholders;
@@ -55,6 +58,21 @@ DEFINE_uint64(transaction_delay_status_reply_usec_in_tests, 0,
               "For tests only. Delay handling status reply by specified amount of usec.");
 DEFINE_double(transaction_ignore_applying_probability_in_tests, 0,
               "Probability to ignore APPLYING update in tests.");
+DEFINE_uint64(transaction_status_cache_size, 10000,
+              "Max number of resolved, i.e. committed or aborted, transaction statuses cached "
+              "by the transaction participant of a tablet.");
+TAG_FLAG(transaction_status_cache_size, advanced);
+
+METRIC_DEFINE_counter(tablet, transaction_status_cache_hits,
+                      "Transaction Status Cache Hits",
+                      yb::MetricUnit::kRequests,
+                      "Number of local commit time lookups and transaction status requests served "
+                      "from the cache of resolved transaction statuses.");
+METRIC_DEFINE_counter(tablet, transaction_status_cache_misses,
+                      "Transaction Status Cache Misses",
+                      yb::MetricUnit::kRequests,
+                      "Number of local commit time lookups and transaction status requests that "
+                      "were not served from the cache of resolved transaction statuses.");
 
 namespace yb {
 namespace tablet {
@@ -126,6 +144,75 @@ class Delayer {
   std::deque<std::pair<MonoTime, std::function<void()>>> queue_;
 };
 
+// Bounded cache of resolved transaction statuses, i.e. commit times of committed transactions and
+// aborts. Such statuses never change, so they could be shared by all reads and conflict resolutions
+// of the tablet, while intents of the transaction are not applied or removed yet.
+class ResolvedTransactionsCache {
+ public:
+  explicit ResolvedTransactionsCache(const scoped_refptr<MetricEntity>& entity) {
+    if (entity) {
+      hits_ = METRIC_transaction_status_cache_hits.Instantiate(entity);
+      misses_ = METRIC_transaction_status_cache_misses.Instantiate(entity);
+    }
+  }
+
+  // Returns commit time of committed transaction, HybridTime::kMin for aborted transaction and
+  // HybridTime::kInvalid when status of transaction is not cached.
+  HybridTime Get(const TransactionId& id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = statuses_.find(id);
+    return it != statuses_.end() ? it->second : HybridTime::kInvalid;
+  }
+
+  void RecordHit() {
+    if (hits_) {
+      hits_->Increment();
+    }
+  }
+
+  void RecordMiss() {
+    if (misses_) {
+      misses_->Increment();
+    }
+  }
+
+  void SetCommitted(const TransactionId& id, HybridTime commit_time) {
+    Set(id, commit_time);
+  }
+
+  void SetAborted(const TransactionId& id) {
+    Set(id, HybridTime::kMin);
+  }
+
+  // Should be invoked when intents of transaction are applied or removed, so its status is not
+  // required anymore.
+  void Erase(const TransactionId& id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    statuses_.erase(id);
+  }
+
+ private:
+  void Set(const TransactionId& id, HybridTime value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!statuses_.emplace(id, value).second) {
+      return;
+    }
+    insertion_order_.push_back(id);
+    // insertion_order_ could contain ids of already erased transactions, so we could evict
+    // status earlier than required. It is OK, because it is just cache.
+    while (insertion_order_.size() > FLAGS_transaction_status_cache_size) {
+      statuses_.erase(insertion_order_.front());
+      insertion_order_.pop_front();
+    }
+  }
+
+  std::mutex mutex_;
+  std::unordered_map<TransactionId, HybridTime, TransactionIdHash> statuses_;
+  std::deque<TransactionId> insertion_order_;
+  scoped_refptr<Counter> hits_;
+  scoped_refptr<Counter> misses_;
+};
+
 class RunningTransaction;
 
 typedef std::shared_ptr<RunningTransaction> RunningTransactionPtr;
@@ -133,8 +220,10 @@ typedef std::shared_ptr<RunningTransaction> RunningTransactionPtr;
 class RunningTransactionContext {
  public:
   RunningTransactionContext(TransactionParticipantContext* participant_context,
-                            TransactionIntentApplier* applier)
-      : participant_context_(*participant_context), applier_(*applier) {
+                            TransactionIntentApplier* applier,
+                            const scoped_refptr<MetricEntity>& entity)
+      : participant_context_(*participant_context), applier_(*applier),
+        resolved_transactions_(entity) {
   }
 
   virtual ~RunningTransactionContext() {}
@@ -147,6 +236,13 @@ class RunningTransactionContext {
 
   virtual const std::string& LogPrefix() const = 0;
 
+  // Requests status of transaction from its status tablet.
+  // Requests to the same status tablet are batched, i.e. when
+  // FLAGS_transaction_rpc_max_concurrent_batches status RPCs to this tablet are in flight,
+  // new requests are queued and sent together when one of them completes.
+  void RequestStatus(client::YBClient* client, const RunningTransactionPtr& transaction,
+                     int64_t serial_no);
+
  protected:
   friend class RunningTransaction;
 
@@ -155,13 +251,66 @@ class RunningTransactionContext {
   TransactionIntentApplier& applier_;
   int64_t request_serial_ = 0;
   std::mutex mutex_;
+  ResolvedTransactionsCache resolved_transactions_;
+
+ private:
+  struct PendingStatusRequest {
+    RunningTransactionPtr transaction;
+    int64_t serial_no;
+  };
+
+  typedef std::vector<PendingStatusRequest> PendingStatusRequests;
+
+  // Status requests sent in a single RPC.
+  struct StatusRequestBatch {
+    PendingStatusRequests requests;
+    rpc::Rpcs::Handle handle;
+    // Whether this RPC is accounted in in_flight of status tablet requests.
+    bool accounted;
+  };
+
+  typedef std::shared_ptr<StatusRequestBatch> StatusRequestBatchPtr;
+
+  // Status requests of transactions that have the same status tablet.
+  struct StatusTabletRequests {
+    // Requests that wait for one of in flight RPCs to complete.
+    PendingStatusRequests queue;
+    // Number of in flight RPCs, limited by FLAGS_transaction_rpc_max_concurrent_batches.
+    int in_flight = 0;
+    // Reset when leader of status tablet does not support batched status requests.
+    // After that requests are sent to this tablet one by one, without any limit.
+    bool batching_supported = true;
+  };
+
+  void SendStatusRequests(client::YBClient* client,
+                          const TabletId& status_tablet,
+                          StatusTabletRequests* requests,
+                          PendingStatusRequests batch,
+                          bool accounted);
+
+  void StatusesReceived(client::YBClient* client,
+                        const TabletId& status_tablet,
+                        StatusTabletRequests* requests,
+                        const StatusRequestBatchPtr& batch,
+                        const Status& status,
+                        const tserver::GetTransactionStatusResponsePB& response);
+
+  // Invoked when RPC accounted in in_flight completes, to send requests queued meanwhile.
+  void StatusRequestBatchDone(client::YBClient* client,
+                              const TabletId& status_tablet,
+                              StatusTabletRequests* requests);
+
+  std::mutex status_requests_mutex_;
+  // Status requests by status tablet id.
+  std::unordered_map<TabletId, StatusTabletRequests> status_requests_;
 };
 
 class RemoveIntentsTask : public rpc::ThreadPoolTask {
  public:
   RemoveIntentsTask(TransactionIntentApplier* applier, TransactionParticipantContext* context,
-                    const TransactionId& id)
-      : applier_(*applier), context_(*context), id_(id) {}
+                    ResolvedTransactionsCache* resolved_transactions, const TransactionId& id)
+      : applier_(*applier), context_(*context), resolved_transactions_(*resolved_transactions),
+        id_(id) {}
 
   bool Prepare(RunningTransactionPtr transaction) {
     bool expected = false;
@@ -178,6 +327,9 @@ class RemoveIntentsTask : public rpc::ThreadPoolTask {
       auto status = applier_.RemoveIntents(id_);
       LOG_IF(WARNING, !status.ok()) << "Failed to remove intents of aborted transaction " << id_
                                     << ": " << status;
+      if (status.ok()) {
+        resolved_transactions_.Erase(id_);
+      }
     }
   }
 
@@ -190,6 +342,7 @@ class RemoveIntentsTask : public rpc::ThreadPoolTask {
  private:
   TransactionIntentApplier& applier_;
   TransactionParticipantContext& context_;
+  ResolvedTransactionsCache& resolved_transactions_;
   TransactionId id_;
   std::atomic<bool> used_{false};
   RunningTransactionPtr transaction_;
@@ -335,13 +488,12 @@ class RunningTransaction : public std::enable_shared_from_this<RunningTransactio
         last_write_id_(last_write_id),
         context_(*context),
         remove_intents_task_(&context->applier_, &context->participant_context_,
-                             metadata_.transaction_id),
-        get_status_handle_(context->rpcs_.InvalidHandle()),
+                             &context->resolved_transactions_, metadata_.transaction_id),
         abort_handle_(context->rpcs_.InvalidHandle()) {
   }
 
   ~RunningTransaction() {
-    context_.rpcs_.Abort({&get_status_handle_, &abort_handle_});
+    context_.rpcs_.Abort({&abort_handle_});
   }
 
   const TransactionId& id() const {
@@ -448,75 +600,57 @@ class RunningTransaction : public std::enable_shared_from_this<RunningTransactio
 
   void SendStatusRequest(
       client::YBClient* client, int64_t serial_no, const RunningTransactionPtr& shared_self) {
-    tserver::GetTransactionStatusRequestPB req;
-    req.set_tablet_id(metadata_.status_tablet);
-    req.set_transaction_id(metadata_.transaction_id.begin(), metadata_.transaction_id.size());
-    req.set_propagated_hybrid_time(context_.participant_context_.Now().ToUint64());
-    context_.rpcs_.RegisterAndStart(
-        client::GetTransactionStatus(
-            TransactionRpcDeadline(),
-            nullptr /* tablet */,
-            client,
-            &req,
-            std::bind(&RunningTransaction::StatusReceived, this, client, _1, _2, serial_no,
-                      shared_self)),
-        &get_status_handle_);
+    context_.RequestStatus(client, shared_self, serial_no);
   }
 
+  // Invoked by RunningTransactionContext when status of this transaction is received.
   void StatusReceived(client::YBClient* client,
-                      const Status& status,
-                      const tserver::GetTransactionStatusResponsePB& response,
+                      const Result<TransactionStatusResult>& result,
                       int64_t serial_no,
                       const RunningTransactionPtr& shared_self) {
     auto delay_usec = FLAGS_transaction_delay_status_reply_usec_in_tests;
     if (delay_usec > 0) {
       delayer_.Delay(
           MonoTime::Now() + MonoDelta::FromMicroseconds(delay_usec),
-          std::bind(&RunningTransaction::DoStatusReceived, this, client, status, response,
-                    serial_no, shared_self));
+          std::bind(&RunningTransaction::DoStatusReceived, this, client, result, serial_no,
+                    shared_self));
     } else {
-      DoStatusReceived(client, status, response, serial_no, shared_self);
+      DoStatusReceived(client, result, serial_no, shared_self);
     }
   }
 
   void DoStatusReceived(client::YBClient* client,
-                        const Status& status,
-                        const tserver::GetTransactionStatusResponsePB& response,
+                        const Result<TransactionStatusResult>& result,
                         int64_t serial_no,
                         const RunningTransactionPtr& shared_self) {
-    if (response.has_propagated_hybrid_time()) {
-      context_.participant_context_.UpdateClock(HybridTime(response.propagated_hybrid_time()));
-    }
-
-    context_.rpcs_.Unregister(&get_status_handle_);
     decltype(status_waiters_) status_waiters;
     HybridTime time_of_status;
     TransactionStatus transaction_status;
-    const bool ok = status.ok();
     int64_t new_request_id = -1;
     {
       std::unique_lock<std::mutex> lock(context_.mutex_);
-      if (!ok) {
+      if (!result.ok()) {
         status_waiters_.swap(status_waiters);
         lock.unlock();
         for (const auto& waiter : status_waiters) {
-          waiter.callback(status);
+          waiter.callback(result.status());
         }
         return;
       }
 
-      DCHECK(response.has_status_hybrid_time() ||
-             response.status() == TransactionStatus::ABORTED);
-      time_of_status = response.has_status_hybrid_time()
-          ? HybridTime(response.status_hybrid_time())
-          : HybridTime::kMax;
+      time_of_status = result->status_time;
       if (last_known_status_hybrid_time_ <= time_of_status) {
         last_known_status_hybrid_time_ = time_of_status;
-        last_known_status_ = response.status();
-        if (response.status() == TransactionStatus::ABORTED) {
-          if (!local_commit_time_ && remove_intents_task_.Prepare(shared_self)) {
-            context_.participant_context_.thread_pool().Enqueue(&remove_intents_task_);
-            VLOG_WITH_PREFIX(1) << "Transaction should be aborted: " << id();
+        last_known_status_ = result->status;
+        if (result->status == TransactionStatus::COMMITTED) {
+          context_.resolved_transactions_.SetCommitted(id(), time_of_status);
+        } else if (result->status == TransactionStatus::ABORTED) {
+          if (!local_commit_time_) {
+            context_.resolved_transactions_.SetAborted(id());
+            if (remove_intents_task_.Prepare(shared_self)) {
+              context_.participant_context_.thread_pool().Enqueue(&remove_intents_task_);
+              VLOG_WITH_PREFIX(1) << "Transaction should be aborted: " << id();
+            }
           }
           context_.RemoveUnlocked(id());
         }
@@ -626,6 +760,8 @@ class RunningTransaction : public std::enable_shared_from_this<RunningTransactio
     return context_.LogPrefix();
   }
 
+  friend class RunningTransactionContext;
+
   TransactionMetadata metadata_;
   IntraTxnWriteId last_write_id_ = 0;
   RunningTransactionContext& context_;
@@ -635,7 +771,6 @@ class RunningTransaction : public std::enable_shared_from_this<RunningTransactio
   TransactionStatus last_known_status_;
   HybridTime last_known_status_hybrid_time_ = HybridTime::kMin;
   std::vector<StatusRequest> status_waiters_;
-  rpc::Rpcs::Handle get_status_handle_;
   rpc::Rpcs::Handle abort_handle_;
   std::vector<TransactionStatusCallback> abort_waiters_;
 
@@ -643,6 +778,149 @@ class RunningTransaction : public std::enable_shared_from_this<RunningTransactio
   Delayer delayer_;
 };
 
+void RunningTransactionContext::RequestStatus(
+    client::YBClient* client, const RunningTransactionPtr& transaction, int64_t serial_no) {
+  const auto& status_tablet = transaction->metadata().status_tablet;
+  StatusTabletRequests* requests;
+  PendingStatusRequests batch;
+  bool accounted = false;
+  {
+    std::lock_guard<std::mutex> lock(status_requests_mutex_);
+    requests = &status_requests_[status_tablet];
+    if (requests->batching_supported) {
+      requests->queue.push_back({transaction, serial_no});
+      if (requests->in_flight >= FLAGS_transaction_rpc_max_concurrent_batches) {
+        return;
+      }
+      ++requests->in_flight;
+      requests->queue.swap(batch);
+      accounted = true;
+    }
+  }
+  if (!accounted) {
+    batch.push_back({transaction, serial_no});
+  }
+  SendStatusRequests(client, status_tablet, requests, std::move(batch), accounted);
+}
+
+void RunningTransactionContext::SendStatusRequests(
+    client::YBClient* client, const TabletId& status_tablet, StatusTabletRequests* requests,
+    PendingStatusRequests batch, bool accounted) {
+  tserver::GetTransactionStatusRequestPB req;
+  req.set_tablet_id(status_tablet);
+  // Servers that do not support batched requests respond with status of the first transaction.
+  const auto& first_id = batch.front().transaction->id();
+  req.set_transaction_id(first_id.begin(), first_id.size());
+  if (batch.size() > 1) {
+    for (const auto& request : batch) {
+      const auto& id = request.transaction->id();
+      req.add_transaction_ids(id.begin(), id.size());
+    }
+  }
+  req.set_propagated_hybrid_time(participant_context_.Now().ToUint64());
+  auto shared_batch = std::make_shared<StatusRequestBatch>(
+      StatusRequestBatch{std::move(batch), rpcs_.InvalidHandle(), accounted});
+  rpcs_.RegisterAndStart(
+      client::GetTransactionStatus(
+          TransactionRpcDeadline(),
+          nullptr /* tablet */,
+          client,
+          &req,
+          std::bind(&RunningTransactionContext::StatusesReceived, this, client, status_tablet,
+                    requests, shared_batch, _1, _2)),
+      &shared_batch->handle);
+}
+
+// Extracts status of transaction with specified index from response to request with specified
+// number of transactions.
+Result<TransactionStatusResult> StatusFromResponse(
+    const tserver::GetTransactionStatusResponsePB& response, size_t index, size_t size) {
+  if (size == 1) {
+    DCHECK(response.has_status_hybrid_time() ||
+           response.status() == TransactionStatus::ABORTED);
+    return TransactionStatusResult{
+        response.status(),
+        response.has_status_hybrid_time() ? HybridTime(response.status_hybrid_time())
+                                          : HybridTime::kMax};
+  }
+  if (static_cast<size_t>(response.statuses_size()) != size ||
+      static_cast<size_t>(response.status_hybrid_times_size()) != size) {
+    return STATUS_FORMAT(
+        IllegalState, "Wrong number of transaction statuses: $0, expected: $1",
+        response.statuses_size(), size);
+  }
+  return TransactionStatusResult{
+      response.statuses(index), HybridTime(response.status_hybrid_times(index))};
+}
+
+void RunningTransactionContext::StatusesReceived(
+    client::YBClient* client,
+    const TabletId& status_tablet,
+    StatusTabletRequests* requests,
+    const StatusRequestBatchPtr& batch,
+    const Status& status,
+    const tserver::GetTransactionStatusResponsePB& response) {
+  if (response.has_propagated_hybrid_time()) {
+    participant_context_.UpdateClock(HybridTime(response.propagated_hybrid_time()));
+  }
+  rpcs_.Unregister(&batch->handle);
+
+  auto& received = batch->requests;
+  PendingStatusRequests resend;
+  if (status.ok() && received.size() > 1 && response.statuses_size() == 0 &&
+      response.has_status()) {
+    // Leader of status tablet ignored transaction_ids, so only status of the first transaction
+    // is present in response.
+    LOG_WITH_PREFIX(INFO) << "Batched status requests are not supported by " << status_tablet;
+    {
+      std::lock_guard<std::mutex> lock(status_requests_mutex_);
+      requests->batching_supported = false;
+    }
+    resend.assign(std::make_move_iterator(received.begin() + 1),
+                  std::make_move_iterator(received.end()));
+    received.resize(1);
+  }
+
+  for (size_t i = 0; i != received.size(); ++i) {
+    const auto& request = received[i];
+    Result<TransactionStatusResult> result = status.ok()
+        ? StatusFromResponse(response, i, received.size())
+        : Result<TransactionStatusResult>(status);
+    request.transaction->StatusReceived(client, result, request.serial_no, request.transaction);
+  }
+
+  for (auto& request : resend) {
+    SendStatusRequests(client, status_tablet, requests, {std::move(request)}, false);
+  }
+
+  if (batch->accounted) {
+    StatusRequestBatchDone(client, status_tablet, requests);
+  }
+}
+
+void RunningTransactionContext::StatusRequestBatchDone(
+    client::YBClient* client, const TabletId& status_tablet, StatusTabletRequests* requests) {
+  PendingStatusRequests next_batch;
+  bool batching_supported;
+  {
+    std::lock_guard<std::mutex> lock(status_requests_mutex_);
+    requests->queue.swap(next_batch);
+    batching_supported = requests->batching_supported;
+    if (next_batch.empty() || !batching_supported) {
+      --requests->in_flight;
+    }
+  }
+  if (batching_supported) {
+    if (!next_batch.empty()) {
+      SendStatusRequests(client, status_tablet, requests, std::move(next_batch), true);
+    }
+    return;
+  }
+  for (auto& request : next_batch) {
+    SendStatusRequests(client, status_tablet, requests, {std::move(request)}, false);
+  }
+}
+
 } // namespace
 
 std::string TransactionApplyData::ToString() const {
@@ -653,8 +931,10 @@ std::string TransactionApplyData::ToString() const {
 
 class TransactionParticipant::Impl : public RunningTransactionContext {
  public:
-  explicit Impl(TransactionParticipantContext* context, TransactionIntentApplier* applier)
-      : RunningTransactionContext(context, applier), log_prefix_(context->tablet_id() + ": ") {
+  Impl(TransactionParticipantContext* context, TransactionIntentApplier* applier,
+       const scoped_refptr<MetricEntity>& entity)
+      : RunningTransactionContext(context, applier, entity),
+        log_prefix_(context->tablet_id() + ": ") {
     LOG_WITH_PREFIX(INFO) << "Start";
   }
 
@@ -703,6 +983,13 @@ class TransactionParticipant::Impl : public RunningTransactionContext {
   }
 
   HybridTime LocalCommitTime(const TransactionId& id) {
+    auto resolved_commit_time = resolved_transactions_.Get(id);
+    if (resolved_commit_time.is_valid() && resolved_commit_time != HybridTime::kMin) {
+      resolved_transactions_.RecordHit();
+      return resolved_commit_time;
+    }
+    // Cached abort does not answer this lookup either, the caller requests status in this case.
+    resolved_transactions_.RecordMiss();
     std::lock_guard<std::mutex> lock(mutex_);
     auto it = transactions_.find(id);
     if (it == transactions_.end()) {
@@ -754,6 +1041,21 @@ class TransactionParticipant::Impl : public RunningTransactionContext {
   }
 
   void RequestStatusAt(const StatusRequest& request) {
+    auto resolved_commit_time = resolved_transactions_.Get(*request.id);
+    if (resolved_commit_time.is_valid()) {
+      resolved_transactions_.RecordHit();
+      if (resolved_commit_time == HybridTime::kMin) {
+        request.callback(TransactionStatusResult{TransactionStatus::ABORTED, HybridTime::kMax});
+      } else {
+        // Transaction is not committed yet at time that is before its commit time.
+        auto status = resolved_commit_time <= request.global_limit_ht
+            ? TransactionStatus::COMMITTED : TransactionStatus::PENDING;
+        request.callback(TransactionStatusResult{status, resolved_commit_time});
+      }
+      return;
+    }
+    resolved_transactions_.RecordMiss();
+
     auto lock_and_iterator = LockAndFindOrLoad(*request.id, *request.reason, request.must_exist);
     if (!lock_and_iterator.found()) {
       request.callback(
@@ -897,6 +1199,7 @@ class TransactionParticipant::Impl : public RunningTransactionContext {
     }
 
     CHECK_OK(applier_.ApplyIntents(data));
+    resolved_transactions_.Erase(data.transaction_id);
 
     {
       auto lock_and_iterator = LockAndFindOrLoad(data.transaction_id, "apply"s);
@@ -954,6 +1257,7 @@ class TransactionParticipant::Impl : public RunningTransactionContext {
     }
 
     auto status = applier_.RemoveIntents(data.transaction_id);
+    resolved_transactions_.Erase(data.transaction_id);
     LOG_IF_WITH_PREFIX(DFATAL, !status.ok()) << "Failed to remove intents for "
                                              << data.transaction_id << ": " << status;
 
@@ -1137,8 +1441,9 @@ class TransactionParticipant::Impl : public RunningTransactionContext {
 };
 
 TransactionParticipant::TransactionParticipant(
-    TransactionParticipantContext* context, TransactionIntentApplier* applier)
-    : impl_(new Impl(context, applier)) {
+    TransactionParticipantContext* context, TransactionIntentApplier* applier,
+    const scoped_refptr<MetricEntity>& entity)
+    : impl_(new Impl(context, applier, entity)) {
 }
 
 TransactionParticipant::~TransactionParticipant() {
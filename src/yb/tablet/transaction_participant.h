@@ -34,6 +34,8 @@
 
 #include "yb/server/server_fwd.h"
 
+#include "yb/gutil/ref_counted.h"
+
 #include "yb/util/opid.pb.h"
 #include "yb/util/result.h"
 
@@ -47,6 +49,7 @@ class WriteBatch;
 namespace yb {
 
 class HybridTime;
+class MetricEntity;
 class TransactionMetadataPB;
 
 namespace tserver {
@@ -104,7 +107,10 @@ class TransactionParticipantContext {
 // instance per tablet.
 class TransactionParticipant : public TransactionStatusManager {
  public:
-  TransactionParticipant(TransactionParticipantContext* context, TransactionIntentApplier* applier);
+  // entity - metric entity of the tablet, used to instantiate transaction status cache metrics.
+  // Could be null.
+  TransactionParticipant(TransactionParticipantContext* context, TransactionIntentApplier* applier,
+                         const scoped_refptr<MetricEntity>& entity);
   virtual ~TransactionParticipant();
 
   // Adds new running transaction.
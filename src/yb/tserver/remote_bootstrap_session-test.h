@@ -166,7 +166,8 @@ class RemoteBootstrapTest : public YBTabletTest {
                                           metric_entity,
                                           raft_pool_.get(),
                                           tablet_prepare_pool_.get(),
-                                          nullptr /* retryable_requests */));
+                                          nullptr /* retryable_requests */,
+                                          nullptr /* multi_raft_manager */));
     consensus::ConsensusBootstrapInfo boot_info;
     ASSERT_OK(tablet_peer_->Start(boot_info));
 
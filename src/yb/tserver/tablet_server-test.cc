@@ -30,6 +30,7 @@
 // under the License.
 //
 
+#include "yb/consensus/consensus.proxy.h"
 #include "yb/consensus/log-test-base.h"
 
 #include "yb/gutil/strings/escaping.h"
@@ -79,6 +80,7 @@ DECLARE_int32(metrics_retirement_age_ms);
 DECLARE_string(block_manager);
 DECLARE_string(rpc_bind_addresses);
 DECLARE_bool(disable_clock_sync_error);
+DECLARE_bool(reject_multi_raft_update_consensus);
 
 // Declare these metrics prototypes for simpler unit testing of their behavior.
 METRIC_DECLARE_counter(rows_inserted);
@@ -539,6 +541,50 @@ TEST_F(TabletServerTest, TestClientGetsErrorBackWhenRecoveryFailed) {
   ASSERT_STR_CONTAINS(resp.error().status().message(), "Tablet not RUNNING: FAILED");
 }
 
+// Every request of a MultiRaftUpdateConsensus call gets its own response, with the error that
+// UpdateConsensus would have returned for it.
+TEST_F(TabletServerTest, TestMultiRaftUpdateConsensus) {
+  const auto local_uuid = mini_server_->server()->fs_manager()->uuid();
+  consensus::MultiRaftUpdateConsensusRequestPB req;
+  auto add_request = [&req](const string& dest_uuid, const string& tablet_id) {
+    auto* consensus_req = req.add_consensus_request();
+    consensus_req->set_dest_uuid(dest_uuid);
+    consensus_req->set_tablet_id(tablet_id);
+    consensus_req->set_caller_uuid("fake-leader");
+    // The tablet is at a later term after its election, so the request is rejected by Raft.
+    consensus_req->set_caller_term(0);
+    consensus_req->mutable_committed_index()->set_term(0);
+    consensus_req->mutable_committed_index()->set_index(0);
+  };
+  add_request(local_uuid, kTabletId);
+  add_request(local_uuid, "no-such-tablet");
+  add_request("no-such-server", kTabletId);
+  add_request(local_uuid, kTabletId);
+
+  consensus::MultiRaftUpdateConsensusResponsePB resp;
+  RpcController controller;
+  ASSERT_OK(consensus_proxy_->MultiRaftUpdateConsensus(req, &resp, &controller));
+  ASSERT_EQ(req.consensus_request_size(), resp.consensus_response_size());
+
+  for (int i : {0, 3}) {
+    const auto& tablet_resp = resp.consensus_response(i);
+    ASSERT_FALSE(tablet_resp.has_error()) << tablet_resp.ShortDebugString();
+    ASSERT_EQ(local_uuid, tablet_resp.responder_uuid());
+    ASSERT_EQ(consensus::ConsensusErrorPB::INVALID_TERM, tablet_resp.status().error().code())
+        << tablet_resp.ShortDebugString();
+  }
+  ASSERT_EQ(TabletServerErrorPB::TABLET_NOT_FOUND, resp.consensus_response(1).error().code());
+  ASSERT_EQ(TabletServerErrorPB::WRONG_SERVER_UUID, resp.consensus_response(2).error().code());
+
+  // A server that does not support the call fails it as a whole, which makes the sender fall back
+  // to separate UpdateConsensus calls.
+  FLAGS_reject_multi_raft_update_consensus = true;
+  controller.Reset();
+  resp.Clear();
+  ASSERT_NOK(consensus_proxy_->MultiRaftUpdateConsensus(req, &resp, &controller));
+  ASSERT_EQ(0, resp.consensus_response_size());
+}
+
 TEST_F(TabletServerTest, TestCreateTablet_TabletExists) {
   CreateTabletRequestPB req;
   CreateTabletResponsePB resp;
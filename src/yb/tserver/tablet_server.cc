@@ -41,6 +41,7 @@
 
 #include "yb/fs/fs_manager.h"
 #include "yb/gutil/strings/substitute.h"
+#include "yb/rpc/messenger.h"
 #include "yb/rpc/service_if.h"
 #include "yb/server/rpc_server.h"
 #include "yb/server/webserver.h"
@@ -270,8 +271,9 @@ Status TabletServer::RegisterServices() {
   RETURN_NOT_OK(RpcAndWebServerBase::RegisterService(FLAGS_ts_admin_svc_queue_length,
                                                      std::move(admin_service)));
 
-  std::unique_ptr<ServiceIf> consensus_service(new ConsensusServiceImpl(metric_entity(),
-                                                                        tablet_manager_.get()));
+  std::unique_ptr<ServiceIf> consensus_service(new ConsensusServiceImpl(
+      metric_entity(), tablet_manager_.get(),
+      &messenger()->ThreadPool(rpc::ServicePriority::kHigh)));
   RETURN_NOT_OK(RpcAndWebServerBase::RegisterService(FLAGS_ts_consensus_svc_queue_length,
                                                      std::move(consensus_service),
                                                      rpc::ServicePriority::kHigh));
@@ -33,6 +33,7 @@
 #include "yb/tserver/tablet_service.h"
 
 #include <algorithm>
+#include <atomic>
 #include <memory>
 #include <string>
 #include <vector>
@@ -52,6 +53,7 @@
 #include "yb/gutil/stl_util.h"
 #include "yb/gutil/stringprintf.h"
 #include "yb/gutil/strings/escaping.h"
+#include "yb/rpc/thread_pool.h"
 #include "yb/server/hybrid_clock.h"
 #include "yb/tablet/tablet_bootstrap_if.h"
 #include "yb/tserver/remote_bootstrap_service.h"
@@ -111,6 +113,9 @@ TAG_FLAG(parallelize_read_ops, runtime);
 DEFINE_test_flag(int32, scanner_inject_latency_on_each_batch_ms, 0,
                  "If set, the scanner will pause the specified number of milliesconds "
                  "before reading each batch of data on the tablet server.");
+DEFINE_test_flag(int32, transaction_status_inject_latency_ms, 0,
+                 "If set, the tablet server will pause the specified number of milliseconds "
+                 "before handling GetTransactionStatus.");
 
 DECLARE_int32(memory_limit_warn_threshold_percentage);
 
@@ -143,6 +148,9 @@ DEFINE_test_flag(bool, simulate_time_out_failures, false, "If true, we will rand
 DEFINE_test_flag(double, respond_write_failed_probability, 0.0,
                  "Probability to respond that write request is failed");
 
+DEFINE_test_flag(bool, reject_multi_raft_update_consensus, false,
+                 "Fail MultiRaftUpdateConsensus calls, like a server that does not support them.");
+
 DECLARE_uint64(max_clock_skew_usec);
 
 namespace yb {
@@ -214,6 +222,57 @@ Status GetTabletRef(const TabletPeerPtr& tablet_peer,
   return Status::OK();
 }
 
+// Collects results of heartbeats received in a single HeartbeatTransactions RPC, and responds
+// when all of them are completed.
+class HeartbeatTransactionsCompletion {
+ public:
+  HeartbeatTransactionsCompletion(rpc::RpcContext context,
+                                  HeartbeatTransactionsResponsePB* response,
+                                  const server::ClockPtr& clock,
+                                  size_t size)
+      : context_(std::move(context)), response_(response), clock_(clock), statuses_(size),
+        left_(size) {}
+
+  // Should be invoked once for each heartbeat.
+  void Completed(size_t index, const Status& status) {
+    statuses_[index] = status;
+    if (left_.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+      return;
+    }
+    for (const auto& heartbeat_status : statuses_) {
+      StatusToPB(heartbeat_status, response_->add_statuses());
+    }
+    response_->set_propagated_hybrid_time(clock_->Now().ToUint64());
+    context_.RespondSuccess();
+  }
+
+ private:
+  rpc::RpcContext context_;
+  HeartbeatTransactionsResponsePB* const response_;
+  server::ClockPtr clock_;
+  std::vector<Status> statuses_;
+  std::atomic<size_t> left_;
+};
+
+class HeartbeatCompletionCallback : public OperationCompletionCallback {
+ public:
+  HeartbeatCompletionCallback(std::shared_ptr<HeartbeatTransactionsCompletion> completion,
+                              size_t index)
+      : completion_(std::move(completion)), index_(index) {}
+
+  void OperationCompleted() override {
+    bool expected = false;
+    if (completed_.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+      completion_->Completed(index_, status());
+    }
+  }
+
+ private:
+  std::shared_ptr<HeartbeatTransactionsCompletion> completion_;
+  const size_t index_;
+  std::atomic<bool> completed_{false};
+};
+
 } // namespace
 
 template<class Resp>
@@ -455,11 +514,54 @@ void TabletServiceImpl::UpdateTransaction(const UpdateTransactionRequestPB* req,
   }
 }
 
+void TabletServiceImpl::HeartbeatTransactions(const HeartbeatTransactionsRequestPB* req,
+                                              HeartbeatTransactionsResponsePB* resp,
+                                              rpc::RpcContext context) {
+  TRACE("HeartbeatTransactions");
+
+  VLOG(1) << "HeartbeatTransactions: " << req->ShortDebugString()
+          << ", context: " << context.ToString();
+  UpdateClock(*req, server_->Clock());
+
+  auto tablet = LookupLeaderTabletOrRespond(
+      server_->tablet_peer_lookup(), req->tablet_id(), resp, &context);
+  if (!tablet || !CheckMemoryPressure(tablet.peer->tablet(), resp, &context)) {
+    return;
+  }
+
+  if (req->states().empty()) {
+    resp->set_propagated_hybrid_time(server_->Clock()->Now().ToUint64());
+    context.RespondSuccess();
+    return;
+  }
+
+  auto* metrics = tablet.peer->tablet()->metrics();
+  if (metrics) {
+    metrics->transaction_heartbeat_rpcs_saved->IncrementBy(req->states_size() - 1);
+  }
+
+  auto completion = std::make_shared<HeartbeatTransactionsCompletion>(
+      std::move(context), resp, server_->Clock(), req->states_size());
+  tablet::UpdateTxnOperationStates states;
+  states.reserve(req->states_size());
+  for (int i = 0; i != req->states_size(); ++i) {
+    auto state = std::make_unique<tablet::UpdateTxnOperationState>(
+        tablet.peer->tablet(), &req->states(i));
+    state->set_completion_callback(std::make_unique<HeartbeatCompletionCallback>(completion, i));
+    states.push_back(std::move(state));
+  }
+  tablet.peer->tablet()->transaction_coordinator()->Handle(&states, tablet.leader_term);
+}
+
 void TabletServiceImpl::GetTransactionStatus(const GetTransactionStatusRequestPB* req,
                                              GetTransactionStatusResponsePB* resp,
                                              rpc::RpcContext context) {
   TRACE("GetTransactionStatus");
 
+  if (PREDICT_FALSE(FLAGS_transaction_status_inject_latency_ms > 0)) {
+    SleepFor(MonoDelta::FromMilliseconds(FLAGS_transaction_status_inject_latency_ms));
+  }
+
   UpdateClock(*req, server_->Clock());
 
   auto tablet_peer = VERIFY_RESULT_OR_RETURN(LookupTabletPeerOrRespond(
@@ -471,8 +573,27 @@ void TabletServiceImpl::GetTransactionStatus(const GetTransactionStatusRequestPB
     return;
   }
 
-  status = tablet_peer->tablet()->transaction_coordinator()->GetStatus(
-      req->transaction_id(), resp);
+  auto* coordinator = tablet_peer->tablet()->transaction_coordinator();
+  if (req->transaction_ids().empty()) {
+    // Status of single transaction, that is also requested by clients that do not batch.
+    google::protobuf::RepeatedPtrField<std::string> transaction_ids;
+    *transaction_ids.Add() = req->transaction_id();
+    status = coordinator->GetStatus(transaction_ids, resp);
+    if (status.ok()) {
+      resp->set_status(resp->statuses(0));
+      if (resp->status() != TransactionStatus::ABORTED) {
+        resp->set_status_hybrid_time(resp->status_hybrid_times(0));
+      }
+      resp->clear_statuses();
+      resp->clear_status_hybrid_times();
+    }
+  } else {
+    auto* metrics = tablet_peer->tablet()->metrics();
+    if (metrics) {
+      metrics->transaction_status_rpcs_saved->IncrementBy(req->transaction_ids_size() - 1);
+    }
+    status = coordinator->GetStatus(req->transaction_ids(), resp);
+  }
   resp->set_propagated_hybrid_time(server_->Clock()->Now().ToUint64());
   if (status.ok()) {
     context.RespondSuccess();
@@ -913,7 +1034,23 @@ void TabletServiceImpl::Read(const ReadRequestPB* req,
   tablet::RequireLease require_lease(req->consistency_level() == YBConsistencyLevel::STRONG);
   // TODO: should check all the tables referenced by the requests to decide if it is transactional.
   bool transactional = tablet->SchemaRef().table_properties().is_transactional();
-  if (!read_time) {
+  if (!read_time && req->max_staleness_ms() > 0 && !require_lease) {
+    // Bounded staleness read. Any read time within the bound is acceptable, so read at the safe
+    // time of this replica, waiting only while it is older than the bound. Since the staleness is
+    // accepted by the client, there is no uncertainty window and the read never restarts.
+    auto min_read_time = server_->Clock()->Now().AddMilliseconds(-req->max_staleness_ms());
+    safe_ht_to_read = tablet->SafeTime(require_lease, min_read_time, context.GetClientDeadline());
+    if (!safe_ht_to_read.is_valid()) { // Timed out
+      TRACE("Timed out waiting for bounded staleness read time");
+      SetupErrorAndRespond(resp->mutable_error(),
+                           STATUS_FORMAT(TimedOut, "Safe time did not reach $0", min_read_time),
+                           TabletServerErrorPB::UNKNOWN_ERROR, &context);
+      return;
+    }
+    read_time = ReadHybridTime::SingleTime(safe_ht_to_read);
+    // Let the client know how stale the result is.
+    resp->set_hybrid_time(read_time.read.ToUint64());
+  } else if (!read_time) {
     safe_ht_to_read = tablet->SafeTime(require_lease);
     // If the read time is not specified, then it is non transactional read.
     // So we should restart it in server in case of failure.
@@ -1130,10 +1267,128 @@ Result<ReadHybridTime> TabletServiceImpl::DoRead(tablet::AbstractTablet* tablet,
   return Status::OK();
 }
 
+namespace {
+
+// Applies a single request of MultiRaftUpdateConsensus, setting error_code on failure.
+Status UpdateTabletConsensus(
+    TabletPeerLookupIf* tablet_manager, const ConsensusRequestPB& req, ConsensusResponsePB* resp,
+    TabletServerErrorPB::Code* error_code) {
+  TabletPeerPtr tablet_peer;
+  Status s = tablet_manager->GetTabletPeer(req.tablet_id(), &tablet_peer);
+  if (PREDICT_FALSE(!s.ok())) {
+    *error_code = s.IsServiceUnavailable() ? TabletServerErrorPB::UNKNOWN_ERROR
+                                           : TabletServerErrorPB::TABLET_NOT_FOUND;
+    return s;
+  }
+  tablet::TabletStatePB state = tablet_peer->state();
+  if (PREDICT_FALSE(state != tablet::RUNNING)) {
+    *error_code = TabletServerErrorPB::TABLET_NOT_RUNNING;
+    return STATUS(IllegalState, "Tablet not RUNNING", tablet::TabletStatePB_Name(state));
+  }
+  shared_ptr<Consensus> consensus = tablet_peer->shared_consensus();
+  if (!consensus) {
+    *error_code = TabletServerErrorPB::TABLET_NOT_RUNNING;
+    return STATUS(ServiceUnavailable, "Consensus unavailable. Tablet not running");
+  }
+  // See UpdateConsensus for the reason of const_cast.
+  return consensus->Update(const_cast<ConsensusRequestPB*>(&req), resp);
+}
+
+void SetMultiRaftResponseError(
+    const Status& status, TabletServerErrorPB::Code code, ConsensusResponsePB* resp) {
+  resp->Clear();
+  StatusToPB(status, resp->mutable_error()->mutable_status());
+  resp->mutable_error()->set_code(code);
+}
+
+// MultiRaftUpdateConsensus call whose requests are applied by separate tasks. The call is
+// responded to when the last of them is done.
+class MultiRaftUpdateCall {
+ public:
+  MultiRaftUpdateCall(TabletPeerLookupIf* tablet_manager,
+                      const consensus::MultiRaftUpdateConsensusRequestPB* req,
+                      consensus::MultiRaftUpdateConsensusResponsePB* resp,
+                      RpcContext context)
+      : tablet_manager_(tablet_manager), req_(*req), resp_(*resp), context_(std::move(context)),
+        remaining_requests_(req->consensus_request_size()) {
+    // Responses are added in advance, so that tasks only modify their own response.
+    resp_.mutable_consensus_response()->Reserve(req_.consensus_request_size());
+    for (int i = 0; i != req_.consensus_request_size(); ++i) {
+      resp_.add_consensus_response();
+    }
+  }
+
+  // Each request gets its own response, with the error that UpdateConsensus would have returned
+  // for it, so that the failure of one tablet does not affect the others.
+  void Apply(int index) {
+    const auto& req = req_.consensus_request(index);
+    auto* resp = resp_.mutable_consensus_response(index);
+    const string& local_uuid = tablet_manager_->NodeInstance().permanent_uuid();
+    TabletServerErrorPB::Code code = TabletServerErrorPB::UNKNOWN_ERROR;
+    Status s;
+    if (PREDICT_FALSE(req.dest_uuid() != local_uuid)) {
+      code = TabletServerErrorPB::WRONG_SERVER_UUID;
+      s = STATUS_FORMAT(InvalidArgument,
+                        "MultiRaftUpdateConsensus: Wrong destination UUID requested. "
+                        "Local UUID: $0. Requested UUID: $1",
+                        local_uuid, req.dest_uuid());
+    } else {
+      s = UpdateTabletConsensus(tablet_manager_, req, resp, &code);
+    }
+    if (PREDICT_FALSE(!s.ok())) {
+      SetMultiRaftResponseError(s, code, resp);
+    }
+  }
+
+  void Failed(int index, const Status& status) {
+    SetMultiRaftResponseError(
+        status, TabletServerErrorPB::UNKNOWN_ERROR, resp_.mutable_consensus_response(index));
+  }
+
+  void RequestDone() {
+    if (remaining_requests_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      context_.RespondSuccess();
+    }
+  }
+
+ private:
+  TabletPeerLookupIf* const tablet_manager_;
+  const consensus::MultiRaftUpdateConsensusRequestPB& req_;
+  consensus::MultiRaftUpdateConsensusResponsePB& resp_;
+  RpcContext context_;
+  std::atomic<int> remaining_requests_;
+};
+
+class MultiRaftUpdateTask : public rpc::ThreadPoolTask {
+ public:
+  MultiRaftUpdateTask(std::shared_ptr<MultiRaftUpdateCall> call, int index)
+      : call_(std::move(call)), index_(index) {}
+
+  void Run() override {
+    call_->Apply(index_);
+  }
+
+  void Done(const Status& status) override {
+    if (!status.ok()) {
+      call_->Failed(index_, status);
+    }
+    call_->RequestDone();
+    delete this;
+  }
+
+ private:
+  std::shared_ptr<MultiRaftUpdateCall> call_;
+  const int index_;
+};
+
+} // namespace
+
 ConsensusServiceImpl::ConsensusServiceImpl(const scoped_refptr<MetricEntity>& metric_entity,
-                                           TabletPeerLookupIf* tablet_manager)
+                                           TabletPeerLookupIf* tablet_manager,
+                                           rpc::ThreadPool* update_pool)
     : ConsensusServiceIf(metric_entity),
-      tablet_manager_(tablet_manager) {
+      tablet_manager_(tablet_manager),
+      update_pool_(update_pool) {
 }
 
 ConsensusServiceImpl::~ConsensusServiceImpl() {
@@ -1171,6 +1426,40 @@ void ConsensusServiceImpl::UpdateConsensus(const ConsensusRequestPB* req,
   context.RespondSuccess();
 }
 
+void ConsensusServiceImpl::MultiRaftUpdateConsensus(
+    const consensus::MultiRaftUpdateConsensusRequestPB* req,
+    consensus::MultiRaftUpdateConsensusResponsePB* resp,
+    rpc::RpcContext context) {
+  DVLOG(3) << "Received Multi Raft Consensus Update RPC with " << req->consensus_request_size()
+           << " requests";
+  if (PREDICT_FALSE(FLAGS_reject_multi_raft_update_consensus)) {
+    context.RespondFailure(STATUS(NotSupported, "MultiRaftUpdateConsensus rejected"));
+    return;
+  }
+  const int num_requests = req->consensus_request_size();
+  if (num_requests == 0) {
+    context.RespondSuccess();
+    return;
+  }
+
+  // Like separate UpdateConsensus RPCs, the requests are applied in parallel, so that a slow
+  // tablet does not delay the heartbeats of the others. The first one is applied by this thread.
+  auto call = std::make_shared<MultiRaftUpdateCall>(tablet_manager_, req, resp, std::move(context));
+  for (int i = 1; i < num_requests; ++i) {
+    auto* task = new MultiRaftUpdateTask(call, i);
+    if (update_pool_) {
+      // Done is invoked on the task if it could not be queued.
+      update_pool_->Enqueue(task);
+    } else {
+      task->Run();
+      task->Done(Status::OK());
+    }
+  }
+  auto* task = new MultiRaftUpdateTask(std::move(call), 0);
+  task->Run();
+  task->Done(Status::OK());
+}
+
 void ConsensusServiceImpl::RequestConsensusVote(const VoteRequestPB* req,
                                                 VoteResponsePB* resp,
                                                 rpc::RpcContext context) {
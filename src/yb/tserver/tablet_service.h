@@ -40,6 +40,8 @@
 #include "yb/consensus/consensus.service.h"
 #include "yb/gutil/ref_counted.h"
 
+#include "yb/rpc/rpc_fwd.h"
+
 #include "yb/tablet/tablet_fwd.h"
 #include "yb/tablet/tablet_peer.h"
 
@@ -101,6 +103,10 @@ class TabletServiceImpl : public TabletServerServiceIf {
                          UpdateTransactionResponsePB* resp,
                          rpc::RpcContext context) override;
 
+  void HeartbeatTransactions(const HeartbeatTransactionsRequestPB* req,
+                             HeartbeatTransactionsResponsePB* resp,
+                             rpc::RpcContext context) override;
+
   void GetTransactionStatus(const GetTransactionStatusRequestPB* req,
                             GetTransactionStatusResponsePB* resp,
                             rpc::RpcContext context) override;
@@ -186,8 +192,11 @@ class TabletServiceAdminImpl : public TabletServerAdminServiceIf {
 
 class ConsensusServiceImpl : public consensus::ConsensusServiceIf {
  public:
+  // The requests of a MultiRaftUpdateConsensus call are applied by separate tasks of
+  // update_pool, if it is specified, otherwise one after another by the handler thread.
   ConsensusServiceImpl(const scoped_refptr<MetricEntity>& metric_entity,
-                       TabletPeerLookupIf* tablet_manager_);
+                       TabletPeerLookupIf* tablet_manager_,
+                       rpc::ThreadPool* update_pool = nullptr);
 
   virtual ~ConsensusServiceImpl();
 
@@ -195,6 +204,10 @@ class ConsensusServiceImpl : public consensus::ConsensusServiceIf {
                                consensus::ConsensusResponsePB *resp,
                                rpc::RpcContext context) override;
 
+  virtual void MultiRaftUpdateConsensus(const consensus::MultiRaftUpdateConsensusRequestPB *req,
+                                        consensus::MultiRaftUpdateConsensusResponsePB *resp,
+                                        rpc::RpcContext context) override;
+
   virtual void RequestConsensusVote(const consensus::VoteRequestPB* req,
                                     consensus::VoteResponsePB* resp,
                                     rpc::RpcContext context) override;
@@ -233,6 +246,7 @@ class ConsensusServiceImpl : public consensus::ConsensusServiceIf {
 
  private:
   TabletPeerLookupIf* tablet_manager_;
+  rpc::ThreadPool* const update_pool_;
 };
 
 }  // namespace tserver
@@ -201,6 +201,29 @@ TEST_F(TsTabletManagerTest, TestProperBackgroundFlushOnStartup) {
   }
 }
 
+TEST_F(TsTabletManagerTest, BootstrapTiming) {
+  std::shared_ptr<TabletPeer> peer;
+  ASSERT_OK(CreateNewTablet(kTabletId, schema_, &peer));
+  peer.reset();
+
+  mini_server_->Shutdown();
+  CreateMiniTabletServer();
+  ASSERT_OK(mini_server_->Start());
+  ASSERT_OK(mini_server_->WaitStarted());
+  tablet_manager_ = mini_server_->server()->tablet_manager();
+
+  TSTabletManager::TabletBootstrapTiming timing;
+  ASSERT_TRUE(tablet_manager_->GetBootstrapTiming(kTabletId, &timing));
+  ASSERT_TRUE(timing.started.Initialized());
+  ASSERT_TRUE(timing.finished.Initialized());
+  ASSERT_LE(timing.queued, timing.started);
+  ASSERT_LE(timing.started, timing.finished);
+  // The tablet has at least the segment written before the restart to replay.
+  ASSERT_GT(timing.wal_bytes, 0);
+
+  ASSERT_FALSE(tablet_manager_->GetBootstrapTiming("no-such-tablet", &timing));
+}
+
 static void AssertMonotonicReportSeqno(int64_t* report_seqno,
                                        const TabletReportPB &report) {
   ASSERT_LT(*report_seqno, report.sequence_number());
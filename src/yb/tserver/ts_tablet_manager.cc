@@ -33,6 +33,7 @@
 #include "yb/tserver/ts_tablet_manager.h"
 
 #include <algorithm>
+#include <deque>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -49,11 +50,15 @@
 #include "yb/consensus/consensus_meta.h"
 #include "yb/consensus/log.h"
 #include "yb/consensus/log_anchor_registry.h"
+#include "yb/consensus/log_util.h"
 #include "yb/consensus/metadata.pb.h"
+#include "yb/consensus/multi_raft_batcher.h"
 #include "yb/consensus/opid_util.h"
 #include "yb/consensus/quorum_util.h"
 #include "yb/consensus/retryable_requests.h"
 
+#include "yb/docdb/docdb_rocksdb_util.h"
+
 #include "yb/fs/fs_manager.h"
 
 #include "yb/gutil/strings/substitute.h"
@@ -63,6 +68,7 @@
 #include "yb/master/sys_catalog.h"
 
 #include "yb/rocksdb/memory_monitor.h"
+#include "yb/rocksdb/pinned_blocks_budget.h"
 
 #include "yb/rpc/messenger.h"
 
@@ -85,6 +91,8 @@
 #include "yb/util/fault_injection.h"
 #include "yb/util/flag_tags.h"
 #include "yb/util/mem_tracker.h"
+#include "yb/util/path_util.h"
+#include "yb/util/priority_thread_pool.h"
 #include "yb/util/metrics.h"
 #include "yb/util/pb_util.h"
 #include "yb/util/stopwatch.h"
@@ -111,6 +119,19 @@ DEFINE_int32(db_block_cache_num_shard_bits, 4,
              "Number of bits to use for sharding the block cache (defaults to 4 bits)");
 TAG_FLAG(db_block_cache_num_shard_bits, advanced);
 
+DEFINE_double(db_block_cache_high_priority_ratio, 0.1,
+              "Fraction of the block cache reserved for index and filter blocks, so that they "
+              "are not evicted by data blocks. They may also use the space that data blocks do "
+              "not use. 0 means that they share the cache with data blocks.");
+TAG_FLAG(db_block_cache_high_priority_ratio, advanced);
+
+DEFINE_int64(db_pinned_index_and_filter_budget_bytes, 0,
+             "Memory budget shared by all tablets for top-level index and fixed-size filter blocks "
+             "that are pinned in memory instead of being looked up in the block cache on every "
+             "read. When the budget is exhausted, blocks of the least recently used tablets are "
+             "unpinned. 0 disables pinning.");
+TAG_FLAG(db_pinned_index_and_filter_budget_bytes, advanced);
+
 DEFINE_test_flag(double, fault_crash_after_blocks_deleted, 0.0,
                  "Fraction of the time when the tablet will crash immediately "
                  "after deleting the data blocks during tablet deletion.");
@@ -347,9 +368,22 @@ TSTabletManager::TSTabletManager(FsManager* fs_manager,
     block_cache_size_bytes = total_ram_avail * FLAGS_db_block_cache_size_percentage / 100;
   }
   if (FLAGS_db_block_cache_size_bytes != kDbCacheSizeCacheDisabled) {
-    tablet_options_.block_cache = rocksdb::NewLRUCache(block_cache_size_bytes,
-                                                       FLAGS_db_block_cache_num_shard_bits);
+    CHECK(FLAGS_db_block_cache_high_priority_ratio >= 0 &&
+          FLAGS_db_block_cache_high_priority_ratio < 1)
+        << "Flag db_block_cache_high_priority_ratio must be in [0, 1). Current value: "
+        << FLAGS_db_block_cache_high_priority_ratio;
+    tablet_options_.block_cache = rocksdb::NewLRUCache(
+        block_cache_size_bytes, FLAGS_db_block_cache_num_shard_bits,
+        false /* strict_capacity_limit */, FLAGS_db_block_cache_high_priority_ratio);
     tablet_options_.block_cache->SetMetrics(server_->metric_entity());
+
+    if (FLAGS_db_pinned_index_and_filter_budget_bytes > 0) {
+      // Pinned blocks are already accounted in the trackers of the tablets that read them.
+      tablet_options_.pinned_blocks_budget = std::make_shared<rocksdb::PinnedBlocksBudget>(
+          MemTracker::CreateTracker(
+              FLAGS_db_pinned_index_and_filter_budget_bytes, "PinnedIndexAndFilterBlocks",
+              server_->mem_tracker(), AddToParent::kFalse));
+    }
   }
 
   // Calculate memstore_size_bytes
@@ -392,6 +426,17 @@ Status TSTabletManager::Init() {
       &server_->options(), server_->metric_entity(), server_->mem_tracker(),
       server_->messenger());
 
+  multi_raft_manager_ = std::make_unique<consensus::MultiRaftManager>(
+      server_->messenger().get(), &server_->proxy_cache());
+
+  // Flushes and compactions of all tablets share one pool, so tablets close to a write stall go
+  // first. They also share one rate limiter if a node wide limit is set.
+  tablet_options_.rate_limiter = docdb::CreateRocksDBNodeRateLimiter();
+  tablet_options_.priority_thread_pool = docdb::CreateRocksDBPriorityThreadPool();
+  if (tablet_options_.priority_thread_pool) {
+    RETURN_NOT_OK(tablet_options_.priority_thread_pool->Init());
+  }
+
   // Start the threadpool we'll use to open tablets.
   // This has to be done in Init() instead of the constructor, since the
   // FsManager isn't initialized until this point.
@@ -408,6 +453,10 @@ Status TSTabletManager::Init() {
   RETURN_NOT_OK(ThreadPoolBuilder("tablet-bootstrap")
                 .set_max_threads(max_bootstrap_threads)
                 .Build(&open_tablet_pool_));
+  // Each running bootstrap reads at most one segment ahead.
+  RETURN_NOT_OK(ThreadPoolBuilder("log-prefetch")
+                .set_max_threads(max_bootstrap_threads)
+                .Build(&log_prefetch_pool_));
 
   // Search for tablets in the metadata dir.
   vector<string> tablet_ids;
@@ -439,8 +488,9 @@ Status TSTabletManager::Init() {
     metas.push_back(meta);
   }
 
-  // Now submit the "Open" task for each.
-  for (const scoped_refptr<TabletMetadata>& meta : metas) {
+  // Now submit the "Open" task for each. The pool runs them in submission order, so the order
+  // decides which tablets become available first.
+  for (const scoped_refptr<TabletMetadata>& meta : OrderTabletsForBootstrap(metas)) {
     scoped_refptr<TransitionInProgressDeleter> deleter;
     {
       std::lock_guard<RWMutex> lock(lock_);
@@ -448,6 +498,7 @@ Status TSTabletManager::Init() {
     }
 
     TabletPeerPtr tablet_peer = VERIFY_RESULT(CreateAndRegisterTabletPeer(meta, NEW_PEER));
+    RecordBootstrapTime(meta->tablet_id(), &TabletBootstrapTiming::queued);
     RETURN_NOT_OK(open_tablet_pool_->SubmitFunc(
         std::bind(&TSTabletManager::OpenTablet, this, meta, deleter)));
   }
@@ -464,6 +515,138 @@ Status TSTabletManager::Init() {
   return Status::OK();
 }
 
+vector<scoped_refptr<TabletMetadata>> TSTabletManager::OrderTabletsForBootstrap(
+    const vector<scoped_refptr<TabletMetadata>>& metas) {
+  struct TabletToOpen {
+    scoped_refptr<TabletMetadata> meta;
+    bool was_leader;
+    uint64_t wal_bytes;
+  };
+
+  // Tablets this server was leading come first, so that they can regain leadership and serve
+  // requests as soon as possible. Within each of these two groups the tablets with the largest WAL
+  // backlog come first, since they take the longest to replay and would otherwise delay the end
+  // of the whole startup.
+  // Consensus metadata and WAL directories of the tablets are read in parallel, using the
+  // bootstrap pool that is still idle at this point.
+  vector<TabletToOpen> tablets;
+  tablets.reserve(metas.size());
+  for (const auto& meta : metas) {
+    tablets.push_back({meta, false /* was_leader */, 0 /* wal_bytes */});
+  }
+  for (auto& tablet : tablets) {
+    auto* tablet_ptr = &tablet;
+    auto status = open_tablet_pool_->SubmitFunc([this, tablet_ptr] {
+      tablet_ptr->was_leader = WasLocalLeader(*tablet_ptr->meta);
+      tablet_ptr->wal_bytes = WalBytesToReplay(*tablet_ptr->meta);
+    });
+    if (!status.ok()) {
+      tablet.was_leader = WasLocalLeader(*tablet.meta);
+      tablet.wal_bytes = WalBytesToReplay(*tablet.meta);
+    }
+  }
+  open_tablet_pool_->Wait();
+  std::stable_sort(tablets.begin(), tablets.end(),
+                   [](const TabletToOpen& lhs, const TabletToOpen& rhs) {
+    if (lhs.was_leader != rhs.was_leader) {
+      return lhs.was_leader;
+    }
+    return lhs.wal_bytes > rhs.wal_bytes;
+  });
+
+  {
+    std::lock_guard<simple_spinlock> lock(bootstrap_timings_lock_);
+    for (const auto& tablet : tablets) {
+      bootstrap_timings_[tablet.meta->tablet_id()].wal_bytes = tablet.wal_bytes;
+    }
+  }
+
+  // Then the tablets of each group are interleaved across WAL drives, so that the concurrently
+  // running bootstraps read from all the drives instead of queueing up on the same one.
+  vector<scoped_refptr<TabletMetadata>> result;
+  result.reserve(tablets.size());
+  auto group_begin = tablets.begin();
+  while (group_begin != tablets.end()) {
+    auto group_end = std::find_if(group_begin, tablets.end(), [group_begin](const auto& tablet) {
+      return tablet.was_leader != group_begin->was_leader;
+    });
+    std::unordered_map<string, std::deque<scoped_refptr<TabletMetadata>>> per_drive;
+    vector<string> drives;
+    for (auto it = group_begin; it != group_end; ++it) {
+      auto& queue = per_drive[it->meta->wal_root_dir()];
+      if (queue.empty()) {
+        drives.push_back(it->meta->wal_root_dir());
+      }
+      queue.push_back(it->meta);
+    }
+    for (size_t left = group_end - group_begin; left != 0;) {
+      for (const auto& drive : drives) {
+        auto& queue = per_drive[drive];
+        if (!queue.empty()) {
+          result.push_back(std::move(queue.front()));
+          queue.pop_front();
+          --left;
+        }
+      }
+    }
+    group_begin = group_end;
+  }
+
+  return result;
+}
+
+uint64_t TSTabletManager::WalBytesToReplay(const TabletMetadata& meta) const {
+  Env* env = fs_manager_->env();
+  uint64_t result = 0;
+  // If a previous bootstrap was interrupted, the segments to replay are in the recovery dir.
+  for (const auto& dir : { meta.wal_dir(), fs_manager_->GetTabletWalRecoveryDir(meta.wal_dir()) }) {
+    vector<string> children;
+    if (!env->GetChildren(dir, &children).ok()) {
+      continue;
+    }
+    for (const auto& child : children) {
+      uint64_t size = 0;
+      if (log::IsLogFileName(child) && env->GetFileSize(JoinPathSegments(dir, child), &size).ok()) {
+        result += size;
+      }
+    }
+  }
+  return result;
+}
+
+bool TSTabletManager::WasLocalLeader(const TabletMetadata& meta) const {
+  std::unique_ptr<ConsensusMetadata> cmeta;
+  if (!ConsensusMetadata::Load(fs_manager_, meta.tablet_id(), fs_manager_->uuid(), &cmeta).ok()) {
+    return false;
+  }
+  // The leader term is persisted when this server wins an election, so this server was the leader
+  // unless it has seen a later term since then.
+  return cmeta->has_leader_term() && cmeta->leader_term() == cmeta->current_term();
+}
+
+void TSTabletManager::RecordBootstrapTime(const string& tablet_id,
+                                          MonoTime TabletBootstrapTiming::*field) {
+  auto now = MonoTime::Now();
+  std::lock_guard<simple_spinlock> lock(bootstrap_timings_lock_);
+  auto& timing = bootstrap_timings_[tablet_id];
+  timing.*field = now;
+  if (!timing.queued.Initialized()) {
+    // Tablets that are opened after startup are not queued behind other bootstraps.
+    timing.queued = now;
+  }
+}
+
+bool TSTabletManager::GetBootstrapTiming(const string& tablet_id,
+                                         TabletBootstrapTiming* timing) const {
+  std::lock_guard<simple_spinlock> lock(bootstrap_timings_lock_);
+  auto it = bootstrap_timings_.find(tablet_id);
+  if (it == bootstrap_timings_.end()) {
+    return false;
+  }
+  *timing = it->second;
+  return true;
+}
+
 Status TSTabletManager::WaitForAllBootstrapsToFinish() {
   CHECK_EQ(state(), MANAGER_RUNNING);
 
@@ -857,6 +1040,11 @@ Status TSTabletManager::DeleteTablet(
 
   tablet_peer->status_listener()->StatusMessage("Deleted tablet blocks from disk");
 
+  {
+    std::lock_guard<simple_spinlock> lock(bootstrap_timings_lock_);
+    bootstrap_timings_.erase(tablet_id);
+  }
+
   // We only remove DELETED tablets from the tablet map.
   if (delete_type == TABLET_DATA_DELETED) {
     std::lock_guard<RWMutex> lock(lock_);
@@ -934,6 +1122,7 @@ void TSTabletManager::OpenTablet(const scoped_refptr<TabletMetadata>& meta,
   consensus::ConsensusBootstrapInfo bootstrap_info;
   Status s;
   consensus::RetryableRequests retryable_requests;
+  RecordBootstrapTime(tablet_id, &TabletBootstrapTiming::started);
   LOG_TIMING_PREFIX(INFO, kLogPrefix, "bootstrapping tablet") {
     // TODO: handle crash mid-creation of tablet? do we ever end up with a
     // partially created tablet here?
@@ -956,8 +1145,10 @@ void TSTabletManager::OpenTablet(const scoped_refptr<TabletMetadata>& meta,
         std::bind(&TSTabletManager::PreserveLocalLeadersOnly, this, _1),
         tablet_peer.get(),
         append_pool(),
-        &retryable_requests};
+        &retryable_requests,
+        log_prefetch_pool_.get()};
     s = BootstrapTablet(data, &tablet, &log, &bootstrap_info);
+    RecordBootstrapTime(tablet_id, &TabletBootstrapTiming::finished);
     if (!s.ok()) {
       LOG(ERROR) << kLogPrefix << "Tablet failed to bootstrap: "
                  << s.ToString();
@@ -978,7 +1169,8 @@ void TSTabletManager::OpenTablet(const scoped_refptr<TabletMetadata>& meta,
                                     tablet->GetMetricEntity(),
                                     raft_pool(),
                                     tablet_prepare_pool(),
-                                    &retryable_requests);
+                                    &retryable_requests,
+                                    multi_raft_manager_.get());
 
     if (!s.ok()) {
       LOG(ERROR) << kLogPrefix << "Tablet failed to init: "
@@ -1041,6 +1233,9 @@ void TSTabletManager::StartShutdown() {
 
   // Shut down the bootstrap pool, so new tablets are registered after this point.
   open_tablet_pool_->Shutdown();
+  if (log_prefetch_pool_) {
+    log_prefetch_pool_->Shutdown();
+  }
 
   // Take a snapshot of the peers list -- that way we don't have to hold
   // on to the lock while shutting them down, which might cause a lock
@@ -1069,6 +1264,9 @@ void TSTabletManager::CompleteShutdown() {
   if (append_pool_) {
     append_pool_->Shutdown();
   }
+  if (tablet_options_.priority_thread_pool) {
+    tablet_options_.priority_thread_pool->Shutdown();
+  }
 
   {
     std::lock_guard<RWMutex> l(lock_);
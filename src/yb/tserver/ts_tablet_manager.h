@@ -58,6 +58,7 @@
 #include "yb/tserver/tserver_admin.pb.h"
 #include "yb/util/locks.h"
 #include "yb/util/metrics.h"
+#include "yb/util/monotime.h"
 #include "yb/util/rw_mutex.h"
 #include "yb/util/status.h"
 #include "yb/util/threadpool.h"
@@ -71,6 +72,7 @@ class HostPort;
 class Partition;
 class Schema;
 class BackgroundTask;
+class PriorityThreadPool;
 
 namespace consensus {
 class RaftConfigPB;
@@ -191,6 +193,19 @@ class TSTabletManager : public tserver::TabletPeerLookupIf {
   bool LookupTablet(const std::string& tablet_id,
                     std::shared_ptr<tablet::TabletPeer>* tablet_peer) const;
 
+  // Progress of the bootstrap of a tablet opened by this tablet manager.
+  struct TabletBootstrapTiming {
+    // Size of the WAL the tablet had to replay, known only for tablets opened at startup.
+    uint64_t wal_bytes = 0;
+    MonoTime queued;
+    // Not initialized until the bootstrap starts and finishes respectively.
+    MonoTime started;
+    MonoTime finished;
+  };
+
+  // Returns true and fills 'timing' if the given tablet was bootstrapped by this tablet manager.
+  bool GetBootstrapTiming(const std::string& tablet_id, TabletBootstrapTiming* timing) const;
+
   // Same as LookupTablet but doesn't acquired the shared lock.
   bool LookupTabletUnlocked(const std::string& tablet_id,
                             std::shared_ptr<tablet::TabletPeer>* tablet_peer) const;
@@ -288,6 +303,10 @@ class TSTabletManager : public tserver::TabletPeerLookupIf {
 
   MemoryMonitor* memory_monitor() { return tablet_options_.memory_monitor.get(); }
 
+  PriorityThreadPool* priority_thread_pool() const {
+    return tablet_options_.priority_thread_pool.get();
+  }
+
   // Flush some tablet if the memstore memory limit is exceeded
   void MaybeFlushTablet();
 
@@ -324,6 +343,20 @@ class TSTabletManager : public tserver::TabletPeerLookupIf {
                                             const std::string& reason,
                                             scoped_refptr<TransitionInProgressDeleter>* deleter);
 
+  // Returns the order in which the tablets should be bootstrapped at startup.
+  std::vector<scoped_refptr<tablet::TabletMetadata>> OrderTabletsForBootstrap(
+      const std::vector<scoped_refptr<tablet::TabletMetadata>>& metas);
+
+  // Returns the total size of the WAL segments that the bootstrap of the tablet will replay.
+  uint64_t WalBytesToReplay(const tablet::TabletMetadata& meta) const;
+
+  // Whether this server was the last known leader of the tablet before the restart.
+  bool WasLocalLeader(const tablet::TabletMetadata& meta) const;
+
+  // Sets the given field of the bootstrap timing of the tablet to now.
+  void RecordBootstrapTime(const std::string& tablet_id,
+                           MonoTime TabletBootstrapTiming::*field);
+
   // Open a tablet meta from the local file system by loading its superblock.
   CHECKED_STATUS OpenTabletMeta(const std::string& tablet_id,
                         scoped_refptr<tablet::TabletMetadata>* metadata);
@@ -442,6 +475,13 @@ class TSTabletManager : public tserver::TabletPeerLookupIf {
   // Thread pool used to open the tablets async, whether bootstrap is required or not.
   std::unique_ptr<ThreadPool> open_tablet_pool_;
 
+  // Thread pool used by bootstraps to read log segments ahead of replay.
+  std::unique_ptr<ThreadPool> log_prefetch_pool_;
+
+  // Bootstrap progress of the tablets opened by this tablet manager, shown on the web UI.
+  std::unordered_map<std::string, TabletBootstrapTiming> bootstrap_timings_;
+  mutable simple_spinlock bootstrap_timings_lock_;
+
   // Thread pool for preparing transactions, shared between all tablets.
   std::unique_ptr<ThreadPool> tablet_prepare_pool_;
 
@@ -451,6 +491,9 @@ class TSTabletManager : public tserver::TabletPeerLookupIf {
   // Thread pool for Raft-related operations, shared between all tablets.
   std::unique_ptr<ThreadPool> raft_pool_;
 
+  // Batches Raft requests of different tablets sent to the same tablet server.
+  std::unique_ptr<consensus::MultiRaftManager> multi_raft_manager_;
+
   // Thread pool for appender threads, shared between all tablets.
   std::unique_ptr<ThreadPool> append_pool_;
 
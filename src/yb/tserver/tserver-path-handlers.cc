@@ -47,6 +47,7 @@
 #include "yb/gutil/strings/join.h"
 #include "yb/gutil/strings/numbers.h"
 #include "yb/gutil/strings/substitute.h"
+#include "yb/rocksdb/options.h"
 #include "yb/server/webui_util.h"
 #include "yb/tablet/maintenance_manager.h"
 #include "yb/tablet/tablet.h"
@@ -56,6 +57,7 @@
 #include "yb/tablet/tablet_peer.h"
 #include "yb/tserver/tablet_server.h"
 #include "yb/tserver/ts_tablet_manager.h"
+#include "yb/util/priority_thread_pool.h"
 #include "yb/util/url-coding.h"
 
 namespace yb {
@@ -113,6 +115,10 @@ Status TabletServerPathHandlers::Register(Webserver* server) {
       "/maintenance-manager", "",
       std::bind(&TabletServerPathHandlers::HandleMaintenanceManagerPage, this, _1, _2),
       true /* styled */, false /* is_on_nav_bar */);
+  server->RegisterPathHandler(
+      "/compactions", "",
+      std::bind(&TabletServerPathHandlers::HandleCompactionsPage, this, _1, _2),
+      true /* styled */, false /* is_on_nav_bar */);
 
   return Status::OK();
 }
@@ -190,6 +196,21 @@ bool CompareByTabletId(const std::shared_ptr<TabletPeer>& a,
   return a->tablet_id() < b->tablet_id();
 }
 
+string BootstrapTimingToString(const TSTabletManager::TabletBootstrapTiming& timing) {
+  string wal = timing.wal_bytes != 0
+      ? Substitute(", $0 of WAL", HumanReadableNumBytes::ToString(timing.wal_bytes))
+      : "";
+  auto now = MonoTime::Now();
+  if (!timing.started.Initialized()) {
+    return Substitute("Queued for $0$1", (now - timing.queued).ToString(), wal);
+  }
+  if (!timing.finished.Initialized()) {
+    return Substitute("Running for $0$1", (now - timing.started).ToString(), wal);
+  }
+  return Substitute("Took $0 after waiting $1$2", (timing.finished - timing.started).ToString(),
+                    (timing.started - timing.queued).ToString(), wal);
+}
+
 }  // anonymous namespace
 
 void TabletServerPathHandlers::HandleTabletsPage(const Webserver::WebRequest& req,
@@ -202,7 +223,8 @@ void TabletServerPathHandlers::HandleTabletsPage(const Webserver::WebRequest& re
   *output << "<table class='table table-striped'>\n";
   *output << "  <tr><th>Table name</th><th>Tablet ID</th>"
       "<th>Partition</th>"
-      "<th>State</th><th>On-disk size</th><th>RaftConfig</th><th>Last status</th></tr>\n";
+      "<th>State</th><th>On-disk size</th><th>RaftConfig</th><th>Last status</th>"
+      "<th>Bootstrap</th></tr>\n";
   for (const std::shared_ptr<TabletPeer>& peer : peers) {
     TabletStatusPB status;
     peer->GetTabletStatusPB(&status);
@@ -222,20 +244,27 @@ void TabletServerPathHandlers::HandleTabletsPage(const Webserver::WebRequest& re
                             .PartitionDebugString(peer->status_listener()->partition(),
                                                   peer->tablet_metadata()->schema());
 
+    string bootstrap;
+    TSTabletManager::TabletBootstrapTiming bootstrap_timing;
+    if (tserver_->tablet_manager()->GetBootstrapTiming(id, &bootstrap_timing)) {
+      bootstrap = BootstrapTimingToString(bootstrap_timing);
+    }
+
     // TODO: would be nice to include some other stuff like memory usage
     shared_ptr<consensus::Consensus> consensus = peer->shared_consensus();
     (*output) << Substitute(
         // Table name, tablet id, partition
         "<tr><td>$0</td><td>$1</td><td>$2</td>"
-        // State, on-disk size, consensus configuration, last status
-        "<td>$3</td><td>$4</td><td>$5</td><td>$6</td></tr>\n",
+        // State, on-disk size, consensus configuration, last status, bootstrap
+        "<td>$3</td><td>$4</td><td>$5</td><td>$6</td><td>$7</td></tr>\n",
         EscapeForHtmlToString(table_name),  // $0
         tablet_id_or_link,  // $1
         EscapeForHtmlToString(partition),  // $2
         EscapeForHtmlToString(peer->HumanReadableState()), n_bytes,  // $3, $4
         consensus ? ConsensusStatePBToHtml(consensus->ConsensusState(CONSENSUS_CONFIG_COMMITTED))
                   : "",  // $5
-        EscapeForHtmlToString(status.last_status()));  // $6
+        EscapeForHtmlToString(status.last_status()),  // $6
+        EscapeForHtmlToString(bootstrap));  // $7
   }
   *output << "</table>\n";
 }
@@ -407,6 +436,9 @@ void TabletServerPathHandlers::HandleDashboardsPage(const Webserver::WebRequest&
   *output << GetDashboardLine("maintenance-manager", "Maintenance Manager",
                               "List of operations that are currently running and those "
                               "that are registered.");
+  *output << GetDashboardLine("compactions", "Compactions",
+                              "Flushes and compactions that are running or waiting for a "
+                              "thread.");
 }
 
 string TabletServerPathHandlers::GetDashboardLine(const std::string& link,
@@ -418,6 +450,43 @@ string TabletServerPathHandlers::GetDashboardLine(const std::string& link,
                     EscapeForHtmlToString(desc));
 }
 
+void TabletServerPathHandlers::HandleCompactionsPage(const Webserver::WebRequest& req,
+                                                     std::stringstream* output) {
+  PriorityThreadPool* pool = tserver_->tablet_manager()->priority_thread_pool();
+  if (!pool) {
+    *output << "Flushes and compactions are scheduled by every tablet separately, see "
+            << "--rocksdb_priority_thread_pool_size.\n";
+    return;
+  }
+  auto states = pool->GetTaskStates();
+  bool as_text = ContainsKey(req.parsed_args, "raw");
+
+  if (!as_text) {
+    *output << "<h1>Flushes and compactions</h1>\n";
+    *output << Substitute("<p>Threads: $0, writes are delayed at priority $1 and above.</p>\n",
+                          pool->max_running_tasks(), rocksdb::kUrgentTaskPriority);
+    *output << "<table class='table table-striped'>\n";
+    *output << "  <tr><th>State</th><th>Priority</th><th>Time in state</th>"
+            << "<th>Description</th></tr>\n";
+  }
+  for (const auto& state : states) {
+    const char* state_name = state.running ? "Running" : "Queued";
+    if (as_text) {
+      *output << state_name << " " << state.priority << " " << state.duration.ToString() << " "
+              << state.description << endl;
+    } else {
+      *output << Substitute("<tr><td>$0</td><td>$1</td><td>$2</td><td>$3</td></tr>\n",
+                            state_name,
+                            state.priority,
+                            HumanReadableElapsedTime::ToShortString(state.duration.ToSeconds()),
+                            EscapeForHtmlToString(state.description));
+    }
+  }
+  if (!as_text) {
+    *output << "</table>\n";
+  }
+}
+
 void TabletServerPathHandlers::HandleMaintenanceManagerPage(const Webserver::WebRequest& req,
                                                             std::stringstream* output) {
   MaintenanceManager* manager = tserver_->maintenance_manager();
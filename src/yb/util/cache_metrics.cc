@@ -59,6 +59,24 @@ METRIC_DEFINE_counter(server, block_cache_hits_caching,
                       "Number of lookups that were expecting a block that found one."
                       "Use this number instead of cache_hits when trying to determine how "
                       "efficient the cache is");
+METRIC_DEFINE_counter(server, block_cache_index_hits,
+                      "Block Cache Index Hits", yb::MetricUnit::kBlocks,
+                      "Number of index block lookups that found a block");
+METRIC_DEFINE_counter(server, block_cache_index_misses,
+                      "Block Cache Index Misses", yb::MetricUnit::kBlocks,
+                      "Number of index block lookups that didn't yield a block");
+METRIC_DEFINE_counter(server, block_cache_filter_hits,
+                      "Block Cache Filter Hits", yb::MetricUnit::kBlocks,
+                      "Number of filter block lookups that found a block");
+METRIC_DEFINE_counter(server, block_cache_filter_misses,
+                      "Block Cache Filter Misses", yb::MetricUnit::kBlocks,
+                      "Number of filter block lookups that didn't yield a block");
+METRIC_DEFINE_counter(server, block_cache_data_hits,
+                      "Block Cache Data Hits", yb::MetricUnit::kBlocks,
+                      "Number of data block lookups that found a block");
+METRIC_DEFINE_counter(server, block_cache_data_misses,
+                      "Block Cache Data Misses", yb::MetricUnit::kBlocks,
+                      "Number of data block lookups that didn't yield a block");
 
 METRIC_DEFINE_gauge_uint64(server, block_cache_usage, "Block Cache Memory Usage",
                            yb::MetricUnit::kBytes,
@@ -71,6 +89,10 @@ METRIC_DEFINE_gauge_uint64(server, block_cache_multi_touch_usage,
                            "Multi Cache Block Cache Memory Usage",
                            yb::MetricUnit::kBytes,
                            "Memory consumed by the multi cache block cache");
+METRIC_DEFINE_gauge_uint64(server, block_cache_high_priority_usage,
+                           "High Priority Block Cache Memory Usage",
+                           yb::MetricUnit::kBytes,
+                           "Memory consumed by index and filter blocks in the block cache");
 namespace yb {
 
 #define MINIT(member, x) member(METRIC_##x.Instantiate(entity))
@@ -83,9 +105,16 @@ CacheMetrics::CacheMetrics(const scoped_refptr<MetricEntity>& entity)
     MINIT(cache_hits_caching, block_cache_hits_caching),
     MINIT(cache_misses, block_cache_misses),
     MINIT(cache_misses_caching, block_cache_misses_caching),
+    MINIT(index_hits, block_cache_index_hits),
+    MINIT(index_misses, block_cache_index_misses),
+    MINIT(filter_hits, block_cache_filter_hits),
+    MINIT(filter_misses, block_cache_filter_misses),
+    MINIT(data_hits, block_cache_data_hits),
+    MINIT(data_misses, block_cache_data_misses),
     GINIT(cache_usage, block_cache_usage),
     GINIT(single_touch_cache_usage, block_cache_single_touch_usage),
-    GINIT(multi_touch_cache_usage, block_cache_multi_touch_usage) {
+    GINIT(multi_touch_cache_usage, block_cache_multi_touch_usage),
+    GINIT(high_priority_cache_usage, block_cache_high_priority_usage) {
 }
 #undef MINIT
 #undef GINIT
@@ -54,10 +54,17 @@ struct CacheMetrics {
   scoped_refptr<Counter> cache_hits_caching;
   scoped_refptr<Counter> cache_misses;
   scoped_refptr<Counter> cache_misses_caching;
+  scoped_refptr<Counter> index_hits;
+  scoped_refptr<Counter> index_misses;
+  scoped_refptr<Counter> filter_hits;
+  scoped_refptr<Counter> filter_misses;
+  scoped_refptr<Counter> data_hits;
+  scoped_refptr<Counter> data_misses;
 
   scoped_refptr<AtomicGauge<uint64_t> > cache_usage;
   scoped_refptr<AtomicGauge<uint64_t> > single_touch_cache_usage;
   scoped_refptr<AtomicGauge<uint64_t> > multi_touch_cache_usage;
+  scoped_refptr<AtomicGauge<uint64_t> > high_priority_cache_usage;
 };
 
 } // namespace yb
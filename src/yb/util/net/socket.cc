@@ -40,6 +40,10 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#if defined(__linux__)
+#include <linux/errqueue.h>
+#endif
+
 #include <limits>
 #include <numeric>
 #include <string>
@@ -71,6 +75,19 @@ DEFINE_bool(socket_inject_short_recvs, false,
 TAG_FLAG(socket_inject_short_recvs, hidden);
 TAG_FLAG(socket_inject_short_recvs, unsafe);
 
+#if defined(__linux__)
+// Zero copy send definitions, missing in headers older than Linux 4.14.
+#ifndef SO_ZEROCOPY
+#define SO_ZEROCOPY 60
+#endif
+#ifndef MSG_ZEROCOPY
+#define MSG_ZEROCOPY 0x4000000
+#endif
+#ifndef SO_EE_ORIGIN_ZEROCOPY
+#define SO_EE_ORIGIN_ZEROCOPY 5
+#endif
+#endif
+
 namespace yb {
 
 size_t IoVecsFullSize(const IoVecs& io_vecs) {
@@ -290,6 +307,18 @@ Status Socket::SetReuseAddr(bool flag) {
   return Status::OK();
 }
 
+Status Socket::SetLinger(bool enabled, int timeout_sec) {
+  struct linger linger;
+  linger.l_onoff = enabled ? 1 : 0;
+  linger.l_linger = timeout_sec;
+  if (setsockopt(fd_, SOL_SOCKET, SO_LINGER, &linger, sizeof(linger)) == -1) {
+    int err = errno;
+    return STATUS(NetworkError, std::string("failed to set SO_LINGER: ") +
+                                ErrnoToString(err), Slice(), err);
+  }
+  return Status::OK();
+}
+
 Status Socket::BindAndListen(const Endpoint& sockaddr,
                              int listenQueueSize) {
   RETURN_NOT_OK(SetReuseAddr(true));
@@ -457,21 +486,22 @@ Status Socket::Write(const uint8_t *buf, int32_t amt, int32_t *nwritten) {
   return Status::OK();
 }
 
-Status Socket::Writev(const struct ::iovec *iov, int iov_len,
-                      int32_t *nwritten) {
+namespace {
+
+Status SendMsg(int fd, const struct ::iovec *iov, int iov_len, int flags, int32_t *nwritten) {
   if (PREDICT_FALSE(iov_len <= 0)) {
     return STATUS(NetworkError,
                 StringPrintf("writev: invalid io vector length of %d",
                              iov_len),
                 Slice(), EINVAL);
   }
-  DCHECK_GE(fd_, 0);
+  DCHECK_GE(fd, 0);
 
   struct msghdr msg;
   memset(&msg, 0, sizeof(struct msghdr));
   msg.msg_iov = const_cast<iovec *>(iov);
   msg.msg_iovlen = iov_len;
-  int res = ::sendmsg(fd_, &msg, MSG_NOSIGNAL);
+  int res = ::sendmsg(fd, &msg, MSG_NOSIGNAL | flags);
   if (PREDICT_FALSE(res < 0)) {
     int err = errno;
     return STATUS(NetworkError, std::string("sendmsg error: ") +
@@ -482,6 +512,73 @@ Status Socket::Writev(const struct ::iovec *iov, int iov_len,
   return Status::OK();
 }
 
+} // namespace
+
+Status Socket::Writev(const struct ::iovec *iov, int iov_len,
+                      int32_t *nwritten) {
+  return SendMsg(fd_, iov, iov_len, 0 /* flags */, nwritten);
+}
+
+#if defined(__linux__)
+
+Status Socket::SetZeroCopy(bool enabled) {
+  int flag = enabled ? 1 : 0;
+  if (setsockopt(fd_, SOL_SOCKET, SO_ZEROCOPY, &flag, sizeof(flag)) == -1) {
+    int err = errno;
+    return STATUS(NetworkError, std::string("failed to set SO_ZEROCOPY: ") +
+                                ErrnoToString(err), Slice(), err);
+  }
+  return Status::OK();
+}
+
+Status Socket::WritevZeroCopy(const struct ::iovec *iov, int iov_len, int32_t *nwritten) {
+  return SendMsg(fd_, iov, iov_len, MSG_ZEROCOPY, nwritten);
+}
+
+Status Socket::ReadZeroCopyCompletions(std::vector<std::pair<uint32_t, uint32_t>>* ranges) {
+  for (;;) {
+    char control[128];
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(struct msghdr));
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    if (recvmsg(fd_, &msg, MSG_ERRQUEUE) == -1) {
+      int err = errno;
+      if (err == EAGAIN || err == EWOULDBLOCK) {
+        return Status::OK();
+      }
+      return STATUS(NetworkError, std::string("recvmsg error queue error: ") +
+                                  ErrnoToString(err), Slice(), err);
+    }
+    for (auto* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+      if (!(cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR) &&
+          !(cmsg->cmsg_level == SOL_IPV6 && cmsg->cmsg_type == IPV6_RECVERR)) {
+        continue;
+      }
+      const auto* error = reinterpret_cast<const sock_extended_err*>(CMSG_DATA(cmsg));
+      if (error->ee_errno == 0 && error->ee_origin == SO_EE_ORIGIN_ZEROCOPY) {
+        ranges->emplace_back(error->ee_info, error->ee_data);
+      }
+    }
+  }
+}
+
+#else
+
+Status Socket::SetZeroCopy(bool enabled) {
+  return STATUS(NotSupported, "Zero copy send is only supported on Linux");
+}
+
+Status Socket::WritevZeroCopy(const struct ::iovec *iov, int iov_len, int32_t *nwritten) {
+  return STATUS(NotSupported, "Zero copy send is only supported on Linux");
+}
+
+Status Socket::ReadZeroCopyCompletions(std::vector<std::pair<uint32_t, uint32_t>>* ranges) {
+  return STATUS(NotSupported, "Zero copy send is only supported on Linux");
+}
+
+#endif
+
 // Mostly follows writen() from Stevens (2004) or Kerrisk (2010).
 Status Socket::BlockingWrite(const uint8_t *buf, size_t buflen, size_t *nwritten,
     const MonoTime& deadline) {
@@ -34,6 +34,8 @@
 
 #include <sys/uio.h>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <boost/container/small_vector.hpp>
 
@@ -109,6 +111,10 @@ class Socket {
   // Sets SO_REUSEADDR to 'flag'. Should be used prior to Bind().
   CHECKED_STATUS SetReuseAddr(bool flag);
 
+  // Sets SO_LINGER. With 'enabled' and zero 'timeout_sec', Close() resets the connection and
+  // discards unsent data instead of sending it in the background.
+  CHECKED_STATUS SetLinger(bool enabled, int timeout_sec);
+
   // Convenience method to invoke the common sequence:
   // 1) SetReuseAddr(true)
   // 2) Bind()
@@ -144,6 +150,20 @@ class Socket {
 
   CHECKED_STATUS Writev(const struct ::iovec *iov, int iov_len, int32_t *nwritten);
 
+  // Set SO_ZEROCOPY, required by WritevZeroCopy(). Returns NotSupported on platforms other than
+  // Linux, and an error on kernels older than 4.14.
+  CHECKED_STATUS SetZeroCopy(bool enabled);
+
+  // Same as Writev, but passes MSG_ZEROCOPY, so the kernel sends the data directly from the given
+  // buffers instead of copying them. The buffers must not be modified or freed until
+  // ReadZeroCopyCompletions() reports the write as completed. Each successful call is assigned
+  // the next write id, starting from 0.
+  CHECKED_STATUS WritevZeroCopy(const struct ::iovec *iov, int iov_len, int32_t *nwritten);
+
+  // Reads the notifications of completed zero copy writes from the socket error queue without
+  // blocking. Appends inclusive ranges of completed write ids to 'ranges'.
+  CHECKED_STATUS ReadZeroCopyCompletions(std::vector<std::pair<uint32_t, uint32_t>>* ranges);
+
   // Blocking Write call, returns IOError unless full buffer is sent.
   // Underlying Socket expected to be in blocking mode. Fails if any Write() sends 0 bytes.
   // Returns OK if buflen bytes were sent, otherwise IOError.
@@ -0,0 +1,164 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "yb/util/countdown_latch.h"
+#include "yb/util/priority_thread_pool.h"
+#include "yb/util/test_macros.h"
+#include "yb/util/test_util.h"
+
+using namespace std::literals;
+
+namespace yb {
+
+namespace {
+
+constexpr int kUrgentPriority = 100;
+
+class TestTask : public PriorityThreadPoolTask {
+ public:
+  TestTask(int id, void* key, std::mutex* mutex, std::vector<int>* order,
+           CountDownLatch* started = nullptr, CountDownLatch* release = nullptr)
+      : id_(id), key_(key), mutex_(mutex), order_(order), started_(started), release_(release) {}
+
+  void Run(const Status& status) override {
+    if (started_) {
+      started_->CountDown();
+    }
+    if (release_) {
+      release_->Wait();
+    }
+    std::lock_guard<std::mutex> lock(*mutex_);
+    order_->push_back(status.ok() ? id_ : -id_);
+  }
+
+  bool BelongsTo(void* key) override {
+    return key == key_;
+  }
+
+  std::string ToString() const override {
+    return Format("TestTask $0", id_);
+  }
+
+ private:
+  const int id_;
+  void* const key_;
+  std::mutex* const mutex_;
+  std::vector<int>* const order_;
+  CountDownLatch* const started_;
+  CountDownLatch* const release_;
+};
+
+} // namespace
+
+class PriorityThreadPoolTest : public YBTest {
+ protected:
+  void Submit(PriorityThreadPool* pool, int priority, int id, void* key = nullptr,
+              CountDownLatch* started = nullptr, CountDownLatch* release = nullptr) {
+    std::unique_ptr<PriorityThreadPoolTask> task(
+        new TestTask(id, key, &mutex_, &order_, started, release));
+    ASSERT_OK(pool->Submit(priority, &task));
+  }
+
+  std::vector<int> Order() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return order_;
+  }
+
+  std::mutex mutex_;
+  std::vector<int> order_;
+};
+
+TEST_F(PriorityThreadPoolTest, Priorities) {
+  PriorityThreadPool pool("test", 1 /* max_running_tasks */, 0 /* reserved_for_urgent */,
+                          kUrgentPriority);
+  ASSERT_OK(pool.Init());
+
+  CountDownLatch started(1);
+  CountDownLatch release(1);
+  Submit(&pool, 0, 1, nullptr, &started, &release);
+  started.Wait();
+
+  Submit(&pool, 1, 2);
+  Submit(&pool, 5, 3);
+  Submit(&pool, 1, 4);
+  Submit(&pool, kUrgentPriority, 5);
+
+  auto states = pool.GetTaskStates();
+  ASSERT_EQ(5, states.size());
+  ASSERT_TRUE(states[0].running);
+  ASSERT_EQ("TestTask 1", states[0].description);
+  ASSERT_FALSE(states[1].running);
+  ASSERT_EQ("TestTask 5", states[1].description);
+  ASSERT_EQ("TestTask 2", states[3].description);
+
+  release.CountDown();
+  ASSERT_OK(WaitFor([this] { return Order().size() == 5; }, 10s, "All tasks done"));
+  ASSERT_EQ((std::vector<int>{1, 5, 3, 2, 4}), Order());
+}
+
+TEST_F(PriorityThreadPoolTest, ReservedForUrgent) {
+  PriorityThreadPool pool("test", 2 /* max_running_tasks */, 1 /* reserved_for_urgent */,
+                          kUrgentPriority);
+  ASSERT_OK(pool.Init());
+
+  CountDownLatch started(1);
+  CountDownLatch release(1);
+  Submit(&pool, 0, 1, nullptr, &started, &release);
+  started.Wait();
+
+  // The second thread is reserved, so the ordinary task waits for the first one.
+  Submit(&pool, 50, 2);
+  Submit(&pool, kUrgentPriority, 3);
+  ASSERT_OK(WaitFor([this] { return Order().size() == 1; }, 10s, "Urgent task done"));
+  std::this_thread::sleep_for(100ms);
+  ASSERT_EQ(std::vector<int>{3}, Order());
+
+  release.CountDown();
+  ASSERT_OK(WaitFor([this] { return Order().size() == 3; }, 10s, "All tasks done"));
+  ASSERT_EQ((std::vector<int>{3, 1, 2}), Order());
+}
+
+TEST_F(PriorityThreadPoolTest, RemoveAndShutdown) {
+  PriorityThreadPool pool("test", 1 /* max_running_tasks */, 0 /* reserved_for_urgent */,
+                          kUrgentPriority);
+  ASSERT_OK(pool.Init());
+
+  int key1 = 0, key2 = 0;
+  CountDownLatch started(1);
+  CountDownLatch release(1);
+  Submit(&pool, 0, 1, &key1, &started, &release);
+  started.Wait();
+
+  Submit(&pool, 0, 2, &key1);
+  Submit(&pool, 0, 3, &key2);
+  Submit(&pool, 0, 4, &key1);
+  pool.Remove(&key1);
+  ASSERT_EQ((std::vector<int>{-2, -4}), Order());
+
+  release.CountDown();
+  ASSERT_OK(WaitFor([this] { return Order().size() == 4; }, 10s, "All tasks done"));
+  ASSERT_EQ((std::vector<int>{-2, -4, 1, 3}), Order());
+
+  pool.Shutdown();
+  std::unique_ptr<PriorityThreadPoolTask> task(new TestTask(5, nullptr, &mutex_, &order_));
+  ASSERT_NOK(pool.Submit(0, &task));
+  ASSERT_NE(nullptr, task);
+}
+
+} // namespace yb
@@ -0,0 +1,180 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/util/priority_thread_pool.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include "yb/util/format.h"
+#include "yb/util/logging.h"
+#include "yb/util/thread.h"
+
+namespace yb {
+
+PriorityThreadPool::PriorityThreadPool(
+    std::string name, size_t max_running_tasks, size_t reserved_for_urgent, int urgent_priority)
+    : name_(std::move(name)),
+      max_running_tasks_(max_running_tasks),
+      reserved_for_urgent_(reserved_for_urgent),
+      urgent_priority_(urgent_priority) {
+  CHECK_GT(max_running_tasks_, reserved_for_urgent_);
+}
+
+PriorityThreadPool::~PriorityThreadPool() {
+  Shutdown();
+}
+
+Status PriorityThreadPool::Init() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  CHECK(threads_.empty());
+  threads_.reserve(max_running_tasks_);
+  for (size_t i = 0; i != max_running_tasks_; ++i) {
+    scoped_refptr<Thread> thread;
+    RETURN_NOT_OK(Thread::Create(
+        name_, Format("$0-worker-$1", name_, i), &PriorityThreadPool::Worker, this, &thread));
+    threads_.push_back(std::move(thread));
+  }
+  return Status::OK();
+}
+
+bool PriorityThreadPool::Less(const QueuedTask& lhs, const QueuedTask& rhs) {
+  if (lhs.priority != rhs.priority) {
+    return lhs.priority < rhs.priority;
+  }
+  return lhs.serial > rhs.serial;
+}
+
+Status PriorityThreadPool::Submit(int priority, std::unique_ptr<PriorityThreadPoolTask>* task) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (closing_) {
+      return STATUS_FORMAT(ShutdownInProgress, "$0 is shutting down", name_);
+    }
+    queue_.push_back(QueuedTask{priority, next_serial_++, MonoTime::Now(), std::move(*task)});
+    std::push_heap(queue_.begin(), queue_.end(), &PriorityThreadPool::Less);
+  }
+  cond_.notify_one();
+  return Status::OK();
+}
+
+void PriorityThreadPool::Remove(void* key) {
+  std::vector<QueuedTask> removed;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = std::stable_partition(
+        queue_.begin(), queue_.end(),
+        [key](const QueuedTask& queued) { return !queued.task->BelongsTo(key); });
+    if (it == queue_.end()) {
+      return;
+    }
+    removed.assign(std::make_move_iterator(it), std::make_move_iterator(queue_.end()));
+    queue_.erase(it, queue_.end());
+    std::make_heap(queue_.begin(), queue_.end(), &PriorityThreadPool::Less);
+  }
+  // Abort in the order the tasks would have run.
+  std::sort(removed.begin(), removed.end(), [](const QueuedTask& lhs, const QueuedTask& rhs) {
+    return Less(rhs, lhs);
+  });
+  AbortTasks(&removed);
+}
+
+void PriorityThreadPool::Shutdown() {
+  std::vector<scoped_refptr<Thread>> threads;
+  std::vector<QueuedTask> queue;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closing_ = true;
+    threads.swap(threads_);
+    queue.swap(queue_);
+  }
+  cond_.notify_all();
+  for (const auto& thread : threads) {
+    CHECK_OK(ThreadJoiner(thread.get()).Join());
+  }
+  AbortTasks(&queue);
+}
+
+void PriorityThreadPool::AbortTasks(std::vector<QueuedTask>* tasks) {
+  const auto status = STATUS_FORMAT(Aborted, "Task removed from $0", name_);
+  for (auto& queued : *tasks) {
+    queued.task->Run(status);
+  }
+  tasks->clear();
+}
+
+bool PriorityThreadPool::CanStartFrontUnlocked() const {
+  if (queue_.empty()) {
+    return false;
+  }
+  return queue_.front().priority >= urgent_priority_ ||
+         running_non_urgent_ + reserved_for_urgent_ < max_running_tasks_;
+}
+
+void PriorityThreadPool::Worker() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (;;) {
+    cond_.wait(lock, [this] { return closing_ || CanStartFrontUnlocked(); });
+    if (closing_) {
+      return;
+    }
+
+    std::pop_heap(queue_.begin(), queue_.end(), &PriorityThreadPool::Less);
+    QueuedTask queued = std::move(queue_.back());
+    queue_.pop_back();
+    const bool urgent = queued.priority >= urgent_priority_;
+    if (!urgent) {
+      ++running_non_urgent_;
+    }
+    running_.emplace(
+        queued.serial, RunningTask{queued.task->ToString(), queued.priority, MonoTime::Now()});
+
+    lock.unlock();
+    queued.task->Run(Status::OK());
+    queued.task.reset();
+    lock.lock();
+
+    running_.erase(queued.serial);
+    if (!urgent) {
+      --running_non_urgent_;
+      // A thread that was left for urgent tasks could pick an ordinary task now.
+      cond_.notify_one();
+    }
+  }
+}
+
+std::vector<PriorityThreadPoolTaskState> PriorityThreadPool::GetTaskStates() const {
+  std::vector<PriorityThreadPoolTaskState> result;
+  std::vector<const QueuedTask*> queued;
+  auto now = MonoTime::Now();
+  std::lock_guard<std::mutex> lock(mutex_);
+  result.reserve(running_.size() + queue_.size());
+  for (const auto& p : running_) {
+    result.push_back({p.second.description, p.second.priority, true /* running */,
+                      now - p.second.start_time});
+  }
+  queued.reserve(queue_.size());
+  for (const auto& task : queue_) {
+    queued.push_back(&task);
+  }
+  std::sort(queued.begin(), queued.end(), [](const QueuedTask* lhs, const QueuedTask* rhs) {
+    return Less(*rhs, *lhs);
+  });
+  for (const auto* task : queued) {
+    result.push_back({task->task->ToString(), task->priority, false /* running */,
+                      now - task->submit_time});
+  }
+  return result;
+}
+
+} // namespace yb
@@ -0,0 +1,134 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#ifndef YB_UTIL_PRIORITY_THREAD_POOL_H
+#define YB_UTIL_PRIORITY_THREAD_POOL_H
+
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "yb/gutil/ref_counted.h"
+
+#include "yb/util/monotime.h"
+#include "yb/util/status.h"
+
+namespace yb {
+
+class Thread;
+
+class PriorityThreadPoolTask {
+ public:
+  virtual ~PriorityThreadPoolTask() = default;
+
+  // Runs the task. `status` is not OK when the task was removed from the pool before it was
+  // started, in this case the task should only release what it holds.
+  virtual void Run(const Status& status) = 0;
+
+  // Whether the task was submitted on behalf of `key`, see PriorityThreadPool::Remove.
+  virtual bool BelongsTo(void* key) = 0;
+
+  virtual std::string ToString() const = 0;
+};
+
+// State of a queued or running task, as reported by PriorityThreadPool::GetTaskStates.
+struct PriorityThreadPoolTaskState {
+  std::string description;
+  int priority;
+  bool running;
+  // Time since the task was submitted if it is queued, or started if it is running.
+  MonoDelta duration;
+};
+
+// Runs tasks on a fixed number of threads in the order of their priorities, higher priority
+// first. Tasks of the same priority run in submission order.
+//
+// Tasks with priority of at least `urgent_priority` can always use all threads, while other tasks
+// leave `reserved_for_urgent` threads free. So urgent tasks do not have to wait for long running
+// ordinary ones when the pool is busy.
+class PriorityThreadPool {
+ public:
+  PriorityThreadPool(std::string name, size_t max_running_tasks, size_t reserved_for_urgent,
+                     int urgent_priority);
+  ~PriorityThreadPool();
+
+  // Starts the worker threads.
+  CHECKED_STATUS Init();
+
+  // Queues the task. On success the pool takes ownership of the task, otherwise it is left in
+  // `task`.
+  CHECKED_STATUS Submit(int priority, std::unique_ptr<PriorityThreadPoolTask>* task);
+
+  // Removes all queued tasks that belong to `key` and runs them with an Aborted status in the
+  // calling thread. Tasks that are already running are not affected.
+  void Remove(void* key);
+
+  // Waits for running tasks, joins the threads and aborts the queued tasks. Following submissions
+  // fail.
+  void Shutdown();
+
+  // Returns running tasks followed by queued tasks in the order they will run.
+  std::vector<PriorityThreadPoolTaskState> GetTaskStates() const;
+
+  size_t max_running_tasks() const {
+    return max_running_tasks_;
+  }
+
+ private:
+  struct QueuedTask {
+    int priority;
+    // Submission order, used to break ties between tasks of the same priority.
+    uint64_t serial;
+    MonoTime submit_time;
+    std::unique_ptr<PriorityThreadPoolTask> task;
+  };
+
+  struct RunningTask {
+    std::string description;
+    int priority;
+    MonoTime start_time;
+  };
+
+  // Orders the queue heap so that the front is the highest priority task submitted first.
+  static bool Less(const QueuedTask& lhs, const QueuedTask& rhs);
+
+  void Worker();
+
+  // Whether the task at the front of the queue could be started now.
+  bool CanStartFrontUnlocked() const;
+
+  void AbortTasks(std::vector<QueuedTask>* tasks);
+
+  const std::string name_;
+  const size_t max_running_tasks_;
+  const size_t reserved_for_urgent_;
+  const int urgent_priority_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable cond_;
+  bool closing_ = false;
+  uint64_t next_serial_ = 0;
+  // Heap ordered with Less.
+  std::vector<QueuedTask> queue_;
+  // Running tasks by serial.
+  std::map<uint64_t, RunningTask> running_;
+  size_t running_non_urgent_ = 0;
+  std::vector<scoped_refptr<Thread>> threads_;
+};
+
+} // namespace yb
+
+#endif // YB_UTIL_PRIORITY_THREAD_POOL_H
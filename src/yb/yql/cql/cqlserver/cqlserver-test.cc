@@ -23,6 +23,7 @@
 
 #include "yb/gutil/strings/join.h"
 #include "yb/util/cast.h"
+#include "yb/util/monotime.h"
 #include "yb/util/net/net_util.h"
 #include "yb/util/test_util.h"
 
@@ -35,6 +36,8 @@ using std::vector;
 using strings::Substitute;
 using yb::integration_tests::YBTableTestBase;
 
+DECLARE_bool(cql_prepared_insert_templates);
+
 class TestCQLService : public YBTableTestBase {
  public:
   void SetUp() override;
@@ -46,6 +49,19 @@ class TestCQLService : public YBTableTestBase {
   void SendRequestAndExpectResponse(const string& cmd, const string& resp);
 
   int server_port() { return cql_server_port_; }
+
+  // Sends request frames and returns the bodies of their responses, which must not be errors.
+  Status SendFramesAndGetResponses(
+      const string& frames, int num_frames, vector<string>* bodies, int timeout_in_millis = 30000);
+
+  // Sends a single request and returns the body of its response.
+  Result<string> SendRequest(uint8_t opcode, const string& body);
+
+  // Runs num_ops executions of a prepared statement, window requests at a time, and returns the
+  // number of executions per second. The statement takes two int arguments, the first one gets
+  // the index of the execution.
+  Result<double> ExecutePrepared(const string& prepared_id, int num_ops, int window);
+
  private:
   Status SendRequestAndGetResponse(
       const string& cmd, int expected_resp_length, int timeout_in_millis = 1000);
@@ -132,6 +148,112 @@ void TestCQLService::SendRequestAndExpectResponse(const string& cmd, const strin
   CHECK_EQ(resp, string(reinterpret_cast<char*>(resp_), resp.length()));
 }
 
+namespace {
+
+constexpr uint8_t kStartupOpcode = 0x01;
+constexpr uint8_t kQueryOpcode = 0x07;
+constexpr uint8_t kPrepareOpcode = 0x09;
+constexpr uint8_t kExecuteOpcode = 0x0a;
+constexpr uint16_t kQuorum = 0x0004;
+constexpr size_t kFrameHeaderSize = 9;
+
+void AppendShort(uint16_t value, string* out) {
+  out->push_back(static_cast<char>(value >> 8));
+  out->push_back(static_cast<char>(value));
+}
+
+void AppendInt(uint32_t value, string* out) {
+  AppendShort(static_cast<uint16_t>(value >> 16), out);
+  AppendShort(static_cast<uint16_t>(value), out);
+}
+
+uint32_t ReadInt(const char* data) {
+  const uint8_t* bytes = util::to_uchar_ptr(data);
+  return (static_cast<uint32_t>(bytes[0]) << 24) | (static_cast<uint32_t>(bytes[1]) << 16) |
+         (static_cast<uint32_t>(bytes[2]) << 8) | bytes[3];
+}
+
+void AppendFrame(uint8_t opcode, uint16_t stream_id, const string& body, string* out) {
+  out->push_back('\x04');
+  out->push_back('\x00');
+  AppendShort(stream_id, out);
+  out->push_back(static_cast<char>(opcode));
+  AppendInt(static_cast<uint32_t>(body.size()), out);
+  out->append(body);
+}
+
+string QueryBody(const string& query) {
+  string body;
+  AppendInt(static_cast<uint32_t>(query.size()), &body);
+  body.append(query);
+  return body;
+}
+
+string ExecuteBody(const string& prepared_id, int32_t arg1, int32_t arg2) {
+  string body;
+  AppendShort(static_cast<uint16_t>(prepared_id.size()), &body);
+  body.append(prepared_id);
+  AppendShort(kQuorum, &body);
+  body.push_back('\x01');  // Flags: values.
+  AppendShort(2, &body);
+  for (int32_t arg : {arg1, arg2}) {
+    AppendInt(sizeof(arg), &body);
+    AppendInt(static_cast<uint32_t>(arg), &body);
+  }
+  return body;
+}
+
+} // namespace
+
+Status TestCQLService::SendFramesAndGetResponses(
+    const string& frames, int num_frames, vector<string>* bodies, int timeout_in_millis) {
+  size_t total_written = 0;
+  while (total_written < frames.size()) {
+    int32_t bytes_written = 0;
+    RETURN_NOT_OK(client_sock_.Write(util::to_uchar_ptr(frames.data() + total_written),
+                                     frames.size() - total_written, &bytes_written));
+    total_written += bytes_written;
+  }
+
+  MonoTime deadline = MonoTime::Now() + MonoDelta::FromMilliseconds(timeout_in_millis);
+  bodies->resize(num_frames);
+  for (auto& body : *bodies) {
+    uint8_t header[kFrameHeaderSize];
+    size_t bytes_read = 0;
+    RETURN_NOT_OK(client_sock_.BlockingRecv(header, sizeof(header), &bytes_read, deadline));
+    body.resize(ReadInt(util::to_char_ptr(header + 5)));
+    RETURN_NOT_OK(client_sock_.BlockingRecv(
+        util::to_uchar_ptr(&body[0]), body.size(), &bytes_read, deadline));
+    if (header[4] == 0x00) {
+      return STATUS(RuntimeError, "Request failed", body);
+    }
+  }
+  return Status::OK();
+}
+
+Result<string> TestCQLService::SendRequest(uint8_t opcode, const string& body) {
+  string frame;
+  AppendFrame(opcode, 0 /* stream_id */, body, &frame);
+  vector<string> bodies;
+  RETURN_NOT_OK(SendFramesAndGetResponses(frame, 1, &bodies));
+  return bodies[0];
+}
+
+Result<double> TestCQLService::ExecutePrepared(
+    const string& prepared_id, int num_ops, int window) {
+  vector<string> bodies;
+  auto start = MonoTime::Now();
+  for (int i = 0; i < num_ops; i += window) {
+    const int num_frames = std::min(window, num_ops - i);
+    string frames;
+    for (int j = 0; j != num_frames; ++j) {
+      AppendFrame(kExecuteOpcode, j, ExecuteBody(prepared_id, i + j, i + j), &frames);
+    }
+    RETURN_NOT_OK(SendFramesAndGetResponses(frames, num_frames, &bodies));
+  }
+  return num_ops / (MonoTime::Now() - start).ToSeconds();
+}
+
 // The following test cases test the CQL protocol marshalling/unmarshalling with hand-coded
 // request messages and expected responses. They are good as basic and error-handling tests.
 // These are expected to be few.
@@ -251,5 +373,46 @@ TEST_F(TestCQLService, TestCQLServerEventConst) {
   ASSERT_EQ(0, memcmp(buffer, ptr, kSize));
 }
 
+TEST_F(TestCQLService, BenchmarkPreparedStatements) {
+  const int kNumOps = AllowSlowTests() ? 100000 : 2000;
+  const int kWindow = 64;
+
+  string startup_body;
+  AppendShort(1, &startup_body);
+  for (const string& str : {string("CQL_VERSION"), string("3.0.0")}) {
+    AppendShort(static_cast<uint16_t>(str.size()), &startup_body);
+    startup_body.append(str);
+  }
+  ASSERT_OK(SendRequest(kStartupOpcode, startup_body));
+
+  for (const string& query : {
+      string("CREATE KEYSPACE IF NOT EXISTS bench;"),
+      string("CREATE TABLE bench.kv (k int PRIMARY KEY, v int);")}) {
+    string body = QueryBody(query);
+    AppendShort(kQuorum, &body);
+    body.push_back('\x00');  // Flags.
+    ASSERT_OK(SendRequest(kQueryOpcode, body));
+  }
+
+  // The body of a PREPARED result is the result kind followed by the prepared id.
+  auto prepare = [this](const string& query) -> Result<string> {
+    string result = VERIFY_RESULT(SendRequest(kPrepareOpcode, QueryBody(query)));
+    SCHECK_GE(result.size(), 6, IllegalState, "Result too short");
+    const size_t id_size = (static_cast<uint8_t>(result[4]) << 8) | static_cast<uint8_t>(result[5]);
+    return result.substr(6, id_size);
+  };
+  auto insert_id = ASSERT_RESULT(prepare("INSERT INTO bench.kv (k, v) VALUES (?, ?);"));
+  auto select_id = ASSERT_RESULT(prepare("SELECT v FROM bench.kv WHERE k = ? AND v = ?;"));
+
+  for (bool use_templates : {false, true}) {
+    FLAGS_cql_prepared_insert_templates = use_templates;
+    auto inserts_per_sec = ASSERT_RESULT(ExecutePrepared(insert_id, kNumOps, kWindow));
+    auto selects_per_sec = ASSERT_RESULT(ExecutePrepared(select_id, kNumOps, kWindow));
+    LOG(INFO) << "Request templates " << (use_templates ? "on" : "off")
+              << ": prepared INSERT " << inserts_per_sec << " ops/s, prepared SELECT "
+              << selects_per_sec << " ops/s";
+  }
+}
+
 }  // namespace cqlserver
 }  // namespace yb
@@ -15,6 +15,8 @@
 
 #include "yb/yql/cql/ql/exec/executor.h"
 
+#include "yb/util/enums.h"
+
 namespace yb {
 namespace ql {
 
@@ -101,5 +103,111 @@ CHECKED_STATUS Executor::ColumnArgsToPB(const PTDmlStmt *tnode, QLWriteRequestPB
   return Status::OK();
 }
 
+//--------------------------------------------------------------------------------------------------
+
+namespace {
+
+// Returns the value in the write request that a bind variable of the template is written to.
+QLExpressionPB* BindSlotToPB(const InsertRequestTemplate::BindSlot& slot, QLWriteRequestPB* req) {
+  switch (slot.field) {
+    case InsertRequestTemplate::Field::kHashed:
+      return req->mutable_hashed_column_values(slot.index);
+    case InsertRequestTemplate::Field::kRange:
+      return req->mutable_range_column_values(slot.index);
+    case InsertRequestTemplate::Field::kRegular:
+      return req->mutable_column_values(slot.index)->mutable_expr();
+  }
+  FATAL_INVALID_ENUM_VALUE(InsertRequestTemplate::Field, slot.field);
+}
+
+} // namespace
+
+std::shared_ptr<const InsertRequestTemplate> Executor::CreateInsertRequestTemplate(
+    const PTInsertStmt *tnode, const QLWriteRequestPB& req) {
+  // Only the column values are filled in from the template, so every other part of the request
+  // must not depend on the bind variables or change between executions.
+  if (tnode->bind_variables().empty() || tnode->if_clause() != nullptr ||
+      tnode->ttl_seconds() != nullptr || tnode->user_timestamp_usec() != nullptr ||
+      !tnode->subscripted_col_args().empty() || !tnode->json_col_args().empty()) {
+    return nullptr;
+  }
+  // Constants are kept in the template as is. Any other expression, like a call to now(), has to
+  // be evaluated on every execution.
+  for (const ColumnArg& col : tnode->column_args()) {
+    if (col.IsInitialized() && col.expr()->expr_op() != ExprOperator::kConst &&
+        col.expr()->expr_op() != ExprOperator::kBindVar) {
+      return nullptr;
+    }
+  }
+
+  auto result = std::make_shared<InsertRequestTemplate>();
+  QLWriteRequestPB* request = &result->request;
+  request->mutable_hashed_column_values()->CopyFrom(req.hashed_column_values());
+  request->mutable_range_column_values()->CopyFrom(req.range_column_values());
+  request->mutable_column_values()->CopyFrom(req.column_values());
+  if (req.has_column_refs()) {
+    request->mutable_column_refs()->CopyFrom(req.column_refs());
+  }
+  if (req.returns_status()) {
+    request->set_returns_status(true);
+  }
+
+  // Visit the column arguments in the same order as ColumnArgsToPB() does.
+  int num_hashed = 0, num_range = 0, num_regular = 0;
+  for (const ColumnArg& col : tnode->column_args()) {
+    if (!col.IsInitialized()) {
+      continue;
+    }
+
+    const ColumnDesc *col_desc = col.desc();
+    InsertRequestTemplate::BindSlot slot;
+    QLExpressionPB *expr_pb;
+    if (col_desc->is_hash()) {
+      slot.field = InsertRequestTemplate::Field::kHashed;
+      slot.index = num_hashed++;
+      expr_pb = request->mutable_hashed_column_values(slot.index);
+    } else if (col_desc->is_primary()) {
+      slot.field = InsertRequestTemplate::Field::kRange;
+      slot.index = num_range++;
+      expr_pb = request->mutable_range_column_values(slot.index);
+    } else {
+      slot.field = InsertRequestTemplate::Field::kRegular;
+      slot.index = num_regular++;
+      expr_pb = request->mutable_column_values(slot.index)->mutable_expr();
+    }
+
+    if (col.expr()->expr_op() == ExprOperator::kBindVar) {
+      slot.bind_var = static_cast<const PTBindVar*>(col.expr().get());
+      expr_pb->Clear();
+      result->slots.push_back(slot);
+    }
+  }
+
+  return result;
+}
+
+CHECKED_STATUS Executor::InsertRequestTemplateToPB(const PTInsertStmt *tnode,
+                                                   const InsertRequestTemplate& request_template,
+                                                   QLWriteRequestPB *req) {
+  req->MergeFrom(request_template.request);
+
+  for (const InsertRequestTemplate::BindSlot& slot : request_template.slots) {
+    QLExpressionPB *expr_pb = BindSlotToPB(slot, req);
+    RETURN_NOT_OK(PTExprToPB(slot.bind_var, expr_pb));
+    const bool is_primary = slot.field != InsertRequestTemplate::Field::kRegular;
+    if (is_primary) {
+      RETURN_NOT_OK(EvalExpr(expr_pb, QLTableRow::empty_row()));
+    }
+
+    // Null values not allowed for primary key: checking here catches nulls introduced by bind.
+    if (is_primary && expr_pb->has_value() && IsNull(expr_pb->value())) {
+      LOG(INFO) << "Unexpected null value. Current request: " << req->DebugString();
+      return exec_context_->Error(tnode, ErrorCode::NULL_ARGUMENT_FOR_PRIMARY_KEY);
+    }
+  }
+
+  return Status::OK();
+}
+
 }  // namespace ql
 }  // namespace yb
@@ -125,6 +125,32 @@ bool ExecContext::HasPendingOperations() const {
   return false;
 }
 
+void ExecContext::PrepareTransactionFlush() {
+  // Responses of unconditional writes that do not update indexes do not lead to any further
+  // operations. So if all operations of the statement are such writes and they are flushed
+  // together, the transaction is committed as soon as they are done.
+  int num_ops = 0;
+  for (auto& tnode_context : tnode_contexts_) {
+    if (tnode_context.child_context()) {
+      return;
+    }
+    for (const auto& op : tnode_context.ops()) {
+      if (op->type() != client::YBOperation::Type::QL_WRITE || op->response().has_status()) {
+        return;
+      }
+      const auto& req = static_cast<const client::YBqlWriteOp&>(*op).request();
+      if (req.has_if_expr() || req.update_index_ids_size() != 0 ||
+          req.has_child_transaction_data()) {
+        return;
+      }
+      ++num_ops;
+    }
+  }
+  if (num_ops == transactional_session()->CountBufferedOperations()) {
+    transaction_->ExpectCommit();
+  }
+}
+
 class AbortTransactionTask : public rpc::ThreadPoolTask {
  public:
   explicit AbortTransactionTask(YBTransactionPtr transaction)
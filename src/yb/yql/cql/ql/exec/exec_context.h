@@ -257,6 +257,10 @@ class ExecContext : public ProcessContextBase {
   // Does this statement have pending operations?
   bool HasPendingOperations() const;
 
+  // Notifies the transaction when its buffered operations are the last ones of this statement, so
+  // it is committed right after they are flushed.
+  void PrepareTransactionFlush();
+
   //------------------------------------------------------------------------------------------------
   client::Restart restart() const {
     return restart_;
@@ -24,10 +24,26 @@
 #include "yb/common/wire_protocol.h"
 #include "yb/rpc/thread_pool.h"
 #include "yb/util/decimal.h"
+#include "yb/util/flag_tags.h"
 #include "yb/util/logging.h"
 #include "yb/util/thread_restrictions.h"
 #include "yb/util/trace.h"
 
+DEFINE_bool(cql_prepared_insert_templates, true,
+            "Execute prepared INSERT statements by filling in the bind variables of a request "
+            "template built on their first execution, instead of converting the parse tree to a "
+            "write request every time.");
+TAG_FLAG(cql_prepared_insert_templates, advanced);
+
+DEFINE_int32(cql_consistent_prefix_read_max_staleness_ms, 0,
+             "If positive, reads with consistency level ONE (CONSISTENT_PREFIX) return data that "
+             "is at most this many milliseconds stale. The closest replica serves them, waiting "
+             "for its safe time to reach the bound if needed. 0 to read at the safe time of the "
+             "replica without a bound. The bound applies to all such reads handled by this "
+             "server's CQL proxy, it can't be set per session or per statement.");
+TAG_FLAG(cql_consistent_prefix_read_max_staleness_ms, evolving);
+TAG_FLAG(cql_consistent_prefix_read_max_staleness_ms, runtime);
+
 namespace yb {
 namespace ql {
 
@@ -777,6 +793,11 @@ Status Executor::ExecPTNode(const PTSelectStmt *tnode, TnodeContext* tnode_conte
   // Set the consistency level for the operation. Always use strong consistency for system tables.
   select_op->set_yb_consistency_level(tnode->is_system() ? YBConsistencyLevel::STRONG
                                                          : params.yb_consistency_level());
+  if (select_op->yb_consistency_level() == YBConsistencyLevel::CONSISTENT_PREFIX &&
+      FLAGS_cql_consistent_prefix_read_max_staleness_ms > 0) {
+    select_op->set_max_staleness(
+        MonoDelta::FromMilliseconds(FLAGS_cql_consistent_prefix_read_max_staleness_ms));
+  }
 
   // If we have several hash partitions (i.e. IN condition on hash columns) we initialize the
   // start partition here, and then iteratively scan the rest in FetchMoreRows.
@@ -794,6 +815,7 @@ Status Executor::ExecPTNode(const PTSelectStmt *tnode, TnodeContext* tnode_conte
         YBqlReadOpPtr op(table->NewQLSelect());
         op->mutable_request()->CopyFrom(select_op->request());
         op->set_yb_consistency_level(select_op->yb_consistency_level());
+        op->set_max_staleness(select_op->max_staleness());
         tnode_context->AdvanceToNextPartition(op->mutable_request());
         RETURN_NOT_OK(AddOperation(op, tnode_context));
         select_op = op; // Use new op as base for the next one, if any.
@@ -940,6 +962,7 @@ Result<bool> Executor::FetchRowsByKeys(const PTSelectStmt* tnode,
   for (const QLRow& key : keys.rows()) {
     YBqlReadOpPtr op(tnode->table()->NewQLSelect());
     op->set_yb_consistency_level(select_op->yb_consistency_level());
+    op->set_max_staleness(select_op->max_staleness());
     QLReadRequestPB* req = op->mutable_request();
     req->CopyFrom(select_op->request());
     RETURN_NOT_OK(WhereKeyToPB(req, schema, key));
@@ -956,6 +979,21 @@ Status Executor::ExecPTNode(const PTInsertStmt *tnode, TnodeContext* tnode_conte
   YBqlWriteOpPtr insert_op(table->NewQLInsert());
   QLWriteRequestPB *req = insert_op->mutable_request();
 
+  // Use the request template of a prepared statement if one was built already.
+  std::shared_ptr<const InsertRequestTemplate> request_template;
+  if (FLAGS_cql_prepared_insert_templates) {
+    request_template = tnode->request_template();
+  }
+  if (request_template != nullptr) {
+    Status s = InsertRequestTemplateToPB(tnode, *request_template, req);
+    if (PREDICT_FALSE(!s.ok())) {
+      return exec_context_->Error(tnode, s, ErrorCode::INVALID_ARGUMENTS);
+    }
+    insert_op->set_writes_static_row(tnode->ModifiesStaticRow());
+    insert_op->set_writes_primary_row(tnode->ModifiesPrimaryRow());
+    return AddOperation(insert_op, tnode_context);
+  }
+
   // Set the ttl.
   Status s = TtlToPB(tnode, req);
   if (PREDICT_FALSE(!s.ok())) {
@@ -998,6 +1036,14 @@ Status Executor::ExecPTNode(const PTInsertStmt *tnode, TnodeContext* tnode_conte
   insert_op->set_writes_static_row(tnode->ModifiesStaticRow());
   insert_op->set_writes_primary_row(tnode->ModifiesPrimaryRow());
 
+  // Build the request template for the next executions of a prepared statement.
+  if (FLAGS_cql_prepared_insert_templates) {
+    auto new_template = CreateInsertRequestTemplate(tnode, *req);
+    if (new_template != nullptr) {
+      tnode->set_request_template(std::move(new_template));
+    }
+  }
+
   // Add the operation.
   return AddOperation(insert_op, tnode_context);
 }
@@ -1244,6 +1290,7 @@ void Executor::FlushAsync() {
   for (ExecContext& exec_context : exec_contexts_) {
     if (exec_context.HasTransaction()) {
       if (exec_context.transactional_session()->CountBufferedOperations() > 0) {
+        exec_context.PrepareTransactionFlush();
         flush_sessions.push_back({exec_context.transactional_session(), &exec_context});
       } else if (!exec_context.HasPendingOperations()) {
         commit_contexts.push_back(&exec_context);
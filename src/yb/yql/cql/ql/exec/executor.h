@@ -296,6 +296,16 @@ class Executor : public QLExprExecutor {
   // Convert column arguments to protobuf.
   CHECKED_STATUS ColumnArgsToPB(const PTDmlStmt *tnode, QLWriteRequestPB *req);
 
+  // Build the request template of an INSERT statement from its first write request. Returns
+  // nullptr if the statement cannot be executed from a template.
+  std::shared_ptr<const InsertRequestTemplate> CreateInsertRequestTemplate(
+      const PTInsertStmt *tnode, const QLWriteRequestPB& req);
+
+  // Set the column values of an INSERT statement from its request template and bind variables.
+  CHECKED_STATUS InsertRequestTemplateToPB(const PTInsertStmt *tnode,
+                                           const InsertRequestTemplate& request_template,
+                                           QLWriteRequestPB *req);
+
   //------------------------------------------------------------------------------------------------
   // Where clause evaluation.
 
@@ -18,6 +18,12 @@
 #ifndef YB_YQL_CQL_QL_PTREE_PT_INSERT_H_
 #define YB_YQL_CQL_QL_PTREE_PT_INSERT_H_
 
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "yb/common/ql_protocol.pb.h"
+
 #include "yb/yql/cql/ql/ptree/list_node.h"
 #include "yb/yql/cql/ql/ptree/tree_node.h"
 #include "yb/yql/cql/ql/ptree/pt_select.h"
@@ -29,6 +35,31 @@ namespace ql {
 
 //--------------------------------------------------------------------------------------------------
 
+// Write request of a prepared INSERT statement with the values of its bind variables left out.
+// Executing the statement again copies the request and fills in the bind variables only, instead
+// of walking the column arguments of the parse tree.
+struct InsertRequestTemplate {
+  // Repeated field of the write request a bind variable is written to.
+  enum class Field {
+    kHashed,
+    kRange,
+    kRegular,
+  };
+
+  struct BindSlot {
+    const PTBindVar* bind_var;
+    Field field;
+    // Index of the value in the repeated field.
+    int index;
+  };
+
+  // Column values, column refs and RETURNS clause of the request.
+  QLWriteRequestPB request;
+  std::vector<BindSlot> slots;
+};
+
+//--------------------------------------------------------------------------------------------------
+
 class PTInsertStmt : public PTDmlStmt {
  public:
   //------------------------------------------------------------------------------------------------
@@ -74,6 +105,17 @@ class PTInsertStmt : public PTDmlStmt {
     return relation_->loc();
   }
 
+  // Request template built by the executor the first time the statement is executed, or nullptr.
+  // The parse tree of a prepared statement is shared by concurrent executions, hence the atomic
+  // access.
+  std::shared_ptr<const InsertRequestTemplate> request_template() const {
+    return std::atomic_load(&request_template_);
+  }
+
+  void set_request_template(std::shared_ptr<const InsertRequestTemplate> request_template) const {
+    std::atomic_store(&request_template_, std::move(request_template));
+  }
+
  private:
   // --- The parser will decorate this node with the following information --
 
@@ -83,6 +125,9 @@ class PTInsertStmt : public PTDmlStmt {
 
   // -- The semantic analyzer will decorate this node with the following information --
 
+  // -- The executor will decorate this node with the following information --
+
+  mutable std::shared_ptr<const InsertRequestTemplate> request_template_;
 };
 
 }  // namespace ql
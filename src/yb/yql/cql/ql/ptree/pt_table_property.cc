@@ -458,10 +458,29 @@ Status PTTablePropertyMap::SetTableProperty(yb::TableProperties *table_property)
   }
   switch (iterator->second) {
     case PropertyMapType::kCaching: FALLTHROUGH_INTENDED;
-    case PropertyMapType::kCompaction: FALLTHROUGH_INTENDED;
     case PropertyMapType::kCompression:
       LOG(WARNING) << "Ignoring table property " << table_property_name;
       break;
+    case PropertyMapType::kCompaction:
+      for (const auto& subproperty : map_elements_->node_list()) {
+        string subproperty_name;
+        ToLowerCase(subproperty->lhs()->c_str(), &subproperty_name);
+        if (subproperty_name != "class") {
+          continue;
+        }
+        // Same as in AnalyzeCompaction, the last 'class' subproperty wins.
+        string class_name;
+        RETURN_NOT_OK(
+            GetStringValueFromExpr(subproperty->rhs(), false, subproperty_name, &class_name));
+        if (class_name.find('.') == string::npos) {
+          class_name.insert(0, Compaction::kClassPrefix);
+        }
+        table_property->SetCompactionStyle(
+            class_name == Compaction::kLeveledCompactionStrategy
+                ? TableCompactionStyle::LEVELED_COMPACTION
+                : TableCompactionStyle::UNIVERSAL_COMPACTION);
+      }
+      break;
     case PropertyMapType::kTransactions:
       for (const auto& subproperty : map_elements_->node_list()) {
         string subproperty_name;
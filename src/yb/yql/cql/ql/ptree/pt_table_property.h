@@ -263,6 +263,9 @@ struct Compaction {
 
   static constexpr auto kClassPrefix = "org.apache.cassandra.db.compaction.";
   static const auto kClassPrefixLen = std::strlen(kClassPrefix);
+  // The only strategy that maps to leveled compaction, all other ones use universal compaction.
+  static constexpr auto kLeveledCompactionStrategy =
+      "org.apache.cassandra.db.compaction.LeveledCompactionStrategy";
 
   static const std::map<std::string, std::set<Subproperty>> kClassSubproperties;
 
@@ -16,6 +16,17 @@
 #include "yb/common/table_properties_constants.h"
 #include "yb/yql/cql/ql/test/ql-test-base.h"
 
+#include "yb/tablet/tablet.h"
+#include "yb/tablet/tablet_peer.h"
+#include "yb/tablet/transaction_participant.h"
+
+#include "yb/tserver/mini_tablet_server.h"
+#include "yb/tserver/tablet_server.h"
+#include "yb/tserver/ts_tablet_manager.h"
+
+DECLARE_bool(transaction_single_shard_fast_path);
+DECLARE_double(transaction_ignore_applying_probability_in_tests);
+
 namespace yb {
 namespace ql {
 
@@ -29,6 +40,20 @@ class TestQLInsertTable : public QLTestBase {
         "INSERT INTO human_resource(id, name, salary) VALUES(1, 'Scott Tiger', 100) USING TTL $0;",
         ttl_seconds);
   }
+
+  size_t CountIntents() {
+    size_t result = 0;
+    for (int i = 0; i != cluster_->num_tablet_servers(); ++i) {
+      auto peers = cluster_->mini_tablet_server(i)->server()->tablet_manager()->GetTabletPeers();
+      for (const auto& peer : peers) {
+        auto participant = peer->tablet()->transaction_participant();
+        if (participant) {
+          result += participant->TEST_CountIntents();
+        }
+      }
+    }
+    return result;
+  }
 };
 
 TEST_F(TestQLInsertTable, TestQLInsertTableSimple) {
@@ -126,5 +151,62 @@ TEST_F(TestQLInsertTable, TestQLInsertTableSimple) {
   // tested here also.
 }
 
+// Test that transaction block, whose writes go to a single tablet, is written without intents.
+TEST_F(TestQLInsertTable, TestInsertSingleShardTransaction) {
+  FLAGS_transaction_single_shard_fast_path = true;
+  ASSERT_NO_FATALS(CreateSimulatedCluster());
+  TestQLProcessor *processor = GetQLProcessor();
+  EXEC_VALID_STMT("CREATE TABLE t (h int, r int, v int, PRIMARY KEY ((h), r)) "
+                  "WITH transactions = { 'enabled' : true };");
+
+  // Keep intents of regular transactions, so they could be counted after commit.
+  FLAGS_transaction_ignore_applying_probability_in_tests = 1.0;
+  const std::string kTransaction =
+      "BEGIN TRANSACTION "
+      "  INSERT INTO t (h, r, v) VALUES ($0, 1, 1); "
+      "  INSERT INTO t (h, r, v) VALUES ($0, 2, 2); "
+      "END TRANSACTION;";
+
+  EXEC_VALID_STMT(strings::Substitute(kTransaction, 1));
+  ASSERT_EQ(0, CountIntents());
+
+  FLAGS_transaction_single_shard_fast_path = false;
+  EXEC_VALID_STMT(strings::Substitute(kTransaction, 2));
+  ASSERT_GT(CountIntents(), 0);
+
+  for (int h = 1; h <= 2; ++h) {
+    EXEC_VALID_STMT(strings::Substitute("SELECT h, r, v FROM t WHERE h = $0;", h));
+    ASSERT_EQ(2, processor->row_block()->row_count());
+  }
+}
+
+// Test that transaction block, whose writes read existing data, is written with intents, so its
+// read time is checked against concurrent writes.
+TEST_F(TestQLInsertTable, TestSingleShardTransactionWithReads) {
+  FLAGS_transaction_single_shard_fast_path = true;
+  ASSERT_NO_FATALS(CreateSimulatedCluster());
+  TestQLProcessor *processor = GetQLProcessor();
+  EXEC_VALID_STMT("CREATE TABLE t (h int, r int, l list<int>, PRIMARY KEY ((h), r)) "
+                  "WITH transactions = { 'enabled' : true };");
+  EXEC_VALID_STMT("INSERT INTO t (h, r, l) VALUES (1, 1, [1, 2, 3]);");
+  EXEC_VALID_STMT("INSERT INTO t (h, r, l) VALUES (1, 2, [1, 2, 3]);");
+
+  FLAGS_transaction_ignore_applying_probability_in_tests = 1.0;
+  const std::vector<std::string> kStatements = {
+    "UPDATE t SET l = l - [1] WHERE h = 1 AND r = 1;",
+    "UPDATE t SET l[0] = 10 WHERE h = 1 AND r = 1;",
+    "DELETE FROM t WHERE h = 1;",
+  };
+  for (const auto& statement : kStatements) {
+    LOG(INFO) << "Statement: " << statement;
+    auto intents_before = CountIntents();
+    EXEC_VALID_STMT("BEGIN TRANSACTION " + statement + " END TRANSACTION;");
+    ASSERT_GT(CountIntents(), intents_before);
+  }
+
+  EXEC_VALID_STMT("SELECT h, r, l FROM t WHERE h = 1;");
+  ASSERT_EQ(0, processor->row_block()->row_count());
+}
+
 } // namespace ql
 } // namespace yb
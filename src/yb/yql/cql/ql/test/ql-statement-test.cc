@@ -26,9 +26,31 @@ using std::unique_ptr;
 using std::shared_ptr;
 using strings::Substitute;
 
+DECLARE_bool(cql_prepared_insert_templates);
+
 namespace yb {
 namespace ql {
 
+// Statement parameters with the bind variables given by position.
+class PositionalParameters : public StatementParameters {
+ public:
+  explicit PositionalParameters(std::vector<QLValue> values) : values_(std::move(values)) {}
+
+  CHECKED_STATUS GetBindVariable(const std::string& name,
+                                 int64_t pos,
+                                 const std::shared_ptr<QLType>& type,
+                                 QLValue* value) const override {
+    if (pos < 0 || pos >= static_cast<int64_t>(values_.size())) {
+      return STATUS_FORMAT(NotFound, "No bind variable at position $0", pos);
+    }
+    *value = values_[pos];
+    return Status::OK();
+  }
+
+ private:
+  std::vector<QLValue> values_;
+};
+
 class TestQLStatement : public QLTestBase {
  public:
   TestQLStatement() : QLTestBase() {
@@ -44,6 +66,21 @@ class TestQLStatement : public QLTestBase {
                               Bind(&TestQLStatement::ExecuteAsyncDone, Unretained(this), cb));
   }
 
+  Status Execute(Statement *stmt, QLProcessor *processor, const StatementParameters& params) {
+    Synchronizer sync;
+    RETURN_NOT_OK(stmt->ExecuteAsync(
+        processor, params,
+        Bind(&TestQLStatement::ExecuteAsyncDone, Unretained(this),
+             Bind(&Synchronizer::StatusCB, Unretained(&sync)))));
+    return sync.Wait();
+  }
+
+  static QLValue Int32Value(int32_t value) {
+    QLValue result;
+    result.set_int32_value(value);
+    return result;
+  }
+
 };
 
 TEST_F(TestQLStatement, TestExecutePrepareAfterTableDrop) {
@@ -103,5 +140,50 @@ TEST_F(TestQLStatement, TestPKIndices) {
   LOG(INFO) << "Done.";
 }
 
+TEST_F(TestQLStatement, TestPreparedInsertTemplate) {
+  // Init the simulated cluster.
+  ASSERT_NO_FATALS(CreateSimulatedCluster());
+
+  // Get a processor.
+  TestQLProcessor *processor = GetQLProcessor();
+
+  EXEC_VALID_STMT("create table t (h int, r int, v int, c int, primary key ((h), r));");
+
+  // The column order differs from the table, and c is a constant, so that the bind variables
+  // and the constant end up in all parts of the write request.
+  Statement stmt(processor->CurrentKeyspace(), "insert into t (v, r, h, c) values (?, ?, ?, 5);");
+  ASSERT_OK(stmt.Prepare(processor));
+
+  // The first execution of each run builds the template, when it is enabled, and the following
+  // ones are executed from it. Both have to store the same rows.
+  constexpr int kNumRows = 5;
+  for (bool use_templates : {false, true}) {
+    FLAGS_cql_prepared_insert_templates = use_templates;
+    const int h = use_templates ? 2 : 1;
+    for (int r = 0; r != kNumRows; ++r) {
+      ASSERT_OK(Execute(&stmt, processor, PositionalParameters(
+          {Int32Value(r * 10), Int32Value(r), Int32Value(h)})));
+    }
+
+    // Null values are still rejected for primary key columns.
+    Status status = Execute(&stmt, processor, PositionalParameters(
+        {Int32Value(0), QLValue(), Int32Value(h)}));
+    ASSERT_TRUE(status.IsQLError() &&
+                GetErrorCode(status) == ErrorCode::NULL_ARGUMENT_FOR_PRIMARY_KEY)
+        << "Expect NULL_ARGUMENT_FOR_PRIMARY_KEY but got " << status;
+
+    CHECK_VALID_STMT(Substitute("select h, r, v, c from t where h = $0;", h));
+    std::shared_ptr<QLRowBlock> row_block = processor->row_block();
+    ASSERT_EQ(row_block->row_count(), kNumRows);
+    for (int r = 0; r != kNumRows; ++r) {
+      const QLRow& row = row_block->row(r);
+      ASSERT_EQ(row.column(0).int32_value(), h);
+      ASSERT_EQ(row.column(1).int32_value(), r);
+      ASSERT_EQ(row.column(2).int32_value(), r * 10);
+      ASSERT_EQ(row.column(3).int32_value(), 5);
+    }
+  }
+}
+
 } // namespace ql
 } // namespace yb
@@ -54,6 +54,10 @@ void QLTestBase::CreateSimulatedCluster(int num_tablet_servers) {
   builder.default_rpc_timeout(MonoDelta::FromSeconds(30));
   builder.set_tserver_uuid(cluster_->mini_tablet_server(0)->server()->permanent_uuid());
   ASSERT_OK(builder.Build(&client_));
+  clock_.reset(new server::HybridClock());
+  ASSERT_OK(clock_->Init());
+  transaction_manager_ = std::make_unique<client::TransactionManager>(
+      client_, clock_, client::LocalTabletFilter());
   metadata_cache_ = std::make_shared<client::YBMetaDataCache>(client_,
       false /* Update roles' permissions cache */);
   ASSERT_OK(client_->CreateNamespaceIfNotExists(kDefaultKeyspaceName));
@@ -74,7 +78,8 @@ TestQLProcessor* QLTestBase::GetQLProcessor(const RoleName& role_name) {
     CreateSimulatedCluster();
   }
 
-  ql_processors_.emplace_back(new TestQLProcessor(client_, metadata_cache_, role_name));
+  ql_processors_.emplace_back(new TestQLProcessor(
+      client_, metadata_cache_, role_name, [this] { return transaction_manager_.get(); }));
   CallUseKeyspace(ql_processors_.back(), kDefaultKeyspaceName);
   return ql_processors_.back().get();
 }
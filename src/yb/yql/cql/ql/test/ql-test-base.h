@@ -93,9 +93,10 @@ class TestQLProcessor : public ClockHolder, public QLProcessor {
   // Constructors.
   TestQLProcessor(std::shared_ptr<client::YBClient> client,
                   std::shared_ptr<client::YBMetaDataCache> cache,
-                  const RoleName& role_name)
+                  const RoleName& role_name,
+                  TransactionManagerProvider transaction_manager_provider)
       : QLProcessor(client, cache, nullptr /* ql_metrics */, clock_,
-                    TransactionManagerProvider()) {
+                    std::move(transaction_manager_provider)) {
     if (!role_name.empty()) {
       ql_env_.ql_session()->set_current_role_name(role_name);
     }
@@ -239,6 +240,10 @@ class QLTestBase : public YBTest {
   std::shared_ptr<client::YBClient> client_;
   std::shared_ptr<client::YBMetaDataCache> metadata_cache_;
 
+  // Transaction manager used by transactional statements.
+  server::ClockPtr clock_;
+  std::unique_ptr<client::TransactionManager> transaction_manager_;
+
   // QL Processor.
   std::vector<TestQLProcessor::UniPtr> ql_processors_;
 
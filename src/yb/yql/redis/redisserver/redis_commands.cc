@@ -30,6 +30,7 @@
 #include "yb/rpc/scheduler.h"
 
 #include "yb/util/crypt.h"
+#include "yb/util/flag_tags.h"
 #include "yb/util/metrics.h"
 #include "yb/util/redis_util.h"
 #include "yb/util/stol_utils.h"
@@ -60,6 +61,14 @@ DEFINE_string(redis_passwords_separator, ",", "The character used to separate mu
 DEFINE_int32(redis_keys_threshold, 10000,
              "Maximum number of keys allowed to be in the db before the KEYS operation errors out");
 
+DEFINE_int32(redis_follower_read_max_staleness_ms, 0,
+             "If positive, read commands are served by the closest replica, which can be a "
+             "follower, and return data that is at most this many milliseconds stale. The bound "
+             "applies to all read commands handled by this server's Redis proxy, it can't be set "
+             "per connection or per command.");
+TAG_FLAG(redis_follower_read_max_staleness_ms, evolving);
+TAG_FLAG(redis_follower_read_max_staleness_ms, runtime);
+
 __attribute__((unused))
 DEFINE_validator(redis_passwords_separator, &ValidateRedisPasswordSeparator);
 
@@ -183,6 +192,15 @@ namespace {
 template<class Op>
 using Parser = Status(*)(Op*, const RedisClientCommand&);
 
+void SetReadOptions(yb::client::YBRedisWriteOp* op) {
+}
+
+void SetReadOptions(yb::client::YBRedisReadOp* op) {
+  if (FLAGS_redis_follower_read_max_staleness_ms > 0) {
+    op->set_max_staleness(MonoDelta::FromMilliseconds(FLAGS_redis_follower_read_max_staleness_ms));
+  }
+}
+
 template<class Op>
 void Command(
     const RedisCommandInfo& info,
@@ -204,6 +222,7 @@ void Command(
     RespondWithFailure(context->call(), idx, s.message().ToBuffer());
     return;
   }
+  SetReadOptions(op.get());
   context->Apply(idx, std::move(op), info.metrics);
 }
 
@@ -51,6 +51,7 @@
 #include "yb/tserver/tserver_service.proxy.h"
 
 #include "yb/util/bytes_formatter.h"
+#include "yb/util/flag_tags.h"
 #include "yb/util/locks.h"
 #include "yb/util/logging.h"
 #include "yb/util/memory/mc_types.h"
@@ -87,6 +88,12 @@ DEFINE_REDIS_histogram_EX(set_internal,
 DEFINE_REDIS_SESSION_GAUGE(allocated);
 DEFINE_REDIS_SESSION_GAUGE(available);
 
+METRIC_DEFINE_histogram(
+    server, redis_coalesced_flush_operations, "Operations per coalesced flush",
+    yb::MetricUnit::kOperations,
+    "Number of Redis operations of different connections sent together by one coalesced flush.",
+    100000, 2);
+
 METRIC_DEFINE_gauge_uint64(
     server, redis_monitoring_clients, "Number of clients running monitor", yb::MetricUnit::kUnits,
     "Number of clients running monitor ");
@@ -116,6 +123,15 @@ DEFINE_int32(redis_password_caching_duration_ms, 5000,
              "The duration for which we will cache the redis passwords. 0 to disable.");
 
 DEFINE_bool(redis_safe_batch, true, "Use safe batching with Redis service");
+DEFINE_int32(redis_coalesce_linger_us, 0,
+             "If positive, the Redis operations of all connections that become ready within this "
+             "many microseconds are flushed together, so that operations of different connections "
+             "on the same tablet are sent in one read and one write RPC. 0 to disable.");
+TAG_FLAG(redis_coalesce_linger_us, advanced);
+DEFINE_int32(redis_coalesce_max_operations, 1000,
+             "Coalesced Redis operations are flushed without waiting for the linger time to pass "
+             "once there are this many of them.");
+TAG_FLAG(redis_coalesce_max_operations, advanced);
 DEFINE_bool(enable_redis_auth, true, "Enable AUTH for the Redis service");
 
 DECLARE_string(placement_cloud);
@@ -330,11 +346,15 @@ class Operation {
   std::atomic<bool> responded_{false};
 };
 
+class BlockCoalescer;
+
 class SessionPool {
  public:
   void Init(const std::shared_ptr<client::YBClient>& client,
-            const scoped_refptr<MetricEntity>& metric_entity) {
+            const scoped_refptr<MetricEntity>& metric_entity,
+            BlockCoalescer* coalescer) {
     client_ = client;
+    coalescer_ = coalescer;
     auto* proto = &METRIC_redis_allocated_sessions;
     allocated_sessions_metric_ = proto->Instantiate(metric_entity, 0);
     proto = &METRIC_redis_available_sessions;
@@ -360,8 +380,15 @@ class SessionPool {
     available_sessions_metric_->IncrementBy(1);
     queue_.push(session.get());
   }
+
+  // Coalescer that blocks are launched through, or nullptr if coalescing is disabled.
+  BlockCoalescer* coalescer() const {
+    return coalescer_;
+  }
+
  private:
   std::shared_ptr<client::YBClient> client_;
+  BlockCoalescer* coalescer_ = nullptr;
   std::mutex mutex_;
   std::vector<std::shared_ptr<client::YBSession>> sessions_;
   boost::lockfree::queue<client::YBSession*> queue_{30};
@@ -371,6 +398,50 @@ class SessionPool {
 
 class Block;
 typedef std::shared_ptr<Block> BlockPtr;
+typedef std::unordered_map<const client::YBOperation*, Status> OperationErrors;
+
+OperationErrors GetOperationErrors(const Status& status, client::YBSession* session) {
+  OperationErrors op_errors;
+  if (!status.ok() && session != nullptr) {
+    for (const auto& error : session->GetPendingErrors()) {
+      op_errors[&error->failed_op()] = std::move(error->status());
+      YB_LOG_EVERY_N_SECS(WARNING, 1) << "Explicit error while inserting: "
+                                      << error->status().ToString();
+    }
+  }
+  return op_errors;
+}
+
+
+// Collects the blocks of all connections that are ready to be launched for a short time, and
+// applies their operations to a single session, so that the batcher sends one read and one write
+// RPC per tablet for all of them. Blocks of the same connection are still launched one after the
+// other, so the order of commands within a connection is preserved.
+class BlockCoalescer : public std::enable_shared_from_this<BlockCoalescer> {
+ public:
+  explicit BlockCoalescer(SessionPool* session_pool) : session_pool_(session_pool) {}
+
+  void Init(const std::shared_ptr<client::YBClient>& client,
+            const scoped_refptr<MetricEntity>& metric_entity) {
+    client_ = client;
+    operations_per_flush_ = METRIC_redis_coalesced_flush_operations.Instantiate(metric_entity);
+  }
+
+  // Queues the block, the block should contain read and write operations only.
+  void Add(BlockPtr block, size_t num_operations);
+
+ private:
+  void Flush();
+
+  SessionPool* const session_pool_;
+  std::shared_ptr<client::YBClient> client_;
+  scoped_refptr<Histogram> operations_per_flush_;
+
+  std::mutex mutex_;
+  std::vector<BlockPtr> blocks_;
+  size_t num_operations_ = 0;
+  bool flush_scheduled_ = false;
+};
 
 class Block : public std::enable_shared_from_this<Block> {
  public:
@@ -394,6 +465,11 @@ class Block : public std::enable_shared_from_this<Block> {
 
   void Launch(SessionPool* session_pool, bool allow_local_calls_in_curr_thread = true) {
     session_pool_ = session_pool;
+    auto* coalescer = session_pool->coalescer();
+    if (coalescer != nullptr && Coalescable()) {
+      coalescer->Add(shared_from_this(), ops_.size());
+      return;
+    }
     session_ = session_pool->Take();
     bool has_ok = false;
     bool applied_operations = false;
@@ -414,6 +490,32 @@ class Block : public std::enable_shared_from_this<Block> {
     }
   }
 
+  // Applies the operations of a coalesced block to the shared session. Returns false and completes
+  // the block if none of them was applied.
+  static bool ApplyCoalesced(BlockPtr* block, client::YBSession* session) {
+    bool has_ok = false;
+    bool applied_operations = false;
+    StatusFunctor callback;
+    for (auto* op : (**block).ops_) {
+      has_ok = op->Apply(session, callback, &applied_operations) || has_ok;
+    }
+    if (!has_ok) {
+      // See BlockCallback.
+      auto context = (**block).context_;
+      (**block).Processed();
+      block->reset();
+    }
+    return has_ok;
+  }
+
+  // Completes a coalesced block, once the shared session was flushed.
+  static void CoalescedDone(BlockPtr block, const Status& status, const OperationErrors& errors) {
+    // See BlockCallback.
+    auto context = block->context_;
+    block->Done(status, errors);
+    block.reset();
+  }
+
   BlockPtr SetNext(const BlockPtr& next) {
     BlockPtr result = std::move(next_);
     next_ = next;
@@ -447,21 +549,23 @@ class Block : public std::enable_shared_from_this<Block> {
   friend class BlockCallback;
 
   void Done(const Status& status) {
+    Done(status, GetOperationErrors(status, session_.get()));
+  }
+
+  void Done(const Status& status, const OperationErrors& op_errors) {
     MonoTime now = MonoTime::Now();
     metrics_internal_.handler_latency->Increment(now.GetDeltaSince(start_).ToMicroseconds());
     VLOG(3) << "Received status from call " << status.ToString(true);
 
-    std::unordered_map<const client::YBOperation*, Status> op_errors;
+    // The errors of a coalesced flush also contain the ones of other blocks, so only errors of
+    // our own operations are considered.
     bool tablet_not_found = false;
-    if (!status.ok()) {
-      if (session_ != nullptr) {
-        for (const auto& error : session_->GetPendingErrors()) {
-          if (error->status().IsNotFound()) {
-            tablet_not_found = true;
-          }
-          op_errors[&error->failed_op()] = std::move(error->status());
-          YB_LOG_EVERY_N_SECS(WARNING, 1) << "Explicit error while inserting: "
-                                          << error->status().ToString();
+    for (auto* op : ops_) {
+      if (op->has_operation()) {
+        auto it = op_errors.find(&op->operation());
+        if (it != op_errors.end() && it->second.IsNotFound()) {
+          tablet_not_found = true;
+          break;
         }
       }
     }
@@ -472,10 +576,10 @@ class Block : public std::enable_shared_from_this<Block> {
     }
 
     for (auto* op : ops_) {
-      if (op->has_operation() && op_errors.find(&op->operation()) != op_errors.end()) {
+      auto it = op->has_operation() ? op_errors.find(&op->operation()) : op_errors.end();
+      if (it != op_errors.end()) {
         // Could check here for NotFound either.
-        auto s = op_errors[&op->operation()];
-        op->Respond(s);
+        op->Respond(it->second);
       } else {
         op->Respond(Status::OK());
       }
@@ -484,6 +588,17 @@ class Block : public std::enable_shared_from_this<Block> {
     Processed();
   }
 
+  // Only blocks of read and write operations are coalesced. Local operations, like DebugSleep,
+  // flush the session on their own.
+  bool Coalescable() const {
+    for (auto* op : ops_) {
+      if (!op->has_operation()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
   void Processed() {
     auto allow_local_calls_in_curr_thread = false;
     if (session_) {
@@ -543,6 +658,82 @@ class Block : public std::enable_shared_from_this<Block> {
   int num_retries_ = 1;
 };
 
+void BlockCoalescer::Add(BlockPtr block, size_t num_operations) {
+  bool flush_now = false;
+  bool schedule_flush = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    blocks_.push_back(std::move(block));
+    num_operations_ += num_operations;
+    if (num_operations_ >= implicit_cast<size_t>(FLAGS_redis_coalesce_max_operations)) {
+      flush_now = true;
+    } else if (!flush_scheduled_) {
+      flush_scheduled_ = true;
+      schedule_flush = true;
+    }
+  }
+
+  if (flush_now) {
+    Flush();
+  } else if (schedule_flush) {
+    // Blocks added after an early flush could be flushed by an already scheduled task, i.e. before
+    // the linger time passes, which is fine.
+    // The task is aborted when the messenger shuts down, then the queued blocks are not flushed.
+    std::weak_ptr<BlockCoalescer> weak_self = shared_from_this();
+    client_->messenger()->scheduler().Schedule(
+        [weak_self](const Status& status) {
+          if (!status.ok()) {
+            return;
+          }
+          auto self = weak_self.lock();
+          if (self) {
+            self->Flush();
+          }
+        },
+        std::chrono::microseconds(FLAGS_redis_coalesce_linger_us));
+  }
+}
+
+void BlockCoalescer::Flush() {
+  std::vector<BlockPtr> blocks;
+  size_t num_operations;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    blocks.swap(blocks_);
+    num_operations = num_operations_;
+    num_operations_ = 0;
+    flush_scheduled_ = false;
+  }
+  if (blocks.empty()) {
+    return;
+  }
+  operations_per_flush_->Increment(num_operations);
+
+  auto session = session_pool_->Take();
+  auto applied_blocks = std::make_shared<std::vector<BlockPtr>>();
+  applied_blocks->reserve(blocks.size());
+  for (auto& block : blocks) {
+    if (Block::ApplyCoalesced(&block, session.get())) {
+      applied_blocks->push_back(std::move(block));
+    }
+  }
+  if (applied_blocks->empty()) {
+    session_pool_->Release(session);
+    return;
+  }
+
+  // The flush could be done from a reactor thread, so local calls are not executed in place.
+  session->set_allow_local_calls_in_curr_thread(false);
+  auto* session_pool = session_pool_;
+  session->FlushAsync([session_pool, session, applied_blocks](const Status& status) {
+    auto errors = GetOperationErrors(status, session.get());
+    session_pool->Release(session);
+    for (auto& block : *applied_blocks) {
+      Block::CoalescedDone(std::move(block), status, errors);
+    }
+  });
+}
+
 typedef std::array<rpc::RpcMethodMetrics, kOperationTypeMapSize> InternalMetrics;
 
 struct BlockData {
@@ -786,6 +977,8 @@ struct RedisServiceImplData : public RedisServiceData {
   std::atomic<bool> initialized_;
   std::shared_ptr<client::YBClient> client_;
   SessionPool session_pool_;
+  // Shared with the scheduled flush tasks.
+  std::shared_ptr<BlockCoalescer> coalescer_;
   std::unordered_map<std::string, std::shared_ptr<client::YBTable>> db_to_opened_table_;
   std::shared_ptr<client::YBMetaDataCache> tables_cache_;
 
@@ -1381,7 +1574,11 @@ Status RedisServiceImplData::Initialize() {
 
     tables_cache_ = std::make_shared<YBMetaDataCache>(client_,
         false /* Update roles permissions cache */);
-    session_pool_.Init(client_, server_->metric_entity());
+    if (FLAGS_redis_coalesce_linger_us > 0) {
+      coalescer_ = std::make_shared<BlockCoalescer>(&session_pool_);
+      coalescer_->Init(client_, server_->metric_entity());
+    }
+    session_pool_.Init(client_, server_->metric_entity(), coalescer_.get());
 
     initialized_.store(true, std::memory_order_release);
   }
@@ -53,6 +53,7 @@ DECLARE_int32(redis_service_yb_client_timeout_millis);
 DECLARE_int32(redis_max_value_size);
 DECLARE_int32(redis_max_command_size);
 DECLARE_int32(redis_password_caching_duration_ms);
+DECLARE_int32(redis_coalesce_linger_us);
 DECLARE_int32(rpc_max_message_size);
 DECLARE_int32(consensus_max_batch_size_bytes);
 DECLARE_int32(consensus_rpc_timeout_ms);
@@ -66,6 +67,7 @@ DEFINE_uint64(test_redis_max_batch, 250,
 METRIC_DECLARE_gauge_uint64(redis_available_sessions);
 METRIC_DECLARE_gauge_uint64(redis_allocated_sessions);
 METRIC_DECLARE_gauge_uint64(redis_monitoring_clients);
+METRIC_DECLARE_histogram(redis_coalesced_flush_operations);
 
 using namespace std::literals;
 using namespace std::placeholders;
@@ -308,6 +310,10 @@ class TestRedisService : public RedisTableTestBase {
     return counter->value();
   }
 
+  uint64_t CountHistogramValues(const HistogramPrototype& proto) {
+    return server_->metric_entity()->FindOrCreateHistogram(&proto)->TotalCount();
+  }
+
   void TestTSTtl(const std::string& expire_command, int64_t ttl_sec, int64_t expire_val,
       const std::string& redis_key) {
     DoRedisTestOk(__LINE__, {"TSADD", redis_key, "10", "v1", "20", "v2", "30", "v3", expire_command,
@@ -1180,6 +1186,75 @@ TEST_F_EX(TestRedisService, PipelinePartial, TestRedisServicePipelined) {
       true /* partial */);
 }
 
+class TestRedisServiceConnections : public TestRedisService {
+ protected:
+  // Runs many connections, each of them sending a single command and waiting for its response
+  // before sending the next one, and returns the total number of commands per second. Each GET
+  // reads the value written by the SET just before it on the same connection.
+  double RunSingleCommandConnections() {
+    const int kNumConnections = AllowSlowTests() ? 1000 : 50;
+    const auto kDuration = std::chrono::seconds(AllowSlowTests() ? 30 : 5);
+
+    std::atomic<bool> stop(false);
+    std::atomic<size_t> num_commands(0);
+    std::atomic<size_t> num_wrong_replies(0);
+    std::vector<std::thread> threads;
+    threads.reserve(kNumConnections);
+    for (int i = 0; i != kNumConnections; ++i) {
+      threads.emplace_back([this, i, &stop, &num_commands, &num_wrong_replies] {
+        RedisClient client("127.0.0.1", server_port());
+        for (size_t j = 0; !stop.load(std::memory_order_acquire); ++j) {
+          auto key = Format("key_$0_$1", i, j / 2 % 100);
+          auto value = Format("value_$0_$1", i, j / 2);
+          auto command = j % 2 == 0 ? RedisCommand{"SET", key, value} : RedisCommand{"GET", key};
+          auto expected = j % 2 == 0 ? std::string("OK") : value;
+          client.Send(command, [&num_wrong_replies, &command, &expected](const RedisReply& reply) {
+            if (reply.get_type() == RedisReplyType::kError || reply.as_string() != expected) {
+              if (num_wrong_replies.fetch_add(1, std::memory_order_acq_rel) == 0) {
+                LOG(ERROR) << "Wrong reply to " << yb::ToString(command) << ": "
+                           << reply.as_string() << ", expected: " << expected;
+              }
+            }
+          });
+          client.Commit();
+          num_commands.fetch_add(1, std::memory_order_acq_rel);
+        }
+      });
+    }
+
+    std::this_thread::sleep_for(kDuration);
+    stop.store(true, std::memory_order_release);
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    EXPECT_EQ(0, num_wrong_replies.load(std::memory_order_acquire));
+    auto result = num_commands.load(std::memory_order_acquire) /
+                  std::chrono::duration<double>(kDuration).count();
+    LOG(INFO) << kNumConnections << " connections: " << result << " commands/s";
+    return result;
+  }
+};
+
+class TestRedisServiceCoalesced : public TestRedisServiceConnections {
+ public:
+  void SetUp() override {
+    FLAGS_redis_coalesce_linger_us = 200;
+    TestRedisServiceConnections::SetUp();
+  }
+};
+
+TEST_F_EX(TestRedisService, SingleCommandConnections, TestRedisServiceConnections) {
+  RunSingleCommandConnections();
+}
+
+TEST_F_EX(TestRedisService, SingleCommandConnectionsCoalesced, TestRedisServiceCoalesced) {
+  RunSingleCommandConnections();
+  auto num_flushes = CountHistogramValues(METRIC_redis_coalesced_flush_operations);
+  ASSERT_GT(num_flushes, 0);
+  LOG(INFO) << "Coalesced flushes: " << num_flushes;
+}
+
 namespace {
 
 class BatchGenerator {